@@ -0,0 +1,57 @@
+#include "3rd-party/catch.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "corpus.h"
+#include "rssfeed.h"
+#include "test/test_helpers/tempfile.h"
+
+using namespace newsboat;
+
+TEST_CASE("Storing feeds in the cache", "[cache]")
+{
+	const auto corpus = bench::generate_corpus(bench::corpus_size());
+
+	ConfigContainer cfg;
+	auto parse_cache = Cache::in_memory(cfg);
+	const auto feeds = bench::parse_corpus(corpus, *parse_cache, cfg);
+
+	BENCHMARK_ADVANCED("Cache::externalize_rssfeed (new articles)")(
+		Catch::Benchmark::Chronometer meter) {
+		std::vector<test_helpers::TempFile> files(meter.runs());
+		std::vector<std::unique_ptr<Cache>> caches;
+		for (const auto& file : files) {
+			caches.push_back(std::make_unique<Cache>(file.get_path(), cfg));
+		}
+		meter.measure([&](int run) {
+			for (const auto& feed : feeds) {
+				caches[run]->externalize_rssfeed(*feed, false);
+			}
+		});
+	};
+
+	test_helpers::TempFile file;
+	Cache cache(file.get_path(), cfg);
+	for (const auto& feed : feeds) {
+		cache.externalize_rssfeed(*feed, false);
+	}
+
+	BENCHMARK("Cache::externalize_rssfeed (known articles)") {
+		for (const auto& feed : feeds) {
+			cache.externalize_rssfeed(*feed, false);
+		}
+	};
+
+	std::vector<std::string> urls;
+	for (const auto& feed : feeds) {
+		urls.push_back(feed->rssurl());
+	}
+
+	BENCHMARK("Cache::internalize_rssfeeds") {
+		return cache.internalize_rssfeeds(urls, nullptr);
+	};
+}
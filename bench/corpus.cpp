@@ -0,0 +1,151 @@
+#include "corpus.h"
+
+#include <ctime>
+#include <random>
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "rss/parser.h"
+#include "rssfeed.h"
+#include "rssparser.h"
+#include "strprintf.h"
+
+using namespace newsboat;
+
+namespace bench {
+
+namespace {
+
+const std::vector<std::string> words = {
+	"newsboat", "feed", "article", "reader", "terminal", "podcast", "episode",
+	"update", "release", "kernel", "compiler", "performance", "cache", "query",
+	"filter", "unread", "bookmark", "network", "server", "client", "library",
+	"the", "a", "of", "and", "to", "in", "is", "for", "on", "with", "as",
+};
+
+std::string sentence(std::mt19937& rng, unsigned int length)
+{
+	std::uniform_int_distribution<size_t> pick(0, words.size() - 1);
+	std::string result;
+	for (unsigned int i = 0; i < length; ++i) {
+		if (i > 0) {
+			result += ' ';
+		}
+		result += words[pick(rng)];
+	}
+	return result;
+}
+
+} // namespace
+
+CorpusSize& corpus_size()
+{
+	static CorpusSize size;
+	return size;
+}
+
+std::string generate_html(unsigned int size, std::uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> block(0, 9);
+
+	std::string result;
+	while (result.size() < size) {
+		const int kind = block(rng);
+		if (kind < 6) {
+			result += strprintf::fmt("<p>%s <b>%s</b> %s <a href=\"https://example.com/%u\">%s</a>. %s.</p>\n",
+					sentence(rng, 12),
+					sentence(rng, 2),
+					sentence(rng, 8),
+					static_cast<unsigned int>(rng() % 100000),
+					sentence(rng, 3),
+					sentence(rng, 10));
+		} else if (kind < 8) {
+			result += "<ul>\n";
+			for (int i = 0; i < 4; ++i) {
+				result += "<li>" + sentence(rng, 6) + "</li>\n";
+			}
+			result += "</ul>\n";
+		} else if (kind < 9) {
+			result += "<blockquote><i>" + sentence(rng, 20) + "</i></blockquote>\n";
+		} else {
+			result += "<table><tr><th>" + sentence(rng, 1) + "</th><th>" +
+				sentence(rng, 1) + "</th></tr>\n";
+			for (int i = 0; i < 3; ++i) {
+				result += "<tr><td>" + sentence(rng, 3) + "</td><td>" +
+					sentence(rng, 3) + "</td></tr>\n";
+			}
+			result += "</table>\n";
+		}
+	}
+	return result;
+}
+
+std::string generate_rss(unsigned int feed_index, const CorpusSize& size)
+{
+	std::mt19937 rng(feed_index);
+
+	std::string result =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<rss version=\"2.0\">\n<channel>\n";
+	result += strprintf::fmt("<title>Feed %u: %s</title>\n", feed_index,
+			sentence(rng, 3));
+	result += strprintf::fmt("<link>https://feed%u.example.com/</link>\n",
+			feed_index);
+	result += "<description>" + sentence(rng, 10) + "</description>\n";
+
+	for (unsigned int i = 0; i < size.items; ++i) {
+		const unsigned int article = feed_index * size.items + i;
+		// One article per hour, newest first
+		const time_t date = 1700000000 - static_cast<time_t>(article) * 3600;
+		char pubdate[64];
+		strftime(pubdate, sizeof(pubdate), "%a, %d %b %Y %H:%M:%S +0000",
+			gmtime(&date));
+
+		result += "<item>\n";
+		result += "<title>" + sentence(rng, 6) + "</title>\n";
+		result += strprintf::fmt("<link>https://feed%u.example.com/%u</link>\n",
+				feed_index, i);
+		result += strprintf::fmt("<guid>urn:bench:%u</guid>\n", article);
+		result += strprintf::fmt("<author>author%u@example.com (%s)</author>\n",
+				static_cast<unsigned int>(rng() % 50), sentence(rng, 2));
+		result += strprintf::fmt("<pubDate>%s</pubDate>\n", pubdate);
+		result += "<description><![CDATA[" + generate_html(size.body_size, article) +
+			"]]></description>\n";
+		result += "</item>\n";
+	}
+
+	result += "</channel>\n</rss>\n";
+	return result;
+}
+
+std::vector<std::string> generate_corpus(const CorpusSize& size)
+{
+	std::vector<std::string> result;
+	for (unsigned int i = 0; i < size.feeds; ++i) {
+		result.push_back(generate_rss(i, size));
+	}
+	return result;
+}
+
+std::string feed_url(unsigned int feed_index)
+{
+	return strprintf::fmt("https://feed%u.example.com/rss", feed_index);
+}
+
+std::vector<std::shared_ptr<RssFeed>> parse_corpus(
+		const std::vector<std::string>& corpus,
+		Cache& cache,
+		ConfigContainer& cfg)
+{
+	std::vector<std::shared_ptr<RssFeed>> result;
+	for (size_t i = 0; i < corpus.size(); ++i) {
+		rsspp::Parser parser;
+		const auto upstream = parser.parse_buffer(corpus[i]);
+		RssParser rssparser(feed_url(i), cache, cfg, nullptr);
+		result.push_back(rssparser.parse(upstream));
+	}
+	return result;
+}
+
+} // namespace bench
@@ -0,0 +1,52 @@
+#ifndef NEWSBOAT_BENCH_CORPUS_H_
+#define NEWSBOAT_BENCH_CORPUS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace newsboat {
+class Cache;
+class ConfigContainer;
+class RssFeed;
+}
+
+namespace bench {
+
+/// \brief Size of the synthetic corpus the benchmarks run on. Set from the
+/// command line, see main().
+struct CorpusSize {
+	unsigned int feeds = 20;
+	unsigned int items = 50;
+	/// Approximate size of each article's HTML body, in bytes
+	unsigned int body_size = 2000;
+};
+
+CorpusSize& corpus_size();
+
+/// \brief HTML article body of roughly \a size bytes: paragraphs with inline
+/// markup and links, lists and the occasional table. The same \a seed always
+/// gives the same body.
+std::string generate_html(unsigned int size, std::uint32_t seed);
+
+/// \brief RSS 2.0 document for feed number \a feed_index of the corpus.
+/// Article GUIDs are unique across feeds.
+std::string generate_rss(unsigned int feed_index, const CorpusSize& size);
+
+/// \brief generate_rss() for every feed of the corpus.
+std::vector<std::string> generate_corpus(const CorpusSize& size);
+
+/// \brief URL under which feed number \a feed_index is stored in the cache.
+std::string feed_url(unsigned int feed_index);
+
+/// \brief Parses every document of \a corpus into an RssFeed, the way a
+/// reload does.
+std::vector<std::shared_ptr<newsboat::RssFeed>> parse_corpus(
+		const std::vector<std::string>& corpus,
+		newsboat::Cache& cache,
+		newsboat::ConfigContainer& cfg);
+
+} // namespace bench
+
+#endif /* NEWSBOAT_BENCH_CORPUS_H_ */
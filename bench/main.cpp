@@ -0,0 +1,42 @@
+#define CATCH_CONFIG_RUNNER
+#include "3rd-party/catch.hpp"
+
+#include <clocale>
+
+#include "corpus.h"
+#include "strprintf.h"
+#include "test/test_helpers/httptestserver.h"
+
+int main(int argc, char* argv[])
+{
+	setlocale(LC_CTYPE, "");
+
+	Catch::Session session;
+
+	auto& size = bench::corpus_size();
+	using Catch::Clara::Opt;
+	session.cli(session.cli()
+		| Opt(size.feeds, "number")["--feeds"]
+		("number of feeds in the synthetic corpus")
+		| Opt(size.items, "number")["--items"]
+		("number of articles per feed")
+		| Opt(size.body_size, "bytes")["--body-size"]
+		("approximate size of each article's HTML body"));
+
+	const int rc = session.applyCommandLine(argc, argv);
+	if (rc != 0) {
+		return rc;
+	}
+
+	// Reports only compare if they were made with the same corpus, so record
+	// its size in them
+	if (session.configData().name.empty()) {
+		session.configData().name = newsboat::strprintf::fmt(
+				"feeds=%u items=%u body-size=%u",
+				size.feeds, size.items, size.body_size);
+	}
+
+	test_helpers::HttpTestServer server;
+
+	return session.run();
+}
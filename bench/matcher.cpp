@@ -0,0 +1,84 @@
+#include "3rd-party/catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "corpus.h"
+#include "matcher.h"
+#include "rssfeed.h"
+#include "rssignores.h"
+#include "rssitem.h"
+#include "strprintf.h"
+
+using namespace newsboat;
+
+TEST_CASE("Matching articles against filters", "[matcher]")
+{
+	const auto corpus = bench::generate_corpus(bench::corpus_size());
+
+	ConfigContainer cfg;
+	auto cache = Cache::in_memory(cfg);
+	const auto feeds = bench::parse_corpus(corpus, *cache, cfg);
+
+	std::vector<RssItem*> items;
+	for (const auto& feed : feeds) {
+		for (const auto& item : feed->items()) {
+			items.push_back(item.get());
+		}
+	}
+
+	const std::vector<std::string> filters = {
+		"unread = \"yes\"",
+		"title =~ \"kernel|compiler\"",
+		"author =~ \"author1\" and age < 30",
+		"content =~ \"performance cache\"",
+	};
+	for (const auto& filter : filters) {
+		Matcher matcher(filter);
+		BENCHMARK("Matcher::matches " + filter) {
+			unsigned int matching = 0;
+			for (const auto item : items) {
+				if (matcher.matches(item)) {
+					++matching;
+				}
+			}
+			return matching;
+		};
+	}
+}
+
+TEST_CASE("Matching articles against ignore-article rules", "[matcher]")
+{
+	const auto corpus = bench::generate_corpus(bench::corpus_size());
+
+	ConfigContainer cfg;
+	auto cache = Cache::in_memory(cfg);
+	const auto feeds = bench::parse_corpus(corpus, *cache, cfg);
+
+	// Half of the rules are for particular feeds, half match feeds by regex
+	RssIgnores ignores;
+	for (unsigned int i = 0; i < 100; ++i) {
+		ignores.handle_action("ignore-article", {
+			bench::feed_url(i),
+			"title =~ \"release\""
+		});
+		ignores.handle_action("ignore-article", {
+			strprintf::fmt("regex:^https://feed%u\\.", i),
+			"author = \"nobody\""
+		});
+	}
+
+	BENCHMARK("RssIgnores::matches 200 rules") {
+		unsigned int ignored = 0;
+		for (const auto& feed : feeds) {
+			for (const auto& item : feed->items()) {
+				if (ignores.matches(item.get())) {
+					++ignored;
+				}
+			}
+		}
+		return ignored;
+	};
+}
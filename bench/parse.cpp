@@ -0,0 +1,46 @@
+#include "3rd-party/catch.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "corpus.h"
+#include "rss/parser.h"
+#include "rssfeed.h"
+#include "rssparser.h"
+
+using namespace newsboat;
+
+TEST_CASE("Parsing feeds", "[parse]")
+{
+	const auto corpus = bench::generate_corpus(bench::corpus_size());
+
+	BENCHMARK("rsspp::Parser::parse_buffer") {
+		std::vector<rsspp::Feed> feeds;
+		for (const auto& xml : corpus) {
+			rsspp::Parser parser;
+			feeds.push_back(parser.parse_buffer(xml));
+		}
+		return feeds;
+	};
+
+	std::vector<rsspp::Feed> upstream;
+	for (const auto& xml : corpus) {
+		rsspp::Parser parser;
+		upstream.push_back(parser.parse_buffer(xml));
+	}
+
+	ConfigContainer cfg;
+	auto cache = Cache::in_memory(cfg);
+
+	BENCHMARK("RssParser::parse") {
+		std::vector<std::shared_ptr<RssFeed>> feeds;
+		for (size_t i = 0; i < upstream.size(); ++i) {
+			RssParser parser(bench::feed_url(i), *cache, cfg, nullptr);
+			feeds.push_back(parser.parse(upstream[i]));
+		}
+		return feeds;
+	};
+}
@@ -0,0 +1,74 @@
+#include "3rd-party/catch.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "corpus.h"
+#include "curlmultirunner.h"
+#include "feedretriever.h"
+#include "rssfeed.h"
+#include "rssparser.h"
+#include "strprintf.h"
+#include "test/test_helpers/httptestserver.h"
+#include "test/test_helpers/tempfile.h"
+
+using namespace newsboat;
+
+TEST_CASE("Reloading feeds over HTTP", "[reload]")
+{
+	const auto corpus = bench::generate_corpus(bench::corpus_size());
+
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	std::vector<test_helpers::HttpTestServer::MockRegistration> endpoints;
+	std::vector<std::string> urls;
+	for (size_t i = 0; i < corpus.size(); ++i) {
+		const auto path = strprintf::fmt("/feed%u", static_cast<unsigned int>(i));
+		endpoints.push_back(testServer.add_endpoint(path, {}, 200,
+		{{"content-type", "application/rss+xml"}},
+		std::vector<std::uint8_t>(corpus[i].begin(), corpus[i].end())));
+		urls.push_back(strprintf::fmt("http://%s%s", address, path));
+	}
+
+	ConfigContainer cfg;
+	test_helpers::TempFile file;
+	Cache cache(file.get_path(), cfg);
+
+	// Same steps as Reloader::reload_http_feeds(): download through one event
+	// loop, then parse and store each feed on a worker thread
+	BENCHMARK("download, parse and store") {
+		std::vector<FeedRetriever::HttpDownload> downloads(urls.size());
+		std::vector<std::shared_ptr<RssFeed>> feeds(urls.size());
+
+		std::vector<CurlMultiRunner::Transfer> transfers;
+		for (size_t i = 0; i < urls.size(); ++i) {
+			CurlMultiRunner::Transfer transfer;
+			transfer.setup = [&, i](CurlHandle& handle) {
+				FeedRetriever retriever(cfg, cache, handle);
+				downloads[i] = retriever.start_http_download(urls[i]);
+				return true;
+			};
+			transfer.finish = [&, i](CurlHandle& handle, CURLcode result) {
+				FeedRetriever retriever(cfg, cache, handle);
+				const auto upstream = retriever.finish_http_download(urls[i],
+						downloads[i], result);
+				RssParser parser(urls[i], cache, cfg, nullptr);
+				feeds[i] = parser.parse(upstream);
+				cache.externalize_rssfeed(*feeds[i], false);
+			};
+			transfers.push_back(std::move(transfer));
+		}
+
+		CurlMultiRunner runner(
+			cfg.get_configvalue_as_int("reload-max-transfers"),
+			cfg.get_configvalue_as_int("reload-max-host-connections"),
+			cfg.get_configvalue_as_int("reload-threads"));
+		runner.run(transfers);
+		return feeds;
+	};
+}
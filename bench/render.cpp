@@ -0,0 +1,52 @@
+#include "3rd-party/catch.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "corpus.h"
+#include "htmlrenderer.h"
+#include "links.h"
+#include "textformatter.h"
+
+using namespace newsboat;
+
+TEST_CASE("Rendering articles", "[render]")
+{
+	const auto& size = bench::corpus_size();
+
+	std::vector<std::string> bodies;
+	for (unsigned int i = 0; i < size.items; ++i) {
+		bodies.push_back(bench::generate_html(size.body_size, i));
+	}
+
+	BENCHMARK("HtmlRenderer::render") {
+		HtmlRenderer renderer;
+		size_t total_lines = 0;
+		for (const auto& body : bodies) {
+			std::vector<std::pair<LineType, std::string>> lines;
+			Links links;
+			renderer.render(body, lines, links, "https://example.com/");
+			total_lines += lines.size();
+		}
+		return total_lines;
+	};
+
+	std::vector<std::vector<std::pair<LineType, std::string>>> rendered;
+	HtmlRenderer renderer;
+	for (const auto& body : bodies) {
+		std::vector<std::pair<LineType, std::string>> lines;
+		Links links;
+		renderer.render(body, lines, links, "https://example.com/");
+		rendered.push_back(std::move(lines));
+	}
+
+	BENCHMARK("TextFormatter::format_text_to_list") {
+		size_t total_lines = 0;
+		for (const auto& lines : rendered) {
+			TextFormatter formatter(lines);
+			total_lines += formatter.format_text_to_list(nullptr, {}, 80, 80).second;
+		}
+		return total_lines;
+	};
+}
@@ -0,0 +1,135 @@
+#ifndef NEWSBOAT_ARTICLERENDERCACHE_H_
+#define NEWSBOAT_ARTICLERENDERCACHE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "links.h"
+
+namespace newsboat {
+
+class ConfigContainer;
+class RegexManager;
+class RssFeed;
+class RssItem;
+
+/// \brief Keeps articles rendered for the article view, so that going back
+/// and forth between articles doesn't render them over and over.
+///
+/// Rendered articles are told apart by their GUID, a hash of everything
+/// that is shown, the widths they were rendered for, the HTML renderer and
+/// the highlighting rules. The least recently used ones are dropped once
+/// there are more than the cache's capacity. Articles the user is likely to
+/// open next can be rendered on a background thread ahead of time.
+class ArticleRenderCache {
+public:
+	/// \brief An article as shown in the article view.
+	struct Rendered {
+		/// STFL list, see item_renderer::to_stfl_list()
+		std::string text;
+		std::size_t num_lines = 0;
+		/// Links of the article, in the order they're numbered in \a text
+		Links links;
+	};
+
+	static const std::size_t DEFAULT_CAPACITY = 32;
+
+	explicit ArticleRenderCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+	/// \brief Stops the background thread, dropping articles which weren't
+	/// rendered yet.
+	~ArticleRenderCache();
+
+	/// \brief Returns \a item rendered for the article view.
+	///
+	/// Renders the article on the calling thread, unless it's in the cache
+	/// already. \a text_width dictates where text is wrapped, \a window_width
+	/// where URLs are wrapped, and \a rxman's rules for the article view are
+	/// used to highlight the text.
+	std::shared_ptr<const Rendered> get(ConfigContainer& cfg,
+		RssItem& item,
+		unsigned int text_width,
+		unsigned int window_width,
+		RegexManager& rxman);
+
+	/// \brief Renders \a items on a background thread, so that get() with
+	/// the same arguments finds them in the cache.
+	///
+	/// Articles queued by earlier calls which weren't rendered yet are
+	/// dropped. The articles as they are now, and the current rules of
+	/// \a rxman, are used, even if they change before the articles are
+	/// rendered.
+	void prerender(ConfigContainer& cfg,
+		const std::vector<std::shared_ptr<RssItem>>& items,
+		unsigned int text_width,
+		unsigned int window_width,
+		const RegexManager& rxman);
+
+	/// \brief Waits until all articles passed to prerender() are rendered.
+	void wait_for_prerender();
+
+	std::size_t size() const;
+
+private:
+	struct Job {
+		ConfigContainer* cfg;
+		/// Copy of the article, see snapshot()
+		std::shared_ptr<RssItem> item;
+		/// Copy of the article's feed, which \a item only holds a weak
+		/// pointer to
+		std::shared_ptr<RssFeed> feed;
+		unsigned int text_width;
+		unsigned int window_width;
+		std::shared_ptr<RegexManager> rxman;
+	};
+
+	/// Copies everything item_renderer::to_stfl_list() shows of \a item
+	/// into a new article, which belongs to no cache and to a new feed that
+	/// only has a title. The UI thread keeps modifying the original.
+	static Job snapshot(ConfigContainer& cfg, RssItem& item);
+
+	static std::string key_of(ConfigContainer& cfg,
+		RssItem& item,
+		unsigned int text_width,
+		unsigned int window_width,
+		const RegexManager& rxman);
+	static std::shared_ptr<const Rendered> render(ConfigContainer& cfg,
+		RssItem& item,
+		unsigned int text_width,
+		unsigned int window_width,
+		RegexManager& rxman);
+
+	/// Returns the article stored under \a key and marks it as recently
+	/// used, or nullptr if there's none. Has to be called with `mtx` held.
+	std::shared_ptr<const Rendered> find(const std::string& key);
+	/// Has to be called with `mtx` held.
+	void insert(const std::string& key, std::shared_ptr<const Rendered> rendered);
+
+	void run();
+
+	const std::size_t capacity;
+
+	using Entry = std::pair<std::string, std::shared_ptr<const Rendered>>;
+	/// Most recently used first
+	std::list<Entry> entries;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+	std::deque<Job> jobs;
+	bool rendering;
+	bool stopping;
+	std::thread worker;
+	mutable std::mutex mtx;
+	std::condition_variable cv;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_ARTICLERENDERCACHE_H_ */
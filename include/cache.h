@@ -4,10 +4,13 @@
 #include <memory>
 #include <mutex>
 #include <sqlite3.h>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "configcontainer.h"
 #include "filepath.h"
+#include "reloadscheduler.h"
+#include "remoteapioutbox.h"
 
 namespace newsboat {
 
@@ -50,6 +53,25 @@ public:
 	void externalize_rssfeed(RssFeed& feed, bool reset_unread);
 	std::shared_ptr<RssFeed> internalize_rssfeed(std::string rssurl,
 		RssIgnores* ign);
+	/// \brief Loads all of \a rssurls at once, in the same order.
+	///
+	/// Returns the same feeds as calling internalize_rssfeed() for each URL,
+	/// but reads the database with two queries in total. Throws
+	/// FeedLoadException if one of the feeds can't be created.
+	std::vector<std::shared_ptr<RssFeed>> internalize_rssfeeds(
+			const std::vector<std::string>& rssurls,
+			RssIgnores* ign);
+	/// \brief Stores \a newfeed and returns the feed as it's now in the cache.
+	///
+	/// The result is the same as calling externalize_rssfeed() followed by
+	/// internalize_rssfeed(), but only the articles of \a newfeed are read
+	/// back from the database; the rest is taken over from \a oldfeed, which
+	/// has to be what internalize_rssfeed() returned for the same feed (or
+	/// what this function returned for it).
+	std::shared_ptr<RssFeed> merge_rssfeed(RssFeed& oldfeed,
+		RssFeed& newfeed,
+		bool reset_unread,
+		RssIgnores* ign);
 	void update_rssitem_unread_and_enqueued(RssItem& item,
 		const std::string& feedurl);
 	/// If requested, removes unreachable data stored in cache.
@@ -64,6 +86,8 @@ public:
 	std::unordered_set<std::string> search_in_items(
 		const std::string& querystr,
 		const std::unordered_set<std::string>& guids);
+	/// \brief Marks all articles (of \a feedurl, if given) read, including
+	/// those queued to be marked unread through a remote API.
 	void mark_all_read(const std::string& feedurl = "");
 	void mark_all_read(RssFeed& feed);
 	void update_rssitem_flags(RssItem* item);
@@ -73,18 +97,81 @@ public:
 	void update_lastmodified(const std::string& uri,
 		time_t t,
 		const std::string& etag);
+	/// \brief Returns the reload schedules of all feeds, keyed by URL.
+	std::unordered_map<std::string, ReloadSchedule> fetch_reload_schedules();
+	ReloadSchedule fetch_reload_schedule(const std::string& feedurl);
+	/// \brief Stores \a schedule, except for its `not_before`, which is
+	/// only changed by update_reload_not_before().
+	void update_reload_schedule(const std::string& feedurl,
+		const ReloadSchedule& schedule);
+	void update_reload_not_before(const std::string& feedurl, time_t t);
+	/// \brief Returns where the next incremental fetch of \a feedurl from a
+	/// remote API should continue, or an empty string if it should fetch
+	/// the feed in full. See rsspp::Feed::sync_position.
+	std::string fetch_sync_position(const std::string& feedurl);
+	void update_sync_position(const std::string& feedurl,
+		const std::string& position);
+	/// \brief Marks the articles of \a feedurl unread if they're among
+	/// \a unread_guids, and read otherwise.
+	///
+	/// Articles whose read state is queued for a remote API (see
+	/// queue_remote_read_state()) are left alone. Returns the articles which
+	/// changed, along with their new unread state.
+	std::unordered_map<std::string, bool> sync_unread_state(
+		const std::string& feedurl,
+		const std::unordered_set<std::string>& unread_guids);
+	/// \brief Queues marking \a guids read or unread through the remote API
+	/// \a api, replacing such changes which weren't sent yet.
+	void queue_remote_read_state(const std::string& api,
+		const std::vector<std::string>& guids,
+		bool read);
+	/// \brief Queues changing the flags of the article \a guid through the
+	/// remote API \a api, merging it with changes which weren't sent yet.
+	void queue_remote_flags(const std::string& api,
+		const std::string& guid,
+		const std::string& oldflags,
+		const std::string& newflags);
+	/// \brief Returns the changes queued for the remote API \a api.
+	std::vector<OutboxEntry> fetch_remote_outbox(const std::string& api);
+	/// \brief Removes changes which were sent, unless the article changed
+	/// again since \a entry was fetched.
+	void remove_from_remote_outbox(const std::string& api,
+		const OutboxEntry& entry);
+	/// \brief Counts a failed attempt to send \a entry, and postpones the
+	/// next one until \a not_before.
+	void postpone_remote_outbox_entry(const std::string& api,
+		const OutboxEntry& entry,
+		time_t not_before);
 	void mark_item_deleted(const std::string& guid, bool b);
 	void remove_old_deleted_items(RssFeed* feed);
 	void mark_items_read_by_guid(const std::vector<std::string>& guids);
 	std::vector<std::string> get_read_item_guids();
 	void fetch_descriptions(RssFeed* feed);
+	/// \brief Returns the content of the articles with the given GUIDs,
+	/// keyed by GUID.
+	///
+	/// Unlike the overload above, this doesn't touch the articles, so it can
+	/// be called for articles which other threads are working with.
+	std::unordered_map<std::string, std::string> fetch_descriptions(
+		const std::vector<std::string>& guids);
 	std::string fetch_description(const RssItem& item);
 
 private:
 	SchemaVersion get_schema_version();
 	void populate_tables();
+	void check_fulltext_index();
+	/// Creates the full-text index if it doesn't exist yet. Returns false
+	/// if SQLite can't provide one.
+	bool prepare_fulltext_index();
 	void set_pragmas();
+	/// Returns an SQL condition that matches articles whose title or
+	/// content contains \a querystr, using the full-text index if possible.
+	std::string search_condition(const std::string& querystr);
 	void delete_item_unlocked(const RssItem& item);
+	void enforce_max_items_unlocked(RssFeed& feed);
+	void finish_internalized_feed_unlocked(
+		const std::shared_ptr<RssFeed>& feed,
+		RssIgnores* ign);
 	void clean_old_articles();
 	void update_rssitem_unlocked(RssItem& item,
 		const std::string& feedurl,
@@ -110,11 +197,21 @@ private:
 		void* callback_argument,
 		bool do_throw);
 
+	/// Returns a prepared statement for \a sql, ready to be bound and
+	/// stepped. Statements are prepared once and kept until the database is
+	/// closed.
+	sqlite3_stmt* get_statement(const std::string& sql);
+	/// Steps \a stmt, which shouldn't return any rows, and resets it.
+	void run_statement(sqlite3_stmt* stmt);
+
 	void close_database();
 
 	sqlite3* db = nullptr;
 	ConfigContainer& cfg;
 	std::recursive_mutex mtx;
+	std::unordered_map<std::string, sqlite3_stmt*> statements;
+	bool has_fulltext_index = false;
+	bool fulltext_index_prepared = false;
 };
 
 } // namespace newsboat
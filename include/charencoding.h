@@ -9,11 +9,14 @@
 namespace newsboat {
 namespace charencoding {
 
-std::optional<std::string> charset_from_bom(std::vector<std::uint8_t> content);
-std::optional<std::string> charset_from_xml_declaration(std::vector<std::uint8_t>
+std::optional<std::string> charset_from_bom(const std::vector<std::uint8_t>& content);
+std::optional<std::string> charset_from_xml_declaration(const std::vector<std::uint8_t>&
 	content);
-std::optional<std::string> charset_from_content_type_header(std::vector<std::uint8_t>
-	header);
+std::optional<std::string> charset_from_content_type_header(
+	const std::vector<std::uint8_t>& header);
+
+/// Returns true if \a charset names UTF-8, i.e. text in it can be used as-is.
+bool is_utf8(const std::string& charset);
 
 } // namespace charencoding
 } // namespace newsboat
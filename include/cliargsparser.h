@@ -63,6 +63,10 @@ public:
 
 	bool refresh_on_start() const;
 
+	/// If `true`, Newsboat should keep running without a user interface and
+	/// serve commands through a Unix domain socket (see Daemon).
+	bool daemon() const;
+
 	std::optional<Filepath> url_file() const;
 
 	std::optional<Filepath> lock_file() const;
@@ -86,6 +90,10 @@ public:
 
 	std::optional<Level> log_level() const;
 
+	/// If non-null, Newsboat should record timed scopes (see ScopeMeasure)
+	/// and write them to this filepath on exit.
+	std::optional<Filepath> trace_file() const;
+
 	/// Returns the reference to the Rust object.
 	///
 	/// This is only meant to be used in situations when one wants to pass
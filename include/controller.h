@@ -1,6 +1,7 @@
 #ifndef NEWSBOAT_CONTROLLER_H_
 #define NEWSBOAT_CONTROLLER_H_
 
+#include <iostream>
 #include <memory>
 
 #include <libxml/tree.h>
@@ -16,6 +17,7 @@
 #include "regexmanager.h"
 #include "reloader.h"
 #include "remoteapi.h"
+#include "remoteapioutbox.h"
 #include "rssignores.h"
 #include "urlreader.h"
 
@@ -35,6 +37,15 @@ public:
 	}
 	int run(const CliArgsParser& args);
 
+	/// \brief Executes commands given with `--execute`, writing their
+	/// output to \a out and error messages to \a err.
+	///
+	/// Stops at the first command that fails. Returns EXIT_SUCCESS if all of
+	/// them succeeded, EXIT_FAILURE otherwise.
+	int execute_commands(const std::vector<std::string>& cmds,
+		std::ostream& out = std::cout,
+		std::ostream& err = std::cerr);
+
 	std::vector<std::shared_ptr<RssItem>> search_for_items(
 			const std::string& query,
 			std::shared_ptr<RssFeed> feed);
@@ -43,7 +54,9 @@ public:
 	void update_visible_feeds();
 	void mark_all_read(unsigned int pos);
 	void mark_article_read(const std::string& guid, bool read);
-	void mark_all_read(const std::string& feedurl);
+	/// \brief Marks all articles of \a feedurl, or of all feeds if it's
+	/// empty, as read. Returns false if the cache couldn't be updated.
+	bool mark_all_read(const std::string& feedurl);
 	void mark_all_read(RssFeed& feed)
 	{
 		rsscache->mark_all_read(feed);
@@ -118,10 +131,11 @@ private:
 	int import_opml(const Filepath& opmlFile, const Filepath& urlFile);
 	void export_opml(bool version2);
 	void rec_find_rss_outlines(xmlNode* node, std::string tag);
-	int execute_commands(const std::vector<std::string>& cmds);
-
 	void import_read_information(const Filepath& readinfofile);
 	void export_read_information(const Filepath& readinfofile);
+	/// \brief Marks \a feed read through the remote API, if there is one.
+	/// Must be called before the feed's articles are marked read in memory.
+	void mark_feed_read_remotely(RssFeed& feed);
 
 	View* v;
 	std::unique_ptr<UrlReader> urlcfg;
@@ -136,6 +150,9 @@ private:
 	ColorManager colorman;
 	RegexManager rxman;
 	std::unique_ptr<RemoteApi> api;
+	/// Sends changes made to articles to `api`. Declared after `api` so
+	/// that it's destroyed first.
+	std::unique_ptr<RemoteApiOutbox> outbox;
 
 	FsLock fslock;
 
@@ -1,6 +1,7 @@
 #ifndef NEWSBOAT_CURLDATARECEIVER_H_
 #define NEWSBOAT_CURLDATARECEIVER_H_
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -17,7 +18,7 @@ public:
 
 protected:
 	explicit CurlDataReceiver(CurlHandle& curlHandle);
-	void handle_data(const std::string& data);
+	void handle_data(const char* data, size_t size);
 
 	CurlDataReceiver(const CurlDataReceiver&) = delete;
 	CurlDataReceiver(CurlDataReceiver&&) = delete;
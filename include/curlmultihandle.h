@@ -0,0 +1,56 @@
+#ifndef NEWSBOAT_CURLMULTIHANDLE_H_
+#define NEWSBOAT_CURLMULTIHANDLE_H_
+
+#include <curl/curl.h>
+#include <stdexcept>
+
+namespace newsboat {
+
+// wrapped curl multi handle for exception safety, see also CurlHandle
+class CurlMultiHandle {
+private:
+	CURLM* h;
+	CurlMultiHandle(const CurlMultiHandle&) = delete;
+	CurlMultiHandle& operator=(const CurlMultiHandle&) = delete;
+
+	void cleanup()
+	{
+		if (h != nullptr) {
+			curl_multi_cleanup(h);
+		}
+	}
+
+public:
+	CurlMultiHandle()
+		: h(curl_multi_init())
+	{
+		if (!h) {
+			throw std::runtime_error("Can't obtain curl multi handle");
+		}
+	}
+	~CurlMultiHandle()
+	{
+		cleanup();
+	}
+	CurlMultiHandle(CurlMultiHandle&& other)
+		: h(other.h)
+	{
+		other.h = nullptr;
+	}
+	CurlMultiHandle& operator=(CurlMultiHandle&& other)
+	{
+		cleanup();
+		h = other.h;
+		other.h = nullptr;
+		return *this;
+	}
+
+	CURLM* ptr()
+	{
+		return h;
+	}
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_CURLMULTIHANDLE_H_ */
@@ -0,0 +1,90 @@
+#ifndef NEWSBOAT_CURLMULTIRUNNER_H_
+#define NEWSBOAT_CURLMULTIRUNNER_H_
+
+#include <condition_variable>
+#include <curl/curl.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "curlhandle.h"
+#include "curlmultihandle.h"
+#include "curlsharehandle.h"
+
+namespace newsboat {
+
+/// \brief Performs many HTTP transfers through a single curl_multi event loop.
+///
+/// At most `max_transfers` transfers are kept in flight at once, and libcurl
+/// opens at most `max_host_connections` connections to any single host.
+/// Transfers which are done are handed over to a pool of worker threads, so
+/// processing one response (e.g. parsing it) overlaps with the downloads that
+/// are still running. Open connections are kept from one run() to the next,
+/// as long as the runner lives. If a CurlShareHandle is given, the DNS cache
+/// and TLS sessions outlive the runner, so the next one can reuse them.
+class CurlMultiRunner {
+public:
+	struct Transfer {
+		/// Configures the easy handle for the transfer. Runs on the thread
+		/// which called run(). If it returns false or throws, the transfer
+		/// is not performed and `finish` is called with CURLE_FAILED_INIT.
+		std::function<bool(CurlHandle&)> setup;
+
+		/// Called on a worker thread with the handle and the result of the
+		/// transfer once it is done.
+		std::function<void(CurlHandle&, CURLcode)> finish;
+	};
+
+	CurlMultiRunner(unsigned int max_transfers,
+		unsigned int max_host_connections,
+		unsigned int num_workers,
+		CurlShareHandle* share = nullptr);
+
+	/// \brief Changes the limits given to the constructor. Takes effect with
+	/// the next run().
+	void set_limits(unsigned int max_transfers,
+		unsigned int max_host_connections,
+		unsigned int num_workers);
+
+	/// \brief Performs all \a transfers.
+	///
+	/// Returns once `finish` has returned for every one of them. Handles are
+	/// reused between transfers, so `setup` must configure every option it
+	/// relies on. Must not be called from more than one thread at a time.
+	void run(std::vector<Transfer>& transfers);
+
+private:
+	struct Completed {
+		size_t index;
+		std::unique_ptr<CurlHandle> handle;
+		CURLcode result;
+	};
+
+	std::unique_ptr<CurlHandle> take_handle();
+	void return_handle(std::unique_ptr<CurlHandle> handle);
+	void dispatch(size_t index, std::unique_ptr<CurlHandle> handle,
+		CURLcode result);
+	void work(std::vector<Transfer>& transfers);
+
+	unsigned int max_transfers;
+	unsigned int max_host_connections;
+	unsigned int num_workers;
+	CurlShareHandle* const share;
+
+	/// Holds the connections which are kept open between runs
+	CurlMultiHandle multi;
+
+	std::mutex handles_mutex;
+	std::vector<std::unique_ptr<CurlHandle>> idle_handles;
+
+	std::mutex queue_mutex;
+	std::condition_variable queue_cv;
+	std::deque<Completed> completed;
+	bool all_dispatched;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_CURLMULTIRUNNER_H_ */
@@ -0,0 +1,68 @@
+#ifndef NEWSBOAT_CURLSHAREHANDLE_H_
+#define NEWSBOAT_CURLSHAREHANDLE_H_
+
+#include <curl/curl.h>
+#include <mutex>
+#include <stdexcept>
+
+namespace newsboat {
+
+// wrapped curl share handle, see also CurlHandle
+//
+// Easy handles which are attached to it through attach() share the DNS cache
+// and TLS sessions, even after they are destroyed. Connections aren't shared:
+// a shared connection cache is a single lock that every transfer of every
+// thread has to take. The handles may be used from different threads. All of
+// them have to be destroyed before the share handle is.
+class CurlShareHandle {
+private:
+	CURLSH* h;
+	std::mutex locks[CURL_LOCK_DATA_LAST];
+
+	CurlShareHandle(const CurlShareHandle&) = delete;
+	CurlShareHandle& operator=(const CurlShareHandle&) = delete;
+
+	static void lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+	{
+		static_cast<CurlShareHandle*>(userptr)->locks[data].lock();
+	}
+
+	static void unlock(CURL*, curl_lock_data data, void* userptr)
+	{
+		static_cast<CurlShareHandle*>(userptr)->locks[data].unlock();
+	}
+
+public:
+	CurlShareHandle()
+		: h(curl_share_init())
+	{
+		if (!h) {
+			throw std::runtime_error("Can't obtain curl share handle");
+		}
+		curl_share_setopt(h, CURLSHOPT_LOCKFUNC, &CurlShareHandle::lock);
+		curl_share_setopt(h, CURLSHOPT_UNLOCKFUNC, &CurlShareHandle::unlock);
+		curl_share_setopt(h, CURLSHOPT_USERDATA, this);
+		curl_share_setopt(h, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(h, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
+	~CurlShareHandle()
+	{
+		curl_share_cleanup(h);
+	}
+
+	/// Makes \a easyhandle use the shared caches. curl_easy_reset() doesn't
+	/// undo this.
+	void attach(CURL* easyhandle)
+	{
+		curl_easy_setopt(easyhandle, CURLOPT_SHARE, h);
+	}
+
+	CURLSH* ptr()
+	{
+		return h;
+	}
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_CURLSHAREHANDLE_H_ */
@@ -0,0 +1,73 @@
+#ifndef NEWSBOAT_DAEMON_H_
+#define NEWSBOAT_DAEMON_H_
+
+#include <chrono>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "filepath.h"
+
+namespace newsboat {
+
+class Controller;
+
+/// \brief Keeps Newsboat running without a user interface, reloading feeds
+/// in the background and executing commands sent through a Unix domain
+/// socket.
+///
+/// Commands are the same as those accepted by `--execute`. A client sends
+/// the size of its request in bytes on a line of its own, followed by the
+/// commands, one per line. The daemon executes them and answers with one line
+/// per line of output, prefixed with "out " or "err " depending on where it
+/// would have been printed, followed by "exit <code>".
+///
+/// Clients are served one at a time. One that doesn't send its whole request
+/// within a few seconds is disconnected, so that it can't hold up the others.
+class Daemon {
+public:
+	Daemon(Controller& ctrl, const Filepath& socket_path);
+	~Daemon();
+
+	/// \brief Serves commands until SIGINT or SIGTERM is received.
+	///
+	/// Returns the process's exit code.
+	int run();
+
+	/// \brief Creates the socket and starts listening on it.
+	///
+	/// Returns false, after telling the user why, if that failed.
+	bool listen();
+
+	/// \brief Waits up to \a timeout for a client to connect, and serves it.
+	///
+	/// Returns false if no client connected. Has to be called after
+	/// listen().
+	bool serve_client(std::chrono::milliseconds timeout);
+
+	/// \brief Returns the path of the socket of the daemon which uses the
+	/// cache at \a cache_file.
+	static Filepath socket_path(const Filepath& cache_file);
+
+	/// \brief Executes \a cmds in the daemon listening at \a socket_path,
+	/// writing their output to \a out and \a err.
+	///
+	/// Returns the exit code of the commands, or nothing if there is no
+	/// daemon to talk to.
+	static std::optional<int> forward_commands(const Filepath& socket_path,
+		const std::vector<std::string>& cmds,
+		std::ostream& out,
+		std::ostream& err);
+
+private:
+	void serve(int client);
+
+	Controller& ctrl;
+	const Filepath path;
+	int listen_fd;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_DAEMON_H_ */
@@ -0,0 +1,136 @@
+#ifndef PODBOAT_DOWNLOADENGINE_H_
+#define PODBOAT_DOWNLOADENGINE_H_
+
+#include <cstdint>
+#include <curl/curl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "configcontainer.h"
+#include "curlmultihandle.h"
+#include "download.h"
+#include "filepath.h"
+
+namespace podboat {
+
+/// \brief Downloads podcast episodes through a single curl_multi event loop,
+/// running on a thread of its own.
+///
+/// Downloads are started and cancelled from the UI thread. The engine never
+/// touches Download objects itself: it reports progress and status changes
+/// as events, which process_events() applies on the UI thread. event_fd()
+/// becomes readable whenever there are events waiting. Events which arrive
+/// after a download was cancelled are dropped, so the Download object may
+/// go away as soon as cancel() returns.
+///
+/// `max-download-speed` caps the combined speed of all downloads and is split
+/// evenly between them. `max-download-host-connections` caps the number of
+/// connections to a single host; downloads beyond that wait for a connection
+/// to become available.
+///
+/// If `download-segments` is greater than 1 and the server supports range
+/// requests, a download is split into segments which are fetched that many at
+/// a time into a SegmentedFile. Interrupted segmented downloads resume from
+/// the segments that were finished.
+class DownloadEngine {
+public:
+	explicit DownloadEngine(newsboat::ConfigContainer& cfg);
+	~DownloadEngine();
+
+	DownloadEngine(const DownloadEngine&) = delete;
+	DownloadEngine& operator=(const DownloadEngine&) = delete;
+
+	/// \brief Starts downloading \a dl, resuming a partial download if there
+	/// is one.
+	void start(Download& dl);
+
+	/// \brief Stops downloading \a dl. The partial file is kept, so that the
+	/// download can be resumed later.
+	void cancel(Download& dl);
+
+	/// \brief File descriptor which is readable while there are events for
+	/// process_events().
+	int event_fd() const;
+
+	/// \brief Applies progress and status changes reported since the last
+	/// call to the corresponding Download objects.
+	void process_events();
+
+private:
+	struct Command {
+		unsigned int id;
+		bool cancel;
+		std::string url;
+		newsboat::Filepath filename;
+	};
+
+	struct Event {
+		unsigned int id;
+		DlStatus status;
+		std::string msg;
+		unsigned long offset;
+		double downloaded;
+		double total;
+		double kbps;
+	};
+
+	struct Transfer;
+	struct Segmented;
+
+	void run();
+	void start_transfer(const Command& command);
+	void start_stream(const Command& command);
+	void start_probe(const Command& command);
+	void start_segmented(const Command& command, std::uint64_t size);
+	void start_segments(Segmented& job);
+	Transfer& add_transfer(std::unique_ptr<Transfer> transfer);
+	void stop_transfer(unsigned int id);
+	void finish_transfer(CURL* easy, CURLcode result);
+	void finish_stream(Transfer& transfer, CURLcode result);
+	void finish_probe(Transfer& transfer, CURLcode result);
+	void finish_segment(Transfer& transfer, CURLcode result);
+	void finish_download(unsigned int id, const newsboat::Filepath& partial,
+		const newsboat::Filepath& filename);
+	void share_bandwidth();
+	void push_event(Event event);
+	void wake_up();
+
+	static size_t write_callback(char* buffer, size_t size, size_t nmemb,
+		void* userp);
+	static size_t header_callback(char* buffer, size_t size, size_t nitems,
+		void* userp);
+	static int progress_callback(void* clientp, curl_off_t dltotal,
+		curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+
+	newsboat::ConfigContainer& cfg;
+	newsboat::CurlMultiHandle multi;
+
+	// Only used by the engine's thread
+	std::map<CURL*, std::unique_ptr<Transfer>> transfers;
+	std::map<unsigned int, std::unique_ptr<Segmented>> segmented;
+
+	// Only used by the UI thread
+	std::map<unsigned int, Download*> active;
+	unsigned int last_id;
+
+	std::mutex commands_mutex;
+	std::vector<Command> commands;
+	bool stopping;
+	// Readable while there are new commands, so that the engine's thread
+	// wakes up from curl_multi_wait()
+	int wakeup_pipe[2];
+
+	std::mutex events_mutex;
+	std::vector<Event> events;
+	int event_pipe[2];
+
+	std::thread thread;
+};
+
+} // namespace podboat
+
+#endif /* PODBOAT_DOWNLOADENGINE_H_ */
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "configcontainer.h"
+#include "unreadindex.h"
 
 namespace newsboat {
 
@@ -37,6 +38,9 @@ public:
 	void set_feeds(const std::vector<std::shared_ptr<RssFeed>>& new_feeds);
 	std::vector<std::shared_ptr<RssFeed>> get_all_feeds() const;
 	unsigned int unread_feed_count() const;
+
+	/// \brief Number of distinct unread articles in feeds that aren't
+	/// hidden. Takes constant time.
 	unsigned int unread_item_count() const;
 
 	void replace_feed(unsigned int pos, std::shared_ptr<RssFeed> feed);
@@ -44,6 +48,10 @@ public:
 private:
 	std::vector<std::shared_ptr<RssFeed>> feeds;
 	mutable std::mutex feeds_mutex;
+
+	// Kept up to date by the feeds themselves
+	const std::shared_ptr<UnreadIndex> unread_index =
+		std::make_shared<UnreadIndex>();
 };
 } // namespace newsboat
 
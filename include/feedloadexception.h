@@ -0,0 +1,35 @@
+#ifndef NEWSBOAT_FEEDLOADEXCEPTION_H_
+#define NEWSBOAT_FEEDLOADEXCEPTION_H_
+
+#include <string>
+
+namespace newsboat {
+
+/// \brief Thrown when one of several feeds that are loaded at once can't be
+/// created, e.g. because it's a query feed whose query is invalid.
+class FeedLoadException : public std::exception {
+public:
+	FeedLoadException(const std::string& url, const std::string& errmsg)
+		: feed_url(url)
+		, msg(errmsg)
+	{
+	}
+	~FeedLoadException() throw() override {}
+	const char* what() const throw() override
+	{
+		return msg.c_str();
+	}
+	/// \brief URL of the feed that couldn't be loaded.
+	const std::string& url() const
+	{
+		return feed_url;
+	}
+
+private:
+	std::string feed_url;
+	std::string msg;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_FEEDLOADEXCEPTION_H_ */
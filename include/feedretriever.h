@@ -1,11 +1,20 @@
 #ifndef NEWSBOAT_FEEDRETRIEVER_H_
 #define NEWSBOAT_FEEDRETRIEVER_H_
 
+#include <ctime>
+#include <curl/curl.h>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "rss/feed.h"
 #include "filepath.h"
 
+namespace rsspp {
+class Parser;
+}
+
 namespace newsboat {
 
 class Cache;
@@ -16,13 +25,58 @@ class RssIgnores;
 
 class FeedRetriever {
 public:
+	/// \brief State of an HTTP download started by start_http_download().
+	struct HttpDownload {
+		HttpDownload();
+		HttpDownload(HttpDownload&&);
+		HttpDownload& operator=(HttpDownload&&);
+		~HttpDownload();
+
+		std::unique_ptr<rsspp::Parser> parser;
+		time_t lastmodified;
+		std::string etag;
+	};
+
 	FeedRetriever(ConfigContainer& cfg, Cache& ch, CurlHandle& easyhandle,
 		RssIgnores* ign = nullptr, RemoteApi* api = nullptr);
 
 	rsspp::Feed retrieve(const std::string& uri);
 
+	/// \brief Fetches the feeds \a uris with as few requests as possible, if
+	/// the remote API allows that.
+	///
+	/// Returns the fetched feeds by URL. Feeds which are missing from the
+	/// result have to be fetched one by one through retrieve().
+	std::map<std::string, rsspp::Feed> retrieve_in_bulk(
+		const std::vector<std::string>& uris);
+
+	/// \brief Returns true if retrieve() would fetch \a uri with a single
+	/// HTTP request, i.e. not through a remote API, a plugin or a file.
+	static bool is_http_download(const ConfigContainer& cfg,
+		const std::string& uri);
+
+	/// \brief Configures the easy handle for downloading \a uri, without
+	/// performing the transfer.
+	///
+	/// For callers which drive the transfer themselves (e.g. through
+	/// curl_multi). Once the transfer has finished, the returned object has
+	/// to be passed to finish_http_download() along with the transfer's
+	/// result.
+	HttpDownload start_http_download(const std::string& uri);
+
+	/// \brief Parses the response of a transfer set up by
+	/// start_http_download(), and stores its Last-Modified and ETag, as well
+	/// as the time before which the server asked not to be contacted again.
+	///
+	/// Throws the same exceptions as retrieve().
+	rsspp::Feed finish_http_download(const std::string& uri,
+		HttpDownload& download, CURLcode ret);
+
 private:
-	rsspp::Feed fetch_ttrss(const std::string& feed_id);
+	/// Returns where an incremental fetch of \a uri should continue, or an
+	/// empty string if it should be fetched in full
+	std::string sync_position(const std::string& uri);
+	rsspp::Feed fetch_ttrss(const std::string& uri, const std::string& feed_id);
 	rsspp::Feed fetch_newsblur(const std::string& feed_id);
 	rsspp::Feed fetch_ocnews(const std::string& feed_id);
 	rsspp::Feed fetch_miniflux(const std::string& feed_id);
@@ -1,18 +1,23 @@
 #ifndef NEWSBOAT_FRESHRSSAPI_H_
 #define NEWSBOAT_FRESHRSSAPI_H_
 
+#include <cstdint>
 #include <libxml/tree.h>
+#include <map>
+#include <memory>
+#include <unordered_set>
 
+#include "3rd-party/json.hpp"
 #include "remoteapi.h"
 #include "rss/feed.h"
 #include "utils.h"
 
-class CurlHandle;
-
 using HTTPMethod = newsboat::utils::HTTPMethod;
 
 namespace newsboat {
 
+class CurlHandle;
+
 class FreshRssApi : public RemoteApi {
 public:
 	explicit FreshRssApi(ConfigContainer& c);
@@ -22,20 +27,58 @@ public:
 	void add_custom_headers(curl_slist** custom_headers) override;
 	bool mark_all_read(const std::string& feedurl) override;
 	bool mark_article_read(const std::string& guid, bool read) override;
+	bool mark_articles_read(const std::vector<std::string>& guids) override;
+	bool mark_articles_unread(const std::vector<std::string>& guids) override;
 	bool update_article_flags(const std::string& oldflags,
 		const std::string& newflags,
 		const std::string& guid) override;
-	rsspp::Feed fetch_feed(const std::string& id, CurlHandle& cached_handle);
+	/// \brief Fetches the articles of the stream \a id.
+	///
+	/// If \a sync_position is set and \a id is a feed (see
+	/// is_feed_stream()), only articles which were added since the fetch
+	/// that returned it are fetched, along with the IDs of all unread
+	/// articles of the stream. Other streams, like the starred articles,
+	/// are always fetched in full: articles join them long after they were
+	/// added, so they'd be missed.
+	rsspp::Feed fetch_feed(const std::string& id, CurlHandle& cached_handle,
+		const std::string& sync_position = "");
+	/// \brief Fetches the articles which were added to any of the feeds
+	/// since their sync positions, through the reading list rather than
+	/// a request per feed.
+	///
+	/// \a sync_positions maps URLs of feeds, as returned by
+	/// get_subscribed_urls(), to their positions, which have to be set.
+	/// Only feed streams (see is_feed_stream()) may be passed: the articles
+	/// of other streams aren't told apart in the reading list.
+	/// Returns the feeds by URL, or nothing if the reading list couldn't be
+	/// fetched, in which case the feeds have to be fetched one by one.
+	std::map<std::string, rsspp::Feed> fetch_feeds(
+		const std::map<std::string, std::string>& sync_positions,
+		CurlHandle& cached_handle);
+
+	/// \brief Returns true if \a url, as returned by get_subscribed_urls(),
+	/// is the stream of a feed rather than e.g. that of the starred articles.
+	bool is_feed_stream(const std::string& url) const;
 
 private:
 	std::string get_new_token();
+	nlohmann::json get_json(const std::string& url, CurlHandle& cached_handle);
+	/// Returns the GUIDs of the unread articles of \a stream, an escaped
+	/// stream ID, or null if they couldn't be fetched
+	std::shared_ptr<const std::unordered_set<std::string>> fetch_unread_ids(
+			const std::string& stream, CurlHandle& cached_handle);
+	/// Adds \a entries of a stream to \a feed, and raises \a newest to the
+	/// time the newest of them was added. Returns false if they couldn't
+	/// be parsed.
+	bool parse_items(const nlohmann::json& entries, rsspp::Feed& feed,
+		std::int64_t& newest);
 	bool refresh_token();
 	std::string retrieve_auth();
 	std::string post_content(const std::string& url,
 		const std::string& postdata);
 	bool star_article(const std::string& guid, bool star);
 	bool share_article(const std::string& guid, bool share);
-	bool mark_article_read_with_token(const std::string& guid,
+	bool mark_articles_read_with_token(const std::vector<std::string>& guids,
 		bool read,
 		const std::string& token);
 	std::string auth;
@@ -16,12 +16,15 @@ public:
 	virtual void add_custom_headers(curl_slist** custom_headers);
 	virtual bool mark_all_read(const std::string& feedurl);
 	virtual bool mark_article_read(const std::string& guid, bool read);
+	virtual bool mark_articles_read(const std::vector<std::string>& guids);
+	virtual bool mark_articles_unread(const std::vector<std::string>& guids);
 	virtual bool update_article_flags(const std::string& inoflags,
 		const std::string& newflags,
 		const std::string& guid);
 
 private:
 	std::string retrieve_auth();
+	bool mark_articles(const std::vector<std::string>& guids, bool read);
 	std::string post_content(const std::string& url,
 		const std::string& postdata);
 	bool star_article(const std::string& guid, bool star);
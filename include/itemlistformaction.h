@@ -8,6 +8,7 @@
 #include "history.h"
 #include "listformaction.h"
 #include "listformatter.h"
+#include "parallelmatcher.h"
 #include "regexmanager.h"
 #include "stflrichtext.h"
 #include "view.h"
@@ -49,6 +50,9 @@ public:
 		pos = p;
 	}
 	std::string get_guid();
+	/// \brief Returns the articles right after and right before the
+	/// selected one, as far as there are any.
+	std::vector<std::shared_ptr<RssItem>> get_adjacent_items();
 	std::vector<KeyMapHintEntry> get_keymap_hint() const override;
 
 	bool jump_to_next_unread_item(bool start_with_first);
@@ -97,6 +101,10 @@ protected:
 	std::shared_ptr<RssFeed> feed;
 
 	Matcher matcher;
+	/// Evaluates \a matcher for the visible articles. Created when it's
+	/// first needed after the filter changed, so that the copies of the
+	/// expression for its threads are only compiled once per filter.
+	std::unique_ptr<ParallelMatcher> parallel_matcher;
 	bool filter_active;
 	void apply_filter(const std::string& filter_query);
 
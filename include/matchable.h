@@ -11,6 +11,18 @@ public:
 	Matchable() = default;
 	virtual ~Matchable() = default;
 	virtual std::optional<std::string> attribute_value(const std::string& attr) const = 0;
+
+	/// \brief Returns the value of a numeric attribute without formatting it
+	/// as a string first.
+	///
+	/// Used by the Matcher for `<`, `>`, `between` etc. If this returns
+	/// nothing, the Matcher converts attribute_value() to a number instead,
+	/// so overriding this is only an optimization.
+	virtual std::optional<int> attribute_value_as_number(
+		const std::string& /* attr */) const
+	{
+		return std::nullopt;
+	}
 };
 
 } // namespace newsboat
@@ -1,6 +1,7 @@
 #ifndef NEWSBOAT_MATCHER_H_
 #define NEWSBOAT_MATCHER_H_
 
+#include <memory>
 #include <set>
 #include <string>
 
@@ -28,15 +29,33 @@ public:
 	static int string_to_num(const std::string& number);
 
 private:
-	bool matches_r(expression* e, Matchable* item);
+	/// \brief Filter expression compiled for evaluation.
+	///
+	/// Numeric literals are converted and regexes are compiled once, when
+	/// the expression is parsed.
+	struct Node {
+		int op;
+		std::string name;
+		std::string literal;
+		int number = 0;
+		int upper = 0;
+		bool valid_range = false;
+		std::shared_ptr<regex_t> regex;
+		std::string regex_error;
+		std::unique_ptr<Node> l, r;
+	};
+
+	static std::unique_ptr<Node> compile(const expression* e);
+	static bool evaluate(const Node* node, Matchable* item);
+	static int number_or_throw(const Node& node, Matchable* item);
 
-	bool matchop_lt(expression* e, Matchable* item);
-	bool matchop_gt(expression* e, Matchable* item);
-	bool matchop_rxeq(expression* e, Matchable* item);
-	bool matchop_cont(expression* e, Matchable* item);
-	bool matchop_eq(expression* e, Matchable* item);
-	bool matchop_between(expression* e, Matchable* item);
+	static bool matchop_rxeq(const Node& node, Matchable* item);
+	static bool matchop_cont(const Node& node, Matchable* item);
+	static bool matchop_eq(const Node& node, Matchable* item);
+	static bool matchop_between(const Node& node, Matchable* item);
 
+	// Shared, because the plan is never modified once compiled
+	std::shared_ptr<const Node> plan;
 	FilterParser p;
 	std::string errmsg;
 	std::string exp;
@@ -20,11 +20,18 @@ public:
 	std::vector<TaggedFeedUrl> get_subscribed_urls() override;
 	bool mark_all_read(const std::string& feedurl) override;
 	bool mark_article_read(const std::string& guid, bool read) override;
+	bool mark_articles_read(const std::vector<std::string>& guids) override;
+	bool mark_articles_unread(const std::vector<std::string>& guids) override;
 	bool update_article_flags(const std::string& oldflags,
 		const std::string& newflags,
 		const std::string& guid) override;
 	void add_custom_headers(curl_slist**) override;
-	rsspp::Feed fetch_feed(const std::string& id, CurlHandle& easyhandle);
+	/// \brief Fetches the entries of the feed \a id.
+	///
+	/// If \a sync_position is set, only entries which were added, or
+	/// marked read or unread, since the fetch that returned it are fetched.
+	rsspp::Feed fetch_feed(const std::string& id, CurlHandle& easyhandle,
+		const std::string& sync_position = "");
 
 private:
 	virtual nlohmann::json run_op(const std::string& path,
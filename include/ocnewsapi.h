@@ -18,6 +18,7 @@ public:
 	bool mark_all_read(const std::string& feedurl) override;
 	bool mark_article_read(const std::string& guid, bool read) override;
 	bool mark_articles_read(const std::vector<std::string>& guids) override;
+	bool mark_articles_unread(const std::vector<std::string>& guids) override;
 	bool update_article_flags(const std::string& oldflags,
 		const std::string& newflags,
 		const std::string& guid) override;
@@ -27,6 +28,8 @@ public:
 private:
 	typedef std::map<std::string, std::pair<rsspp::Feed, long>> FeedMap;
 	std::string retrieve_auth();
+	bool mark_articles(const std::vector<std::string>& guids,
+		const std::string& query);
 	bool query(const std::string& query,
 		nlohmann::json* result = nullptr,
 		const std::string& post = "");
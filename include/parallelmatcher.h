@@ -0,0 +1,59 @@
+#ifndef NEWSBOAT_PARALLELMATCHER_H_
+#define NEWSBOAT_PARALLELMATCHER_H_
+
+#include <memory>
+#include <vector>
+
+namespace newsboat {
+
+class Cache;
+class Matcher;
+class RssItem;
+
+/// \brief Evaluates a filter expression for many articles on all CPU cores.
+///
+/// The articles are cut into chunks of consecutive articles, which are
+/// handed out to the worker threads through a WorkStealingQueue. Every result
+/// is stored at the position of its article, so the outcome doesn't depend on
+/// how the threads were scheduled.
+///
+/// Every thread evaluates a compiled copy of the expression of its own: glibc
+/// serialises all searches through one regex_t behind a lock, so threads
+/// sharing the expression's regexes would wait for each other.
+///
+/// If the expression refers to `content`, the contents of the articles that
+/// don't hold their description in memory are fetched from the cache with one
+/// query per chunk, instead of one query (and one trip through the cache's
+/// lock) per article.
+class ParallelMatcher {
+public:
+	/// \a cache may be nullptr, in which case articles fetch their content
+	/// themselves.
+	ParallelMatcher(Matcher& matcher, Cache* cache);
+
+	/// \brief Returns one element per article in \a items, which is true if
+	/// that article matches the expression.
+	///
+	/// If the expression can't be evaluated for some articles (e.g. because
+	/// it compares a string to a number), the exception thrown for the first
+	/// of them is rethrown, just as if the articles were matched one by one.
+	std::vector<bool> matches(const std::vector<std::shared_ptr<RssItem>>& items);
+
+private:
+	void match_chunk(Matcher& worker_matcher,
+		const std::vector<std::shared_ptr<RssItem>>& items,
+		unsigned int begin,
+		unsigned int end,
+		std::vector<char>& results);
+
+	Matcher& matcher;
+	/// Copies of \a matcher for the threads other than the calling one,
+	/// which uses \a matcher itself. Compiled when they're first needed.
+	std::vector<std::unique_ptr<Matcher>> worker_matchers;
+	Cache* cache;
+	bool prefetch_content;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_PARALLELMATCHER_H_ */
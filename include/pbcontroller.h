@@ -8,6 +8,7 @@
 #include "colormanager.h"
 #include "configcontainer.h"
 #include "download.h"
+#include "downloadengine.h"
 #include "filepath.h"
 #include "fslock.h"
 #include "keymap.h"
@@ -39,6 +40,12 @@ public:
 	unsigned int get_maxdownloads();
 	void start_downloads();
 	void start_download(Download& item);
+	void cancel_download(Download& item);
+
+	/// \brief File descriptor which becomes readable when downloads have
+	/// progressed; process_download_events() applies that progress.
+	int download_events_fd();
+	void process_download_events();
 
 	void increase_parallel_downloads();
 	void decrease_parallel_downloads();
@@ -65,6 +72,7 @@ private:
 	newsboat::Filepath queue_file;
 	newsboat::ConfigContainer cfg;
 	std::vector<Download> downloads_;
+	std::unique_ptr<DownloadEngine> engine;
 
 	newsboat::Filepath config_dir;
 
@@ -37,6 +37,10 @@ private:
 	std::pair<double, std::string> get_speed_human_readable(double kbps);
 	void handle_resize();
 
+	/// \brief Waits for a key press, a resize, or progress of the downloads,
+	/// whichever comes first. The latter are applied before returning.
+	newsboat::Event wait_for_event();
+
 	StflRichText format_line(const std::string& podlist_format,
 		const Download& dl,
 		unsigned int pos,
@@ -29,12 +29,21 @@ public:
 	int feed_matches(Matchable* feed) const;
 	std::string get_attrs_stfl_string(Dialog location, bool hasFocus) const;
 
+	/// \brief Changes whenever a rule is added or removed.
+	///
+	/// Lets text highlighted earlier tell whether it's still up to date.
+	unsigned int version() const
+	{
+		return version_;
+	}
+
 private:
 	using RegexStyleVector = std::vector<std::pair<std::shared_ptr<Regex>, TextStyle>>;
 	std::map<Dialog, RegexStyleVector> locations;
 	std::vector<std::string> cheat_store_for_dump_config;
 	std::vector<std::pair<std::shared_ptr<Matcher>, int>> matchers_article;
 	std::vector<std::pair<std::shared_ptr<Matcher>, int>> matchers_feed;
+	unsigned int version_ = 0;
 
 	void handle_highlight_action(const std::vector<std::string>& params);
 	void handle_highlight_item_action(std::string_view action,
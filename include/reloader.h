@@ -3,11 +3,17 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "configcontainer.h"
 #include "curlhandle.h"
+#include "curlmultirunner.h"
+#include "curlsharehandle.h"
+#include "reloadscheduler.h"
+#include "rss/feed.h"
 
 namespace newsboat {
 
@@ -21,13 +27,23 @@ public:
 	Reloader(Controller& c, Cache& cc, ConfigContainer& cfg);
 
 	/// \brief Creates detached thread that runs periodic updates.
-	void spawn_reloadthread();
+	///
+	/// Only updates status bar if \a unattended is false.
+	void spawn_reloadthread(bool unattended = false);
 
 	/// \brief Starts a thread that will reload feeds with specified
 	/// indexes.
 	///
-	/// If \a indexes is empty, all feeds will be reloaded.
-	void start_reload_all_thread(const std::vector<unsigned int>& indexes = {});
+	/// If \a indexes is empty, all feeds will be reloaded. Only updates
+	/// status bar if \a unattended is false.
+	void start_reload_all_thread(const std::vector<unsigned int>& indexes = {},
+		bool unattended = false);
+
+	/// \brief Starts a thread that will reload the feeds which are due, as
+	/// decided by ReloadScheduler.
+	///
+	/// Reloads all feeds if "reload-adaptive" is disabled.
+	void start_reload_due_thread(bool unattended = false);
 
 	/// \brief Reloads given feed.
 	///
@@ -36,6 +52,7 @@ public:
 	void reload(unsigned int pos, bool unattended = false)
 	{
 		CurlHandle easyHandle;
+		curl_share.attach(easyHandle.ptr());
 		reload(pos, easyHandle, false, unattended);
 	}
 
@@ -43,8 +60,13 @@ public:
 	///
 	/// Only updates status bar if \a unattended is false. The number of
 	/// threads spawned is controlled by the user via reload-threads
-	/// setting.
-	void reload_all(bool unattended = false);
+	/// setting. If \a only_due is true, feeds which ReloadScheduler
+	/// doesn't consider due are skipped.
+	void reload_all(bool unattended = false, bool only_due = false);
+
+	/// \brief Reloads all feeds, like reload_all(), but first waits for
+	/// reloads started by other threads to finish.
+	void reload_all_exclusive(bool unattended = false);
 
 private:
 	/// \brief Reloads all feeds with given indexes in feedlist.
@@ -70,6 +92,32 @@ private:
 		bool show_progress,
 		bool unattended);
 
+	/// \brief Reloads given feed, using \a retrieve to obtain its contents.
+	///
+	/// Takes care of status messages, parsing, error reporting and replacing
+	/// the feed, the same way as the overload above. \a retrieve is called
+	/// with the feed's URL and may throw anything FeedRetriever::retrieve()
+	/// throws.
+	void reload(unsigned int pos,
+		bool show_progress,
+		bool unattended,
+		std::function<rsspp::Feed(const std::string&)> retrieve);
+
+	/// \brief Reloads the feeds with given indexes, which all have to be
+	/// plain HTTP feeds, through a single curl_multi event loop.
+	///
+	/// Up to "reload-max-transfers" downloads are kept in flight; finished
+	/// downloads are parsed by "reload-threads" worker threads while the
+	/// others are still running.
+	void reload_http_feeds(const std::vector<unsigned int>& indexes,
+		bool unattended);
+
+	/// \brief Fetches the feeds with given indexes at once, if the remote API
+	/// allows that. Returns the fetched feeds by URL; the others have to be
+	/// reloaded one by one.
+	std::map<std::string, rsspp::Feed> retrieve_in_bulk(
+		const std::vector<unsigned int>& indexes);
+
 	/// \brief Notify in various ways that there are new unread feeds or
 	/// articles.
 	///
@@ -81,6 +129,19 @@ private:
 	/// notification will contain \a msg passed.
 	void notify(const std::string& msg);
 
+	ReloadScheduler reload_scheduler() const;
+
+	/// \brief Stores where the next incremental fetch of the feed at \a pos
+	/// should continue, after applying the unread state reported by the
+	/// remote API to the articles which were fetched earlier.
+	void apply_remote_sync(unsigned int pos, const std::string& url,
+		const rsspp::Feed& feed);
+
+	/// \brief Updates the reload schedule of the feed at \a url in the cache.
+	void record_reload(const std::string& url,
+		ReloadScheduler::Outcome outcome,
+		const std::vector<time_t>& pubdates);
+
 	void notify_reload_finished(unsigned int unread_feeds_before,
 		unsigned int unread_articles_before);
 
@@ -90,8 +151,13 @@ private:
 	}
 	bool trylock_reload_mutex();
 
-	void partition_reload_to_threads(
-		std::function<void(unsigned int start, unsigned int end)> handle_range,
+	/// \brief Calls \a handle_index for every index in [0, \a num_feeds).
+	///
+	/// The work is shared among "reload-threads" threads through
+	/// a WorkStealingQueue. Each thread passes its own \a easyhandle, so
+	/// consecutive feeds on the same domain can reuse the connection.
+	void distribute_reload_to_threads(
+		std::function<void(CurlHandle& easyhandle, unsigned int index)> handle_index,
 		unsigned int num_feeds);
 
 	Controller& ctrl;
@@ -100,6 +166,17 @@ private:
 	std::mutex reload_mutex;
 	std::atomic<unsigned int> reload_progress;
 	unsigned int reload_progress_max;
+
+	/// DNS cache and TLS sessions of all handles which reload feeds. It
+	/// lives as long as the Reloader, so successive reloads don't have to
+	/// start from scratch.
+	CurlShareHandle curl_share;
+
+	/// Downloads plain HTTP feeds. Kept between reloads, so that they reuse
+	/// the connections which are still open. Declared after `curl_share` so
+	/// that it's destroyed first.
+	CurlMultiRunner http_runner;
+	std::mutex http_runner_mutex;
 };
 
 } // namespace newsboat
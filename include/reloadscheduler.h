@@ -0,0 +1,80 @@
+#ifndef NEWSBOAT_RELOADSCHEDULER_H_
+#define NEWSBOAT_RELOADSCHEDULER_H_
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace newsboat {
+
+/// \brief What is known about how often a feed changes. Kept in the cache
+/// alongside the feed's Last-Modified and ETag.
+struct ReloadSchedule {
+	/// The feed is due for a reload from this point on. 0 means "right away".
+	time_t next_reload = 0;
+
+	/// Average time between the feed's articles, in seconds. 0 if unknown.
+	time_t publish_interval = 0;
+
+	/// Number of reloads in a row which didn't bring any new articles,
+	/// including those the server answered with "304 Not Modified".
+	unsigned int unchanged_reloads = 0;
+
+	/// The server asked not to be contacted again before this point, through
+	/// Cache-Control, Expires or Retry-After headers. 0 if it didn't.
+	time_t not_before = 0;
+};
+
+/// \brief Decides when feeds should be reloaded, based on how often they
+/// were updated in the past.
+///
+/// A feed which got new articles is reloaded again after \a min_interval.
+/// Each reload that brings nothing new doubles the wait, until it reaches
+/// half the time between the feed's articles (or the time since its latest
+/// one, if that's longer), but never beyond \a max_interval. Requests of the
+/// server to wait longer are honored up to \a max_interval, too.
+class ReloadScheduler {
+public:
+	enum class Outcome {
+		NEW_ARTICLES,
+		UNCHANGED,
+		FAILED,
+	};
+
+	ReloadScheduler(time_t min_interval, time_t max_interval);
+
+	/// \brief Updates \a schedule after the feed at \a url was reloaded at
+	/// \a now.
+	///
+	/// \a pubdates are the publication times of the feed's articles; they
+	/// are only looked at if the reload succeeded. A failed reload is retried
+	/// once the server allows it.
+	void record_reload(const std::string& url,
+		ReloadSchedule& schedule,
+		time_t now,
+		Outcome outcome,
+		const std::vector<time_t>& pubdates) const;
+
+	/// \brief Returns true if a feed with \a schedule should be reloaded by
+	/// a reload which starts at \a now.
+	///
+	/// Reloads happen every \a min_interval, so feeds which will be due
+	/// before the middle of the following wait are reloaded now rather than
+	/// a whole interval late.
+	bool is_due(const ReloadSchedule& schedule, time_t now) const;
+
+	/// \brief Returns the average time between the most recent articles
+	/// published at \a pubdates, or 0 if there aren't enough of them.
+	static time_t publish_interval(std::vector<time_t> pubdates);
+
+private:
+	time_t next_interval(const ReloadSchedule& schedule, time_t since_latest) const;
+	time_t jitter(const std::string& url, time_t interval) const;
+
+	const time_t min_interval;
+	const time_t max_interval;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_RELOADSCHEDULER_H_ */
@@ -8,7 +8,7 @@ namespace newsboat {
 
 class ReloadThread {
 public:
-	ReloadThread(Controller& c, ConfigContainer& cf);
+	ReloadThread(Controller& c, ConfigContainer& cf, bool unattended = false);
 	virtual ~ReloadThread();
 	void operator()();
 
@@ -18,6 +18,7 @@ private:
 	time_t waittime_sec;
 	bool suppressed_first;
 	ConfigContainer& cfg;
+	const bool unattended;
 };
 
 } // namespace newsboat
@@ -30,7 +30,12 @@ public:
 	virtual void add_custom_headers(curl_slist** custom_headers) = 0;
 	virtual bool mark_all_read(const std::string& feedurl) = 0;
 	virtual bool mark_article_read(const std::string& guid, bool read) = 0;
+	/// \brief Marks all of \a guids read. The default implementation calls
+	/// mark_article_read() for each of them; APIs which can mark several
+	/// articles at once should override this.
 	virtual bool mark_articles_read(const std::vector<std::string>& guids);
+	/// \brief Like mark_articles_read(), but marks the articles unread.
+	virtual bool mark_articles_unread(const std::vector<std::string>& guids);
 	virtual bool update_article_flags(const std::string& oldflags,
 		const std::string& newflags,
 		const std::string& guid) = 0;
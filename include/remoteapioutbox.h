@@ -0,0 +1,104 @@
+#ifndef NEWSBOAT_REMOTEAPIOUTBOX_H_
+#define NEWSBOAT_REMOTEAPIOUTBOX_H_
+
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace newsboat {
+
+class Cache;
+class RemoteApi;
+
+/// \brief Changes to an article which are yet to be sent to a remote API.
+/// Kept in the cache, see Cache::fetch_remote_outbox().
+struct OutboxEntry {
+	std::string guid;
+
+	/// Whether the article should be marked read or unread. Empty if its
+	/// read state didn't change.
+	std::optional<bool> read;
+
+	/// Flags the API knew about before the first of the queued changes.
+	std::string oldflags;
+
+	/// Flags the article should end up with. Empty if they didn't change.
+	std::optional<std::string> newflags;
+
+	/// Bumped by each change, so that a change which comes in while the
+	/// entry is being sent isn't lost.
+	unsigned int version = 0;
+
+	/// Number of failed attempts to send the changes.
+	unsigned int attempts = 0;
+
+	/// The changes shouldn't be sent before this point. 0 means "right away".
+	time_t not_before = 0;
+};
+
+/// \brief Sends changes of articles' read state and flags to a RemoteApi.
+///
+/// Changes are queued in the cache, so they aren't lost if sending them fails
+/// or Newsboat quits before they're sent. Changes to the same article are
+/// merged, and a single worker thread sends them in batches, retrying those
+/// which failed with an exponential back-off.
+class RemoteApiOutbox {
+public:
+	/// \a api_name tells outboxes of different APIs apart in the cache; it
+	/// should be the value of "urls-source".
+	RemoteApiOutbox(RemoteApi& api, Cache& cache, const std::string& api_name);
+
+	/// \brief Stops the worker thread. Changes which weren't sent yet stay in
+	/// the cache, and are sent by the next outbox for the same API.
+	~RemoteApiOutbox();
+
+	/// \brief Starts the worker thread, which right away sends changes left
+	/// over from the previous run.
+	void start();
+
+	void mark_article_read(const std::string& guid, bool read);
+	void mark_articles_read(const std::vector<std::string>& guids);
+
+	/// \brief Marks the feed \a feedurl read through the API right away.
+	///
+	/// If that fails, its \a unread_guids are queued to be marked read
+	/// instead, so the change is retried like any other.
+	void mark_feed_read(const std::string& feedurl,
+		const std::vector<std::string>& unread_guids);
+	void update_article_flags(const std::string& oldflags,
+		const std::string& newflags,
+		const std::string& guid);
+
+	/// \brief Sends all changes which are due at \a now, on the calling
+	/// thread.
+	///
+	/// Returns the time at which the next of the remaining changes is due,
+	/// or 0 if there are none left.
+	time_t send_due_changes(time_t now);
+
+	/// \brief Returns how long to wait before sending changes which failed
+	/// \a attempts times in a row.
+	static time_t retry_delay(unsigned int attempts);
+
+private:
+	void notify();
+	void run();
+
+	RemoteApi& api;
+	Cache& cache;
+	const std::string api_name;
+
+	std::thread worker;
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool changed;
+	bool stopping;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_REMOTEAPIOUTBOX_H_ */
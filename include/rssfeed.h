@@ -1,8 +1,11 @@
 #ifndef NEWSBOAT_RSSFEED_H_
 #define NEWSBOAT_RSSFEED_H_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -18,12 +21,15 @@ namespace newsboat {
 enum class DlStatus { SUCCESS, TO_BE_DOWNLOADED, DURING_DOWNLOAD, DL_ERROR };
 
 class Cache;
+class Matcher;
+class ParallelMatcher;
+class UnreadIndex;
 
 class RssFeed : public Matchable {
 public:
 
 	explicit RssFeed(Cache* c, const std::string& rssurl);
-	~RssFeed() override = default;
+	~RssFeed() override;
 
 	void set_origin(const FeedOrigin& origin)
 	{
@@ -39,12 +45,10 @@ public:
 	{
 		return title_;
 	}
+	/// \brief Title to display, in the locale's charset. Kept until the
+	/// title or tags change.
 	std::string title() const;
-	void set_title(const std::string& t)
-	{
-		title_ = t;
-		utils::trim(title_);
-	}
+	void set_title(const std::string& t);
 
 	const std::string& description() const
 	{
@@ -79,6 +83,10 @@ public:
 
 	bool hidden() const;
 
+	/// \brief Articles of the feed.
+	///
+	/// The vector may be reordered, but articles have to be added and removed
+	/// with the functions below, which keep the unread counters up to date.
 	std::vector<std::shared_ptr<RssItem>>& items()
 	{
 		return items_;
@@ -87,12 +95,14 @@ public:
 	{
 		items_.push_back(item);
 		items_guid_map[item->guid()] = item;
+		item_added(*item);
 	}
 	void add_items(const std::vector<std::shared_ptr<RssItem>>& items)
 	{
 		for (const auto& item : items) {
 			items_.push_back(item);
 			items_guid_map[item->guid()] = item;
+			item_added(*item);
 		}
 	}
 	void set_items(const std::vector<std::shared_ptr<RssItem>>& items)
@@ -106,12 +116,14 @@ public:
 	{
 		for (auto it = begin; it != end; ++it) {
 			items_guid_map.erase((*it)->guid());
+			item_removed(**it);
 		}
 		items_.erase(begin, end);
 	}
 	void erase_item(std::vector<std::shared_ptr<RssItem>>::iterator pos)
 	{
 		items_guid_map.erase((*pos)->guid());
+		item_removed(**pos);
 		items_.erase(pos);
 	}
 
@@ -125,7 +137,11 @@ public:
 		return rssurl_;
 	}
 
-	unsigned int unread_item_count() const;
+	/// \brief Number of unread articles in the feed. Takes constant time.
+	unsigned int unread_item_count() const
+	{
+		return unread_count_;
+	}
 	unsigned int total_item_count() const
 	{
 		return items_.size();
@@ -138,9 +154,19 @@ public:
 
 	static std::set<std::string> get_valid_attributes();
 	std::optional<std::string> attribute_value(const std::string& attr) const override;
+	std::optional<int> attribute_value_as_number(const std::string& attr) const
+	override;
 
 	void update_items(std::vector<std::shared_ptr<RssFeed>> feeds);
 
+	/// \brief Number of articles the query was evaluated for by the last
+	/// call to update_items(). Articles whose earlier result could be
+	/// reused aren't counted.
+	unsigned int evaluated_item_count() const
+	{
+		return evaluated_count;
+	}
+
 	bool is_query_feed() const
 	{
 		return rssurl_.substr(0, 6) == "query:";
@@ -204,10 +230,25 @@ public:
 
 	void mark_all_items_read();
 
+	/// \brief Makes the feed's unread articles count towards \a index (and
+	/// no longer towards the index it was attached to before).
+	///
+	/// Articles of hidden feeds don't count. Pass nullptr to detach the feed.
+	void set_unread_index(std::shared_ptr<UnreadIndex> index);
+
 	// this is ugly, but makes it possible to lock items use e.g. from the Cache class
 	mutable std::mutex item_mutex;
 
 private:
+	friend class RssItem;
+
+	// These are called with `RssItem::unread_mutex` held, except for the
+	// first two which take it themselves
+	void item_added(RssItem& item);
+	void item_removed(RssItem& item);
+	void item_unread_changed(const RssItem& item);
+	void update_unread_index(bool add);
+
 	FeedOrigin origin_;
 	std::string title_;
 	std::string description_;
@@ -228,8 +269,38 @@ private:
 	unsigned int order;
 	std::mutex items_guid_map_mutex;
 
+	// Query feeds remember which articles matched, so that update_items()
+	// only has to run the Matcher on articles that changed since
+	struct MatchResult {
+		std::weak_ptr<RssItem> item;
+		unsigned int item_version;
+		const RssFeed* feed;
+		bool matches;
+		unsigned int generation;
+	};
+	static bool can_reuse_match_results(Matcher& matcher);
+	static bool refers_to_feed_attributes(Matcher& matcher);
+	std::shared_ptr<Matcher> matcher;
+	/// Evaluates \a matcher in update_items(). Kept for as long as the feed,
+	/// so that the copies of the expression for its threads are only
+	/// compiled once.
+	std::unique_ptr<ParallelMatcher> parallel_matcher;
+	bool reuse_match_results;
+	// Whether results have to be thrown away once the article's feed is
+	// replaced by a reloaded one
+	bool match_results_depend_on_feed;
+	std::unordered_map<const RssItem*, MatchResult> match_results;
+	unsigned int match_generation;
+	unsigned int evaluated_count;
+
 	DlStatus status_;
 	std::mutex status_mutex_;
+
+	std::atomic<unsigned int> unread_count_;
+	std::shared_ptr<UnreadIndex> unread_index_;
+
+	mutable std::mutex title_cache_mutex_;
+	mutable std::optional<std::string> title_cache_;
 };
 
 } // namespace newsboat
@@ -1,17 +1,41 @@
 #ifndef NEWSBOAT_RSSIGNORES_H_
 #define NEWSBOAT_RSSIGNORES_H_
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "configactionhandler.h"
 #include "matcher.h"
+#include "regexowner.h"
 #include "rssitem.h"
 
 namespace newsboat {
 
-typedef std::pair<std::string, std::shared_ptr<Matcher>> FeedUrlExprPair;
+/// \brief The `ignore-article` rules which apply to one feed URL.
+class FeedIgnoreRules {
+public:
+	/// \brief Returns true if any of the rules matches \a item.
+	bool matches(RssItem* item) const;
+
+	bool empty() const
+	{
+		return matchers.empty();
+	}
+
+private:
+	friend class RssIgnores;
+
+	std::vector<std::shared_ptr<Matcher>> matchers;
+};
+
+struct RegexIgnore {
+	std::string pattern;
+	std::shared_ptr<Regex> regex;
+	std::shared_ptr<Matcher> expr;
+};
 
 class RssIgnores : public ConfigActionHandler {
 public:
@@ -24,11 +48,21 @@ public:
 	bool matches_lastmodified(const std::string& url);
 	bool matches_resetunread(const std::string& url);
 
-private:
-	bool matches_expr(std::shared_ptr<Matcher> expr, RssItem* item);
+	/// \brief Returns the `ignore-article` rules which apply to feed
+	/// \a feedurl.
+	///
+	/// The result is computed once per URL and then reused, until the rules
+	/// change.
+	std::shared_ptr<const FeedIgnoreRules> rules_for(const std::string& feedurl);
 
-	std::vector<FeedUrlExprPair> regex_ignores;
+private:
+	std::vector<RegexIgnore> regex_ignores;
 	std::unordered_multimap<std::string, std::shared_ptr<Matcher>> non_regex_ignores;
+
+	/// Cleared whenever `ignore-article` rules are added
+	std::mutex rules_cache_mutex;
+	std::unordered_map<std::string, std::shared_ptr<const FeedIgnoreRules>> rules_cache;
+
 	std::vector<std::string> ignores_lastmodified;
 	std::vector<std::string> resetflag;
 
@@ -1,9 +1,12 @@
 #ifndef NEWSBOAT_RSSITEM_H_
 #define NEWSBOAT_RSSITEM_H_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "matchable.h"
 #include "matcher.h"
@@ -29,6 +32,10 @@ public:
 	}
 	void set_title(const std::string& t);
 
+	/// \brief Title converted to the locale's charset, for sorting. Kept
+	/// until the title changes.
+	std::string title_sort_key() const;
+
 	const std::string& link() const
 	{
 		return link_;
@@ -41,6 +48,10 @@ public:
 	}
 	void set_author(const std::string& a);
 
+	/// \brief Author converted to the locale's charset, for sorting. Kept
+	/// until the author changes.
+	std::string author_sort_key() const;
+
 	Description description() const
 	{
 		std::lock_guard<std::mutex> guard(description_mutex);
@@ -129,6 +140,8 @@ public:
 	static std::set<std::string> get_valid_attributes();
 	std::optional<std::string> attribute_value(const std::string& attr) const
 	override;
+	std::optional<int> attribute_value_as_number(const std::string& attr) const
+	override;
 
 	void set_feedptr(std::shared_ptr<RssFeed> ptr);
 	void set_feedptr(const std::weak_ptr<RssFeed>& ptr);
@@ -144,6 +157,7 @@ public:
 	void set_deleted(bool b)
 	{
 		deleted_ = b;
+		touch();
 	}
 
 	void set_index(unsigned int i)
@@ -169,6 +183,24 @@ public:
 		return override_unread_;
 	}
 
+	/// \brief Changes whenever an attribute that filter expressions can
+	/// refer to is changed.
+	///
+	/// Lets query feeds tell whether an article has to be matched again.
+	/// Attributes forwarded to the article's feed aren't covered.
+	unsigned int version() const
+	{
+		return version_;
+	}
+
+	/// Returns true if the description is held in memory, i.e. it was set or
+	/// loaded from the cache and hasn't been unloaded since.
+	bool has_description() const
+	{
+		std::lock_guard<std::mutex> guard(description_mutex);
+		return description_.has_value();
+	}
+
 	void unload()
 	{
 		std::lock_guard<std::mutex> guard(description_mutex);
@@ -176,6 +208,8 @@ public:
 	}
 
 private:
+	friend class RssFeed;
+
 	std::string title_;
 	std::string link_;
 	std::string author_;
@@ -198,8 +232,28 @@ private:
 	bool deleted_;
 	bool override_unread_;
 
+	std::atomic<unsigned int> version_;
+
+	void touch()
+	{
+		version_++;
+	}
+
+	// Feeds which contain this article, so that they can keep their unread
+	// counters up to date. An article that's in a feed several times is
+	// listed that many times.
+	std::vector<RssFeed*> containing_feeds;
+	// Guards `unread_` and `containing_feeds` of all articles
+	static std::mutex unread_mutex;
+
+	void set_unread_flag(bool u);
+
 	mutable std::mutex description_mutex;
 	std::optional<Description> description_;
+
+	mutable std::mutex sort_keys_mutex;
+	mutable std::optional<std::string> title_sort_key_;
+	mutable std::optional<std::string> author_sort_key_;
 };
 
 } // namespace newsboat
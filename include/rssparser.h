@@ -15,6 +15,7 @@ namespace newsboat {
 
 class Cache;
 class ConfigContainer;
+class FeedIgnoreRules;
 class RssFeed;
 class RssIgnores;
 class RssItem;
@@ -50,8 +51,10 @@ private:
 		const rsspp::Item& item);
 	std::string get_guid(const rsspp::Item& item) const;
 
+	/// \a rules may be nullptr if there are no ignore rules.
 	void add_item_to_feed(std::shared_ptr<RssFeed> feed,
-		std::shared_ptr<RssItem> item);
+		std::shared_ptr<RssItem> item,
+		const FeedIgnoreRules* rules);
 
 	void handle_content_encoded(std::shared_ptr<RssItem> x,
 		const rsspp::Item& item) const;
@@ -1,20 +1,33 @@
 #ifndef NEWSBOAT_SCOPEMEASURE_H_
 #define NEWSBOAT_SCOPEMEASURE_H_
 
+#include <optional>
 #include <string>
 
 #include "libnewsboat-ffi/src/scopemeasure.rs.h" // IWYU pragma: export
 
+#include "tracer.h"
+
 namespace newsboat {
 
+/// \brief Measures time spent in the enclosing scope.
+///
+/// The time is written to the log if the log level is DEBUG, and recorded as
+/// a span if the tracer is enabled (see tracer::enable()). Otherwise, this
+/// costs no more than reading the clock.
 class ScopeMeasure {
 public:
-	explicit ScopeMeasure(const std::string& func);
-	~ScopeMeasure() = default;
+	explicit ScopeMeasure(const std::string& func,
+		const std::string& feed_url = "");
+	~ScopeMeasure();
 	void stopover(const std::string& son = "");
 
 private:
-	rust::Box<scopemeasure::bridged::ScopeMeasure> rs_object;
+	std::string func;
+	std::string feed_url;
+	bool tracing;
+	tracer::Clock::time_point start_time;
+	std::optional<rust::Box<scopemeasure::bridged::ScopeMeasure>> rs_object;
 };
 
 } // namespace newsboat
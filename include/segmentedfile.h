@@ -0,0 +1,96 @@
+#ifndef PODBOAT_SEGMENTEDFILE_H_
+#define PODBOAT_SEGMENTEDFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "filepath.h"
+
+namespace podboat {
+
+/// \brief A partially downloaded file which is filled in segment by segment,
+/// in any order.
+///
+/// The file is allocated at its full size up front. Completed segments are
+/// recorded in a journal next to it (see journal_path()), so that an
+/// interrupted download only has to fetch the segments that weren't finished.
+/// To keep the number of disk flushes down, the journal is brought up to date
+/// at most once per second, and when the file is closed.
+class SegmentedFile {
+public:
+	SegmentedFile();
+	~SegmentedFile();
+
+	SegmentedFile(const SegmentedFile&) = delete;
+	SegmentedFile& operator=(const SegmentedFile&) = delete;
+
+	/// \brief Opens \a path for a download of \a size bytes, split into
+	/// \a segments segments of roughly equal size.
+	///
+	/// If the journal describes a download with the same size and number of
+	/// segments, the segments it lists are considered done. Otherwise, the
+	/// download starts over.
+	///
+	/// Returns false and sets errno on failure.
+	bool open(const newsboat::Filepath& path, std::uint64_t size,
+		unsigned int segments);
+	/// \brief Records the segments that are done in the journal, unless
+	/// the file is complete, and closes it.
+	void close();
+
+	std::uint64_t size() const
+	{
+		return size_;
+	}
+	unsigned int segment_count() const
+	{
+		return done.size();
+	}
+
+	/// \brief First byte of segment \a i, and the number of bytes in it.
+	std::pair<std::uint64_t, std::uint64_t> segment(unsigned int i) const;
+
+	bool is_done(unsigned int i) const
+	{
+		return done[i];
+	}
+	bool is_complete() const;
+
+	/// \brief Number of bytes in the segments that are done.
+	std::uint64_t completed_bytes() const;
+
+	/// \brief Writes \a len bytes at \a offset. Returns false and sets errno
+	/// on failure.
+	bool write(std::uint64_t offset, const char* data, size_t len);
+
+	/// \brief Marks segment \a i as done. It's recorded in the journal by
+	/// the next sync(), which happens right away if the last one was a while
+	/// ago. Returns false and sets errno on failure.
+	bool mark_done(unsigned int i);
+
+	/// \brief Records the segments marked done since the last call in the
+	/// journal, after making sure their data reached the disk. Returns false
+	/// and sets errno on failure.
+	bool sync();
+
+	/// \brief Path of the journal belonging to the partial file \a path.
+	static newsboat::Filepath journal_path(const newsboat::Filepath& path);
+	static bool has_journal(const newsboat::Filepath& path);
+
+private:
+	bool read_journal(const std::string& journal);
+
+	int fd;
+	int journal_fd;
+	std::uint64_t size_;
+	std::vector<bool> done;
+	/// Segments that are done, but not in the journal yet
+	std::vector<unsigned int> unsynced;
+	std::chrono::steady_clock::time_point last_sync;
+};
+
+} // namespace podboat
+
+#endif /* PODBOAT_SEGMENTEDFILE_H_ */
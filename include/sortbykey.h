@@ -0,0 +1,44 @@
+#ifndef NEWSBOAT_SORTBYKEY_H_
+#define NEWSBOAT_SORTBYKEY_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace newsboat {
+
+/// \brief Stable-sorts \a elements by the keys that \a key_of returns for
+/// them, using \a less to compare the keys.
+///
+/// Each key is computed only once, rather than twice per comparison, which
+/// matters when computing it involves converting strings.
+template<typename T, typename KeyOf, typename Less>
+void sort_by_key(std::vector<T>& elements, KeyOf key_of, Less less)
+{
+	using Key = decltype(key_of(elements.front()));
+	std::vector<Key> keys;
+	keys.reserve(elements.size());
+	for (const auto& element : elements) {
+		keys.push_back(key_of(element));
+	}
+
+	std::vector<std::size_t> order(elements.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+	[&](std::size_t a, std::size_t b) {
+		return less(keys[a], keys[b]);
+	});
+
+	std::vector<T> sorted;
+	sorted.reserve(elements.size());
+	for (const auto i : order) {
+		sorted.push_back(std::move(elements[i]));
+	}
+	elements = std::move(sorted);
+}
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_SORTBYKEY_H_ */
@@ -0,0 +1,62 @@
+#ifndef NEWSBOAT_TRACER_H_
+#define NEWSBOAT_TRACER_H_
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#include "filepath.h"
+
+namespace newsboat {
+
+/// \brief Records timed scopes (spans) for later analysis.
+///
+/// Each thread records its spans into its own ring buffer, so recording a span
+/// doesn't take any locks. Once a buffer is full, the oldest spans in it are
+/// overwritten. While the buffers are read or cleared, recording is paused
+/// and spans which end in the meantime are dropped.
+///
+/// Spans are normally recorded by ScopeMeasure, and only while the tracer is
+/// enabled.
+namespace tracer {
+
+using Clock = std::chrono::steady_clock;
+
+/// \brief Starts recording spans. Timestamps are relative to the moment of
+/// the first call.
+void enable();
+
+/// \brief Stops recording spans. Spans recorded so far are kept.
+void disable();
+
+bool is_enabled();
+
+/// \brief Records a span named \a name which lasted from \a start to \a end.
+/// \a feed_url may be empty if the span isn't related to a particular feed.
+///
+/// Does nothing if the tracer isn't enabled.
+void record(const std::string& name, const std::string& feed_url,
+	Clock::time_point start, Clock::time_point end);
+
+/// \brief Writes recorded spans in Chrome's Trace Event format, which can be
+/// opened in chrome://tracing and in Perfetto.
+void write_trace(std::ostream& out);
+
+/// \brief Writes a table with the number of calls, and the distribution of
+/// durations, of each span name.
+void write_summary(std::ostream& out);
+
+/// \brief Disables the tracer, writes the trace to \a path and the summary
+/// next to it, to \a path with ".summary" appended.
+///
+/// Returns false if either file couldn't be written.
+bool write_files(const Filepath& path);
+
+/// \brief Drops all recorded spans.
+void reset();
+
+} // namespace tracer
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_TRACER_H_ */
@@ -1,7 +1,9 @@
 #ifndef NEWSBOAT_TTRSSAPI_H_
 #define NEWSBOAT_TTRSSAPI_H_
 
+#include <memory>
 #include <mutex>
+#include <unordered_set>
 
 #include "3rd-party/json.hpp"
 #include "remoteapi.h"
@@ -30,15 +32,25 @@ public:
 	void add_custom_headers(curl_slist** custom_headers) override;
 	bool mark_all_read(const std::string& feed_url) override;
 	bool mark_article_read(const std::string& guid, bool read) override;
+	bool mark_articles_read(const std::vector<std::string>& guids) override;
+	bool mark_articles_unread(const std::vector<std::string>& guids) override;
 	bool update_article_flags(const std::string& oldflags,
 		const std::string& newflags,
 		const std::string& guid) override;
-	rsspp::Feed fetch_feed(const std::string& id, CurlHandle& cached_handle);
+	/// \brief Fetches the articles of the feed \a id.
+	///
+	/// If \a sync_position is set, only articles which were added since
+	/// the fetch that returned it are fetched, along with the IDs of all
+	/// unread articles of the feed.
+	rsspp::Feed fetch_feed(const std::string& id, CurlHandle& cached_handle,
+		const std::string& sync_position = "");
 	bool update_article(const std::string& guid, int field, int mode);
 
 private:
 	void fetch_feeds_per_category(const nlohmann::json& cat,
 		std::vector<TaggedFeedUrl>& feeds);
+	std::shared_ptr<const std::unordered_set<std::string>> fetch_unread_ids(
+			const std::string& id, CurlHandle& cached_handle);
 	bool star_article(const std::string& guid, bool star);
 	bool publish_article(const std::string& guid, bool publish);
 	TaggedFeedUrl feed_from_json(const nlohmann::json& jfeed,
@@ -0,0 +1,34 @@
+#ifndef NEWSBOAT_UNREADINDEX_H_
+#define NEWSBOAT_UNREADINDEX_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace newsboat {
+
+/// \brief Counts unread articles across several feeds, counting articles
+/// with the same GUID only once.
+///
+/// Feeds attached with RssFeed::set_unread_index() add the GUIDs of their
+/// unread articles, and keep them up to date as articles are added, removed
+/// and marked (un)read.
+class UnreadIndex {
+public:
+	UnreadIndex() = default;
+
+	void add(const std::string& guid);
+	void remove(const std::string& guid);
+
+	/// \brief Number of distinct GUIDs that were added more often than they
+	/// were removed.
+	unsigned int size() const;
+
+private:
+	mutable std::mutex mtx;
+	std::unordered_map<std::string, unsigned int> refcounts;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_UNREADINDEX_H_ */
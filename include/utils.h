@@ -167,6 +167,9 @@ std::optional<LinkType> podcast_mime_to_link_type(const std::string&
 
 std::string string_from_utf8_lossy(const std::vector<std::uint8_t>& text);
 
+/// Returns true if the bytes are valid UTF-8. The bytes aren't copied.
+bool is_valid_utf8(std::string_view text);
+
 /// Replaces invalid UTF-8 code units in the string with U+FFFD (replacement
 /// character). Returns a valid UTF-8 string.
 std::string sanitize_utf8(const std::string& text);
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "articlerendercache.h"
 #include "formaction.h"
 #include "links.h"
 #include "statusline.h"
@@ -58,6 +59,14 @@ public:
 		return keys;
 	}
 	void set_tags(const std::vector<std::string>& t);
+
+	/// \brief Articles rendered for the article view. Outlives the views of
+	/// single articles, so that going back to an article doesn't render it
+	/// again.
+	ArticleRenderCache& get_article_cache()
+	{
+		return article_cache;
+	}
 	void drop_queued_input();
 	void pop_current_formaction();
 	void remove_formaction(unsigned int pos);
@@ -173,6 +182,8 @@ protected:
 	FilterContainer& filters;
 	const ColorManager& colorman;
 
+	ArticleRenderCache article_cache;
+
 private:
 	bool try_prepare_query_feed(std::shared_ptr<RssFeed> feed);
 };
@@ -0,0 +1,47 @@
+#ifndef NEWSBOAT_WORKSTEALINGQUEUE_H_
+#define NEWSBOAT_WORKSTEALINGQUEUE_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace newsboat {
+
+/// \brief Hands out the indexes [0, size) to a fixed number of workers.
+///
+/// Every worker starts out with a contiguous range of indexes, which it takes
+/// from the front, so neighbouring indexes (e.g. feeds on the same domain) are
+/// processed one after another by the same worker. Once a worker's own range
+/// is exhausted, it steals from the back of the range with the most indexes
+/// left. That way, a worker stuck on a few slow items doesn't hold up the
+/// rest of its range while the other workers sit idle.
+class WorkStealingQueue {
+public:
+	WorkStealingQueue(unsigned int size, unsigned int num_workers);
+
+	/// \brief Takes the next index for worker \a worker (counting from 0).
+	///
+	/// Returns false if there is nothing left to do for anybody.
+	bool next(unsigned int worker, unsigned int& index);
+
+	unsigned int workers_count() const
+	{
+		return ranges.size();
+	}
+
+private:
+	struct Range {
+		std::mutex mutex;
+		// Half-open interval [begin, end)
+		unsigned int begin;
+		unsigned int end;
+	};
+
+	bool steal(unsigned int thief, unsigned int& index);
+
+	std::vector<std::unique_ptr<Range>> ranges;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_WORKSTEALINGQUEUE_H_ */
@@ -18,6 +18,7 @@
 #include "matcherexception.h"
 #include "rss/parser.h"
 #include "stflpp.h"
+#include "tracer.h"
 #include "utils.h"
 #include "view.h"
 #include "xlicense.h"
@@ -121,7 +122,19 @@ void print_usage(const std::string& argv0, const ConfigPaths& configpaths)
 			_s("import list of read articles from <file>")
 		},
 		{'h', "help", "", _s("this help")},
-		{'-', "cleanup", "", _s("remove unreferenced items from cache")}
+		{'-', "cleanup", "", _s("remove unreferenced items from cache")},
+		{
+			'-',
+			"daemon",
+			"",
+			_s("keep running in the background, executing commands sent with -x")
+		},
+		{
+			'-',
+			"trace-file",
+			_s("<file>"),
+			_s("write timings of reloading, parsing and rendering to <file>")
+		}
 	};
 
 	std::vector<std::pair<std::string, std::string>> helpLines;
@@ -282,6 +295,11 @@ int main(int argc, char* argv[])
 		return EXIT_SUCCESS;
 	}
 
+	const auto trace_file = args.trace_file();
+	if (trace_file.has_value()) {
+		tracer::enable();
+	}
+
 	int ret;
 	try {
 		ret = c.run(args);
@@ -307,6 +325,12 @@ int main(int argc, char* argv[])
 		::exit(EXIT_FAILURE);
 	}
 
+	if (trace_file.has_value() && !tracer::write_files(trace_file.value())) {
+		std::cerr << strprintf::fmt(_("Failed to write trace to %s"),
+				trace_file.value())
+			<< std::endl;
+	}
+
 	rsspp::Parser::global_cleanup();
 
 	return ret;
@@ -17,23 +17,7 @@ void AtomParser::parse_feed(Feed& f, xmlNode* rootNode)
 		throw Exception(_("XML root node is NULL"));
 	}
 
-	switch (f.rss_version) {
-	case Feed::ATOM_0_3:
-		ns = ATOM_0_3_URI;
-		break;
-	case Feed::ATOM_1_0:
-		ns = ATOM_1_0_URI;
-		break;
-	case Feed::ATOM_0_3_NONS:
-		ns = nullptr;
-		break;
-	default:
-		ns = nullptr;
-		break;
-	}
-
-	f.language = get_prop(rootNode, "lang");
-	globalbase = get_prop(rootNode, "base", XML_URI);
+	parse_root(f, rootNode);
 	std::string author;
 
 	for (xmlNode* node = rootNode->children; node != nullptr;
@@ -57,7 +41,7 @@ void AtomParser::parse_feed(Feed& f, xmlNode* rootNode)
 		} else if (node_is(node, "author", ns)) {
 			parse_and_update_author(node, author);
 		} else if (node_is(node, "entry", ns)) {
-			f.items.push_back(parse_entry(node));
+			f.items.push_back(parse_item(node));
 		}
 	}
 
@@ -70,7 +54,34 @@ void AtomParser::parse_feed(Feed& f, xmlNode* rootNode)
 	}
 }
 
-Item AtomParser::parse_entry(xmlNode* entryNode)
+void AtomParser::parse_root(Feed& f, xmlNode* rootNode)
+{
+	switch (f.rss_version) {
+	case Feed::ATOM_0_3:
+		ns = ATOM_0_3_URI;
+		break;
+	case Feed::ATOM_1_0:
+		ns = ATOM_1_0_URI;
+		break;
+	case Feed::ATOM_0_3_NONS:
+		ns = nullptr;
+		break;
+	default:
+		ns = nullptr;
+		break;
+	}
+
+	f.language = get_prop(rootNode, "lang");
+	globalbase = get_prop(rootNode, "base", XML_URI);
+}
+
+bool AtomParser::is_item(xmlNode* node)
+{
+	return node_is(node, "entry", ns) && node->parent != nullptr
+		&& node->parent == xmlDocGetRootElement(doc);
+}
+
+Item AtomParser::parse_item(xmlNode* entryNode)
 {
 	Item it;
 	std::string author;
@@ -12,6 +12,9 @@ class Item;
 
 struct AtomParser : public RssParser {
 	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_root(Feed& f, xmlNode* rootNode) override;
+	bool is_item(xmlNode* node) override;
+	Item parse_item(xmlNode* entryNode) override;
 	explicit AtomParser(xmlDocPtr doc)
 		: RssParser(doc)
 		, ns(0)
@@ -20,7 +23,6 @@ struct AtomParser : public RssParser {
 	~AtomParser() override {}
 
 private:
-	Item parse_entry(xmlNode* itemNode);
 	void parse_and_update_author(xmlNode* authorNode, std::string& author);
 	static std::string content_type_to_mime(const std::string& type);
 	const char* ns;
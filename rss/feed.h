@@ -1,7 +1,9 @@
 #ifndef NEWSBOAT_RSSPPFEED_H_
 #define NEWSBOAT_RSSPPFEED_H_
 
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "item.h"
@@ -44,6 +46,17 @@ public:
 	std::string pubDate;
 
 	std::vector<Item> items;
+
+	/// Where the next fetch from a remote API should continue, e.g. the
+	/// highest article ID seen so far. Empty if the API doesn't support
+	/// incremental fetches.
+	std::string sync_position;
+
+	/// GUIDs of all unread articles of the feed, as reported by a remote API,
+	/// or null if they weren't fetched. Set by incremental fetches, whose
+	/// `items` don't include articles that were fetched earlier. May be shared
+	/// between feeds, and contain articles of the others too.
+	std::shared_ptr<const std::unordered_set<std::string>> unread_guids;
 };
 
 } // namespace rsspp
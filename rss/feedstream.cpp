@@ -0,0 +1,325 @@
+#include "feedstream.h"
+
+#include <cstdint>
+#include <libxml/SAX2.h>
+#include <libxml/encoding.h>
+#include <libxml/parserInternals.h>
+#include <libxml/tree.h>
+#include <string_view>
+#include <vector>
+
+#include "charencoding.h"
+#include "config.h"
+#include "exception.h"
+#include "logger.h"
+#include "rssparser.h"
+#include "rssparserfactory.h"
+#include "utils.h"
+
+using namespace newsboat;
+
+namespace {
+
+// Enough to contain the byte order mark and the XML declaration
+const size_t HEAD_SIZE = 512;
+
+bool is_continuation_byte(unsigned char c)
+{
+	return (c & 0xC0) == 0x80;
+}
+
+// Length of the UTF-8 sequence that starts with `c`, or 1 if `c` can't start
+// one
+size_t utf8_sequence_length(unsigned char c)
+{
+	if ((c & 0xE0) == 0xC0) {
+		return 2;
+	} else if ((c & 0xF0) == 0xE0) {
+		return 3;
+	} else if ((c & 0xF8) == 0xF0) {
+		return 4;
+	}
+	return 1;
+}
+
+// Returns the length of the multi-byte sequence at the end of `data` that is
+// cut short, or 0 if the last sequence is complete (or not UTF-8 at all)
+size_t incomplete_utf8_suffix(const char* data, size_t size)
+{
+	for (size_t i = 1; i <= 3 && i <= size; i++) {
+		const unsigned char c = data[size - i];
+		if (is_continuation_byte(c)) {
+			// the sequence starts further back
+			continue;
+		}
+		return utf8_sequence_length(c) > i ? i : 0;
+	}
+	return 0;
+}
+
+} // namespace
+
+namespace rsspp {
+
+FeedStream::FeedStream(const std::string& url,
+	std::optional<std::string> charset)
+	: url(url)
+	, charset(charset)
+	, sanitize_utf8(false)
+	, ctxt(nullptr)
+{
+}
+
+FeedStream::~FeedStream()
+{
+	if (ctxt) {
+		if (ctxt->myDoc) {
+			xmlFreeDoc(ctxt->myDoc);
+		}
+		xmlFreeParserCtxt(ctxt);
+	}
+}
+
+void FeedStream::parse_chunk(const char* data, size_t size)
+{
+	if (error || size == 0) {
+		return;
+	}
+
+	try {
+		if (ctxt) {
+			push(data, size, false);
+			return;
+		}
+
+		head.insert(head.end(), data, data + size);
+		if (head.size() >= HEAD_SIZE) {
+			create_context();
+			const std::vector<std::uint8_t> start = std::move(head);
+			head.clear();
+			push(reinterpret_cast<const char*>(start.data()), start.size(), false);
+		}
+	} catch (...) {
+		fail();
+	}
+}
+
+Feed FeedStream::finish()
+{
+	if (!error) {
+		try {
+			if (!ctxt) {
+				create_context();
+				push(reinterpret_cast<const char*>(head.data()), head.size(), true);
+				head.clear();
+			} else {
+				push(nullptr, 0, true);
+			}
+		} catch (...) {
+			fail();
+		}
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	xmlNode* root = ctxt->myDoc ? xmlDocGetRootElement(ctxt->myDoc) : nullptr;
+	if (root == nullptr || !parser) {
+		throw Exception(_("could not parse buffer"));
+	}
+
+	LOG(Level::DEBUG,
+		"FeedStream::finish: read %zu articles while streaming",
+		feed.items.size());
+
+	parser->parse_feed(feed, root);
+
+	if (ctxt->myDoc->encoding) {
+		LOG(Level::INFO,
+			"FeedStream::finish: encoding = %s",
+			(const char*)ctxt->myDoc->encoding);
+	}
+
+	return std::move(feed);
+}
+
+void FeedStream::create_context()
+{
+	const bool self_describing = charencoding::charset_from_bom(head).has_value()
+		|| charencoding::charset_from_xml_declaration(head).has_value();
+
+	xmlSAXHandler sax{};
+	xmlSAXVersion(&sax, 2);
+	sax.startElementNs = &FeedStream::start_element;
+	sax.endElementNs = &FeedStream::end_element;
+
+	ctxt = xmlCreatePushParserCtxt(&sax, nullptr, nullptr, 0, url.c_str());
+	if (ctxt == nullptr) {
+		throw Exception(_("could not parse buffer"));
+	}
+	ctxt->_private = this;
+
+	int options = XML_PARSE_RECOVER | XML_PARSE_NOERROR | XML_PARSE_NOWARNING;
+	if (self_describing) {
+		// libxml2 reads the byte order mark and the XML declaration itself
+		LOG(Level::DEBUG, "FeedStream::create_context: encoding is given by the document");
+	} else if (charset.has_value() && charencoding::is_utf8(charset.value())) {
+		// Valid UTF-8 can go to libxml2 unchanged; there's nothing to convert
+		LOG(Level::DEBUG, "FeedStream::create_context: encoding is utf-8");
+		sanitize_utf8 = true;
+	} else if (charset.has_value()) {
+		xmlCharEncodingHandlerPtr handler =
+			xmlFindCharEncodingHandler(charset.value().c_str());
+		if (handler != nullptr) {
+			LOG(Level::DEBUG, "FeedStream::create_context: convert from %s", charset.value());
+			xmlSwitchToEncoding(ctxt, handler);
+			options |= XML_PARSE_IGNORE_ENC;
+		} else {
+			LOG(Level::DEBUG,
+				"FeedStream::create_context: unknown encoding %s, falling back to auto-detection",
+				charset.value());
+		}
+	} else {
+		LOG(Level::DEBUG, "FeedStream::create_context: no encoding given, assuming utf-8");
+		sanitize_utf8 = true;
+	}
+	xmlCtxtUseOptions(ctxt, options);
+}
+
+void FeedStream::push(const char* data, size_t size, bool terminate)
+{
+	if (!sanitize_utf8) {
+		xmlParseChunk(ctxt, data, size, terminate);
+		return;
+	}
+
+	if (!utf8_tail.empty()) {
+		// Complete the sequence that was cut short at the end of the
+		// previous chunk
+		const size_t length = utf8_sequence_length(utf8_tail[0]);
+		size_t taken = 0;
+		while (utf8_tail.size() < length && taken < size
+			&& is_continuation_byte(data[taken])) {
+			utf8_tail.push_back(data[taken]);
+			taken++;
+		}
+		data += taken;
+		size -= taken;
+		if (utf8_tail.size() < length && size == 0 && !terminate) {
+			return;
+		}
+		const std::string sequence = std::move(utf8_tail);
+		utf8_tail.clear();
+		push_utf8(sequence.data(), sequence.size(), false);
+	}
+
+	// Sequences split between chunks would be replaced otherwise
+	const size_t incomplete = terminate ? 0 : incomplete_utf8_suffix(data, size);
+	utf8_tail.assign(data + size - incomplete, incomplete);
+	push_utf8(data, size - incomplete, terminate);
+}
+
+void FeedStream::push_utf8(const char* data, size_t size, bool terminate)
+{
+	if (utils::is_valid_utf8(std::string_view(data, size))) {
+		xmlParseChunk(ctxt, data, size, terminate);
+		return;
+	}
+
+	const std::string valid = utils::string_from_utf8_lossy(
+			std::vector<std::uint8_t>(data, data + size));
+	xmlParseChunk(ctxt, valid.data(), valid.size(), terminate);
+}
+
+void FeedStream::start_element(void* ctx,
+	const xmlChar* localname,
+	const xmlChar* prefix,
+	const xmlChar* URI,
+	int nb_namespaces,
+	const xmlChar** namespaces,
+	int nb_attributes,
+	int nb_defaulted,
+	const xmlChar** attributes)
+{
+	xmlSAX2StartElementNs(ctx, localname, prefix, URI, nb_namespaces,
+		namespaces, nb_attributes, nb_defaulted, attributes);
+
+	auto context = static_cast<xmlParserCtxtPtr>(ctx);
+	auto stream = static_cast<FeedStream*>(context->_private);
+	xmlNode* node = context->node;
+	if (node == nullptr || node->parent != reinterpret_cast<xmlNode*>(context->myDoc)
+		|| stream->parser || stream->error) {
+		return;
+	}
+
+	try {
+		stream->handle_root(node);
+	} catch (...) {
+		stream->fail();
+	}
+}
+
+void FeedStream::end_element(void* ctx,
+	const xmlChar* localname,
+	const xmlChar* prefix,
+	const xmlChar* URI)
+{
+	auto context = static_cast<xmlParserCtxtPtr>(ctx);
+	auto stream = static_cast<FeedStream*>(context->_private);
+	// The element that is closed, as libxml2 moves on to its parent
+	xmlNode* node = context->node;
+
+	xmlSAX2EndElementNs(ctx, localname, prefix, URI);
+
+	if (node == nullptr || !stream->parser || stream->error) {
+		return;
+	}
+
+	try {
+		stream->handle_end(node);
+	} catch (...) {
+		stream->fail();
+	}
+}
+
+void FeedStream::handle_root(xmlNode* root)
+{
+	feed.rss_version = RssParserFactory::get_version(root);
+	parser = RssParserFactory::get_object(feed.rss_version, ctxt->myDoc);
+	parser->parse_root(feed, root);
+}
+
+void FeedStream::handle_end(xmlNode* node)
+{
+	if (!parser->is_item(node)) {
+		return;
+	}
+
+	feed.items.push_back(parser->parse_item(node));
+
+	// Whitespace between articles would pile up otherwise
+	while (node->prev != nullptr && node->prev->type == XML_TEXT_NODE) {
+		xmlNode* text = node->prev;
+		xmlUnlinkNode(text);
+		xmlFreeNode(text);
+	}
+	xmlUnlinkNode(node);
+	xmlFreeNode(node);
+
+	// libxml2 appends text to the last text node it created, whose length
+	// it keeps track of. That node might be gone now, so make it look the
+	// length up again.
+	ctxt->nodelen = 0;
+	ctxt->nodemem = 0;
+}
+
+void FeedStream::fail()
+{
+	error = std::current_exception();
+	if (ctxt) {
+		xmlStopParser(ctxt);
+	}
+}
+
+} // namespace rsspp
@@ -0,0 +1,89 @@
+#ifndef NEWSBOAT_RSSPPFEEDSTREAM_H_
+#define NEWSBOAT_RSSPPFEEDSTREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <libxml/parser.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "feed.h"
+
+namespace rsspp {
+
+struct RssParser;
+
+/// \brief Parses a feed piece by piece, e.g. while it's being downloaded.
+///
+/// The data is handed to libxml2's push parser. Each article is converted
+/// into an Item as soon as its closing tag is read, and is then removed from
+/// the document. The document thus never holds more than the feed's own
+/// elements plus the article that is being read, no matter how big the feed
+/// is.
+class FeedStream {
+public:
+	/// \a charset is the encoding announced outside of the document, e.g. in
+	/// the Content-Type header. A byte order mark or an XML declaration take
+	/// precedence over it.
+	explicit FeedStream(const std::string& url,
+		std::optional<std::string> charset = std::nullopt);
+	~FeedStream();
+
+	/// \brief Parses the next \a size bytes of the document.
+	///
+	/// Never throws; errors are reported by finish().
+	void parse_chunk(const char* data, size_t size);
+
+	/// \brief Parses whatever is left of the document and returns the feed.
+	///
+	/// Throws rsspp::Exception if the document is not a feed.
+	Feed finish();
+
+private:
+	FeedStream(const FeedStream&) = delete;
+	FeedStream& operator=(const FeedStream&) = delete;
+
+	static void start_element(void* ctx,
+		const xmlChar* localname,
+		const xmlChar* prefix,
+		const xmlChar* URI,
+		int nb_namespaces,
+		const xmlChar** namespaces,
+		int nb_attributes,
+		int nb_defaulted,
+		const xmlChar** attributes);
+	static void end_element(void* ctx,
+		const xmlChar* localname,
+		const xmlChar* prefix,
+		const xmlChar* URI);
+
+	void create_context();
+	void push(const char* data, size_t size, bool terminate);
+	void push_utf8(const char* data, size_t size, bool terminate);
+	void handle_root(xmlNode* root);
+	void handle_end(xmlNode* node);
+	void fail();
+
+	const std::string url;
+	std::optional<std::string> charset;
+
+	// Start of the document, held back until its encoding is known
+	std::vector<std::uint8_t> head;
+	// Set if the document is UTF-8 or its encoding is unknown, in which case
+	// it's read as UTF-8 with invalid sequences replaced
+	bool sanitize_utf8;
+	// Incomplete UTF-8 sequence at the end of the previous chunk
+	std::string utf8_tail;
+
+	xmlParserCtxtPtr ctxt;
+	std::shared_ptr<RssParser> parser;
+	Feed feed;
+	std::exception_ptr error;
+};
+
+} // namespace rsspp
+
+#endif /* NEWSBOAT_RSSPPFEEDSTREAM_H_ */
@@ -1,8 +1,10 @@
 #include "parser.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
 #include <cstring>
+#include <ctime>
 #include <curl/curl.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
@@ -10,10 +12,10 @@
 #include "3rd-party/expected.hpp"
 #include "charencoding.h"
 #include "config.h"
-#include "curldatareceiver.h"
 #include "curlhandle.h"
 #include "curlheadercontainer.h"
 #include "exception.h"
+#include "feedstream.h"
 #include "logger.h"
 #include "remoteapi.h"
 #include "rssparser.h"
@@ -40,6 +42,8 @@ Parser::Parser(unsigned int timeout,
 	, verify_ssl(ssl_verify)
 	, doc(0)
 	, lm(0)
+	, nb(0)
+	, custom_headers(nullptr)
 {
 }
 
@@ -48,6 +52,9 @@ Parser::~Parser()
 	if (doc) {
 		xmlFreeDoc(doc);
 	}
+	if (custom_headers) {
+		curl_slist_free_all(custom_headers);
+	}
 }
 
 nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
@@ -57,8 +64,20 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 	newsboat::RemoteApi* api,
 	const std::string& cookie_cache)
 {
-	CURLcode ret;
-	curl_slist* custom_headers{};
+	prepare_url(url, easyhandle, lastmodified, etag, api, cookie_cache);
+	const CURLcode ret = curl_easy_perform(easyhandle.ptr());
+	return finish_url(url, easyhandle, ret);
+}
+
+void Parser::prepare_url(const std::string& url,
+	newsboat::CurlHandle& easyhandle,
+	time_t lastmodified,
+	const std::string& etag,
+	newsboat::RemoteApi* api,
+	const std::string& cookie_cache)
+{
+	release_request_state(easyhandle);
+	nb = 0;
 
 	curl_easy_reset(easyhandle.ptr());
 
@@ -104,8 +123,11 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 		curl_easy_setopt(easyhandle.ptr(), CURLOPT_CAINFO, curl_ca_bundle);
 	}
 
-	auto curlHeaderHandler = CurlHeaderContainer::register_header_handler(easyhandle);
-	auto curlDataReceiver = CurlDataReceiver::register_data_handler(easyhandle);
+	header_handler = CurlHeaderContainer::register_header_handler(easyhandle);
+	request_url = url;
+	curl_easy_setopt(easyhandle.ptr(), CURLOPT_WRITEDATA, this);
+	curl_easy_setopt(easyhandle.ptr(), CURLOPT_WRITEFUNCTION,
+		&Parser::write_callback);
 
 	if (lastmodified != 0) {
 		curl_easy_setopt(easyhandle.ptr(),
@@ -129,8 +151,12 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 		curl_easy_setopt(
 			easyhandle.ptr(), CURLOPT_HTTPHEADER, custom_headers);
 	}
+}
 
-	ret = curl_easy_perform(easyhandle.ptr());
+nonstd::expected<Feed, Parser::Error> Parser::finish_url(const std::string& url,
+	newsboat::CurlHandle& easyhandle,
+	CURLcode ret)
+{
 	LOG(Level::DEBUG,
 		"Parser::parse_url: ret = %d (%s)",
 		ret,
@@ -151,7 +177,7 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 			static_cast<int64_t>(status));
 	}
 
-	const auto etag_headers = curlHeaderHandler->get_header_lines("ETag");
+	const auto etag_headers = header_handler->get_header_lines("ETag");
 	if (etag_headers.size() >= 1) {
 		std::string etag = etag_headers.back();
 		utils::trim(etag);
@@ -159,7 +185,7 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 		et = etag;
 	}
 
-	const auto last_modified_headers = curlHeaderHandler->get_header_lines("Last-Modified");
+	const auto last_modified_headers = header_handler->get_header_lines("Last-Modified");
 	if (last_modified_headers.size() >= 1) {
 		const std::string header_value = last_modified_headers.back();
 		time_t time = curl_getdate(header_value.c_str(), nullptr);
@@ -178,20 +204,16 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 		}
 	}
 
-	std::optional<std::string> charset_content_type;
-	const auto content_type_headers = curlHeaderHandler->get_header_lines("Content-Type");
-	if (content_type_headers.size() >= 1) {
-		std::string header_value = content_type_headers.back();
-		utils::trim(header_value);
-		LOG(Level::DEBUG, "Parser::parse_url: got content type %s", header_value);
-		const auto input = std::vector<uint8_t>(header_value.begin(), header_value.end());
-		charset_content_type = charencoding::charset_from_content_type_header(input);
+	nb = not_before_from_headers();
+	if (nb != 0) {
+		LOG(Level::DEBUG,
+			"Parser::parse_url: server asks not to be contacted before %" PRId64,
+			static_cast<int64_t>(nb));
 	}
 
-	if (custom_headers) {
-		curl_easy_setopt(easyhandle.ptr(), CURLOPT_HTTPHEADER, 0);
-		curl_slist_free_all(custom_headers);
-	}
+	// Set by write_callback() once the body started to arrive
+	std::unique_ptr<FeedStream> body = std::move(stream);
+	release_request_state(easyhandle);
 
 	if (ret != 0) {
 		LOG(Level::ERROR,
@@ -218,43 +240,133 @@ nonstd::expected<Feed, Parser::Error> Parser::parse_url(const std::string& url,
 		return nonstd::make_unexpected(Error{ErrorType::NotModified, ""});
 	}
 
-	std::string buf = curlDataReceiver->get_data();
-	LOG(Level::DEBUG,
-		"Parser::parse_url: retrieved data for %s: %s",
-		url,
-		buf);
-
-	const std::vector<std::uint8_t> data(buf.begin(), buf.end());
-	const auto charset_xml_declaration = charencoding::charset_from_xml_declaration(data);
-	const auto charset_bom = charencoding::charset_from_bom(data);
-
-	std::optional<std::string> charset;
-	if (charset_bom.has_value()) {
-		charset = charset_bom;
-	} else if (charset_xml_declaration.has_value()) {
-		charset = charset_xml_declaration;
-	} else if (charset_content_type.has_value()) {
-		charset = charset_content_type;
+	if (body) {
+		LOG(Level::DEBUG,
+			"Parser::parse_url: parsing the rest of the data for %s",
+			url);
+		return body->finish();
+	}
+
+	return Feed();
+}
+
+time_t Parser::not_before_from_headers() const
+{
+	const time_t now = time(nullptr);
+
+	// Header values which are a number of seconds, like "Age: 30"
+	auto seconds = [](const std::string& value) -> std::optional<time_t> {
+		if (value.empty() || value.size() > 9
+			|| value.find_first_not_of("0123456789") != std::string::npos) {
+			return std::nullopt;
+		}
+		return std::stoll(value);
+	};
+
+	time_t retry_after = 0;
+	const auto retry_after_headers = header_handler->get_header_lines("Retry-After");
+	if (retry_after_headers.size() >= 1) {
+		const std::string& value = retry_after_headers.back();
+		if (const auto delay = seconds(value)) {
+			retry_after = now + *delay;
+		} else {
+			retry_after = std::max<time_t>(0, curl_getdate(value.c_str(), nullptr));
+		}
+	}
+
+	// Cache-Control's max-age takes precedence over Expires
+	std::optional<time_t> max_age;
+	const auto cache_control_headers = header_handler->get_header_lines("Cache-Control");
+	if (cache_control_headers.size() >= 1) {
+		const auto directives = utils::tokenize(
+				utils::to_lowercase(cache_control_headers.back()), ", ");
+		for (const auto& directive : directives) {
+			if (directive.rfind("max-age=", 0) == 0) {
+				max_age = seconds(directive.substr(std::strlen("max-age=")));
+			}
+		}
+	}
+
+	time_t fresh_until = 0;
+	if (max_age.has_value()) {
+		const auto age_headers = header_handler->get_header_lines("Age");
+		const auto age = age_headers.empty() ? std::nullopt : seconds(age_headers.back());
+		fresh_until = now + *max_age - age.value_or(0);
 	} else {
-		buf = utils::string_from_utf8_lossy(data);
-		charset = "utf-8";
+		const auto expires_headers = header_handler->get_header_lines("Expires");
+		const auto date_headers = header_handler->get_header_lines("Date");
+		const time_t expires = expires_headers.empty() ? -1 :
+			curl_getdate(expires_headers.back().c_str(), nullptr);
+		const time_t date = date_headers.empty() ? -1 :
+			curl_getdate(date_headers.back().c_str(), nullptr);
+		if (expires != -1) {
+			// Relative to the server's clock, in case ours is off
+			fresh_until = (date != -1) ? now + (expires - date) : expires;
+		}
 	}
 
-	if (buf.length() > 0) {
-		LOG(Level::DEBUG,
-			"Parser::parse_url: handing over data to "
-			"parse_buffer()");
-		return parse_buffer(buf, url, charset);
+	const time_t result = std::max(retry_after, fresh_until);
+	return result > now ? result : 0;
+}
+
+std::optional<std::string> Parser::charset_from_headers() const
+{
+	const auto content_type_headers = header_handler->get_header_lines("Content-Type");
+	if (content_type_headers.size() >= 1) {
+		std::string header_value = content_type_headers.back();
+		utils::trim(header_value);
+		LOG(Level::DEBUG, "Parser::parse_url: got content type %s", header_value);
+		const auto input = std::vector<uint8_t>(header_value.begin(), header_value.end());
+		return charencoding::charset_from_content_type_header(input);
 	}
+	return std::nullopt;
+}
 
-	return Feed();
+size_t Parser::write_callback(char* data, size_t size, size_t nmemb,
+	void* parser)
+{
+	auto p = static_cast<Parser*>(parser);
+	try {
+		if (!p->stream) {
+			// All headers of the final response are in by now
+			p->stream.reset(new FeedStream(p->request_url, p->charset_from_headers()));
+		}
+		p->stream->parse_chunk(data, size * nmemb);
+	} catch (const std::exception& e) {
+		LOG(Level::ERROR, "Parser::write_callback: %s", e.what());
+		// Makes curl abort the transfer
+		return 0;
+	}
+	return size * nmemb;
+}
+
+void Parser::release_request_state(newsboat::CurlHandle& easyhandle)
+{
+	header_handler.reset();
+	stream.reset();
+	curl_easy_setopt(easyhandle.ptr(), CURLOPT_WRITEDATA, nullptr);
+	curl_easy_setopt(easyhandle.ptr(), CURLOPT_WRITEFUNCTION, nullptr);
+	if (custom_headers) {
+		curl_easy_setopt(easyhandle.ptr(), CURLOPT_HTTPHEADER, 0);
+		curl_slist_free_all(custom_headers);
+		custom_headers = nullptr;
+	}
 }
 
 Feed Parser::parse_buffer(const std::string& buffer, const std::string& url,
 	std::optional<std::string> charset)
 {
 	doc = nullptr;
-	if (charset.has_value()) {
+	if (charset.has_value() && charencoding::is_utf8(charset.value())
+		&& utils::is_valid_utf8(buffer)) {
+		LOG(Level::DEBUG, "Parser::parse_buffer: parse xml in utf-8 encoding (length: %zu)",
+			buffer.length());
+		doc = xmlReadMemory(buffer.c_str(),
+				buffer.length(),
+				url.c_str(),
+				"UTF-8",
+				XML_PARSE_RECOVER | XML_PARSE_NOERROR | XML_PARSE_NOWARNING | XML_PARSE_IGNORE_ENC);
+	} else if (charset.has_value()) {
 		LOG(Level::DEBUG, "Parser::parse_buffer: convert from %s to utf-8", charset.value());
 		const auto buffer_utf8 = utils::convert_text(buffer, "utf-8", charset.value());
 		LOG(Level::DEBUG, "Parser::parse_buffer: parse xml in utf-8 encoding (length: %zu)",
@@ -319,67 +431,7 @@ Feed Parser::parse_xmlnode(xmlNode* node)
 
 	if (node) {
 		if (node->name && node->type == XML_ELEMENT_NODE) {
-			if (strcmp((const char*)node->name, "rss") == 0) {
-				const char* version = (const char*)xmlGetProp(
-						node, (const xmlChar*)"version");
-				if (!version) {
-					xmlFree((void*)version);
-					throw Exception(_("no RSS version"));
-				}
-				if (strcmp(version, "0.91") == 0) {
-					f.rss_version = Feed::RSS_0_91;
-				} else if (strcmp(version, "0.92") == 0) {
-					f.rss_version = Feed::RSS_0_92;
-				} else if (strcmp(version, "0.94") == 0) {
-					f.rss_version = Feed::RSS_0_94;
-				} else if (strcmp(version, "2.0") == 0 ||
-					strcmp(version, "2") == 0) {
-					f.rss_version = Feed::RSS_2_0;
-				} else if (strcmp(version, "1.0") == 0) {
-					f.rss_version = Feed::RSS_0_91;
-				} else {
-					xmlFree((void*)version);
-					throw Exception(
-						_("invalid RSS version"));
-				}
-				xmlFree((void*)version);
-			} else if (strcmp((const char*)node->name, "RDF") ==
-				0) {
-				f.rss_version = Feed::RSS_1_0;
-			} else if (strcmp((const char*)node->name, "feed") ==
-				0) {
-				if (node->ns && node->ns->href) {
-					if (strcmp((const char*)node->ns->href,
-							ATOM_0_3_URI) == 0) {
-						f.rss_version = Feed::ATOM_0_3;
-					} else if (strcmp((const char*)node->ns
-							->href,
-							ATOM_1_0_URI) == 0) {
-						f.rss_version = Feed::ATOM_1_0;
-					} else {
-						const char* version = (const char*)xmlGetProp(node, (const xmlChar*)"version");
-						if (!version) {
-							xmlFree((void*)version);
-							throw Exception(_(
-									"invalid Atom "
-									"version"));
-						}
-						if (strcmp(version, "0.3") ==
-							0) {
-							xmlFree((void*)version);
-							f.rss_version =
-								Feed::ATOM_0_3_NONS;
-						} else {
-							xmlFree((void*)version);
-							throw Exception(_(
-									"invalid Atom "
-									"version"));
-						}
-					}
-				} else {
-					throw Exception(_("no Atom version"));
-				}
-			}
+			f.rss_version = RssParserFactory::get_version(node);
 
 			std::shared_ptr<RssParser> parser =
 				RssParserFactory::get_object(f.rss_version, doc);
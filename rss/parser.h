@@ -3,6 +3,7 @@
 
 #include <curl/curl.h>
 #include <libxml/parser.h>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -15,11 +16,14 @@
 namespace newsboat {
 
 class CurlHandle;
+class CurlHeaderContainer;
 
 }
 
 namespace rsspp {
 
+class FeedStream;
+
 class Parser {
 public:
 	enum class ErrorType {
@@ -44,6 +48,30 @@ public:
 		const std::string& etag = "",
 		newsboat::RemoteApi* api = 0,
 		const std::string& cookie_cache = "");
+
+	/// \brief Configures \a easyhandle for downloading \a url, without
+	/// performing the transfer.
+	///
+	/// This is the first half of parse_url(), for callers which drive the
+	/// transfer themselves (e.g. through curl_multi). Once the transfer on
+	/// \a easyhandle has finished, finish_url() has to be called with the
+	/// same handle and the result of the transfer.
+	void prepare_url(const std::string& url,
+		newsboat::CurlHandle& easyhandle,
+		time_t lastmodified = 0,
+		const std::string& etag = "",
+		newsboat::RemoteApi* api = 0,
+		const std::string& cookie_cache = "");
+
+	/// \brief Processes the response of a transfer set up by prepare_url().
+	///
+	/// \a ret is the result of the transfer as reported by curl. The body
+	/// is parsed while it's being received, so all that's left to do here
+	/// is to check for errors and parse the last bits.
+	nonstd::expected<Feed, Error> finish_url(const std::string& url,
+		newsboat::CurlHandle& easyhandle,
+		CURLcode ret);
+
 	Feed parse_buffer(const std::string& buffer,
 		const std::string& url = "", std::optional<std::string> charset = std::nullopt);
 	Feed parse_file(const newsboat::Filepath& filename);
@@ -55,12 +83,28 @@ public:
 	{
 		return et;
 	}
+	/// \brief Returns the time before which the server asked not to be
+	/// contacted again, or 0 if it didn't.
+	///
+	/// Taken from the Retry-After, Cache-Control (max-age) and Expires
+	/// headers of the last response to parse_url() or finish_url(), whether
+	/// it succeeded or not.
+	time_t get_not_before()
+	{
+		return nb;
+	}
 
 	static void global_init();
 	static void global_cleanup();
 
 private:
 	Feed parse_xmlnode(xmlNode* node);
+	void release_request_state(newsboat::CurlHandle& easyhandle);
+	std::optional<std::string> charset_from_headers() const;
+	time_t not_before_from_headers() const;
+	static size_t write_callback(char* data, size_t size, size_t nmemb,
+		void* parser);
+
 	unsigned int to;
 	const std::string ua;
 	const std::string prx;
@@ -70,6 +114,11 @@ private:
 	xmlDocPtr doc;
 	time_t lm;
 	std::string et;
+	time_t nb;
+	curl_slist* custom_headers;
+	std::unique_ptr<newsboat::CurlHeaderContainer> header_handler;
+	std::string request_url;
+	std::unique_ptr<FeedStream> stream;
 };
 
 } // namespace rsspp
@@ -21,14 +21,10 @@ void Rss09xParser::parse_feed(Feed& f, xmlNode* rootNode)
 		throw Exception(_("XML root node is NULL"));
 	}
 
-	globalbase = get_prop(rootNode, "base", XML_URI);
+	parse_root(f, rootNode);
 
-	xmlNode* channel = rootNode->children;
-	while (channel && channel->name && strcmp((const char*)channel->name, "channel") != 0) {
-		channel = channel->next;
-	}
-
-	if (!channel || !channel->name) {
+	xmlNode* channel = find_channel(rootNode);
+	if (!channel) {
 		throw Exception(_("no RSS channel found"));
 	}
 
@@ -52,6 +48,34 @@ void Rss09xParser::parse_feed(Feed& f, xmlNode* rootNode)
 	}
 }
 
+void Rss09xParser::parse_root(Feed& /* f */, xmlNode* rootNode)
+{
+	globalbase = get_prop(rootNode, "base", XML_URI);
+}
+
+bool Rss09xParser::is_item(xmlNode* node)
+{
+	return node_is(node, "item", ns) && node->parent != nullptr
+		&& node->parent == find_channel(xmlDocGetRootElement(doc));
+}
+
+xmlNode* Rss09xParser::find_channel(xmlNode* rootNode)
+{
+	if (!rootNode) {
+		return nullptr;
+	}
+
+	xmlNode* channel = rootNode->children;
+	while (channel && channel->name && strcmp((const char*)channel->name, "channel") != 0) {
+		channel = channel->next;
+	}
+
+	if (!channel || !channel->name) {
+		return nullptr;
+	}
+	return channel;
+}
+
 Item Rss09xParser::parse_item(xmlNode* itemNode)
 {
 	Item it;
@@ -12,6 +12,9 @@ class Item;
 
 struct Rss09xParser : public RssParser {
 	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_root(Feed& f, xmlNode* rootNode) override;
+	bool is_item(xmlNode* node) override;
+	Item parse_item(xmlNode* itemNode) override;
 	explicit Rss09xParser(xmlDocPtr doc)
 		: RssParser(doc)
 		, ns(nullptr)
@@ -23,7 +26,7 @@ protected:
 	const char* ns;
 
 private:
-	Item parse_item(xmlNode* itemNode);
+	static xmlNode* find_channel(xmlNode* rootNode);
 };
 
 } // namespace rsspp
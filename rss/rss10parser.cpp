@@ -40,42 +40,58 @@ void Rss10Parser::parse_feed(Feed& f, xmlNode* rootNode)
 				}
 			}
 		} else if (node_is(node, "item", RSS_1_0_NS)) {
-			Item it;
-			it.guid = get_prop(node, "about", RDF_URI);
-			for (xmlNode* itnode = node->children;
-				itnode != nullptr;
-				itnode = itnode->next) {
-				if (node_is(itnode, "title", RSS_1_0_NS)) {
-					it.title = get_content(itnode);
-					it.title_type = "text";
-				} else if (node_is(itnode,
-						"link",
-						RSS_1_0_NS)) {
-					it.link = get_content(itnode);
-				} else if (node_is(itnode,
-						"description",
-						RSS_1_0_NS)) {
-					it.description = get_content(itnode);
-					it.description_mime_type = "";
-				} else if (node_is(itnode, "date", DC_URI)) {
-					it.pubDate = w3cdtf_to_rfc822(
-							get_content(itnode));
-				} else if (node_is(itnode,
-						"encoded",
-						CONTENT_URI)) {
-					it.content_encoded =
-						get_content(itnode);
-				} else if (node_is(itnode,
-						"summary",
-						ITUNES_URI)) {
-					it.itunes_summary = get_content(itnode);
-				} else if (node_is(itnode, "creator", DC_URI)) {
-					it.author = get_content(itnode);
-				}
-			}
-			f.items.push_back(it);
+			f.items.push_back(parse_item(node));
 		}
 	}
 }
 
+void Rss10Parser::parse_root(Feed& /* f */, xmlNode* /* rootNode */)
+{
+}
+
+bool Rss10Parser::is_item(xmlNode* node)
+{
+	return node_is(node, "item", RSS_1_0_NS) && node->parent != nullptr
+		&& node->parent == xmlDocGetRootElement(doc);
+}
+
+Item Rss10Parser::parse_item(xmlNode* itemNode)
+{
+	Item it;
+	it.guid = get_prop(itemNode, "about", RDF_URI);
+	for (xmlNode* itnode = itemNode->children;
+		itnode != nullptr;
+		itnode = itnode->next) {
+		if (node_is(itnode, "title", RSS_1_0_NS)) {
+			it.title = get_content(itnode);
+			it.title_type = "text";
+		} else if (node_is(itnode,
+				"link",
+				RSS_1_0_NS)) {
+			it.link = get_content(itnode);
+		} else if (node_is(itnode,
+				"description",
+				RSS_1_0_NS)) {
+			it.description = get_content(itnode);
+			it.description_mime_type = "";
+		} else if (node_is(itnode, "date", DC_URI)) {
+			it.pubDate = w3cdtf_to_rfc822(
+					get_content(itnode));
+		} else if (node_is(itnode,
+				"encoded",
+				CONTENT_URI)) {
+			it.content_encoded =
+				get_content(itnode);
+		} else if (node_is(itnode,
+				"summary",
+				ITUNES_URI)) {
+			it.itunes_summary = get_content(itnode);
+		} else if (node_is(itnode, "creator", DC_URI)) {
+			it.author = get_content(itnode);
+		}
+	}
+
+	return it;
+}
+
 } // namespace rsspp
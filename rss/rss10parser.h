@@ -8,9 +8,13 @@
 namespace rsspp {
 
 class Feed;
+class Item;
 
 struct Rss10Parser : public RssParser {
 	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_root(Feed& f, xmlNode* rootNode) override;
+	bool is_item(xmlNode* node) override;
+	Item parse_item(xmlNode* itemNode) override;
 	explicit Rss10Parser(xmlDocPtr doc)
 		: RssParser(doc)
 	{
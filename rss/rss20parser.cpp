@@ -17,14 +17,20 @@ void Rss20Parser::parse_feed(Feed& f, xmlNode* rootNode)
 		throw Exception(_("XML root node is NULL"));
 	}
 
+	Rss09xParser::parse_feed(f, rootNode);
+}
+
+void Rss20Parser::parse_root(Feed& f, xmlNode* rootNode)
+{
 	if (rootNode->ns) {
 		const char* ns = (const char*)rootNode->ns->href;
 		if (strcmp(ns, RSS20USERLAND_URI) == 0) {
+			free((void*)this->ns);
 			this->ns = strdup(ns);
 		}
 	}
 
-	Rss09xParser::parse_feed(f, rootNode);
+	Rss09xParser::parse_root(f, rootNode);
 }
 
 } // namespace rsspp
@@ -15,6 +15,7 @@ struct Rss20Parser : public Rss09xParser {
 	{
 	}
 	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_root(Feed& f, xmlNode* rootNode) override;
 	~Rss20Parser() override {}
 };
 
@@ -7,9 +7,23 @@
 namespace rsspp {
 
 class Feed;
+class Item;
 
 struct RssParser {
 	virtual void parse_feed(Feed& f, xmlNode* rootNode) = 0;
+
+	/// \brief Reads what applies to all articles (e.g. the base URL) from
+	/// the root element.
+	///
+	/// parse_feed() does this itself. FeedStream calls it as soon as the
+	/// root element is read, before handing articles to parse_item().
+	virtual void parse_root(Feed& f, xmlNode* rootNode) = 0;
+
+	/// Returns true if \a node is an article that parse_feed() would pass
+	/// to parse_item().
+	virtual bool is_item(xmlNode* node) = 0;
+	virtual Item parse_item(xmlNode* itemNode) = 0;
+
 	explicit RssParser(xmlDocPtr d)
 		: doc(d)
 	{
@@ -1,14 +1,89 @@
 #include "rssparserfactory.h"
 
+#include <cstring>
+
 #include "atomparser.h"
 #include "config.h"
 #include "exception.h"
 #include "rss09xparser.h"
 #include "rss10parser.h"
 #include "rss20parser.h"
+#include "rsspp_uris.h"
 
 namespace rsspp {
 
+Feed::Version RssParserFactory::get_version(xmlNode* node)
+{
+	Feed::Version result = Feed::UNKNOWN;
+	if (!node || !node->name || node->type != XML_ELEMENT_NODE) {
+		return result;
+	}
+
+	if (strcmp((const char*)node->name, "rss") == 0) {
+		const char* version = (const char*)xmlGetProp(
+				node, (const xmlChar*)"version");
+		if (!version) {
+			xmlFree((void*)version);
+			throw Exception(_("no RSS version"));
+		}
+		if (strcmp(version, "0.91") == 0) {
+			result = Feed::RSS_0_91;
+		} else if (strcmp(version, "0.92") == 0) {
+			result = Feed::RSS_0_92;
+		} else if (strcmp(version, "0.94") == 0) {
+			result = Feed::RSS_0_94;
+		} else if (strcmp(version, "2.0") == 0 ||
+			strcmp(version, "2") == 0) {
+			result = Feed::RSS_2_0;
+		} else if (strcmp(version, "1.0") == 0) {
+			result = Feed::RSS_0_91;
+		} else {
+			xmlFree((void*)version);
+			throw Exception(
+				_("invalid RSS version"));
+		}
+		xmlFree((void*)version);
+	} else if (strcmp((const char*)node->name, "RDF") ==
+		0) {
+		result = Feed::RSS_1_0;
+	} else if (strcmp((const char*)node->name, "feed") ==
+		0) {
+		if (node->ns && node->ns->href) {
+			if (strcmp((const char*)node->ns->href,
+					ATOM_0_3_URI) == 0) {
+				result = Feed::ATOM_0_3;
+			} else if (strcmp((const char*)node->ns
+					->href,
+					ATOM_1_0_URI) == 0) {
+				result = Feed::ATOM_1_0;
+			} else {
+				const char* version = (const char*)xmlGetProp(node, (const xmlChar*)"version");
+				if (!version) {
+					xmlFree((void*)version);
+					throw Exception(_(
+							"invalid Atom "
+							"version"));
+				}
+				if (strcmp(version, "0.3") ==
+					0) {
+					xmlFree((void*)version);
+					result =
+						Feed::ATOM_0_3_NONS;
+				} else {
+					xmlFree((void*)version);
+					throw Exception(_(
+							"invalid Atom "
+							"version"));
+				}
+			}
+		} else {
+			throw Exception(_("no Atom version"));
+		}
+	}
+
+	return result;
+}
+
 std::shared_ptr<RssParser> RssParserFactory::get_object(
 	Feed::Version rss_version,
 	xmlDocPtr doc)
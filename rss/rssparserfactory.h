@@ -10,6 +10,12 @@
 namespace rsspp {
 
 struct RssParserFactory {
+	/// \brief Determines the format of a feed from its root element.
+	///
+	/// Returns Feed::UNKNOWN if the element doesn't start any known format,
+	/// and throws rsspp::Exception if it does but the version is missing or
+	/// invalid.
+	static Feed::Version get_version(xmlNode* rootNode);
 	static std::shared_ptr<RssParser> get_object(Feed::Version rss_version,
 		xmlDocPtr doc);
 };
@@ -1,5 +1,6 @@
 use httpmock::{Method::GET, Mock, MockServer};
 use std::io::{Read, stdin};
+use std::time::Duration;
 
 fn main() {
     let server = MockServer::start();
@@ -66,12 +67,15 @@ fn add_endpoint(server: &MockServer) {
         .read_to_end(&mut body)
         .unwrap();
 
+    let delay_ms: u64 = read_line().parse().unwrap();
+
     eprintln!("---------------------------------");
     eprintln!("Adding endpoint {path}");
     eprintln!("Expected Headers: {expected_headers:?}");
     eprintln!("Status: {status}");
     eprintln!("Response headers: {response_headers:?}");
     eprintln!("Body size: {body_size} bytes");
+    eprintln!("Delay: {delay_ms} ms");
     eprintln!("---------------------------------");
 
     let mock = server.mock(|when, then| {
@@ -84,7 +88,7 @@ fn add_endpoint(server: &MockServer) {
         for header in response_headers {
             then = then.header(header.0, header.1)
         }
-        then.body(body);
+        then.body(body).delay(Duration::from_millis(delay_ms));
     });
 
     println!("{}", mock.id);
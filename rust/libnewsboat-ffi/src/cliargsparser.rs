@@ -45,6 +45,7 @@ mod bridged {
         fn using_nonstandard_configs(cliargsparser: &CliArgsParser) -> bool;
         fn should_print_usage(cliargsparser: &CliArgsParser) -> bool;
         fn refresh_on_start(cliargsparser: &CliArgsParser) -> bool;
+        fn daemon(cliargsparser: &CliArgsParser) -> bool;
 
         fn importfile(cliargsparser: &CliArgsParser, mut file: Pin<&mut PathBuf>);
         fn program_name(cliargsparser: &CliArgsParser) -> String;
@@ -65,6 +66,7 @@ mod bridged {
         fn cmdline_history_file(cliargsparser: &CliArgsParser, mut path: Pin<&mut PathBuf>)
         -> bool;
         fn log_file(cliargsparser: &CliArgsParser, mut path: Pin<&mut PathBuf>) -> bool;
+        fn trace_file(cliargsparser: &CliArgsParser, mut path: Pin<&mut PathBuf>) -> bool;
 
         fn cmds_to_execute(cliargsparser: &CliArgsParser) -> Vec<String>;
 
@@ -122,6 +124,10 @@ fn refresh_on_start(cliargsparser: &CliArgsParser) -> bool {
     cliargsparser.0.refresh_on_start
 }
 
+fn daemon(cliargsparser: &CliArgsParser) -> bool {
+    cliargsparser.0.daemon
+}
+
 fn importfile(cliargsparser: &CliArgsParser, mut output: Pin<&mut PathBuf>) {
     match &cliargsparser.0.importfile {
         Some(path) => output.0 = path.to_owned(),
@@ -247,6 +253,16 @@ fn log_file(cliargsparser: &CliArgsParser, mut path: Pin<&mut PathBuf>) -> bool
     }
 }
 
+fn trace_file(cliargsparser: &CliArgsParser, mut path: Pin<&mut PathBuf>) -> bool {
+    match &cliargsparser.0.trace_file {
+        Some(p) => {
+            path.0 = p.to_owned();
+            true
+        }
+        None => false,
+    }
+}
+
 fn cmds_to_execute(cliargsparser: &CliArgsParser) -> Vec<String> {
     cliargsparser.0.cmds_to_execute.to_owned()
 }
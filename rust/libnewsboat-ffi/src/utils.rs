@@ -96,6 +96,7 @@ mod bridged {
         fn locale_to_utf8(text: &[u8]) -> String;
         fn convert_text(text: &[u8], tocode: &str, fromcode: &str) -> Vec<u8>;
         fn string_from_utf8_lossy(text: &[u8]) -> String;
+        fn is_valid_utf8(text: &[u8]) -> bool;
         fn parse_rss_author_email(text: &[u8], name: &mut String, email: &mut String);
     }
 }
@@ -248,6 +249,10 @@ fn string_from_utf8_lossy(text: &[u8]) -> String {
     String::from_utf8_lossy(text).to_string()
 }
 
+fn is_valid_utf8(text: &[u8]) -> bool {
+    std::str::from_utf8(text).is_ok()
+}
+
 fn parse_rss_author_email(text: &[u8], name: &mut String, email: &mut String) {
     (*name, *email) = utils::parse_rss_author_email(text);
 }
@@ -48,6 +48,10 @@ pub struct CliArgsParser {
 
     pub refresh_on_start: bool,
 
+    /// If `true`, Newsboat should keep running in the background and serve commands sent by
+    /// `--execute` through a Unix domain socket.
+    pub daemon: bool,
+
     /// If this contains some value, it's the path to the url file specified by the user.
     pub url_file: Option<PathBuf>,
 
@@ -81,6 +85,10 @@ pub struct CliArgsParser {
 
     /// If this contains some value, it's the log level specified by the user.
     pub log_level: Option<Level>,
+
+    /// If this contains some value, it's the path to which a trace of timed scopes should be
+    /// written when Newsboat exits.
+    pub trace_file: Option<PathBuf>,
 }
 
 /// Returns new path with an added extension
@@ -202,6 +210,10 @@ pub fn parse_cliargs(opts: Vec<OsString>, args: &mut CliArgsParser) -> Result<()
             }
             Short('X') | Long("vacuum") => args.do_vacuum = true,
             Long("cleanup") => args.do_cleanup = true,
+            Long("daemon") => {
+                args.daemon = true;
+                args.silent = true;
+            }
             Short('v') | Long("version") | Short('V') | Long("-V") => args.show_version += 1,
             Short('x') | Long("execute") => {
                 for cmd in parser.values()? {
@@ -225,6 +237,10 @@ pub fn parse_cliargs(opts: Vec<OsString>, args: &mut CliArgsParser) -> Result<()
                 let log_file = parser.value()?;
                 args.log_file = resolve_path(&log_file);
             }
+            Long("trace-file") => {
+                let trace_file = parser.value()?;
+                args.trace_file = resolve_path(&trace_file);
+            }
             Short('l') | Long("log-level") => {
                 let log_level_str = parser.value()?;
                 match Level::try_from(log_level_str.as_ref()) {
@@ -252,6 +268,10 @@ pub fn parse_cliargs(opts: Vec<OsString>, args: &mut CliArgsParser) -> Result<()
         return Err(CliParseError::PrintAndExit);
     }
 
+    if args.daemon && (args.do_export || !args.cmds_to_execute.is_empty()) {
+        return Err(CliParseError::PrintAndExit);
+    }
+
     Ok(())
 }
 
@@ -633,6 +653,33 @@ mod tests {
         check(vec!["newsboat".into(), "--cleanup".into()]);
     }
 
+    #[test]
+    fn t_sets_daemon_and_silent_if_dash_dash_daemon_is_provided() {
+        let args = CliArgsParser::new(vec!["newsboat".into(), "--daemon".into()]);
+
+        assert!(args.daemon);
+        assert!(args.silent);
+        assert_eq!(args.return_code, None);
+    }
+
+    #[test]
+    fn t_asks_to_print_usage_and_exit_with_failure_if_dash_dash_daemon_is_combined_with_x_or_e() {
+        let check = |opts| {
+            let args = CliArgsParser::new(opts);
+
+            assert!(args.should_print_usage);
+            assert_eq!(args.return_code, Some(EXIT_FAILURE));
+        };
+
+        check(vec![
+            "newsboat".into(),
+            "--daemon".into(),
+            "-x".into(),
+            "reload".into(),
+        ]);
+        check(vec!["newsboat".into(), "-e".into(), "--daemon".into()]);
+    }
+
     #[test]
     fn t_increases_show_version_with_each_dash_v_provided() {
         let check = |opts, expected_version| {
@@ -808,6 +855,27 @@ mod tests {
         ]);
     }
 
+    #[test]
+    fn t_sets_trace_file_if_dash_dash_trace_file_is_provided() {
+        let filename = "trace file.json";
+
+        let check = |opts| {
+            let args = CliArgsParser::new(opts);
+
+            assert_eq!(args.trace_file, Some(PathBuf::from(filename)));
+        };
+
+        check(vec![
+            "newsboat".into(),
+            "--trace-file".into(),
+            filename.into(),
+        ]);
+        check(vec![
+            "newsboat".into(),
+            format!("--trace-file={filename}").into(),
+        ]);
+    }
+
     #[test]
     fn t_sets_set_log_level_and_log_level_if_argument_to_dash_l_is_1_to_6() {
         let check = |opts, expected_level| {
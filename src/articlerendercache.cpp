@@ -0,0 +1,283 @@
+#include "articlerendercache.h"
+
+#include <exception>
+#include <functional>
+#include <tuple>
+
+#include "configcontainer.h"
+#include "itemrenderer.h"
+#include "logger.h"
+#include "regexmanager.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+#include "scopemeasure.h"
+#include "strprintf.h"
+#include "utils.h"
+
+namespace newsboat {
+
+ArticleRenderCache::ArticleRenderCache(std::size_t capacity)
+	: capacity(capacity)
+	, rendering(false)
+	, stopping(false)
+{
+}
+
+ArticleRenderCache::~ArticleRenderCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+		jobs.clear();
+	}
+	cv.notify_all();
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+std::shared_ptr<const ArticleRenderCache::Rendered> ArticleRenderCache::get(
+	ConfigContainer& cfg,
+	RssItem& item,
+	unsigned int text_width,
+	unsigned int window_width,
+	RegexManager& rxman)
+{
+	const std::string key = key_of(cfg, item, text_width, window_width, rxman);
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		const auto cached = find(key);
+		if (cached != nullptr) {
+			LOG(Level::DEBUG, "ArticleRenderCache::get: %s is cached", item.guid());
+			return cached;
+		}
+	}
+
+	auto rendered = render(cfg, item, text_width, window_width, rxman);
+	std::lock_guard<std::mutex> lock(mtx);
+	insert(key, rendered);
+	return rendered;
+}
+
+void ArticleRenderCache::prerender(ConfigContainer& cfg,
+	const std::vector<std::shared_ptr<RssItem>>& items,
+	unsigned int text_width,
+	unsigned int window_width,
+	const RegexManager& rxman)
+{
+	// The articles and rules can change on the calling thread while the
+	// worker is rendering, so it gets its own copies of them
+	const auto rules = std::make_shared<RegexManager>(rxman);
+	std::vector<Job> copies;
+	for (const auto& item : items) {
+		if (item != nullptr) {
+			Job job = snapshot(cfg, *item);
+			job.text_width = text_width;
+			job.window_width = window_width;
+			job.rxman = rules;
+			copies.push_back(std::move(job));
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		jobs.assign(copies.begin(), copies.end());
+		if (!worker.joinable() && !jobs.empty()) {
+			worker = std::thread(&ArticleRenderCache::run, this);
+		}
+	}
+	cv.notify_all();
+}
+
+void ArticleRenderCache::wait_for_prerender()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	cv.wait(lock, [this]() {
+		return jobs.empty() && !rendering;
+	});
+}
+
+std::size_t ArticleRenderCache::size() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return entries.size();
+}
+
+ArticleRenderCache::Job ArticleRenderCache::snapshot(ConfigContainer& cfg,
+	RssItem& item)
+{
+	Job job{&cfg, std::make_shared<RssItem>(nullptr), nullptr, 0, 0, nullptr};
+	RssItem& copy = *job.item;
+	copy.set_guid(item.guid());
+	copy.set_title(item.title());
+	copy.set_author(item.author());
+	copy.set_link(item.link());
+	copy.set_pubDate(item.pubDate_timestamp());
+	copy.set_flags(item.flags());
+	copy.set_base(item.get_base());
+	copy.set_feedurl(item.feedurl());
+	copy.set_enclosure_url(item.enclosure_url());
+	copy.set_enclosure_type(item.enclosure_type());
+	copy.set_enclosure_description(item.enclosure_description());
+	copy.set_enclosure_description_mime_type(
+		item.enclosure_description_mime_type());
+	const auto description = item.description();
+	copy.set_description(description.text, description.mime);
+
+	// The title is all that's shown of the feed. It's set through a "~" tag
+	// because that's taken as is, while set_title() would convert it to the
+	// locale's charset a second time.
+	job.feed = std::make_shared<RssFeed>(nullptr, "");
+	job.feed->set_tags({"~" + item_renderer::get_feedtitle(item)});
+	copy.set_feedptr(job.feed);
+
+	return job;
+}
+
+std::string ArticleRenderCache::key_of(ConfigContainer& cfg,
+	RssItem& item,
+	unsigned int text_width,
+	unsigned int window_width,
+	const RegexManager& rxman)
+{
+	// Everything item_renderer::to_stfl_list() shows
+	const auto description = item.description();
+	const std::string content[] = {
+		description.text,
+		description.mime,
+		item_renderer::get_feedtitle(item),
+		item.title(),
+		item.author(),
+		item.pubDate(),
+		item.link(),
+		item.flags(),
+		item.get_base(),
+		item.feedurl(),
+		item.enclosure_url(),
+		item.enclosure_type(),
+		item.enclosure_description(),
+	};
+	std::size_t content_hash = 0;
+	for (const auto& part : content) {
+		// Same mixing as boost::hash_combine
+		content_hash ^= std::hash<std::string>()(part) + 0x9e3779b9
+			+ (content_hash << 6) + (content_hash >> 2);
+	}
+
+	return strprintf::fmt("%s\n%zx\n%u\n%u\n%u\n%s",
+			item.guid(),
+			content_hash,
+			text_width,
+			window_width,
+			rxman.version(),
+			cfg.get_configvalue("html-renderer"));
+}
+
+std::shared_ptr<const ArticleRenderCache::Rendered> ArticleRenderCache::render(
+	ConfigContainer& cfg,
+	RssItem& item,
+	unsigned int text_width,
+	unsigned int window_width,
+	RegexManager& rxman)
+{
+	ScopeMeasure sm("ArticleRenderCache::render", item.feedurl());
+
+	auto rendered = std::make_shared<Rendered>();
+
+	// The podcast, if any, is the article's first link
+	if (!item.enclosure_url().empty()) {
+		const auto link_type = utils::podcast_mime_to_link_type(item.enclosure_type());
+		if (link_type.has_value()) {
+			rendered->links.add_link(item.enclosure_url(), link_type.value());
+		}
+	}
+
+	std::tie(rendered->text, rendered->num_lines) =
+		item_renderer::to_stfl_list(
+			cfg,
+			item,
+			text_width,
+			window_width,
+			&rxman,
+			Dialog::Article,
+			rendered->links);
+
+	return rendered;
+}
+
+std::shared_ptr<const ArticleRenderCache::Rendered> ArticleRenderCache::find(
+	const std::string& key)
+{
+	const auto it = index.find(key);
+	if (it == index.end()) {
+		return nullptr;
+	}
+	entries.splice(entries.begin(), entries, it->second);
+	return it->second->second;
+}
+
+void ArticleRenderCache::insert(const std::string& key,
+	std::shared_ptr<const Rendered> rendered)
+{
+	const auto it = index.find(key);
+	if (it != index.end()) {
+		entries.erase(it->second);
+		index.erase(it);
+	}
+
+	entries.emplace_front(key, std::move(rendered));
+	index[key] = entries.begin();
+
+	while (entries.size() > capacity) {
+		index.erase(entries.back().first);
+		entries.pop_back();
+	}
+}
+
+void ArticleRenderCache::run()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (true) {
+		cv.wait(lock, [this]() {
+			return stopping || !jobs.empty();
+		});
+		if (stopping) {
+			return;
+		}
+
+		const Job job = std::move(jobs.front());
+		jobs.pop_front();
+		rendering = true;
+		lock.unlock();
+
+		try {
+			const std::string key = key_of(*job.cfg, *job.item, job.text_width,
+					job.window_width, *job.rxman);
+			bool cached = false;
+			{
+				std::lock_guard<std::mutex> guard(mtx);
+				cached = (find(key) != nullptr);
+			}
+			if (!cached) {
+				LOG(Level::DEBUG,
+					"ArticleRenderCache::run: pre-rendering %s",
+					job.item->guid());
+				auto rendered = render(*job.cfg, *job.item, job.text_width,
+						job.window_width, *job.rxman);
+				std::lock_guard<std::mutex> guard(mtx);
+				insert(key, std::move(rendered));
+			}
+		} catch (const std::exception& e) {
+			LOG(Level::ERROR,
+				"ArticleRenderCache::run: couldn't render %s: %s",
+				job.item->guid(),
+				e.what());
+		}
+
+		lock.lock();
+		rendering = false;
+		cv.notify_all();
+	}
+}
+
+} // namespace newsboat
@@ -1,5 +1,6 @@
 #include "cache.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cstring>
@@ -10,6 +11,7 @@
 
 #include "configcontainer.h"
 #include "dbexception.h"
+#include "feedloadexception.h"
 #include "logger.h"
 #include "matcherexception.h"
 #include "rssfeed.h"
@@ -51,6 +53,86 @@ void Cache::run_sql_nothrow(const std::string& query,
 	run_sql_impl(query, callback, callback_argument, false);
 }
 
+sqlite3_stmt* Cache::get_statement(const std::string& sql)
+{
+	auto it = statements.find(sql);
+	if (it != statements.end()) {
+		sqlite3_reset(it->second);
+		sqlite3_clear_bindings(it->second);
+		return it->second;
+	}
+
+	LOG(Level::DEBUG, "Cache::get_statement: preparing %s", sql);
+	sqlite3_stmt* stmt{};
+	const int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+	if (rc != SQLITE_OK) {
+		LOG(Level::CRITICAL,
+			"preparing statement \"%s\" failed: (%d) %s",
+			sql,
+			rc,
+			sqlite3_errstr(rc));
+		sqlite3_finalize(stmt);
+		throw DbException(db);
+	}
+	statements.emplace(sql, stmt);
+	return stmt;
+}
+
+void Cache::run_statement(sqlite3_stmt* stmt)
+{
+	const int rc = sqlite3_step(stmt);
+	sqlite3_reset(stmt);
+	if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+		LOG(Level::CRITICAL,
+			"statement \"%s\" failed: (%d) %s",
+			sqlite3_sql(stmt),
+			rc,
+			sqlite3_errstr(rc));
+		throw DbException(db);
+	}
+}
+
+static void bind_text(sqlite3_stmt* stmt, int index, const std::string& value)
+{
+	sqlite3_bind_text(stmt, index, value.c_str(), value.length(), SQLITE_TRANSIENT);
+}
+
+// Wraps statements into a single transaction, which is rolled back unless
+// commit() is called. Does nothing if a transaction is already in progress.
+class ScopeTransaction {
+public:
+	explicit ScopeTransaction(sqlite3* db)
+		: db(db)
+		, active(sqlite3_get_autocommit(db) != 0)
+	{
+		if (active && sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr,
+				nullptr) != SQLITE_OK) {
+			throw DbException(db);
+		}
+	}
+
+	~ScopeTransaction()
+	{
+		if (active) {
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		}
+	}
+
+	void commit()
+	{
+		if (active) {
+			active = false;
+			if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+				throw DbException(db);
+			}
+		}
+	}
+
+private:
+	sqlite3* db;
+	bool active;
+};
+
 struct CbHandler {
 	CbHandler()
 		: c(-1)
@@ -164,11 +246,8 @@ static int vectorofstring_callback(void* vp, int argc, char** argv,
 	return 0;
 }
 
-static int rssitem_callback(void* myfeed, int argc, char** argv,
-	char** /* azColName */)
+static std::shared_ptr<RssItem> rssitem_from_row(char** argv)
 {
-	auto feed = static_cast<RssFeed*>(myfeed);
-	assert(argc == 15);
 	auto item = std::make_shared<RssItem>(nullptr);
 	item->set_guid(argv[0]);
 	item->set_title(argv[1]);
@@ -192,8 +271,43 @@ static int rssitem_callback(void* myfeed, int argc, char** argv,
 	item->set_enqueued((std::string("1") == (argv[12] ? argv[12] : "")));
 	item->set_flags(argv[13] ? argv[13] : "");
 	item->set_base(argv[14] ? argv[14] : "");
+	return item;
+}
 
-	feed->add_item(item);
+static int rssitem_callback(void* myfeed, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto feed = static_cast<RssFeed*>(myfeed);
+	assert(argc == 15);
+	feed->add_item(rssitem_from_row(argv));
+	return 0;
+}
+
+using FeedsByUrl = std::unordered_map<std::string, RssFeed*>;
+
+static int bulk_rssfeed_callback(void* feeds, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto feeds_by_url = static_cast<FeedsByUrl*>(feeds);
+	assert(argc == 4);
+	assert(argv[0] != nullptr);
+	const auto it = feeds_by_url->find(argv[0]);
+	if (it != feeds_by_url->end()) {
+		rssfeed_callback(it->second, argc - 1, argv + 1, nullptr);
+	}
+	return 0;
+}
+
+static int bulk_rssitem_callback(void* feeds, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto feeds_by_url = static_cast<FeedsByUrl*>(feeds);
+	assert(argc == 15);
+	assert(argv[7] != nullptr);
+	const auto it = feeds_by_url->find(argv[7]);
+	if (it != feeds_by_url->end()) {
+		it->second->add_item(rssitem_from_row(argv));
+	}
 	return 0;
 }
 
@@ -269,6 +383,7 @@ Cache::Cache(const Filepath& cachefile, ConfigContainer& c)
 	}
 
 	populate_tables();
+	check_fulltext_index();
 	set_pragmas();
 
 	clean_old_articles();
@@ -298,6 +413,39 @@ void Cache::set_pragmas()
 	run_sql("PRAGMA case_sensitive_like=OFF;");
 }
 
+// Full-text index over articles' titles and contents. The trigram tokenizer
+// matches arbitrary substrings, just like the LIKE queries that were used for
+// searching before.
+static const std::string fulltext_index_table =
+	"CREATE VIRTUAL TABLE IF NOT EXISTS rss_item_fts USING fts5("
+	" title, content, content='rss_item', content_rowid='id', "
+	" tokenize='trigram');";
+
+static const std::string fulltext_index_triggers =
+	"CREATE TRIGGER IF NOT EXISTS rss_item_fts_insert AFTER INSERT ON rss_item "
+	"BEGIN "
+	" INSERT INTO rss_item_fts(rowid, title, content) "
+	" VALUES (new.id, new.title, new.content); "
+	"END; "
+
+	"CREATE TRIGGER IF NOT EXISTS rss_item_fts_delete AFTER DELETE ON rss_item "
+	"BEGIN "
+	" INSERT INTO rss_item_fts(rss_item_fts, rowid, title, content) "
+	" VALUES ('delete', old.id, old.title, old.content); "
+	"END; "
+
+	"CREATE TRIGGER IF NOT EXISTS rss_item_fts_update "
+	"AFTER UPDATE OF title, content ON rss_item "
+	"WHEN old.title != new.title OR old.content != new.content "
+	"BEGIN "
+	" INSERT INTO rss_item_fts(rss_item_fts, rowid, title, content) "
+	" VALUES ('delete', old.id, old.title, old.content); "
+	" INSERT INTO rss_item_fts(rowid, title, content) "
+	" VALUES (new.id, new.title, new.content); "
+	"END; "
+
+	"INSERT INTO rss_item_fts(rss_item_fts) VALUES ('rebuild');";
+
 static const schema_patches schemaPatches{
 	{	{2, 10},
 		{
@@ -395,6 +543,30 @@ static const schema_patches schemaPatches{
 			"ALTER TABLE rss_item ADD COLUMN enclosure_description_mime_type VARCHAR(128) NOT NULL DEFAULT \"\";",
 		}
 	},
+	{	{2, 45},
+		{
+			// Reload schedule, see ReloadScheduler
+			"ALTER TABLE rss_feed ADD COLUMN next_reload INTEGER NOT NULL DEFAULT 0;",
+			"ALTER TABLE rss_feed ADD COLUMN publish_interval INTEGER NOT NULL DEFAULT 0;",
+			"ALTER TABLE rss_feed ADD COLUMN unchanged_reloads INTEGER NOT NULL DEFAULT 0;",
+			"ALTER TABLE rss_feed ADD COLUMN not_before INTEGER NOT NULL DEFAULT 0;",
+
+			// Changes yet to be sent to remote APIs, see RemoteApiOutbox
+			"CREATE TABLE remote_outbox ( "
+			" api VARCHAR(32) NOT NULL, "
+			" guid VARCHAR(64) NOT NULL, "
+			" read INTEGER(1), "
+			" oldflags VARCHAR(52), "
+			" newflags VARCHAR(52), "
+			" version INTEGER NOT NULL DEFAULT 0, "
+			" attempts INTEGER NOT NULL DEFAULT 0, "
+			" not_before INTEGER NOT NULL DEFAULT 0, "
+			" PRIMARY KEY (api, guid));",
+
+			// Position of incremental fetches from remote APIs
+			"ALTER TABLE rss_feed ADD COLUMN sync_position VARCHAR(64) NOT NULL DEFAULT '';",
+		}
+	},
 
 	// Note: schema changes should use the version number of the release that introduced them.
 };
@@ -445,6 +617,113 @@ void Cache::populate_tables()
 	}
 }
 
+void Cache::check_fulltext_index()
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+
+	CbHandler table_cbh;
+	run_sql("SELECT count(*) FROM sqlite_master "
+		"WHERE type = 'table' AND name = 'rss_item_fts';",
+		count_callback,
+		&table_cbh);
+	if (table_cbh.count() == 0) {
+		return;
+	}
+
+	// The cache might have been created by an SQLite which supports FTS5,
+	// but opened by one that doesn't. The triggers would then break every
+	// change to rss_item, so we drop them; they're re-created, and the index
+	// rebuilt, by the next search with FTS5 support.
+	const int rc = sqlite3_exec(db, "SELECT rowid FROM rss_item_fts LIMIT 0;",
+			nullptr, nullptr, nullptr);
+	const bool usable = (rc == SQLITE_OK);
+	if (!usable) {
+		LOG(Level::ERROR,
+			"Cache::check_fulltext_index: full-text index is unusable: (%d) %s",
+			rc,
+			sqlite3_errmsg(db));
+	}
+
+	const bool enabled = cfg.get_configvalue_as_bool("search-index");
+	if (!usable || !enabled) {
+		run_sql("DROP TRIGGER IF EXISTS rss_item_fts_insert;");
+		run_sql("DROP TRIGGER IF EXISTS rss_item_fts_delete;");
+		run_sql("DROP TRIGGER IF EXISTS rss_item_fts_update;");
+	}
+	if (usable && !enabled) {
+		LOG(Level::INFO, "Cache::check_fulltext_index: removing full-text index");
+		run_sql("DROP TABLE rss_item_fts;");
+	}
+}
+
+bool Cache::prepare_fulltext_index()
+{
+	if (fulltext_index_prepared) {
+		return has_fulltext_index;
+	}
+	fulltext_index_prepared = true;
+
+	// Fails if SQLite is built without FTS5 or the trigram tokenizer, in
+	// which case search keeps using LIKE
+	run_sql_nothrow(fulltext_index_table);
+	const int rc = sqlite3_exec(db, "SELECT rowid FROM rss_item_fts LIMIT 0;",
+			nullptr, nullptr, nullptr);
+	if (rc != SQLITE_OK) {
+		LOG(Level::INFO,
+			"Cache::prepare_fulltext_index: no full-text index: (%d) %s",
+			rc,
+			sqlite3_errmsg(db));
+		return false;
+	}
+
+	CbHandler triggers_cbh;
+	run_sql("SELECT count(*) FROM sqlite_master "
+		"WHERE type = 'trigger' "
+		"AND name IN ('rss_item_fts_insert', 'rss_item_fts_delete', "
+		"'rss_item_fts_update');",
+		count_callback,
+		&triggers_cbh);
+	if (triggers_cbh.count() < 3) {
+		LOG(Level::INFO, "Cache::prepare_fulltext_index: building full-text index");
+		ScopeMeasure sm("Cache::prepare_fulltext_index");
+		run_sql(fulltext_index_triggers);
+	}
+
+	has_fulltext_index = true;
+	return true;
+}
+
+std::string Cache::search_condition(const std::string& querystr)
+{
+	// The trigram tokenizer can't match strings shorter than three
+	// characters
+	const auto length = std::count_if(querystr.cbegin(), querystr.cend(),
+	[](char c) {
+		return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+	});
+	if (length < 3 || !cfg.get_configvalue_as_bool("search-index")
+		|| !prepare_fulltext_index()) {
+		return prepare_query("(title LIKE '%%%q%%' OR content LIKE '%%%q%%')",
+				querystr,
+				querystr);
+	}
+
+	// Quoting turns the query into a single FTS5 string, which the trigram
+	// tokenizer matches as a substring
+	std::string phrase = "\"";
+	for (char c : querystr) {
+		if (c == '"') {
+			phrase.push_back('"');
+		}
+		phrase.push_back(c);
+	}
+	phrase.push_back('"');
+
+	return prepare_query(
+			"id IN (SELECT rowid FROM rss_item_fts WHERE rss_item_fts MATCH '%q')",
+			phrase);
+}
+
 void Cache::fetch_lastmodified(const std::string& feedurl,
 	time_t& t,
 	std::string& etag)
@@ -495,6 +774,278 @@ void Cache::update_lastmodified(const std::string& feedurl,
 	run_sql_nothrow(query);
 }
 
+static int reload_schedule_callback(void* handler, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto schedules =
+		static_cast<std::unordered_map<std::string, ReloadSchedule>*>(handler);
+	assert(argc == 5);
+	if (argv[0] == nullptr) {
+		return 0;
+	}
+	ReloadSchedule& schedule = (*schedules)[argv[0]];
+	schedule.next_reload = argv[1] ? std::stoll(argv[1]) : 0;
+	schedule.publish_interval = argv[2] ? std::stoll(argv[2]) : 0;
+	schedule.unchanged_reloads = argv[3] ? std::stoul(argv[3]) : 0;
+	schedule.not_before = argv[4] ? std::stoll(argv[4]) : 0;
+	return 0;
+}
+
+std::unordered_map<std::string, ReloadSchedule> Cache::fetch_reload_schedules()
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	std::unordered_map<std::string, ReloadSchedule> schedules;
+	run_sql("SELECT rssurl, next_reload, publish_interval, unchanged_reloads, "
+		"not_before FROM rss_feed;",
+		reload_schedule_callback,
+		&schedules);
+	return schedules;
+}
+
+ReloadSchedule Cache::fetch_reload_schedule(const std::string& feedurl)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	std::unordered_map<std::string, ReloadSchedule> schedules;
+	run_sql(prepare_query(
+			"SELECT rssurl, next_reload, publish_interval, unchanged_reloads, "
+			"not_before FROM rss_feed WHERE rssurl = '%q';",
+			feedurl),
+		reload_schedule_callback,
+		&schedules);
+	return schedules[feedurl];
+}
+
+void Cache::update_reload_schedule(const std::string& feedurl,
+	const ReloadSchedule& schedule)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	sqlite3_stmt* stmt = get_statement(
+			"UPDATE rss_feed "
+			"SET next_reload = ?1, publish_interval = ?2, unchanged_reloads = ?3 "
+			"WHERE rssurl = ?4;");
+	sqlite3_bind_int64(stmt, 1, schedule.next_reload);
+	sqlite3_bind_int64(stmt, 2, schedule.publish_interval);
+	sqlite3_bind_int64(stmt, 3, schedule.unchanged_reloads);
+	bind_text(stmt, 4, feedurl);
+	run_statement(stmt);
+}
+
+void Cache::update_reload_not_before(const std::string& feedurl, time_t t)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	run_sql(prepare_query("INSERT OR IGNORE INTO rss_feed (rssurl, url, title) VALUES ('%q', '', '')",
+			feedurl));
+
+	sqlite3_stmt* stmt = get_statement(
+			"UPDATE rss_feed SET not_before = ?1 WHERE rssurl = ?2;");
+	sqlite3_bind_int64(stmt, 1, t);
+	bind_text(stmt, 2, feedurl);
+	run_statement(stmt);
+}
+
+std::string Cache::fetch_sync_position(const std::string& feedurl)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	std::string position;
+	run_sql(prepare_query(
+			"SELECT sync_position FROM rss_feed WHERE rssurl = '%q';",
+			feedurl),
+		single_string_callback,
+		&position);
+	return position;
+}
+
+void Cache::update_sync_position(const std::string& feedurl,
+	const std::string& position)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	sqlite3_stmt* stmt = get_statement(
+			"UPDATE rss_feed SET sync_position = ?1 WHERE rssurl = ?2;");
+	bind_text(stmt, 1, position);
+	bind_text(stmt, 2, feedurl);
+	run_statement(stmt);
+}
+
+static int guid_unread_callback(void* handler, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto articles = static_cast<std::vector<std::pair<std::string, bool>>*>(handler);
+	assert(argc == 2);
+	if (argv[0] != nullptr) {
+		articles->emplace_back(argv[0], argv[1] && std::string(argv[1]) == "1");
+	}
+	return 0;
+}
+
+std::unordered_map<std::string, bool> Cache::sync_unread_state(
+	const std::string& feedurl,
+	const std::unordered_set<std::string>& unread_guids)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	ScopeTransaction transaction(db);
+
+	// Articles whose read state is yet to be sent to the API keep the state
+	// they have here
+	std::vector<std::pair<std::string, bool>> articles;
+	run_sql(prepare_query(
+			"SELECT guid, unread FROM rss_item "
+			"WHERE feedurl = '%q' AND deleted = 0 "
+			"AND guid NOT IN "
+			"(SELECT guid FROM remote_outbox WHERE read IS NOT NULL);",
+			feedurl),
+		guid_unread_callback,
+		&articles);
+
+	std::unordered_map<std::string, bool> changed;
+	for (const auto& article : articles) {
+		const bool is_unread = unread_guids.count(article.first) > 0;
+		if (is_unread == article.second) {
+			continue;
+		}
+		sqlite3_stmt* stmt = get_statement(
+				"UPDATE rss_item SET unread = ?1 WHERE guid = ?2;");
+		sqlite3_bind_int(stmt, 1, is_unread ? 1 : 0);
+		bind_text(stmt, 2, article.first);
+		run_statement(stmt);
+		changed[article.first] = is_unread;
+	}
+	transaction.commit();
+
+	LOG(Level::DEBUG,
+		"Cache::sync_unread_state: %zu of %zu articles of %s changed",
+		changed.size(),
+		articles.size(),
+		feedurl);
+	return changed;
+}
+
+void Cache::queue_remote_read_state(const std::string& api,
+	const std::vector<std::string>& guids,
+	bool read)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	ScopeTransaction transaction(db);
+	for (const auto& guid : guids) {
+		sqlite3_stmt* insert = get_statement(
+				"INSERT OR IGNORE INTO remote_outbox (api, guid) VALUES (?1, ?2);");
+		bind_text(insert, 1, api);
+		bind_text(insert, 2, guid);
+		run_statement(insert);
+
+		sqlite3_stmt* update = get_statement(
+				"UPDATE remote_outbox "
+				"SET read = ?3, version = version + 1, attempts = 0, not_before = 0 "
+				"WHERE api = ?1 AND guid = ?2;");
+		bind_text(update, 1, api);
+		bind_text(update, 2, guid);
+		sqlite3_bind_int(update, 3, read ? 1 : 0);
+		run_statement(update);
+	}
+	transaction.commit();
+}
+
+void Cache::queue_remote_flags(const std::string& api,
+	const std::string& guid,
+	const std::string& oldflags,
+	const std::string& newflags)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	ScopeTransaction transaction(db);
+	sqlite3_stmt* insert = get_statement(
+			"INSERT OR IGNORE INTO remote_outbox (api, guid) VALUES (?1, ?2);");
+	bind_text(insert, 1, api);
+	bind_text(insert, 2, guid);
+	run_statement(insert);
+
+	// If earlier changes weren't sent yet, the API still knows the flags the
+	// article had before them
+	sqlite3_stmt* update = get_statement(
+			"UPDATE remote_outbox "
+			"SET oldflags = CASE WHEN newflags IS NULL THEN ?3 ELSE oldflags END, "
+			"newflags = ?4, version = version + 1, attempts = 0, not_before = 0 "
+			"WHERE api = ?1 AND guid = ?2;");
+	bind_text(update, 1, api);
+	bind_text(update, 2, guid);
+	bind_text(update, 3, oldflags);
+	bind_text(update, 4, newflags);
+	run_statement(update);
+	transaction.commit();
+}
+
+static int remote_outbox_callback(void* handler, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto entries = static_cast<std::vector<OutboxEntry>*>(handler);
+	assert(argc == 7);
+	OutboxEntry entry;
+	entry.guid = argv[0] ? argv[0] : "";
+	if (argv[1]) {
+		entry.read = std::string(argv[1]) == "1";
+	}
+	entry.oldflags = argv[2] ? argv[2] : "";
+	if (argv[3]) {
+		entry.newflags = argv[3];
+	}
+	entry.version = argv[4] ? std::stoul(argv[4]) : 0;
+	entry.attempts = argv[5] ? std::stoul(argv[5]) : 0;
+	entry.not_before = argv[6] ? std::stoll(argv[6]) : 0;
+	entries->push_back(std::move(entry));
+	return 0;
+}
+
+std::vector<OutboxEntry> Cache::fetch_remote_outbox(const std::string& api)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	std::vector<OutboxEntry> entries;
+	run_sql(prepare_query(
+			"SELECT guid, read, oldflags, newflags, version, attempts, not_before "
+			"FROM remote_outbox WHERE api = '%q' ORDER BY not_before, guid;",
+			api),
+		remote_outbox_callback,
+		&entries);
+	return entries;
+}
+
+void Cache::remove_from_remote_outbox(const std::string& api,
+	const OutboxEntry& entry)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	sqlite3_stmt* remove = get_statement(
+			"DELETE FROM remote_outbox "
+			"WHERE api = ?1 AND guid = ?2 AND version = ?3;");
+	bind_text(remove, 1, api);
+	bind_text(remove, 2, entry.guid);
+	sqlite3_bind_int64(remove, 3, entry.version);
+	run_statement(remove);
+
+	if (sqlite3_changes(db) == 0 && entry.newflags.has_value()) {
+		// The article changed again in the meantime. The API now knows the
+		// flags that were just sent.
+		sqlite3_stmt* update = get_statement(
+				"UPDATE remote_outbox SET oldflags = ?3 "
+				"WHERE api = ?1 AND guid = ?2 AND newflags IS NOT NULL;");
+		bind_text(update, 1, api);
+		bind_text(update, 2, entry.guid);
+		bind_text(update, 3, entry.newflags.value());
+		run_statement(update);
+	}
+}
+
+void Cache::postpone_remote_outbox_entry(const std::string& api,
+	const OutboxEntry& entry,
+	time_t not_before)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	sqlite3_stmt* stmt = get_statement(
+			"UPDATE remote_outbox SET attempts = attempts + 1, not_before = ?4 "
+			"WHERE api = ?1 AND guid = ?2 AND version = ?3;");
+	bind_text(stmt, 1, api);
+	bind_text(stmt, 2, entry.guid);
+	sqlite3_bind_int64(stmt, 3, entry.version);
+	sqlite3_bind_int64(stmt, 4, not_before);
+	run_statement(stmt);
+}
+
 void Cache::mark_item_deleted(const std::string& guid, bool b)
 {
 	std::lock_guard<std::recursive_mutex> lock(mtx);
@@ -509,47 +1060,37 @@ void Cache::mark_item_deleted(const std::string& guid, bool b)
 void Cache::externalize_rssfeed(RssFeed& feed,
 	bool reset_unread)
 {
-	ScopeMeasure m1("Cache::externalize_feed");
+	ScopeMeasure m1("Cache::externalize_feed", feed.rssurl());
 	if (feed.is_query_feed()) {
 		return;
 	}
 
 	std::lock_guard<std::recursive_mutex> lock(mtx);
 	std::lock_guard<std::mutex> feedlock(feed.item_mutex);
-	// scope_transaction dbtrans(db);
-
-	CbHandler count_cbh;
-	auto query = prepare_query(
-			"SELECT count(*) FROM rss_feed WHERE rssurl = '%q';",
+	ScopeTransaction transaction(db);
+
+	sqlite3_stmt* update_feed = get_statement(
+			"UPDATE rss_feed "
+			"SET title = ?1, url = ?2, is_rtl = ?3 "
+			"WHERE rssurl = ?4;");
+	bind_text(update_feed, 1, feed.title_raw());
+	bind_text(update_feed, 2, feed.link());
+	sqlite3_bind_int(update_feed, 3, feed.is_rtl() ? 1 : 0);
+	bind_text(update_feed, 4, feed.rssurl());
+	run_statement(update_feed);
+
+	if (sqlite3_changes(db) == 0) {
+		LOG(Level::DEBUG,
+			"Cache::externalize_rss_feed: no rss_feed with rssurl = '%s' yet",
 			feed.rssurl());
-	run_sql(query, count_callback, &count_cbh);
-
-	const int count = count_cbh.count();
-	LOG(Level::DEBUG,
-		"Cache::externalize_rss_feed: rss_feeds with rssurl = '%s': "
-		"found "
-		"%d",
-		feed.rssurl(),
-		count);
-	if (count > 0) {
-		const std::string updatequery = prepare_query(
-				"UPDATE rss_feed "
-				"SET title = '%q', url = '%q', is_rtl = %u "
-				"WHERE rssurl = '%q';",
-				feed.title_raw(),
-				feed.link(),
-				feed.is_rtl() ? 1 : 0,
-				feed.rssurl());
-		run_sql(updatequery);
-	} else {
-		const std::string insertquery = prepare_query(
+		sqlite3_stmt* insert_feed = get_statement(
 				"INSERT INTO rss_feed (rssurl, url, title, is_rtl) "
-				"VALUES ( '%q', '%q', '%q', %u );",
-				feed.rssurl(),
-				feed.link(),
-				feed.title_raw(),
-				feed.is_rtl() ? 1 : 0);
-		run_sql(insertquery);
+				"VALUES (?1, ?2, ?3, ?4);");
+		bind_text(insert_feed, 1, feed.rssurl());
+		bind_text(insert_feed, 2, feed.link());
+		bind_text(insert_feed, 3, feed.title_raw());
+		sqlite3_bind_int(insert_feed, 4, feed.is_rtl() ? 1 : 0);
+		run_statement(insert_feed);
 	}
 
 	const unsigned int max_items = cfg.get_configvalue_as_int("max-items");
@@ -588,14 +1129,44 @@ void Cache::externalize_rssfeed(RssFeed& feed,
 			update_rssitem_unlocked(
 				item, feed.rssurl(), reset_unread);
 	}
+
+	transaction.commit();
 }
 
 // this function reads an RssFeed including all of its RssItems.
 // the feed parameter needs to have the rssurl member set.
+static void remove_ignored_items(RssFeed& feed, RssIgnores& ign)
+{
+	const auto rules = ign.rules_for(feed.rssurl());
+	if (rules->empty()) {
+		return;
+	}
+
+	auto& items = feed.items();
+	// Ignored articles are moved to the end, so that erase_items() can
+	// update the feed's unread counter and GUID map as it drops them
+	const auto ignored = std::stable_partition(
+			items.begin(),
+			items.end(),
+	[&](std::shared_ptr<RssItem> item) -> bool {
+		try
+		{
+			return !rules->matches(item.get());
+		} catch (const MatcherException& ex)
+		{
+			LOG(Level::DEBUG,
+				"oops, Matcher exception: %s",
+				ex.what());
+			return true;
+		}
+	});
+	feed.erase_items(ignored, items.end());
+}
+
 std::shared_ptr<RssFeed> Cache::internalize_rssfeed(std::string rssurl,
 	RssIgnores* ign)
 {
-	ScopeMeasure m1("Cache::internalize_rssfeed");
+	ScopeMeasure m1("Cache::internalize_rssfeed", rssurl);
 
 	std::shared_ptr<RssFeed> feed(new RssFeed(this, rssurl));
 
@@ -635,6 +1206,72 @@ std::shared_ptr<RssFeed> Cache::internalize_rssfeed(std::string rssurl,
 			rssurl);
 	run_sql(query, rssitem_callback, feed.get());
 
+	finish_internalized_feed_unlocked(feed, ign);
+	return feed;
+}
+
+std::vector<std::shared_ptr<RssFeed>> Cache::internalize_rssfeeds(
+		const std::vector<std::string>& rssurls,
+		RssIgnores* ign)
+{
+	ScopeMeasure m1("Cache::internalize_rssfeeds");
+
+	std::vector<std::shared_ptr<RssFeed>> feeds;
+	FeedsByUrl feeds_by_url;
+	for (const auto& rssurl : rssurls) {
+		std::shared_ptr<RssFeed> feed;
+		try {
+			feed.reset(new RssFeed(this, rssurl));
+		} catch (const std::string& errmsg) {
+			// Thrown for query feeds whose query is invalid
+			throw FeedLoadException(rssurl, errmsg);
+		}
+		feeds.push_back(feed);
+		if (!utils::is_query_url(rssurl)) {
+			feeds_by_url.emplace(rssurl, feed.get());
+		}
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+
+	// Instead of three queries per feed, two queries fetch everything and
+	// the rows are distributed among feeds by their URL
+	run_sql("SELECT rssurl, title, url, is_rtl FROM rss_feed;",
+		bulk_rssfeed_callback,
+		&feeds_by_url);
+	run_sql("SELECT guid, title, author, url, pubDate, length(content), "
+		"unread, "
+		"feedurl, enclosure_url, enclosure_type, enclosure_description, enclosure_description_mime_type, "
+		"enqueued, flags, base "
+		"FROM rss_item "
+		"WHERE deleted = 0 "
+		"ORDER BY pubDate DESC, id DESC;",
+		bulk_rssitem_callback,
+		&feeds_by_url);
+
+	for (auto& feed : feeds) {
+		const auto it = feeds_by_url.find(feed->rssurl());
+		if (it == feeds_by_url.end()) {
+			continue;
+		}
+		if (it->second != feed.get()) {
+			// The same URL is listed more than once, and only one feed
+			// can own the articles that were read
+			feed = internalize_rssfeed(feed->rssurl(), ign);
+			continue;
+		}
+
+		std::lock_guard<std::mutex> feedlock(feed->item_mutex);
+		finish_internalized_feed_unlocked(feed, ign);
+	}
+
+	return feeds;
+}
+
+void Cache::finish_internalized_feed_unlocked(
+	const std::shared_ptr<RssFeed>& feed,
+	RssIgnores* ign)
+{
 	auto feed_weak_ptr = std::weak_ptr<RssFeed>(feed);
 	for (const auto& item : feed->items()) {
 		item->set_cache(this);
@@ -643,48 +1280,131 @@ std::shared_ptr<RssFeed> Cache::internalize_rssfeed(std::string rssurl,
 	}
 
 	if (ign != nullptr) {
-		auto& items = feed->items();
-		items.erase(
-			std::remove_if(
-				items.begin(),
-				items.end(),
-		[&](std::shared_ptr<RssItem> item) -> bool {
-			try
-			{
-				return ign->matches(item.get());
-			} catch (const MatcherException& ex)
-			{
-				LOG(Level::DEBUG,
-					"oops, Matcher exception: %s",
-					ex.what());
-				return false;
+		remove_ignored_items(*feed, *ign);
+	}
+
+	enforce_max_items_unlocked(*feed);
+	feed->sort_unlocked(cfg.get_article_sort_strategy());
+}
+
+std::shared_ptr<RssFeed> Cache::merge_rssfeed(RssFeed& oldfeed,
+	RssFeed& newfeed,
+	bool reset_unread,
+	RssIgnores* ign)
+{
+	ScopeMeasure m1("Cache::merge_rssfeed", oldfeed.rssurl());
+
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	externalize_rssfeed(newfeed, reset_unread);
+
+	const std::string rssurl = oldfeed.rssurl();
+	std::shared_ptr<RssFeed> feed(new RssFeed(this, rssurl));
+	if (utils::is_query_url(rssurl)) {
+		return feed;
+	}
+
+	std::lock_guard<std::mutex> feedlock(feed->item_mutex);
+
+	std::string query = prepare_query(
+			"SELECT title, url, is_rtl FROM rss_feed WHERE rssurl = '%q';",
+			rssurl);
+	run_sql(query, rssfeed_callback, feed.get());
+
+	// Articles that were just stored might have been inserted, updated or
+	// left alone, so we read them back. Everything else is unchanged since
+	// `oldfeed` was loaded. Their GUIDs go into a temporary table rather
+	// than the query itself, which would get too long for large feeds.
+	run_sql("CREATE TEMP TABLE IF NOT EXISTS merged_guids "
+		"(guid VARCHAR(64) PRIMARY KEY NOT NULL);");
+	ScopeTransaction transaction(db);
+	run_sql("DELETE FROM temp.merged_guids;");
+	bool has_guids = false;
+	{
+		std::lock_guard<std::mutex> newfeedlock(newfeed.item_mutex);
+		sqlite3_stmt* insert = get_statement(
+				"INSERT OR IGNORE INTO temp.merged_guids (guid) VALUES (?);");
+		for (const auto& item : newfeed.items()) {
+			bind_text(insert, 1, item->guid());
+			run_statement(insert);
+			has_guids = true;
+		}
+	}
+	if (has_guids) {
+		query = prepare_query(
+				"SELECT guid, title, author, url, pubDate, length(content), "
+				"unread, "
+				"feedurl, enclosure_url, enclosure_type, enclosure_description, enclosure_description_mime_type, "
+				"enqueued, flags, base "
+				"FROM rss_item "
+				"WHERE feedurl = '%q' "
+				"AND deleted = 0 "
+				"AND guid IN (SELECT guid FROM temp.merged_guids) "
+				"ORDER BY pubDate DESC, id DESC;",
+				rssurl);
+		run_sql(query, rssitem_callback, feed.get());
+	}
+	run_sql("DELETE FROM temp.merged_guids;");
+	transaction.commit();
+
+	std::unordered_set<std::string> stored_guids;
+	for (const auto& item : feed->items()) {
+		stored_guids.insert(item->guid());
+	}
+
+	if (ign != nullptr) {
+		remove_ignored_items(*feed, *ign);
+	}
+
+	{
+		std::lock_guard<std::mutex> oldfeedlock(oldfeed.item_mutex);
+		for (const auto& item : oldfeed.items()) {
+			if (!item->deleted()
+				&& stored_guids.find(item->guid()) == stored_guids.end()) {
+				feed->add_item(item);
 			}
-		}),
-		items.end());
+		}
 	}
 
+	auto feed_weak_ptr = std::weak_ptr<RssFeed>(feed);
+	for (const auto& item : feed->items()) {
+		item->set_cache(this);
+		item->set_feedptr(feed_weak_ptr);
+		item->set_feedurl(feed->rssurl());
+	}
+
+	enforce_max_items_unlocked(*feed);
+	feed->sort_unlocked(cfg.get_article_sort_strategy());
+	return feed;
+}
+
+void Cache::enforce_max_items_unlocked(RssFeed& feed)
+{
 	const unsigned int max_items = cfg.get_configvalue_as_int("max-items");
 
-	if (max_items > 0 && feed->total_item_count() > max_items) {
+	if (max_items > 0 && feed.total_item_count() > max_items) {
+		// keep the newest articles
+		std::stable_sort(feed.items().begin(), feed.items().end(),
+		[](const std::shared_ptr<RssItem>& a, const std::shared_ptr<RssItem>& b) {
+			return a->pubDate_timestamp() > b->pubDate_timestamp();
+		});
+
 		std::vector<std::shared_ptr<RssItem>> flagged_items;
-		for (unsigned int j = max_items; j < feed->total_item_count();
+		for (unsigned int j = max_items; j < feed.total_item_count();
 			++j) {
-			if (feed->items()[j]->flags().length() == 0) {
-				delete_item_unlocked(*feed->items()[j]);
+			if (feed.items()[j]->flags().length() == 0) {
+				delete_item_unlocked(*feed.items()[j]);
 			} else {
-				flagged_items.push_back(feed->items()[j]);
+				flagged_items.push_back(feed.items()[j]);
 			}
 		}
 
-		auto it = feed->items().begin() + max_items;
-		feed->erase_items(
-			it, feed->items().end()); // delete old entries
+		auto it = feed.items().begin() + max_items;
+		feed.erase_items(
+			it, feed.items().end()); // delete old entries
 
 		// if some flagged articles were saved, append them
-		feed->add_items(flagged_items);
+		feed.add_items(flagged_items);
 	}
-	feed->sort_unlocked(cfg.get_article_sort_strategy());
-	return feed;
 }
 
 std::vector<std::shared_ptr<RssItem>> Cache::search_for_items(
@@ -704,12 +1424,11 @@ std::vector<std::shared_ptr<RssItem>> Cache::search_for_items(
 				"enclosure_description, enclosure_description_mime_type, "
 				"enqueued, flags, base "
 				"FROM rss_item "
-				"WHERE (title LIKE '%%%q%%' OR content LIKE '%%%q%%') "
+				"WHERE %s "
 				"AND feedurl = '%q' "
 				"AND deleted = 0 "
 				"ORDER BY pubDate DESC, id DESC;",
-				querystr,
-				querystr,
+				search_condition(querystr),
 				feedurl);
 	} else {
 		query = prepare_query(
@@ -719,25 +1438,31 @@ std::vector<std::shared_ptr<RssItem>> Cache::search_for_items(
 				"enclosure_description, enclosure_description_mime_type, "
 				"enqueued, flags, base "
 				"FROM rss_item "
-				"WHERE (title LIKE '%%%q%%' OR content LIKE '%%%q%%') "
+				"WHERE %s "
 				"AND deleted = 0 "
 				"ORDER BY pubDate DESC,  id DESC;",
-				querystr,
-				querystr);
+				search_condition(querystr));
 	}
 
 	run_sql(query, search_item_callback, &items);
 	for (const auto& item : items) {
 		item->set_cache(this);
 	}
+	// Rules are looked up once per feed rather than for each article
+	std::unordered_map<std::string, std::shared_ptr<const FeedIgnoreRules>> rules;
 	items.erase(
 		std::remove_if(
 			items.begin(),
 			items.end(),
 	[&](std::shared_ptr<RssItem> item) -> bool {
+		auto& feed_rules = rules[item->feedurl()];
+		if (feed_rules == nullptr)
+		{
+			feed_rules = ign.rules_for(item->feedurl());
+		}
 		try
 		{
-			return ign.matches(item.get());
+			return feed_rules->matches(item.get());
 		} catch (const MatcherException& ex)
 		{
 			LOG(Level::DEBUG,
@@ -766,10 +1491,9 @@ std::unordered_set<std::string> Cache::search_in_items(
 	std::string query = prepare_query(
 			"SELECT guid "
 			"FROM rss_item "
-			"WHERE (title LIKE '%%%q%%' OR content LIKE '%%%q%%') "
+			"WHERE %s "
 			"AND guid IN %s;",
-			querystr,
-			querystr,
+			search_condition(querystr),
 			list);
 
 	std::unordered_set<std::string> items;
@@ -868,108 +1592,71 @@ void Cache::update_rssitem_unlocked(RssItem& item,
 	const std::string& feedurl,
 	bool reset_unread)
 {
-	std::string query = prepare_query(
-			"SELECT count(*) FROM rss_item WHERE guid = '%q';",
-			item.guid());
-	CbHandler count_cbh;
-	run_sql(query, count_callback, &count_cbh);
 	const auto description = item.description();
-	if (count_cbh.count() > 0) {
-		if (reset_unread) {
-			std::string content;
-			query = prepare_query(
-					"SELECT content FROM rss_item WHERE guid = "
-					"'%q';",
-					item.guid());
-			run_sql(query, single_string_callback, &content);
-			if (content != description.text) {
-				LOG(Level::DEBUG,
-					"Cache::update_rssitem_unlocked: '%s' "
-					"is "
-					"different from '%s'",
-					content,
-					description.text);
-				query = prepare_query(
-						"UPDATE rss_item SET unread = 1 WHERE "
-						"guid = '%q';",
-						item.guid());
-				run_sql(query);
-			}
-		}
-		std::string update;
-		if (item.override_unread()) {
-			update = prepare_query(
-					"UPDATE rss_item "
-					"SET title = '%q', author = '%q', url = '%q', "
-					"feedurl = '%q', "
-					"content = '%q', content_mime_type = '%q', enclosure_url = '%q', "
-					"enclosure_type = '%q', enclosure_description = '%q', "
-					"enclosure_description_mime_type = '%q', base = '%q', unread = "
-					"'%d' "
-					"WHERE guid = '%q'",
-					item.title(),
-					item.author(),
-					item.link(),
-					feedurl,
-					description.text,
-					description.mime,
-					item.enclosure_url(),
-					item.enclosure_type(),
-					item.enclosure_description(),
-					item.enclosure_description_mime_type(),
-					item.get_base(),
-					(item.unread() ? 1 : 0),
-					item.guid());
-		} else {
-			update = prepare_query(
-					"UPDATE rss_item "
-					"SET title = '%q', author = '%q', url = '%q', "
-					"feedurl = '%q', "
-					"content = '%q', content_mime_type = '%q', enclosure_url = '%q', "
-					"enclosure_type = '%q', enclosure_description = '%q', "
-					"enclosure_description_mime_type = '%q', base = '%q' "
-					"WHERE guid = '%q'",
-					item.title(),
-					item.author(),
-					item.link(),
-					feedurl,
-					description.text,
-					description.mime,
-					item.enclosure_url(),
-					item.enclosure_type(),
-					item.enclosure_description(),
-					item.enclosure_description_mime_type(),
-					item.get_base(),
-					item.guid());
-		}
-		run_sql(update);
-	} else {
-		std::int64_t pubTimestamp = item.pubDate_timestamp();
-		std::string insert = prepare_query(
-				"INSERT INTO rss_item (guid, title, author, url, "
-				"feedurl, "
-				"pubDate, content, content_mime_type, unread, enclosure_url, "
-				"enclosure_type, enclosure_description, enclosure_description_mime_type, "
-				"enqueued, base) "
-				"VALUES "
-				"('%q','%q','%q','%q','%q','%" PRId64 "','%q','%q','%d','%q','%q','%q','%q',%d, '%q')",
-				item.guid(),
-				item.title(),
-				item.author(),
-				item.link(),
-				feedurl,
-				pubTimestamp,
-				description.text,
-				description.mime,
-				(item.unread() ? 1 : 0),
-				item.enclosure_url(),
-				item.enclosure_type(),
-				item.enclosure_description(),
-				item.enclosure_description_mime_type(),
-				item.enqueued() ? 1 : 0,
-				item.get_base());
-		run_sql(insert);
+
+	// An article is usually in the cache already, so we try to update it
+	// first and only insert it if that didn't touch any row. (An upsert
+	// would need a UNIQUE index on `guid`, which existing cache files are not
+	// guaranteed to satisfy.)
+	std::string unread_expression = "unread";
+	if (item.override_unread()) {
+		unread_expression = "?13";
+	} else if (reset_unread) {
+		// The right-hand side of SET sees the old row, so this compares the
+		// stored content with the new one
+		unread_expression = "CASE WHEN content != ?5 THEN 1 ELSE unread END";
+	}
+	sqlite3_stmt* update = get_statement(
+			"UPDATE rss_item "
+			"SET title = ?1, author = ?2, url = ?3, feedurl = ?4, "
+			"content = ?5, content_mime_type = ?6, enclosure_url = ?7, "
+			"enclosure_type = ?8, enclosure_description = ?9, "
+			"enclosure_description_mime_type = ?10, base = ?11, "
+			"unread = " + unread_expression + " "
+			"WHERE guid = ?12;");
+	bind_text(update, 1, item.title());
+	bind_text(update, 2, item.author());
+	bind_text(update, 3, item.link());
+	bind_text(update, 4, feedurl);
+	bind_text(update, 5, description.text);
+	bind_text(update, 6, description.mime);
+	bind_text(update, 7, item.enclosure_url());
+	bind_text(update, 8, item.enclosure_type());
+	bind_text(update, 9, item.enclosure_description());
+	bind_text(update, 10, item.enclosure_description_mime_type());
+	bind_text(update, 11, item.get_base());
+	bind_text(update, 12, item.guid());
+	if (item.override_unread()) {
+		sqlite3_bind_int(update, 13, item.unread() ? 1 : 0);
+	}
+	run_statement(update);
+
+	if (sqlite3_changes(db) > 0) {
+		return;
 	}
+
+	sqlite3_stmt* insert = get_statement(
+			"INSERT INTO rss_item (guid, title, author, url, feedurl, "
+			"pubDate, content, content_mime_type, unread, enclosure_url, "
+			"enclosure_type, enclosure_description, enclosure_description_mime_type, "
+			"enqueued, base) "
+			"VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15);");
+	bind_text(insert, 1, item.guid());
+	bind_text(insert, 2, item.title());
+	bind_text(insert, 3, item.author());
+	bind_text(insert, 4, item.link());
+	bind_text(insert, 5, feedurl);
+	sqlite3_bind_int64(insert, 6, item.pubDate_timestamp());
+	bind_text(insert, 7, description.text);
+	bind_text(insert, 8, description.mime);
+	sqlite3_bind_int(insert, 9, item.unread() ? 1 : 0);
+	bind_text(insert, 10, item.enclosure_url());
+	bind_text(insert, 11, item.enclosure_type());
+	bind_text(insert, 12, item.enclosure_description());
+	bind_text(insert, 13, item.enclosure_description_mime_type());
+	sqlite3_bind_int(insert, 14, item.enqueued() ? 1 : 0);
+	bind_text(insert, 15, item.get_base());
+	run_statement(insert);
 }
 
 void Cache::mark_all_read(RssFeed& feed)
@@ -1008,7 +1695,28 @@ void Cache::mark_all_read(const std::string& feedurl)
 				"SET unread = '0' "
 				"WHERE unread != '0';");
 	}
+
+	// Read state changes queued for a remote API would otherwise be sent
+	// after the API has marked the whole feed read, and undo that
+	std::string outbox_query;
+	if (feedurl.length() > 0) {
+		outbox_query = prepare_query(
+				"UPDATE remote_outbox "
+				"SET read = 1, version = version + 1 "
+				"WHERE read = 0 "
+				"AND guid IN (SELECT guid FROM rss_item WHERE feedurl = '%q');",
+				feedurl);
+	} else {
+		outbox_query = prepare_query(
+				"UPDATE remote_outbox "
+				"SET read = 1, version = version + 1 "
+				"WHERE read = 0;");
+	}
+
+	ScopeTransaction transaction(db);
 	run_sql(query);
+	run_sql(outbox_query);
+	transaction.commit();
 }
 
 void Cache::update_rssitem_unread_and_enqueued(RssItem& item,
@@ -1072,7 +1780,7 @@ void Cache::update_rssitem_flags(RssItem* item)
 
 void Cache::remove_old_deleted_items(RssFeed* feed)
 {
-	ScopeMeasure m1("Cache::remove_old_deleted_items");
+	ScopeMeasure m1("Cache::remove_old_deleted_items", feed->rssurl());
 
 	std::lock_guard<std::recursive_mutex> cache_lock(mtx);
 	std::lock_guard<std::mutex> feed_lock(feed->item_mutex);
@@ -1188,6 +1896,33 @@ void Cache::fetch_descriptions(RssFeed* feed)
 	run_sql(query, fill_content_callback, feed);
 }
 
+std::unordered_map<std::string, std::string> Cache::fetch_descriptions(
+	const std::vector<std::string>& guids)
+{
+	std::lock_guard<std::recursive_mutex> lock(mtx);
+	std::vector<std::string> quoted_guids;
+	for (const auto& guid : guids) {
+		quoted_guids.push_back(prepare_query("'%q'", guid));
+	}
+	const std::string in_clause = utils::join(quoted_guids, ", ");
+
+	const std::string query = prepare_query(
+			"SELECT guid, content FROM rss_item WHERE guid IN (%s);",
+			in_clause);
+
+	std::unordered_map<std::string, std::string> descriptions;
+	auto store_description = [](void* d, int, char** argv, char**) -> int {
+		auto& descs = *static_cast<std::unordered_map<std::string, std::string>*>(d);
+		if (argv[0]) {
+			descs[argv[0]] = argv[1] ? argv[1] : "";
+		}
+		return 0;
+	};
+
+	run_sql(query, store_description, &descriptions);
+	return descriptions;
+}
+
 std::string Cache::fetch_description(const RssItem& item)
 {
 	std::lock_guard<std::recursive_mutex> lock(mtx);
@@ -1248,6 +1983,11 @@ SchemaVersion Cache::get_schema_version()
 
 void Cache::close_database()
 {
+	for (const auto& statement : statements) {
+		sqlite3_finalize(statement.second);
+	}
+	statements.clear();
+
 	if (db != nullptr) {
 		sqlite3_close(db);
 		db = nullptr;
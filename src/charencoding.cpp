@@ -1,11 +1,12 @@
 #include "charencoding.h"
 
 #include "libnewsboat-ffi/src/charencoding.rs.h"
+#include "utils.h"
 
 namespace newsboat {
 namespace charencoding {
 
-std::optional<std::string> charset_from_bom(std::vector<std::uint8_t> content)
+std::optional<std::string> charset_from_bom(const std::vector<std::uint8_t>& content)
 {
 	rust::String charset;
 	const auto input = rust::Slice<const std::uint8_t>(content.data(), content.size());
@@ -15,7 +16,7 @@ std::optional<std::string> charset_from_bom(std::vector<std::uint8_t> content)
 	return {};
 }
 
-std::optional<std::string> charset_from_xml_declaration(std::vector<std::uint8_t>
+std::optional<std::string> charset_from_xml_declaration(const std::vector<std::uint8_t>&
 	content)
 {
 	rust::String charset;
@@ -26,8 +27,8 @@ std::optional<std::string> charset_from_xml_declaration(std::vector<std::uint8_t
 	return {};
 }
 
-std::optional<std::string> charset_from_content_type_header(std::vector<std::uint8_t>
-	header)
+std::optional<std::string> charset_from_content_type_header(
+	const std::vector<std::uint8_t>& header)
 {
 	rust::String charset;
 	const auto input = rust::Slice<const std::uint8_t>(header.data(), header.size());
@@ -37,5 +38,11 @@ std::optional<std::string> charset_from_content_type_header(std::vector<std::uin
 	return {};
 }
 
+bool is_utf8(const std::string& charset)
+{
+	const std::string name = utils::to_lowercase(charset);
+	return name == "utf-8" || name == "utf8";
+}
+
 } // namespace charencoding
 } // namespace newsboat
@@ -117,6 +117,11 @@ bool CliArgsParser::refresh_on_start() const
 	return newsboat::cliargsparser::bridged::refresh_on_start(*rs_object);
 }
 
+bool CliArgsParser::daemon() const
+{
+	return newsboat::cliargsparser::bridged::daemon(*rs_object);
+}
+
 std::optional<Filepath> CliArgsParser::url_file() const
 {
 	auto path = filepath::bridged::create_empty();
@@ -211,6 +216,15 @@ std::optional<Level> CliArgsParser::log_level() const
 	return std::nullopt;
 }
 
+std::optional<Filepath> CliArgsParser::trace_file() const
+{
+	auto path = filepath::bridged::create_empty();
+	if (newsboat::cliargsparser::bridged::trace_file(*rs_object, *path)) {
+		return Filepath(std::move(path));
+	}
+	return std::nullopt;
+}
+
 const cliargsparser::bridged::CliArgsParser& CliArgsParser::get_rust_ref() const
 {
 	return *rs_object;
@@ -75,6 +75,7 @@ ConfigContainer::ConfigContainer()
 		ConfigData("false", ConfigDataType::BOOL)},
 	{"download-path", ConfigData("~/", ConfigDataType::PATH)},
 	{"download-retries", ConfigData("1", ConfigDataType::INT)},
+	{"download-segments", ConfigData("1", ConfigDataType::INT)},
 	{"download-timeout", ConfigData("30", ConfigDataType::INT)},
 	{"error-log", ConfigData("", ConfigDataType::PATH)},
 	{"external-url-viewer", ConfigData("", ConfigDataType::PATH)},
@@ -157,6 +158,7 @@ ConfigContainer::ConfigContainer()
 	{
 		"markfeedread-jumps-to-next-unread",
 		ConfigData("false", ConfigDataType::BOOL)},
+	{"max-download-host-connections", ConfigData("0", ConfigDataType::INT)},
 	{"max-download-speed", ConfigData("0", ConfigDataType::INT)},
 	{"max-downloads", ConfigData("1", ConfigDataType::INT)},
 	{"max-items", ConfigData("0", ConfigDataType::INT)},
@@ -229,9 +231,13 @@ ConfigContainer::ConfigContainer()
 			"socks5",
 			"socks5h"}))},
 	{"refresh-on-startup", ConfigData("no", ConfigDataType::BOOL)},
+	{"reload-adaptive", ConfigData("no", ConfigDataType::BOOL)},
+	{"reload-adaptive-max-time", ConfigData("1440", ConfigDataType::INT)},
 	{
 		"reload-only-visible-feeds",
 		ConfigData("false", ConfigDataType::BOOL)},
+	{"reload-max-host-connections", ConfigData("2", ConfigDataType::INT)},
+	{"reload-max-transfers", ConfigData("8", ConfigDataType::INT)},
 	{"reload-threads", ConfigData("1", ConfigDataType::INT)},
 	{"reload-time", ConfigData("60", ConfigDataType::INT)},
 	{"restrict-filename", ConfigData("yes", ConfigDataType::BOOL)},
@@ -242,6 +248,7 @@ ConfigContainer::ConfigContainer()
 		ConfigData("black yellow bold",
 			ConfigDataType::STR,
 			true)},
+	{"search-index", ConfigData("no", ConfigDataType::BOOL)},
 	{
 		"selecttag-format",
 		ConfigData("%4i  %T (%u)", ConfigDataType::STR)},
@@ -29,10 +29,12 @@
 #include "configcontainer.h"
 #include "configexception.h"
 #include "configpaths.h"
+#include "daemon.h"
 #include "dbexception.h"
 #include "exception.h"
 #include "feedhqapi.h"
 #include "feedhqurlreader.h"
+#include "feedloadexception.h"
 #include "formaction.h"
 #include "feedbinapi.h"
 #include "freshrssapi.h"
@@ -42,6 +44,7 @@
 #include "inoreaderurlreader.h"
 #include "itemrenderer.h"
 #include "logger.h"
+#include "matcherexception.h"
 #include "minifluxapi.h"
 #include "minifluxurlreader.h"
 #include "newsblurapi.h"
@@ -193,6 +196,19 @@ int Controller::run(const CliArgsParser& args)
 		configpaths.set_cache_file(cachefilepath);
 	}
 
+	// A running daemon already has everything loaded, so let it do the work
+	const auto cmds_to_execute = args.cmds_to_execute();
+	if (cmds_to_execute.size() >= 1) {
+		const auto ret = Daemon::forward_commands(
+				Daemon::socket_path(configpaths.cache_file()),
+				cmds_to_execute,
+				std::cout,
+				std::cerr);
+		if (ret.has_value()) {
+			return ret.value();
+		}
+	}
+
 	pid_t pid;
 	std::string error;
 	if (!fslock.try_lock(configpaths.lock_file(), pid, error)) {
@@ -373,6 +389,8 @@ int Controller::run(const CliArgsParser& args)
 			std::cerr << _("Authentication failed.") << std::endl;
 			return EXIT_FAILURE;
 		}
+		outbox = std::make_unique<RemoteApiOutbox>(*api, *rsscache, type);
+		outbox->start();
 	}
 	const auto error_message = urlcfg->reload();
 	if (error_message.has_value()) {
@@ -452,33 +470,34 @@ int Controller::run(const CliArgsParser& args)
 	}
 	std::cout.flush();
 
-	unsigned int i = 0;
-	for (const auto& feed_url : urlcfg->get_urls()) {
-		try {
-			bool ignore_disp =
-				(cfg.get_configvalue("ignore-mode") ==
-					"display");
-			std::shared_ptr<RssFeed> feed =
-				rsscache->internalize_rssfeed(
-					feed_url.url, ignore_disp ? &ign : nullptr);
-			feed->set_origin(feed_url.origin);
-			feed->set_tags(feed_url.tags);
-			feed->set_order(i);
-			feedcontainer.add_feed(feed);
-		} catch (const DbException& e) {
-			std::cerr << _("Error while loading feeds from "
-					"database: ")
-				<< e.what() << std::endl;
-			return EXIT_FAILURE;
-		} catch (const std::string& str) {
-			std::cerr << strprintf::fmt(
-					_("Error while loading feed '%s': %s"),
-					feed_url.url,
-					str)
-				<< std::endl;
-			return EXIT_FAILURE;
+	const auto& feed_urls = urlcfg->get_urls();
+	std::vector<std::string> rssurls;
+	for (const auto& feed_url : feed_urls) {
+		rssurls.push_back(feed_url.url);
+	}
+	try {
+		const bool ignore_disp =
+			(cfg.get_configvalue("ignore-mode") == "display");
+		const auto feeds = rsscache->internalize_rssfeeds(
+				rssurls, ignore_disp ? &ign : nullptr);
+		for (unsigned int i = 0; i < feeds.size(); i++) {
+			feeds[i]->set_origin(feed_urls[i].origin);
+			feeds[i]->set_tags(feed_urls[i].tags);
+			feeds[i]->set_order(i);
+			feedcontainer.add_feed(feeds[i]);
 		}
-		i++;
+	} catch (const DbException& e) {
+		std::cerr << _("Error while loading feeds from "
+				"database: ")
+			<< e.what() << std::endl;
+		return EXIT_FAILURE;
+	} catch (const FeedLoadException& e) {
+		std::cerr << strprintf::fmt(
+				_("Error while loading feed '%s': %s"),
+				e.url(),
+				e.what())
+			<< std::endl;
+		return EXIT_FAILURE;
 	}
 
 	if (!args.do_export() && !args.silent()) {
@@ -543,12 +562,16 @@ int Controller::run(const CliArgsParser& args)
 	v->set_tags(urlcfg->get_alltags());
 	v->set_cache(rsscache.get());
 
-	const auto cmds_to_execute = args.cmds_to_execute();
 	if (cmds_to_execute.size() >= 1) {
 		execute_commands(cmds_to_execute);
 		return EXIT_SUCCESS;
 	}
 
+	if (args.daemon()) {
+		Daemon daemon(*this, Daemon::socket_path(configpaths.cache_file()));
+		return daemon.run();
+	}
+
 	// if the user wants to refresh on startup via configuration file, then
 	// do so, but only if -r hasn't been supplied.
 	if (!refresh_on_start &&
@@ -615,42 +638,39 @@ void Controller::update_visible_feeds()
 	v->update_visible_feeds(feedcontainer.get_all_feeds());
 }
 
-void Controller::mark_all_read(const std::string& feedurl)
+bool Controller::mark_all_read(const std::string& feedurl)
 {
 	try {
 		rsscache->mark_all_read(feedurl);
 	} catch (const DbException& e) {
+		LOG(Level::ERROR, "Controller::mark_all_read: %s", e.what());
 		v->get_statusline().show_error(strprintf::fmt(
 				_("Error: couldn't mark all feeds read: %s"),
 				e.what()));
-		return;
+		return false;
 	}
 
 	if (feedurl.empty()) { // Mark all feeds as read
-		if (api) {
-			for (const auto& feed : feedcontainer.get_all_feeds()) {
-				api->mark_all_read(feed->rssurl());
-			}
+		for (const auto& feed : feedcontainer.get_all_feeds()) {
+			mark_feed_read_remotely(*feed);
 		}
 		feedcontainer.mark_all_feeds_read();
 	} else { // Mark a specific feed as read
 		const auto feed = feedcontainer.get_feed_by_url(feedurl);
 		if (!feed) {
-			return;
-		}
-
-		if (api) {
-			api->mark_all_read(feed->rssurl());
+			return true;
 		}
 
+		mark_feed_read_remotely(*feed);
 		feed->mark_all_items_read();
 	}
+	return true;
 }
 
 void Controller::mark_article_read(const std::string& guid, bool read)
 {
-	if (api) {
-		api->mark_article_read(guid, read);
+	if (outbox) {
+		outbox->mark_article_read(guid, read);
 	}
 }
 
@@ -663,22 +683,11 @@ void Controller::mark_all_read(unsigned int pos)
 	}
 
 	if (feed->is_query_feed()) {
-		if (api) {
-			std::vector<std::string> item_guids;
-			for (const auto& item : feed->items()) {
-				if (item->unread()) {
-					item_guids.push_back(item->guid());
-				}
-			}
-			api->mark_articles_read(item_guids);
-		}
 		rsscache->mark_all_read(*feed);
 	} else {
 		rsscache->mark_all_read(feed->rssurl());
-		if (api) {
-			api->mark_all_read(feed->rssurl());
-		}
 	}
+	mark_feed_read_remotely(*feed);
 	m.stopover(
 		"after rsscache->mark_all_read, before iteration over "
 		"items");
@@ -686,11 +695,31 @@ void Controller::mark_all_read(unsigned int pos)
 	feedcontainer.mark_all_feed_items_read(feed);
 }
 
+void Controller::mark_feed_read_remotely(RssFeed& feed)
+{
+	if (!outbox) {
+		return;
+	}
+
+	std::vector<std::string> unread_guids;
+	for (const auto& item : feed.items()) {
+		if (item->unread()) {
+			unread_guids.push_back(item->guid());
+		}
+	}
+	if (feed.is_query_feed()) {
+		// The API doesn't know about query feeds
+		outbox->mark_articles_read(unread_guids);
+	} else {
+		outbox->mark_feed_read(feed.rssurl(), unread_guids);
+	}
+}
+
 void Controller::mark_all_read(const std::vector<std::string>& item_guids)
 {
 	ScopeMeasure m("Controller::mark_all_read");
-	if (api) {
-		api->mark_articles_read(item_guids);
+	if (outbox) {
+		outbox->mark_articles_read(item_guids);
 	}
 }
 
@@ -698,17 +727,13 @@ void Controller::replace_feed(RssFeed& oldfeed, RssFeed& newfeed, unsigned int p
 	bool unattended)
 {
 	LOG(Level::DEBUG, "Controller::replace_feed: saving");
-	rsscache->externalize_rssfeed(
-		newfeed, ign.matches_resetunread(newfeed.rssurl()));
-	LOG(Level::DEBUG,
-		"Controller::replace_feed: after externalize_rssfeed");
-
-	bool ignore_disp = (cfg.get_configvalue("ignore-mode") == "display");
-	std::shared_ptr<RssFeed> feed = rsscache->internalize_rssfeed(
-			oldfeed.rssurl(), ignore_disp ? &ign : nullptr);
+	const bool ignore_disp = (cfg.get_configvalue("ignore-mode") == "display");
+	std::shared_ptr<RssFeed> feed = rsscache->merge_rssfeed(oldfeed, newfeed,
+			ign.matches_resetunread(newfeed.rssurl()),
+			ignore_disp ? &ign : nullptr);
 	feed->set_origin(oldfeed.get_origin());
 	LOG(Level::DEBUG,
-		"Controller::replace_feed: after internalize_rssfeed");
+		"Controller::replace_feed: after merge_rssfeed");
 
 	auto* feed_url = urlcfg->get_entry(oldfeed.rssurl());
 	if (feed_url != nullptr) {
@@ -718,6 +743,16 @@ void Controller::replace_feed(RssFeed& oldfeed, RssFeed& newfeed, unsigned int p
 	feedcontainer.replace_feed(pos, feed);
 
 	if (cfg.get_configvalue_as_bool("podcast-auto-enqueue")) {
+		std::vector<std::shared_ptr<RssItem>> not_enqueued;
+		{
+			std::lock_guard<std::mutex> lock(feed->item_mutex);
+			for (const auto& item : feed->items()) {
+				if (!item->enqueued()) {
+					not_enqueued.push_back(item);
+				}
+			}
+		}
+
 		const auto result = queueManager.autoenqueue(*feed);
 		switch (result.status) {
 		case EnqueueStatus::QUEUED_SUCCESSFULLY:
@@ -734,10 +769,13 @@ void Controller::replace_feed(RssFeed& oldfeed, RssFeed& newfeed, unsigned int p
 				strprintf::fmt(_("Failed to open queue file: %s."), result.extra_filename));
 			break;
 		}
-	}
 
-	for (const auto& item : feed->items()) {
-		rsscache->update_rssitem_unread_and_enqueued(*item, feed->rssurl());
+		// Everything else already is in the cache as it is in memory
+		for (const auto& item : not_enqueued) {
+			if (item->enqueued()) {
+				rsscache->update_rssitem_unread_and_enqueued(*item, feed->rssurl());
+			}
+		}
 	}
 
 	v->notify_itemlist_change(feed);
@@ -904,27 +942,76 @@ Filepath Controller::get_urls_file()
 	return configpaths.url_file();
 }
 
-int Controller::execute_commands(const std::vector<std::string>& cmds)
+int Controller::execute_commands(const std::vector<std::string>& cmds,
+	std::ostream& out,
+	std::ostream& err)
 {
 	if (v->formaction_stack_size() > 0) {
 		v->pop_current_formaction();
 	}
-	for (const auto& cmd : cmds) {
+	for (const auto& cmdline : cmds) {
 		LOG(Level::DEBUG,
 			"Controller::execute_commands: executing `%s'",
-			cmd);
+			cmdline);
+
+		// Everything after the command name is its argument, so that filter
+		// expressions don't need another level of quoting
+		std::string cmd = cmdline;
+		std::string arg;
+		const auto space = cmdline.find(' ');
+		if (space != std::string::npos) {
+			cmd = cmdline.substr(0, space);
+			arg = cmdline.substr(space + 1);
+			utils::trim(arg);
+		}
+
 		if (cmd == "reload") {
-			reloader->reload_all(true);
+			reloader->reload_all_exclusive(true);
 		} else if (cmd == "print-unread") {
-			std::cout << strprintf::fmt(_("%u unread articles"),
+			out << strprintf::fmt(_("%u unread articles"),
 					feedcontainer.unread_item_count())
 				<< std::endl;
+		} else if (cmd == "print-feeds-unread") {
+			for (const auto& feed : feedcontainer.get_all_feeds()) {
+				if (!feed->is_query_feed()) {
+					out << feed->unread_item_count() << '\t' << feed->rssurl() << std::endl;
+				}
+			}
+		} else if (cmd == "print-query") {
+			std::shared_ptr<RssFeed> results;
+			try {
+				results = std::make_shared<RssFeed>(rsscache.get(), "query:results:" + arg);
+				results->update_items(feedcontainer.get_all_feeds());
+			} catch (const std::string& msg) {
+				err << strprintf::fmt(_("%s: %s: %s"), "newsboat", cmd, msg) << std::endl;
+				return EXIT_FAILURE;
+			} catch (const MatcherException& e) {
+				err << strprintf::fmt(_("%s: %s: %s"), "newsboat", cmd, e.what()) << std::endl;
+				return EXIT_FAILURE;
+			}
+			results->sort(cfg.get_article_sort_strategy());
+			std::lock_guard<std::mutex> lock(results->item_mutex);
+			for (const auto& item : results->items()) {
+				out << item->link() << '\t' << utils::utf8_to_locale(item->title()) << std::endl;
+			}
+		} else if (cmd == "mark-read") {
+			if (!arg.empty() && !feedcontainer.get_feed_by_url(arg)) {
+				err << strprintf::fmt(_("%s: %s: no such feed: %s"), "newsboat", cmd, arg)
+					<< std::endl;
+				return EXIT_FAILURE;
+			}
+			if (!mark_all_read(arg)) {
+				err << strprintf::fmt(_("%s: %s: couldn't mark articles read"),
+						"newsboat",
+						cmd)
+					<< std::endl;
+				return EXIT_FAILURE;
+			}
 		} else {
-			std::cerr
-					<< strprintf::fmt(_("%s: %s: unknown command"),
-							"newsboat",
-							cmd)
-						<< std::endl;
+			err << strprintf::fmt(_("%s: %s: unknown command"),
+					"newsboat",
+					cmd)
+				<< std::endl;
 			return EXIT_FAILURE;
 		}
 	}
@@ -1050,8 +1137,8 @@ void Controller::dump_config(const Filepath& filename) const
 
 void Controller::update_flags(std::shared_ptr<RssItem> item)
 {
-	if (api) {
-		api->update_article_flags(
+	if (outbox) {
+		outbox->update_article_flags(
 			item->oldflags(), item->flags(), item->guid());
 	}
 	item->update_flags();
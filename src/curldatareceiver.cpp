@@ -1,7 +1,18 @@
 #include "curldatareceiver.h"
 
+#include <curl/curl.h>
+
 namespace newsboat {
 
+#if LIBCURL_VERSION_NUM >= 0x073700 // 7.55.0
+namespace {
+
+// Servers can claim anything, so don't set aside more than this up front
+const curl_off_t MAX_RESERVED_SIZE = 64 * 1024 * 1024;
+
+} // namespace
+#endif
+
 std::unique_ptr<newsboat::CurlDataReceiver> CurlDataReceiver::register_data_handler(
 	CurlHandle& curlHandle)
 {
@@ -31,16 +42,27 @@ size_t CurlDataReceiver::write_callback(char* buffer, size_t size, size_t nmemb,
 	void* receiver)
 {
 	auto data_receiver = static_cast<CurlDataReceiver*>(receiver);
-	const auto data = std::string(buffer, size * nmemb);
 
-	data_receiver->handle_data(data);
+	data_receiver->handle_data(buffer, size * nmemb);
 
 	return size * nmemb;
 }
 
-void CurlDataReceiver::handle_data(const std::string& data)
+void CurlDataReceiver::handle_data(const char* data, size_t size)
 {
-	accumulated_data += data;
+#if LIBCURL_VERSION_NUM >= 0x073700 // 7.55.0
+	if (accumulated_data.empty()) {
+		// The headers are in by now, so the body can be received without
+		// growing the buffer over and over
+		curl_off_t content_length = -1;
+		if (curl_easy_getinfo(curl_handle.ptr(), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+				&content_length) == CURLE_OK
+			&& content_length > 0 && content_length <= MAX_RESERVED_SIZE) {
+			accumulated_data.reserve(content_length);
+		}
+	}
+#endif
+	accumulated_data.append(data, size);
 }
 
 } // namespace newsboat
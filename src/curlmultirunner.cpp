@@ -0,0 +1,214 @@
+#include "curlmultirunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "logger.h"
+
+namespace newsboat {
+
+namespace {
+
+const int WAIT_TIMEOUT_MS = 1000;
+
+/// How long to sleep if libcurl has no sockets to wait on, e.g. while it's
+/// resolving a name
+const std::chrono::milliseconds IDLE_SLEEP(10);
+
+} // namespace
+
+CurlMultiRunner::CurlMultiRunner(unsigned int max_transfers,
+	unsigned int max_host_connections,
+	unsigned int num_workers,
+	CurlShareHandle* share)
+	: share(share)
+	, all_dispatched(false)
+{
+	curl_multi_setopt(multi.ptr(), CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	set_limits(max_transfers, max_host_connections, num_workers);
+}
+
+void CurlMultiRunner::set_limits(unsigned int max_transfers,
+	unsigned int max_host_connections,
+	unsigned int num_workers)
+{
+	this->max_transfers = std::max(max_transfers, 1u);
+	this->max_host_connections = max_host_connections;
+	this->num_workers = std::max(num_workers, 1u);
+
+	// 0 means "no limit" to libcurl, same as for our setting
+	curl_multi_setopt(multi.ptr(), CURLMOPT_MAX_HOST_CONNECTIONS,
+		static_cast<long>(max_host_connections));
+}
+
+void CurlMultiRunner::run(std::vector<Transfer>& transfers)
+{
+	if (transfers.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+		all_dispatched = false;
+	}
+
+	const unsigned int worker_count = std::min<size_t>(num_workers, transfers.size());
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < worker_count; ++i) {
+		workers.emplace_back([&]() {
+			work(transfers);
+		});
+	}
+
+	std::map<CURL*, std::pair<size_t, std::unique_ptr<CurlHandle>>> active;
+	size_t next = 0;
+	bool multi_failed = false;
+
+	while (next < transfers.size() || !active.empty()) {
+		while (active.size() < max_transfers && next < transfers.size()) {
+			const size_t index = next++;
+			auto handle = take_handle();
+
+			bool ok = false;
+			try {
+				ok = transfers[index].setup(*handle);
+			} catch (const std::exception& e) {
+				LOG(Level::ERROR,
+					"CurlMultiRunner::run: setting up transfer #%zu failed: %s",
+					index,
+					e.what());
+			}
+
+			if (ok && !multi_failed) {
+				const CURLMcode mc = curl_multi_add_handle(multi.ptr(), handle->ptr());
+				if (mc == CURLM_OK) {
+					CURL* easy = handle->ptr();
+					active.emplace(easy, std::make_pair(index, std::move(handle)));
+					continue;
+				}
+				LOG(Level::ERROR,
+					"CurlMultiRunner::run: curl_multi_add_handle failed: %s",
+					curl_multi_strerror(mc));
+			}
+			dispatch(index, std::move(handle), CURLE_FAILED_INIT);
+		}
+
+		int still_running = 0;
+		CURLMcode mc = curl_multi_perform(multi.ptr(), &still_running);
+
+		CURLMsg* msg = nullptr;
+		int msgs_left = 0;
+		while ((msg = curl_multi_info_read(multi.ptr(), &msgs_left)) != nullptr) {
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+			CURL* easy = msg->easy_handle;
+			// `msg` is invalidated by curl_multi_remove_handle()
+			const CURLcode result = msg->data.result;
+			curl_multi_remove_handle(multi.ptr(), easy);
+
+			auto it = active.find(easy);
+			if (it != active.end()) {
+				dispatch(it->second.first, std::move(it->second.second), result);
+				active.erase(it);
+			}
+		}
+
+		if (mc == CURLM_OK && !active.empty()) {
+			int numfds = 0;
+			mc = curl_multi_wait(multi.ptr(), nullptr, 0, WAIT_TIMEOUT_MS, &numfds);
+			// Unlike curl_multi_poll() (libcurl 7.66.0 and newer),
+			// curl_multi_wait() returns right away if there's nothing to
+			// wait on
+			if (mc == CURLM_OK && numfds == 0) {
+				std::this_thread::sleep_for(IDLE_SLEEP);
+			}
+		}
+
+		if (mc != CURLM_OK) {
+			LOG(Level::ERROR,
+				"CurlMultiRunner::run: curl_multi error: %s",
+				curl_multi_strerror(mc));
+			multi_failed = true;
+			for (auto& transfer : active) {
+				curl_multi_remove_handle(multi.ptr(), transfer.first);
+				dispatch(transfer.second.first, std::move(transfer.second.second),
+					CURLE_FAILED_INIT);
+			}
+			active.clear();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+		all_dispatched = true;
+	}
+	queue_cv.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+std::unique_ptr<CurlHandle> CurlMultiRunner::take_handle()
+{
+	std::lock_guard<std::mutex> guard(handles_mutex);
+	if (idle_handles.empty()) {
+		auto handle = std::unique_ptr<CurlHandle>(new CurlHandle());
+		if (share != nullptr) {
+			share->attach(handle->ptr());
+		}
+		return handle;
+	}
+	auto handle = std::move(idle_handles.back());
+	idle_handles.pop_back();
+	return handle;
+}
+
+void CurlMultiRunner::return_handle(std::unique_ptr<CurlHandle> handle)
+{
+	std::lock_guard<std::mutex> guard(handles_mutex);
+	idle_handles.push_back(std::move(handle));
+}
+
+void CurlMultiRunner::dispatch(size_t index, std::unique_ptr<CurlHandle> handle,
+	CURLcode result)
+{
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+		completed.push_back(Completed{index, std::move(handle), result});
+	}
+	queue_cv.notify_one();
+}
+
+void CurlMultiRunner::work(std::vector<Transfer>& transfers)
+{
+	while (true) {
+		std::unique_lock<std::mutex> lock(queue_mutex);
+		queue_cv.wait(lock, [&]() {
+			return !completed.empty() || all_dispatched;
+		});
+		if (completed.empty()) {
+			return;
+		}
+		Completed c = std::move(completed.front());
+		completed.pop_front();
+		lock.unlock();
+
+		try {
+			transfers[c.index].finish(*c.handle, c.result);
+		} catch (const std::exception& e) {
+			LOG(Level::ERROR,
+				"CurlMultiRunner::work: finishing transfer #%zu failed: %s",
+				c.index,
+				e.what());
+		}
+		return_handle(std::move(c.handle));
+	}
+}
+
+} // namespace newsboat
@@ -0,0 +1,372 @@
+#include "daemon.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <limits>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "controller.h"
+#include "logger.h"
+#include "reloader.h"
+#include "strprintf.h"
+
+namespace newsboat {
+
+namespace {
+
+// A request is a handful of commands; anything bigger isn't from our client
+const size_t MAX_REQUEST_SIZE = 64 * 1024;
+
+// How long a client may take to send its request, or to accept the reply
+const std::chrono::seconds CLIENT_TIMEOUT(5);
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int /* sig */)
+{
+	stop_requested = 1;
+}
+
+bool fill_address(const Filepath& path, sockaddr_un& address)
+{
+	const std::string p = path.to_locale_string();
+	if (p.empty() || p.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, p.c_str(), p.size() + 1);
+	return true;
+}
+
+bool write_all(int fd, const std::string& data)
+{
+	size_t written = 0;
+	while (written < data.size()) {
+		const ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		written += n;
+	}
+	return true;
+}
+
+// Reads until `data` holds `size` bytes, giving up at `deadline` or if the
+// other side closes the connection first
+bool read_until(int fd, std::string& data, size_t size,
+	std::chrono::steady_clock::time_point deadline)
+{
+	char buf[4096];
+	while (data.size() < size) {
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+				deadline - std::chrono::steady_clock::now()).count();
+		if (remaining <= 0) {
+			return false;
+		}
+		pollfd pfd{fd, POLLIN, 0};
+		const int ready = ::poll(&pfd, 1, static_cast<int>(remaining));
+		if (ready < 0 && errno != EINTR) {
+			return false;
+		}
+		if (ready <= 0) {
+			continue;
+		}
+
+		const ssize_t n = ::read(fd, buf, std::min(sizeof(buf), size - data.size()));
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (n == 0) {
+			return false;
+		}
+		data.append(buf, n);
+	}
+	return true;
+}
+
+// Reads a request: its size in bytes on a line of its own, then the request
+bool read_request(int fd, std::string& request)
+{
+	const auto deadline = std::chrono::steady_clock::now() + CLIENT_TIMEOUT;
+
+	// The size line is read byte by byte, so that none of the request is
+	// consumed along with it
+	std::string header;
+	const size_t max_header_size = std::to_string(MAX_REQUEST_SIZE).size() + 1;
+	while (header.empty() || header.back() != '\n') {
+		if (header.size() == max_header_size
+			|| !read_until(fd, header, header.size() + 1, deadline)) {
+			return false;
+		}
+	}
+	if (header.size() < 2
+		|| header.find_first_not_of("0123456789") != header.size() - 1) {
+		return false;
+	}
+	const size_t size = std::stoul(header);
+	if (size > MAX_REQUEST_SIZE) {
+		return false;
+	}
+
+	return read_until(fd, request, size, deadline);
+}
+
+// Reads until the other side shuts down its end of the connection
+bool read_all(int fd, std::string& data, size_t limit)
+{
+	char buf[4096];
+	for (;;) {
+		const ssize_t n = ::read(fd, buf, sizeof(buf));
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (n == 0) {
+			return true;
+		}
+		data.append(buf, n);
+		if (data.size() > limit) {
+			return false;
+		}
+	}
+}
+
+std::string prefix_lines(const std::string& prefix, const std::string& text)
+{
+	std::string result;
+	std::istringstream lines(text);
+	std::string line;
+	while (std::getline(lines, line)) {
+		result += prefix + line + "\n";
+	}
+	return result;
+}
+
+} // namespace
+
+Daemon::Daemon(Controller& ctrl, const Filepath& socket_path)
+	: ctrl(ctrl)
+	, path(socket_path)
+	, listen_fd(-1)
+{
+}
+
+Daemon::~Daemon()
+{
+	if (listen_fd >= 0) {
+		::close(listen_fd);
+		::unlink(path.to_locale_string().c_str());
+	}
+}
+
+Filepath Daemon::socket_path(const Filepath& cache_file)
+{
+	Filepath result = cache_file;
+	result.add_extension("sock");
+	return result;
+}
+
+int Daemon::run()
+{
+	if (!listen()) {
+		return EXIT_FAILURE;
+	}
+
+	struct sigaction action {};
+	action.sa_handler = request_stop;
+	sigemptyset(&action.sa_mask);
+	::sigaction(SIGINT, &action, nullptr);
+	::sigaction(SIGTERM, &action, nullptr);
+
+	LOG(Level::INFO, "Daemon::run: listening on %s", path);
+	ctrl.get_reloader()->spawn_reloadthread(true);
+
+	while (!stop_requested) {
+		// The timeout makes sure a signal that arrives right before poll()
+		// isn't missed for long
+		serve_client(std::chrono::seconds(1));
+	}
+
+	LOG(Level::INFO, "Daemon::run: stopping");
+	return EXIT_SUCCESS;
+}
+
+bool Daemon::listen()
+{
+	sockaddr_un address;
+	if (!fill_address(path, address)) {
+		std::cerr << strprintf::fmt(_("Error: socket path `%s' is too long"), path)
+			<< std::endl;
+		return false;
+	}
+
+	listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0) {
+		std::cerr << strprintf::fmt(_("Error: couldn't create socket: %s"),
+				std::strerror(errno))
+			<< std::endl;
+		return false;
+	}
+	// Programs run by Newsboat (notify-program, exec: feeds etc.) shouldn't
+	// keep the socket open
+	::fcntl(listen_fd, F_SETFD, FD_CLOEXEC);
+
+	// We hold the lock on the cache, so a socket that's still there was left
+	// behind by a daemon which didn't get to clean up
+	::unlink(address.sun_path);
+
+	// Only the user may send commands. Nobody can connect before listen(),
+	// so the socket's permissions can be fixed after it's created rather than
+	// through the process-wide umask.
+	if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+			sizeof(address)) != 0
+		|| ::chmod(address.sun_path, S_IRUSR | S_IWUSR) != 0
+		|| ::listen(listen_fd, 16) != 0) {
+		std::cerr << strprintf::fmt(_("Error: couldn't listen on `%s': %s"),
+				path,
+				std::strerror(errno))
+			<< std::endl;
+		::close(listen_fd);
+		listen_fd = -1;
+		return false;
+	}
+	return true;
+}
+
+bool Daemon::serve_client(std::chrono::milliseconds timeout)
+{
+	pollfd pfd{listen_fd, POLLIN, 0};
+	const int ready = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+	if (ready <= 0) {
+		return false;
+	}
+
+	const int client = ::accept(listen_fd, nullptr, nullptr);
+	if (client < 0) {
+		LOG(Level::WARN, "Daemon::serve_client: accept() failed: %s",
+			std::strerror(errno));
+		return false;
+	}
+	serve(client);
+	::close(client);
+	return true;
+}
+
+void Daemon::serve(int client)
+{
+	// A client that doesn't read its reply mustn't block us either
+	const timeval send_timeout{CLIENT_TIMEOUT.count(), 0};
+	::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &send_timeout,
+		sizeof(send_timeout));
+
+	std::string request;
+	if (!read_request(client, request)) {
+		LOG(Level::WARN, "Daemon::serve: couldn't read request");
+		return;
+	}
+
+	std::vector<std::string> cmds;
+	std::istringstream lines(request);
+	std::string line;
+	while (std::getline(lines, line)) {
+		if (!line.empty()) {
+			cmds.push_back(line);
+		}
+	}
+	LOG(Level::DEBUG, "Daemon::serve: got %" PRIu64 " commands",
+		static_cast<uint64_t>(cmds.size()));
+
+	std::ostringstream out;
+	std::ostringstream err;
+	int code = EXIT_FAILURE;
+	try {
+		code = ctrl.execute_commands(cmds, out, err);
+	} catch (const std::exception& e) {
+		err << e.what() << std::endl;
+	}
+
+	const std::string response = prefix_lines("out ", out.str())
+		+ prefix_lines("err ", err.str())
+		+ "exit " + std::to_string(code) + "\n";
+	if (!write_all(client, response)) {
+		LOG(Level::WARN, "Daemon::serve: client went away before the reply");
+	}
+}
+
+std::optional<int> Daemon::forward_commands(const Filepath& socket_path,
+	const std::vector<std::string>& cmds,
+	std::ostream& out,
+	std::ostream& err)
+{
+	sockaddr_un address;
+	if (!fill_address(socket_path, address)) {
+		return std::nullopt;
+	}
+
+	const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return std::nullopt;
+	}
+	if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+		// Nobody is listening; the commands have to be run by this process
+		::close(fd);
+		return std::nullopt;
+	}
+	LOG(Level::INFO, "Daemon::forward_commands: sending commands to %s", socket_path);
+
+	std::string request;
+	for (const auto& cmd : cmds) {
+		request += cmd + "\n";
+	}
+	request = std::to_string(request.size()) + "\n" + request;
+
+	std::string response;
+	const bool ok = write_all(fd, request)
+		&& ::shutdown(fd, SHUT_WR) == 0
+		&& read_all(fd, response, std::numeric_limits<size_t>::max());
+	::close(fd);
+
+	std::optional<int> code;
+	std::istringstream lines(response);
+	std::string line;
+	while (ok && std::getline(lines, line)) {
+		if (line.compare(0, 4, "out ") == 0) {
+			out << line.substr(4) << std::endl;
+		} else if (line.compare(0, 4, "err ") == 0) {
+			err << line.substr(4) << std::endl;
+		} else if (line.compare(0, 5, "exit ") == 0) {
+			code = std::atoi(line.c_str() + 5);
+		}
+	}
+
+	if (!code.has_value()) {
+		err << _("Error: lost connection to the daemon") << std::endl;
+		return EXIT_FAILURE;
+	}
+	return code;
+}
+
+} // namespace newsboat
@@ -0,0 +1,755 @@
+#include "downloadengine.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <libgen.h>
+#include <stdexcept>
+#include <strings.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "curlhandle.h"
+#include "logger.h"
+#include "segmentedfile.h"
+#include "utils.h"
+
+using namespace newsboat;
+
+namespace podboat {
+
+namespace {
+
+// How often a single download reports its progress to the UI
+const std::chrono::milliseconds PROGRESS_INTERVAL(250);
+
+// Longest time the event loop sleeps without looking at new commands
+const int POLL_TIMEOUT_MS = 1000;
+
+// Segments are at least this big, and there are at most MAX_SEGMENTS of them.
+// Both only depend on the size of the file, so that an interrupted download
+// is split the same way when it's resumed.
+const std::uint64_t MIN_SEGMENT_SIZE = 4 * 1024 * 1024;
+const std::uint64_t MAX_SEGMENTS = 256;
+
+bool exists(const Filepath& path)
+{
+	struct stat sb;
+	return stat(path.to_locale_string().c_str(), &sb) == 0;
+}
+
+void create_parent_directories(const Filepath& path)
+{
+	const auto path_str = path.to_locale_string();
+	// Have to copy the string into a vector in order to be able to
+	// get a char* pointer. std::string::c_str() won't do because it
+	// returns const char*, whereas ::dirname() needs non-const.
+	std::vector<char> directory(path_str.begin(), path_str.end());
+	directory.push_back('\0');
+	utils::mkdir_parents(Filepath::from_locale_string(dirname(&directory[0])));
+}
+
+unsigned int segment_count(std::uint64_t size)
+{
+	const std::uint64_t segment_size = std::max(MIN_SEGMENT_SIZE,
+			size / MAX_SEGMENTS);
+	return (size + segment_size - 1) / segment_size;
+}
+
+} // namespace
+
+struct DownloadEngine::Transfer {
+	enum class Kind {
+		// The whole file, or the rest of it after a partial download
+		STREAM,
+		// Asks for the first byte, to find out if the server supports ranges
+		PROBE,
+		// One segment of a segmented download
+		SEGMENT,
+	};
+
+	Transfer(DownloadEngine& engine_, Kind kind_, const Command& command)
+		: engine(engine_)
+		, kind(kind_)
+		, id(command.id)
+		, url(command.url)
+		, filename(command.filename)
+		, partial(command.filename)
+		, resumed(false)
+		, offset(0)
+		, bytecount(0)
+		, started(std::chrono::steady_clock::now())
+		, last_report(started)
+		, probed_size(0)
+		, job(nullptr)
+		, segment(0)
+		, first(0)
+		, length(0)
+		, max_recv_speed(0)
+	{
+		partial.add_extension(ConfigContainer::PARTIAL_FILE_SUFFIX);
+	}
+
+	Command command() const
+	{
+		return Command{id, false, url, filename};
+	}
+
+	bool has_partial_content()
+	{
+		long code = 0;
+		curl_easy_getinfo(handle.ptr(), CURLINFO_RESPONSE_CODE, &code);
+		return code == 206;
+	}
+
+	DownloadEngine& engine;
+	const Kind kind;
+	const unsigned int id;
+	const std::string url;
+	const Filepath filename;
+	Filepath partial;
+	CurlHandle handle;
+
+	// STREAM
+	std::ofstream f;
+	bool resumed;
+	unsigned long offset;
+	size_t bytecount;
+	std::chrono::steady_clock::time_point started;
+	std::chrono::steady_clock::time_point last_report;
+
+	// PROBE: total size from the Content-Range header
+	std::uint64_t probed_size;
+
+	// SEGMENT: bytes [first, first + length) of the file
+	Segmented* job;
+	unsigned int segment;
+	std::uint64_t first;
+	std::uint64_t length;
+
+	// CURLOPT_MAX_RECV_SPEED_LARGE as last set by share_bandwidth(), 0 if
+	// it wasn't set yet
+	curl_off_t max_recv_speed;
+};
+
+struct DownloadEngine::Segmented {
+	Segmented(const Command& command_, unsigned int connections_)
+		: command(command_)
+		, partial(command_.filename)
+		, connections(connections_)
+		, next_segment(0)
+		, running(0)
+		, offset(0)
+		, bytecount(0)
+		, started(std::chrono::steady_clock::now())
+		, last_report(started)
+	{
+		partial.add_extension(ConfigContainer::PARTIAL_FILE_SUFFIX);
+	}
+
+	const Command command;
+	Filepath partial;
+	SegmentedFile file;
+	const unsigned int connections;
+	unsigned int next_segment;
+	unsigned int running;
+	std::uint64_t offset;
+	std::uint64_t bytecount;
+	std::chrono::steady_clock::time_point started;
+	std::chrono::steady_clock::time_point last_report;
+};
+
+DownloadEngine::DownloadEngine(ConfigContainer& c)
+	: cfg(c)
+	, last_id(0)
+	, stopping(false)
+{
+	if (pipe2(event_pipe, O_NONBLOCK | O_CLOEXEC) == -1) {
+		throw std::runtime_error(std::string("Can't create pipe: ") +
+			strerror(errno));
+	}
+	if (pipe2(wakeup_pipe, O_NONBLOCK | O_CLOEXEC) == -1) {
+		const std::string error = strerror(errno);
+		close(event_pipe[0]);
+		close(event_pipe[1]);
+		throw std::runtime_error("Can't create pipe: " + error);
+	}
+
+	const int max_host_connections =
+		cfg.get_configvalue_as_int("max-download-host-connections");
+	if (max_host_connections > 0) {
+		curl_multi_setopt(multi.ptr(), CURLMOPT_MAX_HOST_CONNECTIONS,
+			static_cast<long>(max_host_connections));
+	}
+
+	thread = std::thread(&DownloadEngine::run, this);
+}
+
+DownloadEngine::~DownloadEngine()
+{
+	{
+		std::lock_guard<std::mutex> guard(commands_mutex);
+		stopping = true;
+	}
+	wake_up();
+	thread.join();
+
+	close(event_pipe[0]);
+	close(event_pipe[1]);
+	close(wakeup_pipe[0]);
+	close(wakeup_pipe[1]);
+}
+
+void DownloadEngine::start(Download& dl)
+{
+	const unsigned int id = ++last_id;
+	active[id] = &dl;
+	dl.set_status(DlStatus::DOWNLOADING);
+
+	{
+		std::lock_guard<std::mutex> guard(commands_mutex);
+		commands.push_back(Command{id, false, dl.url(), dl.filename()});
+	}
+	wake_up();
+}
+
+void DownloadEngine::cancel(Download& dl)
+{
+	dl.set_status(DlStatus::CANCELLED);
+
+	const auto it = std::find_if(active.begin(), active.end(),
+	[&](const std::pair<const unsigned int, Download*>& entry) {
+		return entry.second == &dl;
+	});
+	if (it == active.end()) {
+		return;
+	}
+	const unsigned int id = it->first;
+	active.erase(it);
+
+	{
+		std::lock_guard<std::mutex> guard(commands_mutex);
+		commands.push_back(Command{id, true, {}, {}});
+	}
+	wake_up();
+}
+
+int DownloadEngine::event_fd() const
+{
+	return event_pipe[0];
+}
+
+void DownloadEngine::process_events()
+{
+	std::vector<Event> pending;
+	{
+		std::lock_guard<std::mutex> guard(events_mutex);
+		// Drain the pipe while holding the lock, so that we can't swallow
+		// the wakeup for an event that isn't in `pending`
+		char buf[64];
+		while (read(event_pipe[0], buf, sizeof(buf)) > 0) {
+		}
+		pending.swap(events);
+	}
+
+	for (const auto& event : pending) {
+		const auto it = active.find(event.id);
+		if (it == active.end()) {
+			continue;
+		}
+		Download* dl = it->second;
+
+		if (event.status == DlStatus::DOWNLOADING) {
+			if (dl->status() == DlStatus::DOWNLOADING) {
+				dl->set_offset(event.offset);
+				dl->set_kbps(event.kbps);
+				dl->set_progress(event.downloaded, event.total);
+			}
+		} else {
+			dl->set_status(event.status, event.msg);
+			active.erase(it);
+		}
+	}
+}
+
+void DownloadEngine::run()
+{
+	curl_waitfd wakeup;
+	wakeup.fd = wakeup_pipe[0];
+	wakeup.events = CURL_WAIT_POLLIN;
+
+	while (true) {
+		// Drained before looking at the commands, so that a command which
+		// comes in afterwards wakes us up again
+		char buf[64];
+		while (read(wakeup_pipe[0], buf, sizeof(buf)) > 0) {
+		}
+
+		std::vector<Command> todo;
+		{
+			std::lock_guard<std::mutex> guard(commands_mutex);
+			if (stopping) {
+				break;
+			}
+			todo.swap(commands);
+		}
+
+		for (const auto& command : todo) {
+			if (command.cancel) {
+				stop_transfer(command.id);
+			} else {
+				start_transfer(command);
+			}
+		}
+		share_bandwidth();
+
+		int still_running = 0;
+		curl_multi_perform(multi.ptr(), &still_running);
+
+		CURLMsg* msg;
+		int msgs_left;
+		while ((msg = curl_multi_info_read(multi.ptr(), &msgs_left))) {
+			if (msg->msg == CURLMSG_DONE) {
+				finish_transfer(msg->easy_handle, msg->data.result);
+			}
+		}
+		share_bandwidth();
+
+		wakeup.revents = 0;
+		curl_multi_wait(multi.ptr(), &wakeup, 1, POLL_TIMEOUT_MS, nullptr);
+	}
+
+	// Partial files are kept so that the downloads can be resumed later
+	for (auto& entry : transfers) {
+		curl_multi_remove_handle(multi.ptr(), entry.first);
+	}
+	transfers.clear();
+	segmented.clear();
+}
+
+void DownloadEngine::start_transfer(const Command& command)
+{
+	Filepath partial = command.filename;
+	partial.add_extension(ConfigContainer::PARTIAL_FILE_SUFFIX);
+
+	// A partial file without a journal can only be resumed as a whole
+	if (SegmentedFile::has_journal(partial) || (!exists(partial)
+			&& cfg.get_configvalue_as_int("download-segments") > 1)) {
+		start_probe(command);
+	} else {
+		start_stream(command);
+	}
+}
+
+DownloadEngine::Transfer& DownloadEngine::add_transfer(
+	std::unique_ptr<Transfer> transfer)
+{
+	CURL* easy = transfer->handle.ptr();
+
+	utils::set_common_curl_options(transfer->handle, cfg);
+
+	curl_easy_setopt(easy, CURLOPT_URL, transfer->url.c_str());
+	curl_easy_setopt(easy, CURLOPT_TIMEOUT, 0);
+	curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_callback);
+	curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+	curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0);
+	curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, progress_callback);
+	curl_easy_setopt(easy, CURLOPT_XFERINFODATA, transfer.get());
+
+	curl_multi_add_handle(multi.ptr(), easy);
+	return *transfers.emplace(easy, std::move(transfer)).first->second;
+}
+
+void DownloadEngine::start_stream(const Command& command)
+{
+	auto transfer = std::make_unique<Transfer>(*this, Transfer::Kind::STREAM,
+			command);
+
+	const std::string partial = transfer->partial.to_locale_string();
+	struct stat sb;
+	if (stat(partial.c_str(), &sb) == -1) {
+		LOG(Level::INFO,
+			"DownloadEngine::start_stream: stat failed: starting normal "
+			"download");
+
+		create_parent_directories(transfer->partial);
+		transfer->f.open(partial, std::fstream::out);
+	} else {
+		LOG(Level::INFO,
+			"DownloadEngine::start_stream: stat ok: starting download "
+			"from %" PRIi64,
+			static_cast<int64_t>(sb.st_size));
+		curl_easy_setopt(transfer->handle.ptr(), CURLOPT_RESUME_FROM_LARGE,
+			static_cast<curl_off_t>(sb.st_size));
+		transfer->offset = sb.st_size;
+		transfer->resumed = true;
+		transfer->f.open(partial, std::fstream::out | std::fstream::app);
+	}
+
+	if (!transfer->f.is_open()) {
+		push_event(Event{command.id, DlStatus::FAILED, strerror(errno), 0, 0, 0, 0});
+		return;
+	}
+
+	push_event(Event{command.id, DlStatus::DOWNLOADING, {}, transfer->offset, 0, 0, 0});
+
+	add_transfer(std::move(transfer));
+}
+
+void DownloadEngine::start_probe(const Command& command)
+{
+	LOG(Level::DEBUG, "DownloadEngine::start_probe: checking if %s supports "
+		"range requests", command.url);
+
+	auto transfer = std::make_unique<Transfer>(*this, Transfer::Kind::PROBE,
+			command);
+	curl_easy_setopt(transfer->handle.ptr(), CURLOPT_RANGE, "0-0");
+	curl_easy_setopt(transfer->handle.ptr(), CURLOPT_HEADERFUNCTION,
+		header_callback);
+	curl_easy_setopt(transfer->handle.ptr(), CURLOPT_HEADERDATA, transfer.get());
+
+	add_transfer(std::move(transfer));
+}
+
+void DownloadEngine::start_segmented(const Command& command,
+	std::uint64_t size)
+{
+	const unsigned int connections = std::max(1,
+			cfg.get_configvalue_as_int("download-segments"));
+	auto job = std::make_unique<Segmented>(command, connections);
+
+	create_parent_directories(job->partial);
+	if (!job->file.open(job->partial, size, segment_count(size))) {
+		push_event(Event{command.id, DlStatus::FAILED, strerror(errno), 0, 0, 0, 0});
+		return;
+	}
+
+	job->offset = job->file.completed_bytes();
+	LOG(Level::INFO,
+		"DownloadEngine::start_segmented: %u segments of %s, %" PRIu64
+		" of %" PRIu64 " bytes done",
+		job->file.segment_count(),
+		command.url,
+		job->offset,
+		size);
+	push_event(Event{command.id, DlStatus::DOWNLOADING, {},
+			static_cast<unsigned long>(job->offset), 0,
+			static_cast<double>(size - job->offset), 0});
+
+	Segmented& added = *segmented.emplace(command.id, std::move(job)).first->second;
+	start_segments(added);
+}
+
+void DownloadEngine::start_segments(Segmented& job)
+{
+	SegmentedFile& file = job.file;
+	while (job.running < job.connections) {
+		while (job.next_segment < file.segment_count()
+			&& file.is_done(job.next_segment)) {
+			++job.next_segment;
+		}
+		if (job.next_segment == file.segment_count()) {
+			break;
+		}
+
+		auto transfer = std::make_unique<Transfer>(*this, Transfer::Kind::SEGMENT,
+				job.command);
+		transfer->job = &job;
+		transfer->segment = job.next_segment;
+		std::tie(transfer->first, transfer->length) = file.segment(job.next_segment);
+		const std::string range = std::to_string(transfer->first) + "-" +
+			std::to_string(transfer->first + transfer->length - 1);
+		curl_easy_setopt(transfer->handle.ptr(), CURLOPT_RANGE, range.c_str());
+
+		add_transfer(std::move(transfer));
+		++job.next_segment;
+		++job.running;
+	}
+
+	if (job.running == 0) {
+		const unsigned int id = job.command.id;
+		const Filepath partial = job.partial;
+		const Filepath filename = job.command.filename;
+		segmented.erase(id);
+		finish_download(id, partial, filename);
+	}
+}
+
+void DownloadEngine::stop_transfer(unsigned int id)
+{
+	for (auto it = transfers.begin(); it != transfers.end();) {
+		if (it->second->id == id) {
+			LOG(Level::INFO, "DownloadEngine::stop_transfer: cancelling %s",
+				it->second->url);
+			curl_multi_remove_handle(multi.ptr(), it->first);
+			it = transfers.erase(it);
+		} else {
+			++it;
+		}
+	}
+	segmented.erase(id);
+}
+
+void DownloadEngine::finish_transfer(CURL* easy, CURLcode result)
+{
+	const auto it = transfers.find(easy);
+	if (it == transfers.end()) {
+		return;
+	}
+	curl_multi_remove_handle(multi.ptr(), easy);
+	std::unique_ptr<Transfer> transfer = std::move(it->second);
+	transfers.erase(it);
+
+	LOG(Level::INFO,
+		"DownloadEngine::finish_transfer: rc = %u (%s)",
+		result,
+		curl_easy_strerror(result));
+
+	switch (transfer->kind) {
+	case Transfer::Kind::STREAM:
+		finish_stream(*transfer, result);
+		break;
+	case Transfer::Kind::PROBE:
+		finish_probe(*transfer, result);
+		break;
+	case Transfer::Kind::SEGMENT:
+		finish_segment(*transfer, result);
+		break;
+	}
+}
+
+void DownloadEngine::finish_stream(Transfer& transfer, CURLcode result)
+{
+	transfer.f.close();
+
+	const std::string partial = transfer.partial.to_locale_string();
+	if (result == CURLE_OK) {
+		finish_download(transfer.id, transfer.partial, transfer.filename);
+	} else if (transfer.resumed) {
+		// attempt complete re-download
+		::unlink(partial.c_str());
+		start_stream(transfer.command());
+	} else {
+		::unlink(partial.c_str());
+		push_event(Event{transfer.id, DlStatus::FAILED, curl_easy_strerror(result), 0, 0, 0, 0});
+	}
+}
+
+void DownloadEngine::finish_probe(Transfer& transfer, CURLcode result)
+{
+	// A server without range support answers with the whole file, which the
+	// write callback refuses, so `result` doesn't tell us much here
+	if (transfer.has_partial_content() && transfer.probed_size > 0
+		&& segment_count(transfer.probed_size) > 1) {
+		start_segmented(transfer.command(), transfer.probed_size);
+		return;
+	}
+
+	LOG(Level::INFO,
+		"DownloadEngine::finish_probe: not splitting %s (rc = %u, size = %"
+		PRIu64 ")",
+		transfer.url,
+		result,
+		transfer.probed_size);
+
+	// A journal is of no use if the file can't be downloaded in segments
+	if (SegmentedFile::has_journal(transfer.partial)) {
+		::unlink(SegmentedFile::journal_path(transfer.partial).to_locale_string().c_str());
+		::unlink(transfer.partial.to_locale_string().c_str());
+	}
+	start_stream(transfer.command());
+}
+
+void DownloadEngine::finish_segment(Transfer& transfer, CURLcode result)
+{
+	Segmented& job = *transfer.job;
+	--job.running;
+
+	std::string error;
+	if (result != CURLE_OK) {
+		error = curl_easy_strerror(result);
+	} else if (transfer.bytecount != transfer.length) {
+		error = "Server sent an incomplete segment";
+	} else if (!job.file.mark_done(transfer.segment)) {
+		error = strerror(errno);
+	}
+
+	if (error.empty()) {
+		start_segments(job);
+		return;
+	}
+
+	// The segments that are done stay in the journal, so the download can be
+	// resumed later
+	LOG(Level::INFO,
+		"DownloadEngine::finish_segment: segment %u of %s failed: %s",
+		transfer.segment,
+		transfer.url,
+		error);
+	const unsigned int id = transfer.id;
+	stop_transfer(id);
+	push_event(Event{id, DlStatus::FAILED, error, 0, 0, 0, 0});
+}
+
+void DownloadEngine::finish_download(unsigned int id, const Filepath& partial,
+	const Filepath& filename)
+{
+	LOG(Level::DEBUG,
+		"DownloadEngine::finish_download: download complete, deleting "
+		"temporary suffix");
+	if (rename(partial.to_locale_string().c_str(),
+			filename.to_locale_string().c_str()) == 0) {
+		::unlink(SegmentedFile::journal_path(partial).to_locale_string().c_str());
+		push_event(Event{id, DlStatus::READY, {}, 0, 0, 0, 0});
+	} else {
+		push_event(Event{id, DlStatus::RENAME_FAILED, strerror(errno), 0, 0, 0, 0});
+	}
+}
+
+void DownloadEngine::share_bandwidth()
+{
+	const int max_dl_speed = cfg.get_configvalue_as_int("max-download-speed");
+	if (max_dl_speed <= 0 || transfers.empty()) {
+		return;
+	}
+
+	std::map<unsigned int, size_t> handles_per_download;
+	for (const auto& entry : transfers) {
+		++handles_per_download[entry.second->id];
+	}
+
+	// Each download gets the same share, no matter how many segments it
+	// fetches at once
+	const curl_off_t total = static_cast<curl_off_t>(max_dl_speed) * 1024;
+	const curl_off_t per_download = total / handles_per_download.size();
+	for (auto& entry : transfers) {
+		const curl_off_t share = std::max<curl_off_t>(1,
+				per_download / handles_per_download[entry.second->id]);
+		// Transfers replace each other within a single step (a probe by the
+		// stream, a segment by the next one), so the limit is tracked per
+		// transfer rather than by how many of them there are
+		if (entry.second->max_recv_speed != share) {
+			curl_easy_setopt(entry.first, CURLOPT_MAX_RECV_SPEED_LARGE, share);
+			entry.second->max_recv_speed = share;
+		}
+	}
+}
+
+void DownloadEngine::wake_up()
+{
+	const char c = 0;
+	if (write(wakeup_pipe[1], &c, 1) == -1 && errno != EAGAIN) {
+		LOG(Level::ERROR, "DownloadEngine::wake_up: write failed: %s",
+			strerror(errno));
+	}
+}
+
+void DownloadEngine::push_event(Event event)
+{
+	std::lock_guard<std::mutex> guard(events_mutex);
+	const bool was_empty = events.empty();
+	events.push_back(std::move(event));
+	if (was_empty) {
+		const char c = 0;
+		if (write(event_pipe[1], &c, 1) == -1 && errno != EAGAIN) {
+			LOG(Level::ERROR, "DownloadEngine::push_event: write failed: %s",
+				strerror(errno));
+		}
+	}
+}
+
+size_t DownloadEngine::write_callback(char* buffer, size_t size, size_t nmemb,
+	void* userp)
+{
+	Transfer* transfer = static_cast<Transfer*>(userp);
+	const size_t len = size * nmemb;
+
+	switch (transfer->kind) {
+	case Transfer::Kind::STREAM:
+		transfer->f.write(buffer, len);
+		transfer->bytecount += len;
+		return transfer->f.bad() ? 0 : len;
+	case Transfer::Kind::PROBE:
+		// Don't download the whole file if the server ignored the range
+		return transfer->has_partial_content() ? len : 0;
+	case Transfer::Kind::SEGMENT:
+		if (!transfer->has_partial_content()
+			|| transfer->bytecount + len > transfer->length
+			|| !transfer->job->file.write(transfer->first + transfer->bytecount,
+				buffer, len)) {
+			return 0;
+		}
+		transfer->bytecount += len;
+		transfer->job->bytecount += len;
+		return len;
+	}
+	return 0;
+}
+
+size_t DownloadEngine::header_callback(char* buffer, size_t size,
+	size_t nitems, void* userp)
+{
+	Transfer* transfer = static_cast<Transfer*>(userp);
+	const std::string header(buffer, size * nitems);
+
+	// Content-Range: bytes 0-0/<size>
+	const std::string name = "content-range:";
+	if (header.size() > name.size()
+		&& strncasecmp(header.c_str(), name.c_str(), name.size()) == 0) {
+		const auto slash = header.rfind('/');
+		if (slash != std::string::npos) {
+			transfer->probed_size = std::strtoull(header.c_str() + slash + 1,
+					nullptr, 10);
+		}
+	}
+	return size * nitems;
+}
+
+int DownloadEngine::progress_callback(void* clientp, curl_off_t dltotal,
+	curl_off_t dlnow, curl_off_t /* ultotal */, curl_off_t /* ulnow */)
+{
+	using fpseconds = std::chrono::duration<double>;
+
+	Transfer* transfer = static_cast<Transfer*>(clientp);
+	if (transfer->kind == Transfer::Kind::PROBE) {
+		return 0;
+	}
+
+	// Segments report the progress of the whole download
+	Segmented* job = transfer->job;
+	auto& last_report = job ? job->last_report : transfer->last_report;
+	const auto now = std::chrono::steady_clock::now();
+	if (now - last_report < PROGRESS_INTERVAL) {
+		return 0;
+	}
+	last_report = now;
+
+	const auto started = job ? job->started : transfer->started;
+	const double bytecount = job ? job->bytecount : transfer->bytecount;
+	const double elapsed =
+		std::chrono::duration_cast<fpseconds>(now - started).count();
+	const double kbps = (bytecount / elapsed) / 1024;
+
+	if (job) {
+		transfer->engine.push_event(Event{transfer->id, DlStatus::DOWNLOADING, {},
+				static_cast<unsigned long>(job->offset),
+				bytecount,
+				static_cast<double>(job->file.size() - job->offset),
+				kbps});
+	} else {
+		transfer->engine.push_event(Event{transfer->id, DlStatus::DOWNLOADING, {},
+				transfer->offset,
+				static_cast<double>(dlnow),
+				static_cast<double>(dltotal),
+				kbps});
+	}
+	return 0;
+}
+
+} // namespace podboat
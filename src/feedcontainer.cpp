@@ -1,11 +1,10 @@
 #include "feedcontainer.h"
 
 #include <algorithm> // stable_sort
-#include <numeric>   // accumulate
-#include <unordered_set>
 
 #include "logger.h"
 #include "rssfeed.h"
+#include "sortbykey.h"
 
 namespace newsboat {
 
@@ -26,20 +25,18 @@ void FeedContainer::sort_feeds(const FeedSortStrategy& sort_strategy)
 		});
 		break;
 	case FeedSortMethod::FIRST_TAG:
-		std::stable_sort(
-			feeds.begin(), feeds.end(),
-		[&](std::shared_ptr<RssFeed> a, std::shared_ptr<RssFeed> b) {
-			if (a->get_firsttag().length() == 0 ||
-				b->get_firsttag().length() == 0) {
-				bool result =
-					a->get_firsttag().length() > b->get_firsttag().length();
+		sort_by_key(feeds,
+		[](const std::shared_ptr<RssFeed>& feed) {
+			return feed->get_firsttag();
+		},
+		[&](const std::string& left, const std::string& right) {
+			if (left.length() == 0 || right.length() == 0) {
+				bool result = left.length() > right.length();
 				if (sort_strategy.sd == SortDirection::ASC) {
 					result = !result;
 				}
 				return result;
 			}
-			const auto left = a->get_firsttag();
-			const auto right = b->get_firsttag();
 			bool result = utils::strnaturalcmp(left, right) < 0;
 			if (sort_strategy.sd == SortDirection::ASC) {
 				result = !result;
@@ -48,11 +45,11 @@ void FeedContainer::sort_feeds(const FeedSortStrategy& sort_strategy)
 		});
 		break;
 	case FeedSortMethod::TITLE:
-		std::stable_sort(
-			feeds.begin(), feeds.end(),
-		[&](std::shared_ptr<RssFeed> a, std::shared_ptr<RssFeed> b) {
-			const auto left = a->title();
-			const auto right = b->title();
+		sort_by_key(feeds,
+		[](const std::shared_ptr<RssFeed>& feed) {
+			return feed->title();
+		},
+		[&](const std::string& left, const std::string& right) {
 			if (sort_strategy.sd == SortDirection::ASC) {
 				return utils::strnaturalcmp(left, right) > 0;
 			} else {
@@ -186,6 +183,7 @@ void FeedContainer::mark_all_feeds_read()
 void FeedContainer::add_feed(const std::shared_ptr<RssFeed> feed)
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	feed->set_unread_index(unread_index);
 	feeds.push_back(feed);
 }
 
@@ -284,7 +282,13 @@ void FeedContainer::set_feeds(
 	const std::vector<std::shared_ptr<RssFeed>>& new_feeds)
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	for (const auto& feed : feeds) {
+		feed->set_unread_index(nullptr);
+	}
 	feeds = new_feeds;
+	for (const auto& feed : feeds) {
+		feed->set_unread_index(unread_index);
+	}
 }
 
 std::vector<std::shared_ptr<RssFeed>> FeedContainer::get_all_feeds() const
@@ -305,33 +309,11 @@ unsigned int FeedContainer::unread_feed_count() const
 
 unsigned int FeedContainer::unread_item_count() const
 {
-	std::lock_guard<std::mutex> feedslock(feeds_mutex);
-
-	using guid_set = std::unordered_set<std::string>;
-	const auto unread_guids =
-		std::accumulate(feeds.begin(),
-			feeds.end(),
-			guid_set(),
-	[](guid_set guids, const std::shared_ptr<RssFeed> feed) {
-		// Hidden feeds can't be viewed. The only way to read their articles is
-		// via a query feed; items that aren't in query feeds are completely
-		// inaccessible. Thus, we skip hidden feeds altogether to avoid
-		// counting items that can't be accessed.
-		if (feed->hidden()) {
-			return guids;
-		}
-
-		std::lock_guard<std::mutex> itemslock(feed->item_mutex);
-		for (const auto& item : feed->items()) {
-			if (item->unread()) {
-				guids.insert(item->guid());
-			}
-		}
-
-		return guids;
-	});
-
-	return unread_guids.size();
+	// Hidden feeds can't be viewed. The only way to read their articles is
+	// via a query feed; items that aren't in query feeds are completely
+	// inaccessible. Thus, hidden feeds don't add their articles to the index,
+	// to avoid counting items that can't be accessed.
+	return unread_index->size();
 }
 
 void FeedContainer::replace_feed(unsigned int pos,
@@ -339,7 +321,9 @@ void FeedContainer::replace_feed(unsigned int pos,
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
 	assert(pos < feeds.size());
+	feeds[pos]->set_unread_index(nullptr);
 	feeds[pos] = feed;
+	feed->set_unread_index(unread_index);
 }
 
 } // namespace newsboat
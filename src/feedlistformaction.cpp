@@ -65,6 +65,7 @@ void FeedListFormAction::init()
 
 void FeedListFormAction::prepare()
 {
+	ScopeMeasure sm("FeedListFormAction::prepare");
 	set_keymap_hints();
 
 	const auto sort_strategy = cfg->get_feed_sort_strategy();
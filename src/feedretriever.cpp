@@ -16,12 +16,23 @@
 #include "rss/exception.h"
 #include "rss/parser.h"
 #include "rssignores.h"
+#include "scopemeasure.h"
 #include "strprintf.h"
 #include "ttrssapi.h"
 #include "utils.h"
 
 namespace newsboat {
 
+FeedRetriever::HttpDownload::HttpDownload()
+	: lastmodified(0)
+{
+}
+
+FeedRetriever::HttpDownload::HttpDownload(HttpDownload&&) = default;
+FeedRetriever::HttpDownload& FeedRetriever::HttpDownload::operator=(
+	HttpDownload&&) = default;
+FeedRetriever::HttpDownload::~HttpDownload() = default;
+
 FeedRetriever::FeedRetriever(ConfigContainer& cfg, Cache& ch, CurlHandle&
 	easyhandle, RssIgnores* ign, RemoteApi* api)
 	: cfg(cfg)
@@ -34,6 +45,7 @@ FeedRetriever::FeedRetriever(ConfigContainer& cfg, Cache& ch, CurlHandle&
 
 rsspp::Feed FeedRetriever::retrieve(const std::string& uri)
 {
+	ScopeMeasure sm("FeedRetriever::retrieve", uri);
 	/*
 	 *	- http:// and https:// URLs are downloaded and parsed regularly
 	 *	- exec: URLs are executed and their output is parsed
@@ -45,7 +57,7 @@ rsspp::Feed FeedRetriever::retrieve(const std::string& uri)
 	if (urls_source == "ttrss") {
 		const std::string::size_type pound = uri.find_first_of('#');
 		if (pound != std::string::npos) {
-			return fetch_ttrss(uri.substr(pound + 1));
+			return fetch_ttrss(uri, uri.substr(pound + 1));
 		} else {
 			return {};
 		}
@@ -82,12 +94,71 @@ rsspp::Feed FeedRetriever::retrieve(const std::string& uri)
 	}
 }
 
-rsspp::Feed FeedRetriever::fetch_ttrss(const std::string& feed_id)
+std::map<std::string, rsspp::Feed> FeedRetriever::retrieve_in_bulk(
+	const std::vector<std::string>& uris)
+{
+	ScopeMeasure sm("FeedRetriever::retrieve_in_bulk");
+
+	// Only incremental fetches can be done in bulk: fetching a feed in full
+	// takes its own request anyway
+	FreshRssApi* fapi = dynamic_cast<FreshRssApi*>(api);
+	if (cfg.get_configvalue("urls-source") != "freshrss" || fapi == nullptr) {
+		return {};
+	}
+	std::map<std::string, std::string> sync_positions;
+	for (const auto& uri : uris) {
+		// Special streams, like the starred articles, aren't part of the
+		// reading list and are left to retrieve()
+		if (!fapi->is_feed_stream(uri)) {
+			continue;
+		}
+		const std::string position = sync_position(uri);
+		if (!position.empty()) {
+			sync_positions[uri] = position;
+		}
+	}
+	if (sync_positions.size() < 2) {
+		return {};
+	}
+
+	auto feeds = fapi->fetch_feeds(sync_positions, easyhandle);
+	LOG(Level::INFO,
+		"FeedRetriever::retrieve_in_bulk: fetched %zu of %zu feeds",
+		feeds.size(),
+		uris.size());
+	return feeds;
+}
+
+bool FeedRetriever::is_http_download(const ConfigContainer& cfg,
+	const std::string& uri)
+{
+	// Keep in sync with the dispatch in retrieve()
+	const std::string urls_source = cfg.get_configvalue("urls-source");
+	if (urls_source == "ttrss" || urls_source == "newsblur" ||
+		urls_source == "ocnews" || urls_source == "miniflux" ||
+		urls_source == "feedbin" || urls_source == "freshrss") {
+		return false;
+	}
+	return utils::is_http_url(uri);
+}
+
+std::string FeedRetriever::sync_position(const std::string& uri)
+{
+	// Feeds which are always downloaded in full ignore Last-Modified and
+	// ETag, and shouldn't be fetched incrementally either
+	if (ign && ign->matches_lastmodified(uri)) {
+		return "";
+	}
+	return ch.fetch_sync_position(uri);
+}
+
+rsspp::Feed FeedRetriever::fetch_ttrss(const std::string& uri,
+	const std::string& feed_id)
 {
 	rsspp::Feed f;
 	TtRssApi* tapi = dynamic_cast<TtRssApi*>(api);
 	if (tapi) {
-		f = tapi->fetch_feed(feed_id, easyhandle);
+		f = tapi->fetch_feed(feed_id, easyhandle, sync_position(uri));
 	}
 	LOG(Level::DEBUG,
 		"FeedRetriever::fetch_ttrss: f.items.size = %" PRIu64,
@@ -129,7 +200,7 @@ rsspp::Feed FeedRetriever::fetch_miniflux(const std::string& feed_id)
 	rsspp::Feed f;
 	MinifluxApi* mapi = dynamic_cast<MinifluxApi*>(api);
 	if (mapi) {
-		f = mapi->fetch_feed(feed_id, easyhandle);
+		f = mapi->fetch_feed(feed_id, easyhandle, sync_position(feed_id));
 	}
 	LOG(Level::INFO,
 		"FeedRetriever::fetch_miniflux: f.items.size = %" PRIu64,
@@ -157,7 +228,7 @@ rsspp::Feed FeedRetriever::fetch_freshrss(const std::string& feed_id)
 	rsspp::Feed f;
 	FreshRssApi* fapi = dynamic_cast<FreshRssApi*>(api);
 	if (fapi) {
-		f = fapi->fetch_feed(feed_id, easyhandle);
+		f = fapi->fetch_feed(feed_id, easyhandle, sync_position(feed_id));
 	}
 	LOG(Level::INFO,
 		"FeedRetriever::fetch_freshrss: f.items.size = %" PRIu64,
@@ -170,6 +241,25 @@ rsspp::Feed FeedRetriever::download_http(const std::string& uri)
 {
 	rsspp::Feed f;
 	const unsigned int retrycount = cfg.get_configvalue_as_int("download-retries");
+
+	for (unsigned int i = 0; i < retrycount
+		&& f.rss_version == rsspp::Feed::Version::UNKNOWN; i++) {
+		HttpDownload download = start_http_download(uri);
+		const CURLcode ret = curl_easy_perform(easyhandle.ptr());
+		f = finish_http_download(uri, download, ret);
+	}
+	LOG(Level::DEBUG,
+		"FeedRetriever::download_http: http URL %s, valid: %s",
+		uri,
+		(f.rss_version != rsspp::Feed::Version::UNKNOWN) ? "true" : "false");
+
+	return f;
+}
+
+FeedRetriever::HttpDownload FeedRetriever::start_http_download(
+	const std::string& uri)
+{
+	ScopeMeasure sm("FeedRetriever::start_http_download", uri);
 	std::string proxy;
 	std::string proxy_auth;
 	std::string proxy_type;
@@ -180,85 +270,106 @@ rsspp::Feed FeedRetriever::download_http(const std::string& uri)
 		proxy_type = cfg.get_configvalue("proxy-type");
 	}
 
-	for (unsigned int i = 0; i < retrycount
-		&& f.rss_version == rsspp::Feed::Version::UNKNOWN; i++) {
-		std::string useragent = utils::get_useragent(cfg);
-		LOG(Level::DEBUG,
-			"FeedRetriever::download_http: user-agent = %s",
-			useragent);
-		rsspp::Parser p(cfg.get_configvalue_as_int(
+	std::string useragent = utils::get_useragent(cfg);
+	LOG(Level::DEBUG,
+		"FeedRetriever::start_http_download: user-agent = %s",
+		useragent);
+
+	HttpDownload download;
+	download.parser.reset(new rsspp::Parser(cfg.get_configvalue_as_int(
 				"download-timeout"),
 			useragent,
 			proxy,
 			proxy_auth,
 			utils::get_proxy_type(proxy_type),
 			cfg.get_configvalue_as_bool(
-				"ssl-verifypeer"));
-		time_t lm = 0;
-		std::string etag;
-		if (!ign || !ign->matches_lastmodified(uri)) {
-			ch.fetch_lastmodified(uri, lm, etag);
+				"ssl-verifypeer")));
+	if (!ign || !ign->matches_lastmodified(uri)) {
+		ch.fetch_lastmodified(uri, download.lastmodified, download.etag);
+	}
+	download.parser->prepare_url(
+		uri,
+		easyhandle,
+		download.lastmodified,
+		download.etag,
+		api,
+		cfg.get_configvalue_as_filepath("cookie-cache").to_locale_string());
+
+	return download;
+}
+
+rsspp::Feed FeedRetriever::finish_http_download(const std::string& uri,
+	HttpDownload& download, CURLcode ret)
+{
+	ScopeMeasure sm("FeedRetriever::finish_http_download", uri);
+	rsspp::Parser& p = *download.parser;
+	const time_t lm = download.lastmodified;
+	const std::string& etag = download.etag;
+
+	// A time that has passed doesn't delay anything, so there's no need to
+	// clear the one from an earlier response
+	auto store_not_before = [&]() {
+		if (p.get_not_before() != 0) {
+			ch.update_reload_not_before(uri, p.get_not_before());
 		}
-		const auto result = p.parse_url(
-				uri,
-				easyhandle,
-				lm,
-				etag,
-				api,
-				cfg.get_configvalue_as_filepath("cookie-cache").to_locale_string());
+	};
+
+	const auto result = [&]() {
+		try {
+			return p.finish_url(uri, easyhandle, ret);
+		} catch (const rsspp::Exception&) {
+			// Retry-After usually comes with an error
+			store_not_before();
+			throw;
+		}
+	}();
+	store_not_before();
 
-		auto store_lm_etag = [&]() {
+	auto store_lm_etag = [&]() {
+		LOG(Level::DEBUG,
+			"FeedRetriever::finish_http_download: lm = %" PRId64 " etag = %s",
+			// On GCC, `time_t` is `long int`, which is at least 32 bits
+			// long according to the spec. On x86_64, it's actually 64
+			// bits. Thus, casting to int64_t is either a no-op, or an
+			// up-cast which are always safe.
+			static_cast<int64_t>(p.get_last_modified()),
+			p.get_etag());
+		if (p.get_last_modified() != 0 ||
+			p.get_etag().length() > 0) {
 			LOG(Level::DEBUG,
-				"FeedRetriever::download_http: lm = %" PRId64 " etag = %s",
-				// On GCC, `time_t` is `long int`, which is at least 32 bits
-				// long according to the spec. On x86_64, it's actually 64
-				// bits. Thus, casting to int64_t is either a no-op, or an
-				// up-cast which are always safe.
-				static_cast<int64_t>(p.get_last_modified()),
+				"FeedRetriever::finish_http_download: "
+				"lastmodified "
+				"old: %" PRId64 " new: %" PRId64,
+				// On GCC, `time_t` is `long int`, which is at least 32
+				// bits long according to the spec. On x86_64, it's
+				// actually 64 bits. Thus, casting to int64_t is either
+				// a no-op, or an up-cast which are always safe.
+				static_cast<int64_t>(lm),
+				static_cast<int64_t>(p.get_last_modified()));
+			LOG(Level::DEBUG,
+				"FeedRetriever::finish_http_download: etag old: "
+				"%s "
+				"new %s",
+				etag,
 				p.get_etag());
-			if (p.get_last_modified() != 0 ||
-				p.get_etag().length() > 0) {
-				LOG(Level::DEBUG,
-					"FeedRetriever::download_http: "
-					"lastmodified "
-					"old: %" PRId64 " new: %" PRId64,
-					// On GCC, `time_t` is `long int`, which is at least 32
-					// bits long according to the spec. On x86_64, it's
-					// actually 64 bits. Thus, casting to int64_t is either
-					// a no-op, or an up-cast which are always safe.
-					static_cast<int64_t>(lm),
-					static_cast<int64_t>(p.get_last_modified()));
-				LOG(Level::DEBUG,
-					"FeedRetriever::download_http: etag old: "
-					"%s "
-					"new %s",
-					etag,
-					p.get_etag());
-				ch.update_lastmodified(uri,
-					(p.get_last_modified() != lm) ? p.get_last_modified() : 0,
-					(etag != p.get_etag()) ? p.get_etag() : "");
-			}
-		};
+			ch.update_lastmodified(uri,
+				(p.get_last_modified() != lm) ? p.get_last_modified() : 0,
+				(etag != p.get_etag()) ? p.get_etag() : "");
+		}
+	};
 
-		if (result.has_value()) {
-			f = result.value();
+	if (!result.has_value()) {
+		auto error = result.error();
+		switch (error.type) {
+		case rsspp::Parser::ErrorType::NotModified:
 			store_lm_etag();
-		} else {
-			auto error = result.error();
-			switch (error.type) {
-			case rsspp::Parser::ErrorType::NotModified:
-				store_lm_etag();
-				throw rsspp::NotModifiedException();
-				break;
-			}
+			throw rsspp::NotModifiedException();
+			break;
 		}
 	}
-	LOG(Level::DEBUG,
-		"FeedRetriever::download_http: http URL %s, valid: %s",
-		uri,
-		(f.rss_version != rsspp::Feed::Version::UNKNOWN) ? "true" : "false");
 
-	return f;
+	store_lm_etag();
+	return result.value();
 }
 
 rsspp::Feed FeedRetriever::get_execplugin(const std::string& plugin)
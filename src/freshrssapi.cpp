@@ -1,10 +1,15 @@
 #include "freshrssapi.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
 #include <curl/curl.h>
 #include <json.h>
+#include <map>
+#include <memory>
 #include <time.h>
+#include <unordered_set>
 #include <vector>
-#include <thread>
 
 #include "config.h"
 #include "curldatareceiver.h"
@@ -26,9 +31,24 @@
 #define FRESHRSS_API_MARK_ALL_READ_URL FRESHRSS_API_PREFIX "mark-all-as-read"
 #define FRESHRSS_API_EDIT_TAG_URL FRESHRSS_API_PREFIX "edit-tag"
 #define FRESHRSS_API_TOKEN_URL FRESHRSS_API_PREFIX "token"
+#define FRESHRSS_ITEM_IDS_URL FRESHRSS_API_PREFIX "stream/items/ids"
 
 namespace newsboat {
 
+namespace {
+
+/// Number of article IDs requested at once
+const unsigned int ITEM_IDS_PAGE_SIZE = 10000;
+
+/// Stream of the articles of all subscriptions, escaped for use in URLs
+const char* const READING_LIST_STREAM =
+	"user%2F-%2Fstate%2Fcom.google%2Freading-list";
+
+/// Number of articles requested from the reading list at once
+const unsigned int READING_LIST_PAGE_SIZE = 1000;
+
+} // namespace
+
 FreshRssApi::FreshRssApi(ConfigContainer& c)
 	: RemoteApi(c)
 {
@@ -225,38 +245,43 @@ bool FreshRssApi::mark_all_read(const std::string& feedurl)
 bool FreshRssApi::mark_article_read(const std::string& guid, bool read)
 {
 	refresh_token();
+	return mark_articles_read_with_token({guid}, read, token);
+}
 
-	std::thread t{[=]()
-	{
-		LOG(Level::DEBUG,
-			"FreshRssApi::mark_article_read: inside thread, marking "
-			"article as read...");
-		mark_article_read_with_token(guid, read, token);
-	}};
+bool FreshRssApi::mark_articles_read(const std::vector<std::string>& guids)
+{
+	refresh_token();
+	return mark_articles_read_with_token(guids, true, token);
+}
 
-	t.detach();
-	return true;
+bool FreshRssApi::mark_articles_unread(const std::vector<std::string>& guids)
+{
+	refresh_token();
+	return mark_articles_read_with_token(guids, false, token);
 }
 
-bool FreshRssApi::mark_article_read_with_token(const std::string& guid,
+bool FreshRssApi::mark_articles_read_with_token(
+	const std::vector<std::string>& guids,
 	bool read,
 	const std::string& token)
 {
+	// edit-tag applies the same change to every article passed as `i`
 	std::string postcontent;
+	for (const auto& guid : guids) {
+		postcontent.append(strprintf::fmt("i=%s&", guid));
+	}
 
 	if (read) {
-		postcontent = strprintf::fmt(
-				"i=%s&a=user/-/state/com.google/read&r=user/-/state/"
+		postcontent.append(strprintf::fmt(
+				"a=user/-/state/com.google/read&r=user/-/state/"
 				"com.google/kept-unread&ac=edit&T=%s",
-				guid,
-				token);
+				token));
 	} else {
-		postcontent = strprintf::fmt(
-				"i=%s&r=user/-/state/com.google/read&a=user/-/state/"
+		postcontent.append(strprintf::fmt(
+				"r=user/-/state/com.google/read&a=user/-/state/"
 				"com.google/kept-unread&a=user/-/state/com.google/"
 				"tracking-kept-unread&ac=edit&T=%s",
-				guid,
-				token);
+				token));
 	}
 
 	std::string result = post_content(
@@ -264,7 +289,7 @@ bool FreshRssApi::mark_article_read_with_token(const std::string& guid,
 			postcontent);
 
 	LOG(Level::DEBUG,
-		"FreshRssApi::mark_article_read_with_token: postcontent = %s "
+		"FreshRssApi::mark_articles_read_with_token: postcontent = %s "
 		"result "
 		"= %s",
 		postcontent,
@@ -408,15 +433,97 @@ std::string FreshRssApi::post_content(const std::string& url,
 	return result;
 }
 
-rsspp::Feed FreshRssApi::fetch_feed(const std::string& id, CurlHandle& cached_handle)
+rsspp::Feed FreshRssApi::fetch_feed(const std::string& id, CurlHandle& cached_handle,
+	const std::string& sync_position)
 {
 	rsspp::Feed feed;
 	feed.rss_version = rsspp::Feed::FRESHRSS_JSON;
 
-	const std::string query = strprintf::fmt("%s?n=%u",
-			id,
-			cfg.get_configvalue_as_int("freshrss-min-items"));
+	// Incremental fetches ask for the articles which were added since the
+	// newest one seen so far, following continuations until all of them
+	// are fetched
+	const bool feed_stream = is_feed_stream(id);
+	const bool incremental = !sync_position.empty() && feed_stream;
+	std::int64_t newest = incremental
+		? std::strtoll(sync_position.c_str(), nullptr, 10)
+		: 0;
+
+	std::string continuation;
+	do {
+		std::string query = strprintf::fmt("%s?n=%u",
+				id,
+				cfg.get_configvalue_as_int("freshrss-min-items"));
+		if (incremental) {
+			query.append(strprintf::fmt("&ot=%s", sync_position));
+		}
+		if (!continuation.empty()) {
+			query.append(strprintf::fmt("&c=%s", continuation));
+		}
+
+		const nlohmann::json content = get_json(query, cached_handle);
+		if (content.is_null()) {
+			return feed;
+		}
+
+		const nlohmann::json entries = content["items"];
+		if (!entries.is_array()) {
+			LOG(Level::ERROR,
+				"FreshRssApi::fetch_feed: items is not an array");
+			return feed;
+		}
+
+		continuation.clear();
+		if (content.contains("continuation") && content["continuation"].is_string()) {
+			continuation = content["continuation"];
+		}
+
+		LOG(Level::DEBUG,
+			"FreshRssApi::fetch_feed: %" PRIu64 " items",
+			static_cast<uint64_t>(entries.size()));
+		if (!parse_items(entries, feed, newest)) {
+			return feed;
+		}
+	} while (incremental && !continuation.empty());
+
+	if (incremental) {
+		const std::string prefix =
+			cfg.get_configvalue("freshrss-url") + FRESHRSS_FEED_PREFIX;
+		feed.unread_guids = fetch_unread_ids(id.substr(prefix.length()),
+				cached_handle);
+		if (feed.unread_guids == nullptr) {
+			// Try again from the same position next time
+			return feed;
+		}
+	}
+	if (newest > 0 && feed_stream) {
+		feed.sync_position = std::to_string(newest);
+	}
+
+	return feed;
+}
+
+bool FreshRssApi::is_feed_stream(const std::string& url) const
+{
+	const std::string prefix =
+		cfg.get_configvalue("freshrss-url") + FRESHRSS_FEED_PREFIX;
+	if (url.compare(0, prefix.length(), prefix) != 0) {
+		return false;
+	}
+	try {
+		const std::string stream = utils::unescape_url(url.substr(prefix.length()));
+		return stream.compare(0, 5, "feed/") == 0;
+	} catch (const std::runtime_error& e) {
+		LOG(Level::DEBUG,
+			"FreshRssApi::is_feed_stream: Failed to unescape_url(%s): %s",
+			url,
+			e.what());
+		return false;
+	}
+}
 
+nlohmann::json FreshRssApi::get_json(const std::string& url,
+	CurlHandle& cached_handle)
+{
 	curl_slist* custom_headers{};
 	add_custom_headers(&custom_headers);
 	curl_easy_setopt(cached_handle.ptr(), CURLOPT_HTTPHEADER, custom_headers);
@@ -424,7 +531,7 @@ rsspp::Feed FreshRssApi::fetch_feed(const std::string& id, CurlHandle& cached_ha
 	utils::set_common_curl_options(cached_handle, cfg);
 	curl_easy_setopt(cached_handle.ptr(),
 		CURLOPT_URL,
-		query.c_str());
+		url.c_str());
 
 	auto curlDataReceiver = CurlDataReceiver::register_data_handler(cached_handle);
 
@@ -435,31 +542,176 @@ rsspp::Feed FreshRssApi::fetch_feed(const std::string& id, CurlHandle& cached_ha
 	const std::string result = curlDataReceiver->get_data();
 	if (result.empty()) {
 		LOG(Level::ERROR,
-			"FreshRssApi::fetch_feed: Empty response: %s",
+			"FreshRssApi::get_json: Empty response: %s",
 			result);
-		return feed;
+		return nullptr;
 	}
-	nlohmann::json content;
 	try {
-		content = nlohmann::json::parse(result);
+		return nlohmann::json::parse(result);
 	} catch (nlohmann::json::parse_error& e) {
 		LOG(Level::ERROR,
-			"FreshRssApi::fetch_feed: reply failed to parse: %s",
+			"FreshRssApi::get_json: reply failed to parse: %s",
 			result);
-		return feed;
+		return nullptr;
 	}
+}
 
+std::map<std::string, rsspp::Feed> FreshRssApi::fetch_feeds(
+	const std::map<std::string, std::string>& sync_positions,
+	CurlHandle& cached_handle)
+{
+	std::map<std::string, rsspp::Feed> feeds;
+	if (sync_positions.empty()) {
+		return feeds;
+	}
 
-	const nlohmann::json entries = content["items"];
-	if (!entries.is_array()) {
-		LOG(Level::ERROR,
-			"FreshRssApi::fetch_feed: items is not an array");
-		return feed;
+	// The reading list holds the articles of all subscriptions, so one
+	// (paginated) fetch starting at the oldest of the positions gets every
+	// article any of the feeds is missing
+	std::int64_t oldest = 0;
+	for (const auto& position : sync_positions) {
+		const std::int64_t t = std::strtoll(position.second.c_str(), nullptr, 10);
+		if (t <= 0) {
+			LOG(Level::ERROR,
+				"FreshRssApi::fetch_feeds: %s has no sync position",
+				position.first);
+			return feeds;
+		}
+		oldest = (oldest == 0) ? t : std::min(oldest, t);
 	}
 
-	LOG(Level::DEBUG,
-		"FreshRssApi::fetch_feed: %" PRIu64 " items",
-		static_cast<uint64_t>(entries.size()));
+	const std::string prefix =
+		cfg.get_configvalue("freshrss-url") + FRESHRSS_FEED_PREFIX;
+	std::map<std::string, rsspp::Feed> fetched;
+	for (const auto& position : sync_positions) {
+		fetched[position.first].rss_version = rsspp::Feed::FRESHRSS_JSON;
+	}
+
+	std::int64_t newest = oldest;
+	std::string continuation;
+	do {
+		std::string query = strprintf::fmt("%s%s?n=%u&ot=%" PRId64,
+				prefix,
+				READING_LIST_STREAM,
+				READING_LIST_PAGE_SIZE,
+				oldest);
+		if (!continuation.empty()) {
+			query.append(strprintf::fmt("&c=%s", continuation));
+		}
+
+		const nlohmann::json content = get_json(query, cached_handle);
+		if (content.is_null()) {
+			return feeds;
+		}
+
+		// Articles are handed to the feed they come from, which is known by
+		// the same URL get_subscribed_urls() made of its stream ID
+		std::map<std::string, nlohmann::json> entries_per_feed;
+		continuation.clear();
+		try {
+			const nlohmann::json& entries = content.at("items");
+			LOG(Level::DEBUG,
+				"FreshRssApi::fetch_feeds: %" PRIu64 " items",
+				static_cast<uint64_t>(entries.size()));
+			for (const auto& entry : entries) {
+				if (!entry.contains("origin")
+					|| !entry["origin"].contains("streamId")) {
+					continue;
+				}
+				const std::string stream = entry["origin"]["streamId"];
+				char* escaped_id = curl_easy_escape(cached_handle.ptr(),
+						stream.c_str(), 0);
+				const std::string url = prefix + escaped_id;
+				curl_free(escaped_id);
+				if (fetched.count(url) != 0) {
+					entries_per_feed[url].push_back(entry);
+				}
+			}
+			if (content.contains("continuation") && content["continuation"].is_string()) {
+				continuation = content["continuation"];
+			}
+		} catch (const nlohmann::json::exception& e) {
+			LOG(Level::ERROR,
+				"FreshRssApi::fetch_feeds: failed to parse reading list: %s",
+				e.what());
+			return feeds;
+		}
+
+		for (const auto& entries : entries_per_feed) {
+			if (!parse_items(entries.second, fetched[entries.first], newest)) {
+				return feeds;
+			}
+		}
+	} while (!continuation.empty());
+
+	const auto unread_guids = fetch_unread_ids(READING_LIST_STREAM,
+			cached_handle);
+	if (unread_guids == nullptr) {
+		return feeds;
+	}
+	for (auto& feed : fetched) {
+		const std::int64_t position = std::strtoll(
+				sync_positions.at(feed.first).c_str(), nullptr, 10);
+		feed.second.sync_position = std::to_string(std::max(position, newest));
+		feed.second.unread_guids = unread_guids;
+	}
+
+	LOG(Level::INFO,
+		"FreshRssApi::fetch_feeds: fetched %zu feeds from the reading list",
+		fetched.size());
+	return fetched;
+}
+
+std::shared_ptr<const std::unordered_set<std::string>> FreshRssApi::fetch_unread_ids(
+		const std::string& stream, CurlHandle& cached_handle)
+{
+	std::unordered_set<std::string> guids;
+	std::string continuation;
+	do {
+		std::string query = strprintf::fmt(
+				"%s%s?s=%s&xt=user/-/state/com.google/read&n=%u&output=json",
+				cfg.get_configvalue("freshrss-url"),
+				FRESHRSS_ITEM_IDS_URL,
+				stream,
+				ITEM_IDS_PAGE_SIZE);
+		if (!continuation.empty()) {
+			query.append(strprintf::fmt("&c=%s", continuation));
+		}
+
+		const nlohmann::json content = get_json(query, cached_handle);
+		if (content.is_null()) {
+			return nullptr;
+		}
+
+		continuation.clear();
+		try {
+			if (content.contains("itemRefs") && !content["itemRefs"].is_null()) {
+				for (const auto& ref : content["itemRefs"]) {
+					// The IDs are decimal, while articles are identified
+					// by the hexadecimal "long form" of them
+					const std::string decimal = ref["id"];
+					guids.insert(strprintf::fmt(
+							"tag:google.com,2005:reader/item/%016" PRIx64,
+							static_cast<uint64_t>(std::stoull(decimal))));
+				}
+			}
+			if (content.contains("continuation") && content["continuation"].is_string()) {
+				continuation = content["continuation"];
+			}
+		} catch (const std::exception& e) {
+			LOG(Level::ERROR,
+				"FreshRssApi::fetch_unread_ids: failed to parse item IDs: %s",
+				e.what());
+			return nullptr;
+		}
+	} while (!continuation.empty());
+
+	return std::make_shared<const std::unordered_set<std::string>>(std::move(guids));
+}
+
+bool FreshRssApi::parse_items(const nlohmann::json& entries, rsspp::Feed& feed,
+	std::int64_t& newest)
+{
 	try {
 		for (const auto& entry : entries) {
 			rsspp::Item item;
@@ -544,13 +796,23 @@ rsspp::Feed FreshRssApi::fetch_feed(const std::string& id, CurlHandle& cached_ha
 				item.labels.push_back("read");
 			}
 
+			// When the article was added, in microseconds. `ot` takes
+			// seconds, and articles added within the same second as the
+			// newest one are fetched once more next time rather than missed.
+			if (entry.contains("timestampUsec") && entry["timestampUsec"].is_string()) {
+				const std::string usec = entry["timestampUsec"];
+				newest = std::max<std::int64_t>(newest,
+						std::strtoll(usec.c_str(), nullptr, 10) / 1000000);
+			}
+
 			feed.items.push_back(item);
 		}
 	} catch (nlohmann::json::exception& e) {
 		LOG(Level::ERROR, "Exception occurred while parsing feed: ", e.what());
+		return false;
 	}
 
-	return feed;
+	return true;
 }
 
 } // namespace newsboat
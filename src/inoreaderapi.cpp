@@ -4,7 +4,6 @@
 #include <curl/curl.h>
 #include <json.h>
 #include <vector>
-#include <thread>
 
 #include "curldatareceiver.h"
 #include "curlhandle.h"
@@ -206,38 +205,40 @@ bool InoreaderApi::mark_all_read(const std::string& feedurl)
 
 bool InoreaderApi::mark_article_read(const std::string& guid, bool read)
 {
-	// Do this in a thread, as we don't care about the result enough to wait
-	// for it.  borrowed from ttrssapi.cpp
-	std::thread t{[=]()
-	{
-		LOG(Level::DEBUG,
-			"InoreaderApi::mark_article_read: inside thread, marking "
-			"thread as read...");
+	return mark_articles({guid}, read);
+}
 
-		std::string postcontent;
+bool InoreaderApi::mark_articles_read(const std::vector<std::string>& guids)
+{
+	return mark_articles(guids, true);
+}
 
-		if (read) {
-			postcontent = strprintf::fmt(
-					"i=%s&a=user/-/state/com.google/read",
-					guid);
-		} else {
-			postcontent = strprintf::fmt(
-					"i=%s&r=user/-/state/com.google/read",
-					guid);
-		}
+bool InoreaderApi::mark_articles_unread(const std::vector<std::string>& guids)
+{
+	return mark_articles(guids, false);
+}
 
-		std::string result =
-			post_content(INOREADER_API_EDIT_TAG_URL, postcontent);
+bool InoreaderApi::mark_articles(const std::vector<std::string>& guids,
+	bool read)
+{
+	// edit-tag applies the same change to every article passed as `i`
+	std::string postcontent;
+	for (const auto& guid : guids) {
+		postcontent.append(strprintf::fmt("i=%s&", guid));
+	}
+	postcontent.append(read
+		? "a=user/-/state/com.google/read"
+		: "r=user/-/state/com.google/read");
 
-		LOG(Level::DEBUG,
-			"InoreaderApi::mark_article_read: postcontent = %s result = %s",
-			postcontent,
-			result);
-
-		return result == "OK";
-	}};
-	t.detach();
-	return true;
+	std::string result =
+		post_content(INOREADER_API_EDIT_TAG_URL, postcontent);
+
+	LOG(Level::DEBUG,
+		"InoreaderApi::mark_articles: postcontent = %s result = %s",
+		postcontent,
+		result);
+
+	return result == "OK";
 }
 
 bool InoreaderApi::update_article_flags(const std::string& inoflags,
@@ -1020,16 +1020,31 @@ void ItemListFormAction::do_update_visible_items()
 
 	bool show_read = cfg->get_configvalue_as_bool("show-read-articles");
 
+	std::vector<std::shared_ptr<RssItem>> candidates;
+	std::vector<unsigned int> positions;
 	unsigned int i = 0;
 	for (const auto& item : items) {
 		item->set_index(i + 1);
-		if ((show_read || item->unread()) &&
-			(!filter_active || matcher.matches(item.get()))) {
-			new_visible_items.push_back(ItemPtrPosPair(item, i));
+		if (show_read || item->unread()) {
+			candidates.push_back(item);
+			positions.push_back(i);
 		}
 		i++;
 	}
 
+	std::vector<bool> matching(candidates.size(), true);
+	if (filter_active) {
+		if (parallel_matcher == nullptr) {
+			parallel_matcher = std::make_unique<ParallelMatcher>(matcher, rsscache);
+		}
+		matching = parallel_matcher->matches(candidates);
+	}
+	for (unsigned int j = 0; j < candidates.size(); j++) {
+		if (matching[j]) {
+			new_visible_items.push_back(ItemPtrPosPair(candidates[j], positions[j]));
+		}
+	}
+
 	LOG(Level::DEBUG,
 		"ItemListFormAction::do_update_visible_items: size = %" PRIu64,
 		static_cast<uint64_t>(visible_items.size()));
@@ -1083,6 +1098,7 @@ void ItemListFormAction::draw_items()
 
 void ItemListFormAction::prepare()
 {
+	ScopeMeasure sm("ItemListFormAction::prepare", feed->rssurl());
 	set_keymap_hints();
 
 	std::lock_guard<std::mutex> mtx(redraw_mtx);
@@ -1388,6 +1404,19 @@ std::string ItemListFormAction::get_guid()
 	return visible_items[itempos].first->guid();
 }
 
+std::vector<std::shared_ptr<RssItem>> ItemListFormAction::get_adjacent_items()
+{
+	std::vector<std::shared_ptr<RssItem>> items;
+	const unsigned int itempos = list.get_position();
+	if (itempos + 1 < visible_items.size()) {
+		items.push_back(visible_items[itempos + 1].first);
+	}
+	if (itempos > 0 && itempos <= visible_items.size()) {
+		items.push_back(visible_items[itempos - 1].first);
+	}
+	return items;
+}
+
 std::vector<KeyMapHintEntry> ItemListFormAction::get_keymap_hint() const
 {
 	std::vector<KeyMapHintEntry> hints;
@@ -1701,6 +1730,7 @@ void ItemListFormAction::apply_filter(const std::string& filtertext)
 
 		if (unavailable_attributes.empty()) {
 			matcher = new_matcher;
+			parallel_matcher.reset();
 			store_selection();
 			filter_active = true;
 			invalidate_list();
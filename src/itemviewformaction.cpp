@@ -83,6 +83,7 @@ void ItemViewFormAction::update_head(RssItem& item)
 
 void ItemViewFormAction::prepare()
 {
+	ScopeMeasure sm("ItemViewFormAction::prepare");
 	/*
 	 * whenever necessary, the item view is regenerated. This is done
 	 * by putting together the feed name, title, link, author, optional
@@ -119,25 +120,19 @@ void ItemViewFormAction::prepare()
 					&rxman,
 					Dialog::Article);
 		} else {
-			links.clear();
-			if (!item->enclosure_url().empty()) {
-				const auto link_type = utils::podcast_mime_to_link_type(item->enclosure_type());
-				if (link_type.has_value()) {
-					links.add_link(item->enclosure_url(), link_type.value());
-				}
-			}
-
-			std::tie(formatted_text, num_lines) =
-				item_renderer::to_stfl_list(
-					// cfg can't be nullptr because that's a long-lived object
-					// created at the very start of the program.
-					*cfg,
-					*item,
-					text_width,
-					window_width,
-					&rxman,
-					Dialog::Article,
-					links);
+			// cfg can't be nullptr because that's a long-lived object
+			// created at the very start of the program.
+			auto& article_cache = v.get_article_cache();
+			const auto rendered = article_cache.get(*cfg, *item, text_width,
+					window_width, rxman);
+			formatted_text = rendered->text;
+			num_lines = rendered->num_lines;
+			links = rendered->links;
+
+			// Have the articles the user is likely to read next ready by
+			// the time they're opened
+			article_cache.prerender(*cfg, itemlist->get_adjacent_items(),
+				text_width, window_width, rxman);
 		}
 
 		textview.stfl_replace_lines(num_lines, formatted_text);
@@ -39,6 +39,7 @@ bool Matcher::parse(const std::string& expr)
 	} else {
 		errmsg = utils::wstr2str(p.get_error());
 	}
+	plan = compile(p.get_root());
 
 	LOG(Level::DEBUG,
 		"Matcher::parse: parsing `%s' succeeded: %d",
@@ -63,16 +64,82 @@ bool Matcher::matches(Matchable* item)
 	 * The whole matching code is speed-critical, as the matching happens on
 	 * a lot of different occasions, and slow matching can be easily
 	 * measured (and felt by the user) on slow computers with a lot of items
-	 * to match.
+	 * to match. That's why the expression is compiled into a plan by
+	 * parse(), and only that plan is evaluated here.
 	 */
 	bool retval = false;
 	if (item) {
 		ScopeMeasure m1("Matcher::matches");
-		retval = matches_r(p.get_root(), item);
+		retval = evaluate(plan.get(), item);
 	}
 	return retval;
 }
 
+std::unique_ptr<Matcher::Node> Matcher::compile(const expression* e)
+{
+	if (e == nullptr) {
+		return nullptr;
+	}
+
+	auto node = std::make_unique<Node>();
+	node->op = e->op;
+	node->name = e->name;
+	node->literal = e->literal;
+
+	switch (e->op) {
+	case LOGOP_AND:
+	case LOGOP_OR:
+		// Operands are kept in the order they were written in: the left
+		// one may short-circuit past an attribute that isn't available
+		node->l = compile(e->l);
+		node->r = compile(e->r);
+		return node;
+
+	case MATCHOP_LT:
+	case MATCHOP_GT:
+	case MATCHOP_LE:
+	case MATCHOP_GE:
+		node->number = string_to_num(e->literal);
+		break;
+
+	case MATCHOP_BETWEEN: {
+		const std::vector<std::string> lit = utils::tokenize(e->literal, ":");
+		if (lit.size() >= 2) {
+			node->valid_range = true;
+			node->number = string_to_num(lit[0]);
+			node->upper = string_to_num(lit[1]);
+			if (node->number > node->upper) {
+				std::swap(node->number, node->upper);
+			}
+		}
+		break;
+	}
+
+	case MATCHOP_RXEQ:
+	case MATCHOP_RXNE: {
+		auto regex = new regex_t;
+		const int err = regcomp(regex,
+				e->literal.c_str(),
+				REG_EXTENDED | REG_ICASE | REG_NOSUB);
+		if (err == 0) {
+			node->regex = std::shared_ptr<regex_t>(regex, [](regex_t* r) {
+				regfree(r);
+				delete r;
+			});
+		} else {
+			// Reported when the expression is evaluated, like before
+			char buf[1024];
+			regerror(err, regex, buf, sizeof(buf));
+			node->regex_error = buf;
+			delete regex;
+		}
+		break;
+	}
+	}
+
+	return node;
+}
+
 std::string get_attr_or_throw(Matchable* item, const std::string& attr_name)
 {
 	const auto attr = item->attribute_value(attr_name);
@@ -87,149 +154,120 @@ std::string get_attr_or_throw(Matchable* item, const std::string& attr_name)
 	return attr.value();
 }
 
-bool Matcher::matchop_lt(expression* e, Matchable* item)
+int Matcher::number_or_throw(const Node& node, Matchable* item)
 {
-	const int ilit = string_to_num(e->literal);
-
-	const auto attr = get_attr_or_throw(item, e->name);
-	const int iatt = string_to_num(attr);
-
-	return iatt < ilit;
+	const auto number = item->attribute_value_as_number(node.name);
+	if (number.has_value()) {
+		return number.value();
+	}
+	return string_to_num(get_attr_or_throw(item, node.name));
 }
 
-bool Matcher::matchop_between(expression* e, Matchable* item)
+bool Matcher::matchop_between(const Node& node, Matchable* item)
 {
-	const auto attr = get_attr_or_throw(item, e->name);
-	const int att = string_to_num(attr);
-
-	const std::vector<std::string> lit = utils::tokenize(e->literal, ":");
-	if (lit.size() < 2) {
+	const int att = number_or_throw(node, item);
+	if (!node.valid_range) {
 		return false;
 	}
 
-	int i1 = string_to_num(lit[0]);
-	int i2 = string_to_num(lit[1]);
-	if (i1 > i2) {
-		std::swap(i1, i2);
-	}
-
-	return (att >= i1 && att <= i2);
+	return (att >= node.number && att <= node.upper);
 }
 
-bool Matcher::matchop_gt(expression* e, Matchable* item)
+bool Matcher::matchop_rxeq(const Node& node, Matchable* item)
 {
-	const auto attr = get_attr_or_throw(item, e->name);
-	const int iatt = string_to_num(attr);
+	const auto attr = get_attr_or_throw(item, node.name);
 
-	const int ilit = string_to_num(e->literal);
-
-	return iatt > ilit;
-}
-
-bool Matcher::matchop_rxeq(expression* e, Matchable* item)
-{
-	const auto attr = get_attr_or_throw(item, e->name);
-
-	if (!e->regex) {
-		e->regex = new regex_t;
-		int err;
-		if ((err = regcomp(e->regex,
-						e->literal.c_str(),
-						REG_EXTENDED | REG_ICASE | REG_NOSUB)) != 0) {
-			delete e->regex;
-			e->regex = nullptr;
-			char buf[1024];
-			regerror(err, e->regex, buf, sizeof(buf));
-			throw MatcherException(
-				MatcherException::Type::InvalidRegex,
-				e->literal,
-				buf);
-		}
+	if (!node.regex) {
+		throw MatcherException(
+			MatcherException::Type::InvalidRegex,
+			node.literal,
+			node.regex_error);
 	}
-	if (regexec(e->regex,
-			attr.c_str(),
-			0,
-			nullptr,
-			0) == 0) {
-		return true;
-	}
-	return false;
+	return regexec(node.regex.get(), attr.c_str(), 0, nullptr, 0) == 0;
 }
 
-bool Matcher::matchop_cont(expression* e, Matchable* item)
+bool Matcher::matchop_cont(const Node& node, Matchable* item)
 {
-	const auto attr = get_attr_or_throw(item, e->name);
+	const auto attr = get_attr_or_throw(item, node.name);
 
-	const std::vector<std::string> elements = utils::tokenize(attr, " ");
-	const std::string literal = e->literal;
-	for (const auto& elem : elements) {
-		if (literal == elem) {
+	// Same as looking for the literal among utils::tokenize(attr, " "), but
+	// without splitting the attribute into a vector
+	const std::string& literal = node.literal;
+	if (literal.empty() || literal.find(' ') != std::string::npos) {
+		return false;
+	}
+	std::string::size_type pos = 0;
+	while ((pos = attr.find(literal, pos)) != std::string::npos) {
+		const auto end = pos + literal.length();
+		if ((pos == 0 || attr[pos - 1] == ' ')
+			&& (end == attr.length() || attr[end] == ' ')) {
 			return true;
 		}
+		pos++;
 	}
 	return false;
 }
 
-bool Matcher::matchop_eq(expression* e, Matchable* item)
+bool Matcher::matchop_eq(const Node& node, Matchable* item)
 {
-	const auto attr = get_attr_or_throw(item, e->name);
+	const auto attr = get_attr_or_throw(item, node.name);
 
-	return (attr == e->literal);
+	return (attr == node.literal);
 }
 
-bool Matcher::matches_r(expression* e, Matchable* item)
+bool Matcher::evaluate(const Node* node, Matchable* item)
 {
-	if (e) {
-		switch (e->op) {
-		/* the operator "and" and "or" simply connect two different
-		 * subexpressions */
-		case LOGOP_AND:
-			// short-circuit evaluation in C -> short circuit evaluation in the filter language
-			return matches_r(e->l, item) &&
-				matches_r(e->r, item);
+	if (node == nullptr) {
+		return true; // shouldn't happen
+	}
 
-		case LOGOP_OR:
-			return matches_r(e->l, item) ||
-				matches_r(e->r, item); // same here
+	switch (node->op) {
+	/* the operator "and" and "or" simply connect two different
+	 * subexpressions */
+	case LOGOP_AND:
+		// short-circuit evaluation in C -> short circuit evaluation in the filter language
+		return evaluate(node->l.get(), item) &&
+			evaluate(node->r.get(), item);
 
-		/* while the other operators connect an attribute with a value */
-		case MATCHOP_EQ:
-			return matchop_eq(e, item);
+	case LOGOP_OR:
+		return evaluate(node->l.get(), item) ||
+			evaluate(node->r.get(), item);
 
-		case MATCHOP_NE:
-			return !matchop_eq(e, item);
+	/* while the other operators connect an attribute with a value */
+	case MATCHOP_EQ:
+		return matchop_eq(*node, item);
 
-		case MATCHOP_LT:
-			return matchop_lt(e, item);
+	case MATCHOP_NE:
+		return !matchop_eq(*node, item);
 
-		case MATCHOP_BETWEEN:
-			return matchop_between(e, item);
+	case MATCHOP_LT:
+		return number_or_throw(*node, item) < node->number;
 
-		case MATCHOP_GT:
-			return matchop_gt(e, item);
+	case MATCHOP_BETWEEN:
+		return matchop_between(*node, item);
 
-		case MATCHOP_LE:
-			return !matchop_gt(e, item);
+	case MATCHOP_GT:
+		return number_or_throw(*node, item) > node->number;
 
-		case MATCHOP_GE:
-			return !matchop_lt(e, item);
+	case MATCHOP_LE:
+		return number_or_throw(*node, item) <= node->number;
 
-		case MATCHOP_RXEQ:
-			return matchop_rxeq(e, item);
+	case MATCHOP_GE:
+		return number_or_throw(*node, item) >= node->number;
 
-		case MATCHOP_RXNE:
-			return !matchop_rxeq(e, item);
+	case MATCHOP_RXEQ:
+		return matchop_rxeq(*node, item);
 
-		case MATCHOP_CONTAINS:
-			return matchop_cont(e, item);
+	case MATCHOP_RXNE:
+		return !matchop_rxeq(*node, item);
 
-		case MATCHOP_CONTAINSNOT:
-			return !matchop_cont(e, item);
-		}
-		return false;
-	} else {
-		return true; // shouldn't happen
+	case MATCHOP_CONTAINS:
+		return matchop_cont(*node, item);
+
+	case MATCHOP_CONTAINSNOT:
+		return !matchop_cont(*node, item);
 	}
+	return false;
 }
 
 std::string Matcher::get_parse_error() const
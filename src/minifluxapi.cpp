@@ -1,9 +1,12 @@
 #include "minifluxapi.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cinttypes>
+#include <cstdio>
+#include <ctime>
 #include <curl/curl.h>
 #include <iostream>
-#include <thread>
 
 #include "3rd-party/json.hpp"
 #include "config.h"
@@ -18,6 +21,48 @@ using json = nlohmann::json;
 using HTTPMethod = newsboat::utils::HTTPMethod;
 
 namespace newsboat {
+
+namespace {
+
+/// Number of entries requested at once by incremental fetches
+const unsigned int ENTRIES_PAGE_SIZE = 100;
+
+/// Parses an RFC 3339 timestamp like "2023-04-01T12:34:56.789+02:00".
+/// Returns 0 if it's malformed.
+time_t parse_timestamp(const std::string& timestamp)
+{
+	struct tm tm = {};
+	const char* rest = strptime(timestamp.c_str(), "%Y-%m-%dT%H:%M:%S", &tm);
+	if (rest == nullptr) {
+		return 0;
+	}
+	time_t result = timegm(&tm);
+
+	// Skip fractions of a second
+	if (*rest == '.') {
+		++rest;
+		while (isdigit(*rest)) {
+			++rest;
+		}
+	}
+
+	int hours = 0;
+	int minutes = 0;
+	if (*rest == '+' || *rest == '-') {
+		if (sscanf(rest + 1, "%2d:%2d", &hours, &minutes) != 2) {
+			return 0;
+		}
+		const time_t offset = hours * 60 * 60 + minutes * 60;
+		result += (*rest == '+') ? -offset : offset;
+	} else if (*rest != 'Z' && *rest != 'z') {
+		return 0;
+	}
+
+	return result;
+}
+
+} // namespace
+
 MinifluxApi::MinifluxApi(ConfigContainer& c)
 	: RemoteApi(c)
 {
@@ -134,21 +179,23 @@ bool MinifluxApi::mark_all_read(const std::string& id)
 
 bool MinifluxApi::mark_article_read(const std::string& guid, bool read)
 {
-	// Do this in a thread, as we don't care about the result enough to wait
-	// for it.
-	std::thread t{[=]()
-	{
-		LOG(Level::DEBUG,
-			"MinifluxApi::mark_article_read: inside thread, marking "
-			"article as read...");
-
-		// Call the MinifluxApi's update_article function as a thread.
-		json args;
-		args["status"] = read ? "read" : "unread";
-		this->update_article(guid, args);
-	}};
-	t.detach();
-	return true;
+	json args;
+	args["status"] = read ? "read" : "unread";
+	return update_article(guid, args);
+}
+
+bool MinifluxApi::mark_articles_read(const std::vector<std::string>& guids)
+{
+	json args;
+	args["status"] = "read";
+	return update_articles(guids, args);
+}
+
+bool MinifluxApi::mark_articles_unread(const std::vector<std::string>& guids)
+{
+	json args;
+	args["status"] = "unread";
+	return update_articles(guids, args);
 }
 
 bool MinifluxApi::save_article(const std::string& guid, bool save)
@@ -209,82 +256,118 @@ bool MinifluxApi::update_article_flags(const std::string&  oldflags,
 	return success;
 }
 
-rsspp::Feed MinifluxApi::fetch_feed(const std::string& id, CurlHandle& cached_handle)
+rsspp::Feed MinifluxApi::fetch_feed(const std::string& id, CurlHandle& cached_handle,
+	const std::string& sync_position)
 {
 	rsspp::Feed feed;
 	feed.rss_version = rsspp::Feed::MINIFLUX_JSON;
 
-	const std::string query =
-		id == "starred" ?
-		"/v1/entries?starred=true"
-		: strprintf::fmt("/v1/feeds/%s/entries?order=published_at&direction=desc&limit=%u",
-			id,
-			cfg.get_configvalue_as_int("miniflux-min-items"));
+	// Incremental fetches ask for the entries which changed since the
+	// latest change seen so far. That includes new entries as well as those
+	// which were marked read or unread, so no separate request is needed to
+	// keep their status in sync.
+	const bool incremental = !sync_position.empty() && id != "starred";
+	time_t latest_change = incremental
+		? std::strtoll(sync_position.c_str(), nullptr, 10)
+		: 0;
+
+	for (unsigned int offset = 0;;) {
+		std::string query;
+		if (id == "starred") {
+			query = "/v1/entries?starred=true";
+		} else if (incremental) {
+			query = strprintf::fmt(
+					"/v1/feeds/%s/entries?changed_after=%s&order=id&direction=asc"
+					"&limit=%u&offset=%u",
+					id,
+					sync_position,
+					ENTRIES_PAGE_SIZE,
+					offset);
+		} else {
+			query = strprintf::fmt(
+					"/v1/feeds/%s/entries?order=published_at&direction=desc&limit=%u",
+					id,
+					cfg.get_configvalue_as_int("miniflux-min-items"));
+		}
 
-	const json content = run_op(query, json(), cached_handle, HTTPMethod::GET);
-	if (content.is_null()) {
-		return feed;
-	}
+		const json content = run_op(query, json(), cached_handle, HTTPMethod::GET);
+		if (content.is_null()) {
+			return feed;
+		}
 
-	const json entries = content["entries"];
-	if (!entries.is_array()) {
-		LOG(Level::ERROR,
-			"MinifluxApi::fetch_feed: items is not an array");
-		return feed;
-	}
+		const json entries = content["entries"];
+		if (!entries.is_array()) {
+			LOG(Level::ERROR,
+				"MinifluxApi::fetch_feed: items is not an array");
+			return feed;
+		}
 
-	LOG(Level::DEBUG,
-		"MinifluxApi::fetch_feed: %" PRIu64 " items",
-		static_cast<uint64_t>(entries.size()));
-	try {
-		for (const auto& entry : entries) {
-			rsspp::Item item;
-
-			if (!entry["title"].is_null()) {
-				item.title = entry["title"];
-			}
+		LOG(Level::DEBUG,
+			"MinifluxApi::fetch_feed: %" PRIu64 " items",
+			static_cast<uint64_t>(entries.size()));
+		try {
+			for (const auto& entry : entries) {
+				rsspp::Item item;
 
-			if (!entry["url"].is_null()) {
-				item.link = entry["url"];
-			}
+				if (!entry["title"].is_null()) {
+					item.title = entry["title"];
+				}
 
-			if (!entry["author"].is_null()) {
-				item.author = entry["author"];
-			}
+				if (!entry["url"].is_null()) {
+					item.link = entry["url"];
+				}
 
-			if (!entry["content"].is_null()) {
-				item.content_encoded = entry["content"];
-			}
+				if (!entry["author"].is_null()) {
+					item.author = entry["author"];
+				}
+
+				if (!entry["content"].is_null()) {
+					item.content_encoded = entry["content"];
+				}
 
-			if (!entry["enclosures"].is_null() && entry["enclosures"].is_array()) {
-				for (const auto& enclosure : entry["enclosures"]) {
-					if (!enclosure["url"].is_null() && !enclosure["mime_type"].is_null()) {
-						rsspp::Enclosure enc;
-						enc.url = enclosure["url"];
-						enc.type = enclosure["mime_type"];
-						item.enclosures.push_back(enc);
+				if (!entry["enclosures"].is_null() && entry["enclosures"].is_array()) {
+					for (const auto& enclosure : entry["enclosures"]) {
+						if (!enclosure["url"].is_null() && !enclosure["mime_type"].is_null()) {
+							rsspp::Enclosure enc;
+							enc.url = enclosure["url"];
+							enc.type = enclosure["mime_type"];
+							item.enclosures.push_back(enc);
+						}
 					}
 				}
-			}
 
-			const int entry_id = entry["id"];
-			item.guid = std::to_string(entry_id);
+				const int entry_id = entry["id"];
+				item.guid = std::to_string(entry_id);
+
+				item.pubDate = entry["published_at"];
+
+				const std::string status = entry["status"];
+				if (status == "unread") {
+					item.labels.push_back("miniflux:unread");
+				} else {
+					item.labels.push_back("miniflux:read");
+				}
 
-			item.pubDate = entry["published_at"];
+				if (entry.contains("changed_at") && entry["changed_at"].is_string()) {
+					latest_change = std::max(latest_change,
+							parse_timestamp(entry["changed_at"]));
+				}
 
-			const std::string status = entry["status"];
-			if (status == "unread") {
-				item.labels.push_back("miniflux:unread");
-			} else {
-				item.labels.push_back("miniflux:read");
+				feed.items.push_back(item);
 			}
+		} catch (json::exception& e) {
+			LOG(Level::ERROR,
+				"Exception occurred while parsing feeed: ",
+				e.what());
+			return feed;
+		}
 
-			feed.items.push_back(item);
+		offset += entries.size();
+		const bool more = content.contains("total") && content["total"].is_number()
+			&& offset < content["total"].get<unsigned int>();
+		if (!incremental || entries.empty() || !more) {
+			break;
 		}
-	} catch (json::exception& e) {
-		LOG(Level::ERROR,
-			"Exception occurred while parsing feeed: ",
-			e.what());
 	}
 
 	std::sort(feed.items.begin(),
@@ -293,6 +376,12 @@ rsspp::Feed MinifluxApi::fetch_feed(const std::string& id, CurlHandle& cached_ha
 		return a.pubDate_ts > b.pubDate_ts;
 	});
 
+	// Entries which changed within the same second as the latest one are
+	// fetched once more next time rather than missed
+	if (id != "starred" && latest_change > 0) {
+		feed.sync_position = std::to_string(latest_change);
+	}
+
 	return feed;
 }
 
@@ -160,13 +160,23 @@ bool OcNewsApi::mark_article_read(const std::string& guid, bool read)
 }
 
 bool OcNewsApi::mark_articles_read(const std::vector<std::string>& guids)
+{
+	return mark_articles(guids, "items/read/multiple");
+}
+
+bool OcNewsApi::mark_articles_unread(const std::vector<std::string>& guids)
+{
+	return mark_articles(guids, "items/unread/multiple");
+}
+
+bool OcNewsApi::mark_articles(const std::vector<std::string>& guids,
+	const std::string& query)
 {
 	std::vector<std::string> ids;
 	for (const auto& guid : guids) {
 		ids.push_back(guid.substr(0, guid.find_first_of(":")));
 	}
 
-	const std::string query = "items/read/multiple";
 	const std::string id_array = strprintf::fmt("[%s]", utils::join(ids, ","));
 	const std::string parameters = strprintf::fmt(R"({"items": %s})", id_array);
 	return this->query(query, nullptr, parameters);
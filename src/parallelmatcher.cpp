@@ -0,0 +1,156 @@
+#include "parallelmatcher.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+
+#include "cache.h"
+#include "logger.h"
+#include "matchable.h"
+#include "matcher.h"
+#include "rssitem.h"
+#include "utils.h"
+#include "workstealingqueue.h"
+
+namespace newsboat {
+
+namespace {
+
+// Large enough for the threads not to fight over the queue and for the
+// content of a chunk to be fetched in one go, small enough for all cores to
+// get some work on a feed with a few thousand articles.
+const unsigned int CHUNK_SIZE = 128;
+
+/// Presents an article to the Matcher with the content that was fetched for
+/// it beforehand.
+class PrefetchedArticle : public Matchable {
+public:
+	PrefetchedArticle(const RssItem& item, const std::string& content)
+		: item(item)
+		, content(content)
+	{
+	}
+
+	std::optional<std::string> attribute_value(const std::string& attr) const
+	override
+	{
+		if (attr == "content") {
+			return utils::utf8_to_locale(content);
+		}
+		return item.attribute_value(attr);
+	}
+
+	std::optional<int> attribute_value_as_number(const std::string& attr) const
+	override
+	{
+		return item.attribute_value_as_number(attr);
+	}
+
+private:
+	const RssItem& item;
+	const std::string& content;
+};
+
+} // namespace
+
+ParallelMatcher::ParallelMatcher(Matcher& matcher, Cache* cache)
+	: matcher(matcher)
+	, cache(cache)
+	, prefetch_content(false)
+{
+	if (cache != nullptr) {
+		const auto attributes = matcher.get_referenced_attributes();
+		prefetch_content = attributes.find("content") != attributes.end();
+	}
+}
+
+std::vector<bool> ParallelMatcher::matches(
+	const std::vector<std::shared_ptr<RssItem>>& items)
+{
+	const unsigned int num_chunks = (items.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	std::vector<char> results(items.size(), 0);
+	std::vector<std::exception_ptr> errors(num_chunks);
+
+	const unsigned int num_threads = std::max(1u,
+			std::min(std::thread::hardware_concurrency(), num_chunks));
+	while (worker_matchers.size() + 1 < num_threads) {
+		worker_matchers.push_back(
+			std::make_unique<Matcher>(matcher.get_expression()));
+	}
+
+	WorkStealingQueue queue(num_chunks, num_threads);
+	auto worker = [&](unsigned int worker_id) {
+		Matcher& worker_matcher =
+			(worker_id == 0) ? matcher : *worker_matchers[worker_id - 1];
+		unsigned int chunk = 0;
+		while (queue.next(worker_id, chunk)) {
+			const unsigned int begin = chunk * CHUNK_SIZE;
+			const unsigned int end = std::min<size_t>(begin + CHUNK_SIZE, items.size());
+			try {
+				match_chunk(worker_matcher, items, begin, end, results);
+			} catch (...) {
+				errors[chunk] = std::current_exception();
+			}
+		}
+	};
+
+	LOG(Level::DEBUG,
+		"ParallelMatcher::matches: %" PRIu64 " articles in %u chunks on %u threads",
+		static_cast<uint64_t>(items.size()),
+		num_chunks,
+		num_threads);
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < num_threads; i++) {
+		threads.emplace_back(worker, i);
+	}
+	worker(0);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// Chunks stop at their first failure, so the first failed chunk holds
+	// the error for the first article that couldn't be matched
+	for (const auto& error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	return std::vector<bool>(results.begin(), results.end());
+}
+
+void ParallelMatcher::match_chunk(Matcher& worker_matcher,
+	const std::vector<std::shared_ptr<RssItem>>& items,
+	unsigned int begin,
+	unsigned int end,
+	std::vector<char>& results)
+{
+	std::unordered_map<std::string, std::string> contents;
+	if (prefetch_content) {
+		std::vector<std::string> guids;
+		for (unsigned int i = begin; i < end; i++) {
+			if (!items[i]->has_description()) {
+				guids.push_back(items[i]->guid());
+			}
+		}
+		if (!guids.empty()) {
+			contents = cache->fetch_descriptions(guids);
+		}
+	}
+
+	for (unsigned int i = begin; i < end; i++) {
+		RssItem& item = *items[i];
+		const auto content = contents.find(item.guid());
+		if (content != contents.end()) {
+			PrefetchedArticle article(item, content->second);
+			results[i] = worker_matcher.matches(&article);
+		} else {
+			results[i] = worker_matcher.matches(&item);
+		}
+	}
+}
+
+} // namespace newsboat
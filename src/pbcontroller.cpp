@@ -10,7 +10,6 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <memory>
-#include <thread>
 #include <unistd.h>
 
 #include "config.h"
@@ -20,7 +19,6 @@
 #include "logger.h"
 #include "nullconfigactionhandler.h"
 #include "pbview.h"
-#include "poddlthread.h"
 #include "queueloader.h"
 #include "strprintf.h"
 #include "utils.h"
@@ -296,7 +294,9 @@ int PbController::run(PbView& v)
 	});
 	ql->reload(downloads_);
 
+	engine = std::make_unique<DownloadEngine>(cfg);
 	v.run(automatic_dl, cfg.get_configvalue_as_bool("wrap-scroll"));
+	engine.reset();
 
 	Stfl::reset();
 
@@ -457,8 +457,22 @@ void PbController::start_downloads()
 
 void PbController::start_download(Download& item)
 {
-	std::thread t{PodDlThread(&item, cfg)};
-	t.detach();
+	engine->start(item);
+}
+
+void PbController::cancel_download(Download& item)
+{
+	engine->cancel(item);
+}
+
+int PbController::download_events_fd()
+{
+	return engine->event_fd();
+}
+
+void PbController::process_download_events()
+{
+	engine->process_events();
 }
 
 void PbController::increase_parallel_downloads()
@@ -3,6 +3,8 @@
 #include <cinttypes>
 #include <cstring>
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include "config.h"
 #include "configcontainer.h"
@@ -106,7 +108,7 @@ void PbView::run(bool auto_download, bool wrap_scroll)
 		}
 
 		dllist_form.draw_form();
-		const auto event = dllist_form.wait_for_event(500);
+		const auto event = wait_for_event();
 
 		if (auto_download) {
 			if (ctrl.get_maxdownloads() >
@@ -252,8 +254,7 @@ void PbView::run(bool auto_download, bool wrap_scroll)
 				const auto idx = downloads_list.get_position();
 				if (ctrl.downloads()[idx].status() ==
 					DlStatus::DOWNLOADING) {
-					ctrl.downloads()[idx].set_status(
-						DlStatus::CANCELLED);
+					ctrl.cancel_download(ctrl.downloads()[idx]);
 				}
 			}
 		}
@@ -300,6 +301,30 @@ void PbView::run(bool auto_download, bool wrap_scroll)
 	} while (!quit);
 }
 
+newsboat::Event PbView::wait_for_event()
+{
+	// Keys which curses has already read from the terminal wouldn't wake
+	// up poll(), so check for them first
+	const auto event = dllist_form.wait_for_event(1);
+	if (event.name != "TIMEOUT") {
+		return event;
+	}
+
+	struct pollfd fds[2];
+	fds[0].fd = STDIN_FILENO;
+	fds[0].events = POLLIN;
+	fds[1].fd = ctrl.download_events_fd();
+	fds[1].events = POLLIN;
+
+	// poll() also returns when interrupted by SIGWINCH; curses then reports
+	// the resize below
+	if (poll(fds, 2, -1) > 0 && (fds[1].revents & POLLIN)) {
+		ctrl.process_download_events();
+	}
+
+	return dllist_form.wait_for_event(1);
+}
+
 void PbView::handle_resize()
 {
 	std::vector<std::reference_wrapper<newsboat::Stfl::Form>> forms = {dllist_form, help_form};
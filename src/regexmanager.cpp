@@ -21,6 +21,7 @@ void RegexManager::dump_config(std::vector<std::string>& config_output) const
 void RegexManager::handle_action(std::string_view action,
 	const std::vector<std::string>& params)
 {
+	version_++;
 	if (action == "highlight") {
 		handle_highlight_action(params);
 	} else if (action == "highlight-article" || action == "highlight-feed") {
@@ -70,6 +71,7 @@ void RegexManager::remove_last_regex(Dialog location)
 	}
 
 	regexes.pop_back();
+	version_++;
 }
 
 void RegexManager::quote_and_highlight(StflRichText& stflString, Dialog location) const
@@ -1,12 +1,16 @@
 #include "reloader.h"
 
 #include <algorithm>
+#include <cinttypes>
+#include <exception>
 #include <iostream>
 #include <ncurses.h>
 #include <thread>
+#include <unordered_set>
 
 #include "controller.h"
 #include "curlhandle.h"
+#include "curlmultirunner.h"
 #include "dbexception.h"
 #include "feedretriever.h"
 #include "fmtstrformatter.h"
@@ -19,23 +23,58 @@
 #include "scopemeasure.h"
 #include "utils.h"
 #include "view.h"
+#include "workstealingqueue.h"
 
 namespace newsboat {
 
+namespace {
+
+std::vector<time_t> pubdates_of(RssFeed& feed)
+{
+	std::lock_guard<std::mutex> lock(feed.item_mutex);
+	std::vector<time_t> pubdates;
+	pubdates.reserve(feed.items().size());
+	for (const auto& item : feed.items()) {
+		pubdates.push_back(item->pubDate_timestamp());
+	}
+	return pubdates;
+}
+
+bool has_new_articles(RssFeed& oldfeed, RssFeed& newfeed)
+{
+	std::unordered_set<std::string> known;
+	{
+		std::lock_guard<std::mutex> lock(oldfeed.item_mutex);
+		for (const auto& item : oldfeed.items()) {
+			known.insert(item->guid());
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(newfeed.item_mutex);
+	return std::any_of(newfeed.items().begin(), newfeed.items().end(),
+	[&](const std::shared_ptr<RssItem>& item) {
+		return known.count(item->guid()) == 0;
+	});
+}
+
+} // namespace
+
 Reloader::Reloader(Controller& c, Cache& cc, ConfigContainer& cfg)
 	: ctrl(c)
 	, rsscache(cc)
 	, cfg(cfg)
+	, http_runner(1, 0, 1, &curl_share)
 {
 }
 
-void Reloader::spawn_reloadthread()
+void Reloader::spawn_reloadthread(bool unattended)
 {
-	std::thread t{ReloadThread(ctrl, cfg)};
+	std::thread t{ReloadThread(ctrl, cfg, unattended)};
 	t.detach();
 }
 
-void Reloader::start_reload_all_thread(const std::vector<unsigned int>& indexes)
+void Reloader::start_reload_all_thread(const std::vector<unsigned int>& indexes,
+	bool unattended)
 {
 	LOG(Level::INFO, "starting reload all thread");
 	std::thread t([=]() {
@@ -44,9 +83,9 @@ void Reloader::start_reload_all_thread(const std::vector<unsigned int>& indexes)
 			"feeds...");
 		if (trylock_reload_mutex()) {
 			if (indexes.empty()) {
-				reload_all();
+				reload_all(unattended);
 			} else {
-				reload_indexes(indexes);
+				reload_indexes(indexes, unattended);
 			}
 			unlock_reload_mutex();
 		}
@@ -54,6 +93,23 @@ void Reloader::start_reload_all_thread(const std::vector<unsigned int>& indexes)
 	t.detach();
 }
 
+void Reloader::start_reload_due_thread(bool unattended)
+{
+	if (!cfg.get_configvalue_as_bool("reload-adaptive")) {
+		start_reload_all_thread({}, unattended);
+		return;
+	}
+
+	LOG(Level::INFO, "starting reload due thread");
+	std::thread t([=]() {
+		if (trylock_reload_mutex()) {
+			reload_all(unattended, true);
+			unlock_reload_mutex();
+		}
+	});
+	t.detach();
+}
+
 bool Reloader::trylock_reload_mutex()
 {
 	if (reload_mutex.try_lock()) {
@@ -69,9 +125,24 @@ void Reloader::reload(unsigned int pos,
 	bool show_progress,
 	bool unattended)
 {
-	ScopeMeasure sm("Reloader::reload");
+	const bool ignore_dl =
+		(cfg.get_configvalue("ignore-mode") == "download");
+	RssIgnores* ign = ignore_dl ? ctrl.get_ignores() : nullptr;
+
+	reload(pos, show_progress, unattended, [&](const std::string& url) {
+		FeedRetriever feed_retriever(cfg, rsscache, easyhandle, ign, ctrl.get_api());
+		return feed_retriever.retrieve(url);
+	});
+}
+
+void Reloader::reload(unsigned int pos,
+	bool show_progress,
+	bool unattended,
+	std::function<rsspp::Feed(const std::string&)> retrieve)
+{
 	LOG(Level::DEBUG, "Reloader::reload: pos = %u", pos);
 	std::shared_ptr<RssFeed> oldfeed = ctrl.get_feedcontainer()->get_feed(pos);
+	ScopeMeasure sm("Reloader::reload", oldfeed ? oldfeed->rssurl() : "");
 	if (oldfeed) {
 		LOG(Level::INFO, "Reloader::reload: starting reload of %s", oldfeed->rssurl());
 
@@ -96,6 +167,11 @@ void Reloader::reload(unsigned int pos,
 
 		const bool ignore_dl =
 			(cfg.get_configvalue("ignore-mode") == "download");
+		// The schedule is only used to pick the feeds that are due
+		const bool adaptive = cfg.get_configvalue_as_bool("reload-adaptive");
+
+		auto outcome = ReloadScheduler::Outcome::FAILED;
+		std::vector<time_t> pubdates;
 
 		try {
 			const auto inner_message_lifetime = message_lifetime;
@@ -106,8 +182,7 @@ void Reloader::reload(unsigned int pos,
 
 			LOG(Level::INFO, "Reloader::reload: retrieving feed");
 			sm.stopover("start retrieving");
-			FeedRetriever feed_retriever(cfg, rsscache, easyhandle, ign, ctrl.get_api());
-			const rsspp::Feed feed = feed_retriever.retrieve(oldfeed->rssurl());
+			const rsspp::Feed feed = retrieve(oldfeed->rssurl());
 
 			LOG(Level::INFO, "Reloader::reload: parsing feed");
 			sm.stopover("start parsing");
@@ -115,13 +190,30 @@ void Reloader::reload(unsigned int pos,
 
 			std::shared_ptr<RssFeed> newfeed = parser.parse(feed);
 			sm.stopover("start replacing feed");
+			outcome = ReloadScheduler::Outcome::UNCHANGED;
 			if (newfeed != nullptr) {
+				if (adaptive) {
+					if (has_new_articles(*oldfeed, *newfeed)) {
+						outcome = ReloadScheduler::Outcome::NEW_ARTICLES;
+					}
+					pubdates = pubdates_of(*newfeed);
+				}
 				ctrl.replace_feed(
 					*oldfeed, *newfeed, pos, unattended);
 				if (newfeed->total_item_count() == 0) {
 					LOG(Level::DEBUG,
 						"Reloader::reload: feed is empty");
 				}
+				if (!feed.sync_position.empty()) {
+					// An incremental fetch only brings new articles, so
+					// take the publication times of those fetched earlier
+					// into account too
+					const auto stored = ctrl.get_feedcontainer()->get_feed(pos);
+					if (adaptive && stored != nullptr) {
+						pubdates = pubdates_of(*stored);
+					}
+					apply_remote_sync(pos, oldfeed->rssurl(), feed);
+				}
 			}
 			oldfeed->set_status(DlStatus::SUCCESS);
 		} catch (const DbException& e) {
@@ -142,6 +234,16 @@ void Reloader::reload(unsigned int pos,
 		} catch (const rsspp::NotModifiedException&) {
 			// Nothing to be done, feed was not chaned since last retrieve
 			oldfeed->set_status(DlStatus::SUCCESS);
+			outcome = ReloadScheduler::Outcome::UNCHANGED;
+			if (adaptive) {
+				pubdates = pubdates_of(*oldfeed);
+			}
+		}
+		if (!errmsg.empty()) {
+			outcome = ReloadScheduler::Outcome::FAILED;
+		}
+		if (adaptive) {
+			record_reload(oldfeed->rssurl(), outcome, pubdates);
 		}
 		if (!errmsg.empty()) {
 			oldfeed->set_status(DlStatus::DL_ERROR);
@@ -153,8 +255,29 @@ void Reloader::reload(unsigned int pos,
 	}
 }
 
-void Reloader::partition_reload_to_threads(
-	std::function<void(unsigned int start, unsigned int end)> handle_range,
+void Reloader::apply_remote_sync(unsigned int pos, const std::string& url,
+	const rsspp::Feed& feed)
+{
+	if (feed.unread_guids != nullptr) {
+		const auto changed = rsscache.sync_unread_state(url, *feed.unread_guids);
+		const auto stored = ctrl.get_feedcontainer()->get_feed(pos);
+		if (!changed.empty() && stored != nullptr) {
+			std::lock_guard<std::mutex> lock(stored->item_mutex);
+			for (const auto& item : stored->items()) {
+				const auto it = changed.find(item->guid());
+				if (it != changed.end()) {
+					item->set_unread_nowrite(it->second);
+				}
+			}
+		}
+	}
+
+	// Only now that the articles are stored, the next fetch may skip them
+	rsscache.update_sync_position(url, feed.sync_position);
+}
+
+void Reloader::distribute_reload_to_threads(
+	std::function<void(CurlHandle& easyhandle, unsigned int index)> handle_index,
 	unsigned int num_feeds)
 {
 	int num_threads = cfg.get_configvalue_as_int("reload-threads");
@@ -163,36 +286,68 @@ void Reloader::partition_reload_to_threads(
 	const int max_threads = num_feeds;
 	num_threads = std::max(min_threads, std::min(num_threads, max_threads));
 
-	LOG(Level::DEBUG, "Reloader::partition_reload_to_threads: starting with reload...");
-	reload_progress = 0;
-	reload_progress_max = num_feeds;
-	if (num_threads == 1) {
-		handle_range(0, num_feeds - 1);
-	} else {
-		std::vector<std::pair<unsigned int, unsigned int>> partitions =
-				utils::partition_indexes(0, num_feeds - 1, num_threads);
-		std::vector<std::thread> threads;
-		LOG(Level::DEBUG,
-			"Reloader::partition_reload_to_threads: starting reload threads...");
-		for (int i = 0; i < num_threads - 1; i++) {
-			auto range = partitions[i];
-			threads.emplace_back([=]() {
-				handle_range(range.first, range.second);
-			});
+	LOG(Level::DEBUG, "Reloader::distribute_reload_to_threads: starting with reload...");
+
+	WorkStealingQueue queue(num_feeds, num_threads);
+	auto worker = [&](unsigned int worker_id) {
+		CurlHandle easyhandle;
+		curl_share.attach(easyhandle.ptr());
+		unsigned int index = 0;
+		while (queue.next(worker_id, index)) {
+			// Reset any options set on the handle before next reload
+			curl_easy_reset(easyhandle.ptr());
+			handle_index(easyhandle, index);
 		}
+	};
+
+	std::vector<std::thread> threads;
+	LOG(Level::DEBUG,
+		"Reloader::distribute_reload_to_threads: starting reload threads...");
+	for (int i = 1; i < num_threads; i++) {
+		threads.emplace_back(worker, i);
+	}
+	LOG(Level::DEBUG,
+		"Reloader::distribute_reload_to_threads: starting my own reload...");
+	worker(0);
+	LOG(Level::DEBUG,
+		"Reloader::distribute_reload_to_threads: joining other threads...");
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+}
+
+ReloadScheduler Reloader::reload_scheduler() const
+{
+	time_t min_interval = 60 * cfg.get_configvalue_as_int("reload-time");
+	if (min_interval == 0) {
+		min_interval = 60;
+	}
+	const time_t max_interval = 60 * cfg.get_configvalue_as_int("reload-adaptive-max-time");
+	return ReloadScheduler(min_interval, max_interval);
+}
+
+void Reloader::record_reload(const std::string& url,
+	ReloadScheduler::Outcome outcome,
+	const std::vector<time_t>& pubdates)
+{
+	try {
+		ReloadSchedule schedule = rsscache.fetch_reload_schedule(url);
+		reload_scheduler().record_reload(url, schedule, time(nullptr), outcome,
+			pubdates);
+		rsscache.update_reload_schedule(url, schedule);
 		LOG(Level::DEBUG,
-			"Reloader::partition_reload_to_threads: starting my own reload...");
-		handle_range(partitions[num_threads - 1].first,
-			partitions[num_threads - 1].second);
-		LOG(Level::DEBUG,
-			"Reloader::partition_reload_to_threads: joining other threads...");
-		for (size_t i = 0; i < threads.size(); i++) {
-			threads[i].join();
-		}
+			"Reloader::record_reload: next reload of %s in %" PRIi64 " seconds",
+			url,
+			static_cast<int64_t>(schedule.next_reload - time(nullptr)));
+	} catch (const DbException& e) {
+		LOG(Level::ERROR,
+			"Reloader::record_reload: couldn't store schedule of %s: %s",
+			url,
+			e.what());
 	}
 }
 
-void Reloader::reload_all(bool unattended)
+void Reloader::reload_all(bool unattended, bool only_due)
 {
 	ScopeMeasure sm("Reloader::reload_all");
 
@@ -205,8 +360,29 @@ void Reloader::reload_all(bool unattended)
 	const auto num_feeds = ctrl.get_feedcontainer()->feeds_size();
 
 	std::vector<unsigned int> v;
-	for (unsigned int i = 0; i < num_feeds; ++i) {
-		v.push_back(i);
+	if (only_due) {
+		const auto schedules = rsscache.fetch_reload_schedules();
+		const auto scheduler = reload_scheduler();
+		const time_t now = time(nullptr);
+		const auto feeds = ctrl.get_feedcontainer()->get_all_feeds();
+		for (unsigned int i = 0; i < num_feeds && i < feeds.size(); ++i) {
+			const auto schedule = schedules.find(feeds[i]->rssurl());
+			if (schedule == schedules.end()
+				|| scheduler.is_due(schedule->second, now)) {
+				v.push_back(i);
+			}
+		}
+		LOG(Level::INFO,
+			"Reloader::reload_all: %zu of %zu feeds are due",
+			v.size(),
+			feeds.size());
+		if (v.empty()) {
+			return;
+		}
+	} else {
+		for (unsigned int i = 0; i < num_feeds; ++i) {
+			v.push_back(i);
+		}
 	}
 	reload_indexes_impl(v, unattended);
 
@@ -230,6 +406,12 @@ void Reloader::reload_all(bool unattended)
 	notify_reload_finished(unread_feeds, unread_articles);
 }
 
+void Reloader::reload_all_exclusive(bool unattended)
+{
+	std::lock_guard<std::mutex> guard(reload_mutex);
+	reload_all(unattended);
+}
+
 void Reloader::reload_indexes_impl(std::vector<unsigned int> indexes, bool unattended)
 {
 	auto extract = [](std::string& s, const std::string& url) {
@@ -255,19 +437,164 @@ void Reloader::reload_indexes_impl(std::vector<unsigned int> indexes, bool unatt
 		return domain1 < domain2;
 	});
 
-	partition_reload_to_threads([&](unsigned int start, unsigned int end) {
-		CurlHandle easyhandle;
-		for (auto i = start; i <= end; ++i) {
-			// Reset any options set on the handle before next reload
-			curl_easy_reset(easyhandle.ptr());
+	reload_progress = 0;
+	reload_progress_max = indexes.size();
+
+	// Plain HTTP feeds are downloaded through a single curl_multi event loop,
+	// so one slow host doesn't hold up the feeds queued behind it. Everything
+	// else (remote APIs, plugins, local files) is reloaded by threads, each
+	// doing one blocking fetch after another and taking over the remaining
+	// feeds of threads which are held up by slow ones.
+	std::vector<unsigned int> http_indexes;
+	std::vector<unsigned int> other_indexes;
+	for (const auto index : indexes) {
+		if (FeedRetriever::is_http_download(cfg, feeds[index]->rssurl())) {
+			http_indexes.push_back(index);
+		} else {
+			other_indexes.push_back(index);
+		}
+	}
+
+	std::thread other_feeds_thread;
+	if (!other_indexes.empty()) {
+		other_feeds_thread = std::thread([&]() {
+			// Feeds the remote API returned all at once are only parsed by
+			// the threads, without another request
+			auto prefetched = retrieve_in_bulk(other_indexes);
+			distribute_reload_to_threads([&](CurlHandle& easyhandle, unsigned int i) {
+				unsigned int feed_index = other_indexes[i];
+				LOG(Level::DEBUG,
+					"Reloader::reload_indexes_impl: reloading feed #%u",
+					feed_index);
+				const auto feed = prefetched.find(feeds[feed_index]->rssurl());
+				if (feed != prefetched.end()) {
+					reload(feed_index, true, unattended, [&](const std::string&) {
+						return std::move(feed->second);
+					});
+				} else {
+					reload(feed_index, easyhandle, true, unattended);
+				}
+			}, other_indexes.size());
+		});
+	}
 
-			unsigned int feed_index = indexes[i];
-			LOG(Level::DEBUG,
-				"Reloader::reload_indexes_impl: reloading feed #%u",
-				feed_index);
-			reload(feed_index, easyhandle, true, unattended);
+	if (!http_indexes.empty()) {
+		reload_http_feeds(http_indexes, unattended);
+	}
+
+	if (other_feeds_thread.joinable()) {
+		other_feeds_thread.join();
+	}
+}
+
+std::map<std::string, rsspp::Feed> Reloader::retrieve_in_bulk(
+	const std::vector<unsigned int>& indexes)
+{
+	if (ctrl.get_api() == nullptr) {
+		return {};
+	}
+
+	std::vector<std::string> urls;
+	for (const auto index : indexes) {
+		const auto feed = ctrl.get_feedcontainer()->get_feed(index);
+		if (feed != nullptr && !feed->is_query_feed()) {
+			urls.push_back(feed->rssurl());
 		}
-	}, indexes.size());
+	}
+
+	const bool ignore_dl =
+		(cfg.get_configvalue("ignore-mode") == "download");
+	RssIgnores* ign = ignore_dl ? ctrl.get_ignores() : nullptr;
+
+	CurlHandle easyhandle;
+	curl_share.attach(easyhandle.ptr());
+	try {
+		FeedRetriever feed_retriever(cfg, rsscache, easyhandle, ign,
+			ctrl.get_api());
+		return feed_retriever.retrieve_in_bulk(urls);
+	} catch (const std::exception& e) {
+		LOG(Level::ERROR,
+			"Reloader::retrieve_in_bulk: falling back to fetching feeds one "
+			"by one: %s",
+			e.what());
+		return {};
+	}
+}
+
+void Reloader::reload_http_feeds(const std::vector<unsigned int>& indexes,
+	bool unattended)
+{
+	ScopeMeasure sm("Reloader::reload_http_feeds");
+
+	const bool ignore_dl =
+		(cfg.get_configvalue("ignore-mode") == "download");
+	RssIgnores* ign = ignore_dl ? ctrl.get_ignores() : nullptr;
+
+	std::vector<FeedRetriever::HttpDownload> downloads(indexes.size());
+	std::vector<std::exception_ptr> setup_errors(indexes.size());
+
+	std::vector<CurlMultiRunner::Transfer> transfers;
+	for (size_t i = 0; i < indexes.size(); ++i) {
+		const unsigned int pos = indexes[i];
+		const auto feed = ctrl.get_feedcontainer()->get_feed(pos);
+		const std::string url = feed ? feed->rssurl() : "";
+
+		CurlMultiRunner::Transfer transfer;
+		transfer.setup = [=, &downloads, &setup_errors](CurlHandle& easyhandle) {
+			if (url.empty()) {
+				return false;
+			}
+			try {
+				LOG(Level::DEBUG,
+					"Reloader::reload_http_feeds: starting download of feed #%u",
+					pos);
+				FeedRetriever feed_retriever(cfg, rsscache, easyhandle, ign,
+					ctrl.get_api());
+				downloads[i] = feed_retriever.start_http_download(url);
+				feed->set_status(DlStatus::DURING_DOWNLOAD);
+				return true;
+			} catch (...) {
+				setup_errors[i] = std::current_exception();
+				return false;
+			}
+		};
+		transfer.finish = [=, &downloads, &setup_errors](CurlHandle& easyhandle,
+		CURLcode result) {
+			reload(pos, true, unattended, [&](const std::string& feed_url) {
+				if (setup_errors[i]) {
+					std::rethrow_exception(setup_errors[i]);
+				}
+				FeedRetriever feed_retriever(cfg, rsscache, easyhandle, ign,
+					ctrl.get_api());
+				if (downloads[i].parser == nullptr) {
+					// The feed vanished while the reload was queued
+					return rsspp::Feed();
+				}
+				rsspp::Feed f = feed_retriever.finish_http_download(feed_url,
+						downloads[i], result);
+				downloads[i] = FeedRetriever::HttpDownload();
+
+				// Further attempts (if "download-retries" asks for them) are
+				// made synchronously on this worker's handle
+				const unsigned int retrycount = cfg.get_configvalue_as_int("download-retries");
+				for (unsigned int attempt = 1; attempt < retrycount
+					&& f.rss_version == rsspp::Feed::Version::UNKNOWN; ++attempt) {
+					auto download = feed_retriever.start_http_download(feed_url);
+					const CURLcode ret = curl_easy_perform(easyhandle.ptr());
+					f = feed_retriever.finish_http_download(feed_url, download, ret);
+				}
+				return f;
+			});
+		};
+		transfers.push_back(std::move(transfer));
+	}
+
+	std::lock_guard<std::mutex> guard(http_runner_mutex);
+	http_runner.set_limits(
+		std::max(1, cfg.get_configvalue_as_int("reload-max-transfers")),
+		std::max(0, cfg.get_configvalue_as_int("reload-max-host-connections")),
+		std::max(1, cfg.get_configvalue_as_int("reload-threads")));
+	http_runner.run(transfers);
 }
 
 void Reloader::reload_indexes(const std::vector<unsigned int>& indexes, bool unattended)
@@ -0,0 +1,115 @@
+#include "reloadscheduler.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace newsboat {
+
+namespace {
+
+// Enough articles to even out a few irregular ones, few enough for the
+// estimate to follow changes in how often the feed is updated
+const size_t RECENT_ARTICLES = 20;
+
+// Spreads reloads of feeds with the same interval, but doesn't delay any of
+// them by more than this
+const time_t MAX_JITTER = 15 * 60;
+
+} // namespace
+
+ReloadScheduler::ReloadScheduler(time_t min_interval, time_t max_interval)
+	: min_interval(std::max<time_t>(min_interval, 1))
+	, max_interval(std::max(max_interval, this->min_interval))
+{
+}
+
+void ReloadScheduler::record_reload(const std::string& url,
+	ReloadSchedule& schedule,
+	time_t now,
+	Outcome outcome,
+	const std::vector<time_t>& pubdates) const
+{
+	if (outcome == Outcome::FAILED) {
+		schedule.next_reload = std::min(schedule.not_before, now + max_interval);
+		return;
+	}
+
+	if (outcome == Outcome::NEW_ARTICLES) {
+		schedule.unchanged_reloads = 0;
+	} else if (schedule.unchanged_reloads < 64) {
+		schedule.unchanged_reloads++;
+	}
+
+	const time_t sample = publish_interval(pubdates);
+	if (sample > 0) {
+		schedule.publish_interval = (schedule.publish_interval > 0)
+			? (3 * schedule.publish_interval + sample) / 4
+			: sample;
+	}
+
+	time_t since_latest = 0;
+	if (!pubdates.empty()) {
+		since_latest = std::max<time_t>(0,
+				now - *std::max_element(pubdates.begin(), pubdates.end()));
+	}
+
+	const time_t interval = next_interval(schedule, since_latest);
+	schedule.next_reload = now + interval + jitter(url, interval);
+	schedule.next_reload = std::max(schedule.next_reload,
+			std::min(schedule.not_before, now + max_interval));
+}
+
+bool ReloadScheduler::is_due(const ReloadSchedule& schedule, time_t now) const
+{
+	return schedule.next_reload <= now + min_interval / 2;
+}
+
+time_t ReloadScheduler::publish_interval(std::vector<time_t> pubdates)
+{
+	pubdates.erase(std::remove_if(pubdates.begin(), pubdates.end(),
+	[](time_t t) {
+		return t <= 0;
+	}), pubdates.end());
+	std::sort(pubdates.begin(), pubdates.end(), std::greater<time_t>());
+	pubdates.erase(std::unique(pubdates.begin(), pubdates.end()), pubdates.end());
+	if (pubdates.size() > RECENT_ARTICLES) {
+		pubdates.resize(RECENT_ARTICLES);
+	}
+
+	if (pubdates.size() < 2) {
+		return 0;
+	}
+	return (pubdates.front() - pubdates.back()) / (pubdates.size() - 1);
+}
+
+time_t ReloadScheduler::next_interval(const ReloadSchedule& schedule,
+	time_t since_latest) const
+{
+	time_t backoff = min_interval;
+	for (unsigned int i = 0; i < schedule.unchanged_reloads && backoff < max_interval;
+		i++) {
+		backoff *= 2;
+	}
+
+	// Checking twice per article is enough not to fall behind. A feed that
+	// went quiet is checked less often the longer it stays quiet.
+	time_t limit = max_interval;
+	const time_t expected = std::max(schedule.publish_interval, since_latest);
+	if (expected > 0) {
+		limit = std::min(limit, expected / 2);
+	}
+
+	return std::clamp(std::min(backoff, limit), min_interval, max_interval);
+}
+
+time_t ReloadScheduler::jitter(const std::string& url, time_t interval) const
+{
+	const time_t cap = std::min(interval / 10, MAX_JITTER);
+	if (cap <= 0) {
+		return 0;
+	}
+	// Derived from the URL, so a feed keeps its place relative to the others
+	return std::hash<std::string>()(url) % (cap + 1);
+}
+
+} // namespace newsboat
@@ -7,12 +7,13 @@
 
 namespace newsboat {
 
-ReloadThread::ReloadThread(Controller& c, ConfigContainer& cf)
+ReloadThread::ReloadThread(Controller& c, ConfigContainer& cf, bool unattended)
 	: ctrl(c)
 	, oldtime(0)
 	, waittime_sec(0)
 	, suppressed_first(false)
 	, cfg(cf)
+	, unattended(unattended)
 {
 	LOG(Level::INFO,
 		"ReloadThread: waiting %" PRIi64 " seconds between reloads",
@@ -37,12 +38,12 @@ void ReloadThread::operator()()
 
 		if (cfg.get_configvalue_as_bool("auto-reload")) {
 			if (suppressed_first) {
-				ctrl.get_reloader()->start_reload_all_thread();
+				ctrl.get_reloader()->start_reload_due_thread(unattended);
 			} else {
 				suppressed_first = true;
 				if (!cfg.get_configvalue_as_bool(
 						"suppress-first-reload")) {
-					ctrl.get_reloader()->start_reload_all_thread();
+					ctrl.get_reloader()->start_reload_due_thread(unattended);
 				}
 			}
 		} else {
@@ -27,6 +27,17 @@ bool RemoteApi::mark_articles_read(const std::vector<std::string>& guids)
 	return success;
 }
 
+bool RemoteApi::mark_articles_unread(const std::vector<std::string>& guids)
+{
+	bool success = true;
+	for (const auto& guid : guids) {
+		if (!this->mark_article_read(guid, false)) {
+			success = false;
+		}
+	}
+	return success;
+}
+
 const std::string RemoteApi::read_password(const Filepath& file)
 {
 	glob_t exp;
@@ -0,0 +1,248 @@
+#include "remoteapioutbox.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <unordered_map>
+
+#include "cache.h"
+#include "logger.h"
+#include "remoteapi.h"
+#include "scopemeasure.h"
+
+namespace newsboat {
+
+namespace {
+
+/// Changes which come in within this time of each other are sent together
+const std::chrono::seconds BATCH_DELAY(1);
+
+/// Maximum number of articles marked read or unread by a single call
+const std::size_t MAX_BATCH_SIZE = 100;
+
+/// Changes which failed this many times in a row are dropped
+const unsigned int MAX_ATTEMPTS = 10;
+
+const time_t MIN_RETRY_DELAY = 30;
+const time_t MAX_RETRY_DELAY = 60 * 60;
+
+/// Calls \a send, treating exceptions as failures
+bool try_send(const std::string& what, const std::function<bool()>& send)
+{
+	try {
+		return send();
+	} catch (const std::exception& e) {
+		LOG(Level::ERROR, "RemoteApiOutbox: %s failed: %s", what, e.what());
+		return false;
+	}
+}
+
+} // namespace
+
+RemoteApiOutbox::RemoteApiOutbox(RemoteApi& api, Cache& cache,
+	const std::string& api_name)
+	: api(api)
+	, cache(cache)
+	, api_name(api_name)
+	, changed(false)
+	, stopping(false)
+{
+}
+
+RemoteApiOutbox::~RemoteApiOutbox()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+	}
+	cv.notify_one();
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+void RemoteApiOutbox::start()
+{
+	if (!worker.joinable()) {
+		worker = std::thread(&RemoteApiOutbox::run, this);
+	}
+}
+
+void RemoteApiOutbox::mark_article_read(const std::string& guid, bool read)
+{
+	cache.queue_remote_read_state(api_name, {guid}, read);
+	notify();
+}
+
+void RemoteApiOutbox::mark_articles_read(const std::vector<std::string>& guids)
+{
+	if (guids.empty()) {
+		return;
+	}
+	cache.queue_remote_read_state(api_name, guids, true);
+	notify();
+}
+
+void RemoteApiOutbox::mark_feed_read(const std::string& feedurl,
+	const std::vector<std::string>& unread_guids)
+{
+	const bool ok = try_send("marking feed read", [&]() {
+		return api.mark_all_read(feedurl);
+	});
+	if (!ok) {
+		LOG(Level::INFO,
+			"RemoteApiOutbox::mark_feed_read: queueing %zu articles of %s "
+			"to be marked read",
+			unread_guids.size(),
+			feedurl);
+		mark_articles_read(unread_guids);
+	}
+}
+
+void RemoteApiOutbox::update_article_flags(const std::string& oldflags,
+	const std::string& newflags,
+	const std::string& guid)
+{
+	cache.queue_remote_flags(api_name, guid, oldflags, newflags);
+	notify();
+}
+
+time_t RemoteApiOutbox::send_due_changes(time_t now)
+{
+	ScopeMeasure m("RemoteApiOutbox::send_due_changes");
+
+	const auto entries = cache.fetch_remote_outbox(api_name);
+
+	time_t next_attempt = 0;
+	const auto schedule = [&next_attempt](time_t t) {
+		if (next_attempt == 0 || t < next_attempt) {
+			next_attempt = t;
+		}
+	};
+
+	std::vector<const OutboxEntry*> due;
+	std::vector<std::string> to_read;
+	std::vector<std::string> to_unread;
+	for (const auto& entry : entries) {
+		if (entry.not_before > now) {
+			schedule(entry.not_before);
+			continue;
+		}
+		due.push_back(&entry);
+		if (entry.read.has_value()) {
+			(entry.read.value() ? to_read : to_unread).push_back(entry.guid);
+		}
+	}
+	if (due.empty()) {
+		return next_attempt;
+	}
+	LOG(Level::DEBUG,
+		"RemoteApiOutbox::send_due_changes: %zu articles due, "
+		"%zu to be marked read, %zu unread",
+		due.size(),
+		to_read.size(),
+		to_unread.size());
+
+	std::unordered_map<std::string, bool> succeeded;
+	const auto send_read_state = [&](const std::vector<std::string>& guids,
+	bool read) {
+		for (std::size_t begin = 0; begin < guids.size(); begin += MAX_BATCH_SIZE) {
+			const auto end = std::min(begin + MAX_BATCH_SIZE, guids.size());
+			const std::vector<std::string> batch(guids.begin() + begin,
+				guids.begin() + end);
+			const bool ok = try_send(read ? "marking articles read"
+			: "marking articles unread", [&]() {
+				return read ? api.mark_articles_read(batch)
+					: api.mark_articles_unread(batch);
+			});
+			for (const auto& guid : batch) {
+				succeeded[guid] = ok;
+			}
+		}
+	};
+	send_read_state(to_read, true);
+	send_read_state(to_unread, false);
+
+	for (const auto entry : due) {
+		bool ok = succeeded.count(entry->guid) == 0 || succeeded[entry->guid];
+		if (entry->newflags.has_value() && entry->newflags.value() != entry->oldflags) {
+			ok = try_send("updating flags", [&]() {
+				return api.update_article_flags(entry->oldflags,
+						entry->newflags.value(), entry->guid);
+			}) && ok;
+		}
+
+		if (ok) {
+			cache.remove_from_remote_outbox(api_name, *entry);
+		} else if (entry->attempts + 1 >= MAX_ATTEMPTS) {
+			LOG(Level::ERROR,
+				"RemoteApiOutbox::send_due_changes: giving up on changes "
+				"to article %s after %u attempts",
+				entry->guid,
+				entry->attempts + 1);
+			cache.remove_from_remote_outbox(api_name, *entry);
+		} else {
+			const time_t retry_at = now + retry_delay(entry->attempts + 1);
+			cache.postpone_remote_outbox_entry(api_name, *entry, retry_at);
+			schedule(retry_at);
+		}
+	}
+
+	return next_attempt;
+}
+
+time_t RemoteApiOutbox::retry_delay(unsigned int attempts)
+{
+	time_t delay = MIN_RETRY_DELAY;
+	for (unsigned int i = 1; i < attempts && delay < MAX_RETRY_DELAY; ++i) {
+		delay *= 2;
+	}
+	return std::min(delay, MAX_RETRY_DELAY);
+}
+
+void RemoteApiOutbox::notify()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		changed = true;
+	}
+	cv.notify_one();
+}
+
+void RemoteApiOutbox::run()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (!stopping) {
+		changed = false;
+		lock.unlock();
+		time_t next_attempt = 0;
+		try {
+			next_attempt = send_due_changes(time(nullptr));
+		} catch (const std::exception& e) {
+			LOG(Level::ERROR, "RemoteApiOutbox::run: %s", e.what());
+			next_attempt = time(nullptr) + MIN_RETRY_DELAY;
+		}
+		lock.lock();
+
+		const auto woken = [this]() {
+			return stopping || changed;
+		};
+		if (next_attempt == 0) {
+			cv.wait(lock, woken);
+		} else {
+			cv.wait_until(lock,
+				std::chrono::system_clock::from_time_t(next_attempt), woken);
+		}
+
+		// Give further changes a chance to join the batch, e.g. when
+		// articles are being marked read one after another
+		if (changed) {
+			cv.wait_for(lock, BATCH_DELAY, [this]() {
+				return stopping;
+			});
+		}
+	}
+}
+
+} // namespace newsboat
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <curl/curl.h>
 #include <langinfo.h>
+#include <limits>
 #include <random>
 #include <string.h>
 #include <sys/utsname.h>
@@ -14,8 +15,11 @@
 #include "config.h"
 #include "configcontainer.h"
 #include "logger.h"
+#include "parallelmatcher.h"
 #include "scopemeasure.h"
+#include "sortbykey.h"
 #include "strprintf.h"
+#include "unreadindex.h"
 #include "utils.h"
 
 namespace newsboat {
@@ -28,7 +32,12 @@ RssFeed::RssFeed(Cache* c, const std::string& rssurl)
 	, is_rtl_(false)
 	, idx(0)
 	, order(0)
+	, reuse_match_results(false)
+	, match_results_depend_on_feed(false)
+	, match_generation(0)
+	, evaluated_count(0)
 	, status_(DlStatus::SUCCESS)
+	, unread_count_(0)
 {
 	if (utils::is_query_url(rssurl_)) {
 		/* Query string looks like this:
@@ -51,12 +60,15 @@ RssFeed::RssFeed(Cache* c, const std::string& rssurl)
 			query += *it;
 		}
 		// Have to check if the result is a valid query, just in case
-		Matcher m;
-		if (!m.parse(query)) {
+		matcher = std::make_shared<Matcher>();
+		if (!matcher->parse(query)) {
 			throw strprintf::fmt(
 				_("couldn't parse filter expression `%s': %s"),
-				query, m.get_parse_error());
+				query, matcher->get_parse_error());
 		}
+		reuse_match_results = can_reuse_match_results(*matcher);
+		match_results_depend_on_feed = refers_to_feed_attributes(*matcher);
+		parallel_matcher = std::make_unique<ParallelMatcher>(*matcher, ch);
 
 		LOG(Level::DEBUG,
 			"RssFeed constructor: query name = `%s' expr = `%s'",
@@ -68,14 +80,83 @@ RssFeed::RssFeed(Cache* c, const std::string& rssurl)
 	}
 }
 
-unsigned int RssFeed::unread_item_count() const
+RssFeed::~RssFeed()
+{
+	std::lock_guard<std::mutex> guard(RssItem::unread_mutex);
+	update_unread_index(false);
+	for (const auto& item : items_) {
+		auto& feeds = item->containing_feeds;
+		feeds.erase(std::remove(feeds.begin(), feeds.end(), this), feeds.end());
+	}
+}
+
+void RssFeed::item_added(RssItem& item)
+{
+	std::lock_guard<std::mutex> guard(RssItem::unread_mutex);
+	item.containing_feeds.push_back(this);
+	if (item.unread()) {
+		item_unread_changed(item);
+	}
+}
+
+void RssFeed::item_removed(RssItem& item)
+{
+	std::lock_guard<std::mutex> guard(RssItem::unread_mutex);
+	auto& feeds = item.containing_feeds;
+	const auto it = std::find(feeds.begin(), feeds.end(), this);
+	if (it == feeds.end()) {
+		return;
+	}
+	feeds.erase(it);
+	if (item.unread()) {
+		unread_count_--;
+		if (unread_index_ && !hidden()) {
+			unread_index_->remove(item.guid());
+		}
+	}
+}
+
+void RssFeed::item_unread_changed(const RssItem& item)
+{
+	if (item.unread()) {
+		unread_count_++;
+	} else {
+		unread_count_--;
+	}
+
+	if (unread_index_ && !hidden()) {
+		if (item.unread()) {
+			unread_index_->add(item.guid());
+		} else {
+			unread_index_->remove(item.guid());
+		}
+	}
+}
+
+void RssFeed::update_unread_index(bool add)
+{
+	if (!unread_index_ || hidden()) {
+		return;
+	}
+	for (const auto& item : items_) {
+		if (!item->unread()) {
+			continue;
+		}
+		if (add) {
+			unread_index_->add(item->guid());
+		} else {
+			unread_index_->remove(item->guid());
+		}
+	}
+}
+
+void RssFeed::set_unread_index(std::shared_ptr<UnreadIndex> index)
 {
 	std::lock_guard<std::mutex> lock(item_mutex);
-	return std::count_if(items_.begin(),
-			items_.end(),
-	[](const std::shared_ptr<RssItem>& item) {
-		return item->unread();
-	});
+	std::lock_guard<std::mutex> guard(RssItem::unread_mutex);
+	update_unread_index(false);
+	unread_index_ = index;
+	update_unread_index(true);
 }
 
 bool RssFeed::matches_tag(const std::string& tag)
@@ -109,11 +190,35 @@ std::vector<std::string> RssFeed::get_tags() const
 
 void RssFeed::set_tags(const std::vector<std::string>& tags)
 {
+	// Hiding the feed (or showing it again) changes what it contributes to
+	// the unread index
+	std::lock_guard<std::mutex> lock(item_mutex);
+	std::lock_guard<std::mutex> guard(RssItem::unread_mutex);
+	update_unread_index(false);
 	tags_ = tags;
+	update_unread_index(true);
+
+	// The title may come from a tag
+	std::lock_guard<std::mutex> title_guard(title_cache_mutex_);
+	title_cache_.reset();
+}
+
+void RssFeed::set_title(const std::string& t)
+{
+	title_ = t;
+	utils::trim(title_);
+
+	std::lock_guard<std::mutex> guard(title_cache_mutex_);
+	title_cache_.reset();
 }
 
 std::string RssFeed::title() const
 {
+	std::lock_guard<std::mutex> guard(title_cache_mutex_);
+	if (title_cache_.has_value()) {
+		return title_cache_.value();
+	}
+
 	bool found_title = false;
 	std::string alt_title;
 	for (const auto& tag : tags_) {
@@ -123,9 +228,10 @@ std::string RssFeed::title() const
 			break;
 		}
 	}
-	return found_title
+	title_cache_ = found_title
 		? alt_title
 		: utils::utf8_to_locale(title_);
+	return title_cache_.value();
 }
 
 bool RssFeed::hidden() const
@@ -218,6 +324,36 @@ std::optional<std::string> RssFeed::attribute_value(const std::string&
 	return std::nullopt;
 }
 
+std::optional<int> RssFeed::attribute_value_as_number(
+	const std::string& attribname) const
+{
+	const auto saturate = [](long long value) {
+		return static_cast<int>(std::clamp<long long>(value,
+					std::numeric_limits<int>::min(),
+					std::numeric_limits<int>::max()));
+	};
+
+	if (attribname == "unread_count") {
+		return saturate(unread_item_count());
+	} else if (attribname == "total_count") {
+		return saturate(items_.size());
+	} else if (attribname == "feedindex") {
+		return saturate(idx);
+	} else if (attribname == "latest_article_age") {
+		using ItemType = std::shared_ptr<RssItem>;
+		const auto latest_article_iterator = std::max_element(items_.begin(),
+		items_.end(), [](const ItemType& a, const ItemType& b) {
+			return a->pubDate_timestamp() < b->pubDate_timestamp();
+		});
+		if (latest_article_iterator != items_.end()) {
+			const auto timestamp = (*latest_article_iterator)->pubDate_timestamp();
+			return saturate((time(nullptr) - timestamp) / 86400);
+		}
+		return 0;
+	}
+	return std::nullopt;
+}
+
 void RssFeed::update_items(std::vector<std::shared_ptr<RssFeed>> feeds)
 {
 	std::lock_guard<std::mutex> lock(item_mutex);
@@ -229,26 +365,95 @@ void RssFeed::update_items(std::vector<std::shared_ptr<RssFeed>> feeds)
 
 	ScopeMeasure sm("RssFeed::update_items");
 
-	Matcher m(query);
-
+	for (const auto& item : items_) {
+		item_removed(*item);
+	}
 	items_.clear();
 	items_guid_map.clear();
-
+	match_generation++;
+
+	// Articles are collected first and matched all at once, so that the
+	// matching can be spread over several threads
+	struct Candidate {
+		std::shared_ptr<RssItem> item;
+		std::shared_ptr<RssFeed> feed;
+		unsigned int item_version;
+		MatchResult* result;
+		bool needs_evaluation;
+	};
+	std::vector<Candidate> candidates;
+	std::vector<std::shared_ptr<RssItem>> to_evaluate;
 	for (const auto& feed : feeds) {
 		if (feed->is_query_feed()) {
 			// don't fetch items from other query feeds!
 			continue;
 		}
 		for (const auto& item : feed->items()) {
-			if (!item->deleted() && m.matches(item.get())) {
-				LOG(Level::DEBUG, "RssFeed::update_items: Matcher matches!");
-				item->set_feedptr(feed);
-				items_.push_back(item);
-				items_guid_map[item->guid()] = item;
+			if (item->deleted()) {
+				continue;
+			}
+
+			// Taken before matching, so that changes made in the meantime
+			// cause the article to be matched again next time
+			const unsigned int item_version = item->version();
+			MatchResult* result = nullptr;
+			bool needs_evaluation = true;
+			if (reuse_match_results) {
+				result = &match_results[item.get()];
+				// An expired pointer means that a new article was allocated
+				// at the address of one that's gone
+				needs_evaluation = result->item.expired()
+					|| result->item_version != item_version
+					|| (match_results_depend_on_feed && result->feed != feed.get());
+				result->generation = match_generation;
 			}
+			if (needs_evaluation) {
+				to_evaluate.push_back(item);
+			}
+			candidates.push_back(Candidate{item, feed, item_version, result,
+					needs_evaluation});
+		}
+	}
+
+	const std::vector<bool> evaluated = parallel_matcher->matches(to_evaluate);
+	evaluated_count = evaluated.size();
+
+	auto next_evaluated = evaluated.begin();
+	for (auto& candidate : candidates) {
+		bool matches = false;
+		if (candidate.needs_evaluation) {
+			matches = *next_evaluated++;
+			if (candidate.result != nullptr) {
+				candidate.result->item_version = candidate.item_version;
+				candidate.result->matches = matches;
+				candidate.result->item = candidate.item;
+				candidate.result->feed = candidate.feed.get();
+			}
+		} else {
+			matches = candidate.result->matches;
+		}
+
+		if (matches) {
+			LOG(Level::DEBUG, "RssFeed::update_items: Matcher matches!");
+			candidate.item->set_feedptr(candidate.feed);
+			items_.push_back(candidate.item);
+			items_guid_map[candidate.item->guid()] = candidate.item;
+			item_added(*candidate.item);
 		}
 	}
 
+	// forget about articles which are gone
+	for (auto it = match_results.begin(); it != match_results.end();) {
+		if (it->second.generation != match_generation) {
+			it = match_results.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	LOG(Level::DEBUG,
+		"RssFeed::update_items: evaluated the query for %" PRIu64 " articles",
+		static_cast<uint64_t>(evaluated.size()));
 	sm.stopover("matching");
 
 	std::sort(items_.begin(), items_.end());
@@ -256,6 +461,56 @@ void RssFeed::update_items(std::vector<std::shared_ptr<RssFeed>> feeds)
 	sm.stopover("sorting");
 }
 
+bool RssFeed::can_reuse_match_results(Matcher& matcher)
+{
+	// Attributes that only change along with the article's version, or when
+	// the article is moved to another feed (i.e. the feed was reloaded, see
+	// refers_to_feed_attributes()).
+	// Everything else (e.g. `age`, `unread_count`, `tags`) can change
+	// without either, so such queries are always evaluated from scratch.
+	static const std::set<std::string> stable_attributes = {
+		"title",
+		"link",
+		"author",
+		"content",
+		"date",
+		"guid",
+		"unread",
+		"enclosure_url",
+		"enclosure_type",
+		"flags",
+		"feedtitle",
+		"description",
+		"feedlink",
+		"feeddate",
+		"rssurl",
+	};
+	for (const auto& attribute : matcher.get_referenced_attributes()) {
+		if (stable_attributes.find(attribute) == stable_attributes.end()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool RssFeed::refers_to_feed_attributes(Matcher& matcher)
+{
+	// A reloaded feed is a new RssFeed object which keeps the articles that
+	// didn't change, and its title, link or date may differ from the old one's
+	static const std::set<std::string> feed_attributes = {
+		"feedtitle",
+		"description",
+		"feedlink",
+		"feeddate",
+	};
+	for (const auto& attribute : matcher.get_referenced_attributes()) {
+		if (feed_attributes.find(attribute) != feed_attributes.end()) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void RssFeed::sort(const ArticleSortStrategy& sort_strategy)
 {
 	std::lock_guard<std::mutex> lock(item_mutex);
@@ -266,12 +521,11 @@ void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
 {
 	switch (sort_strategy.sm) {
 	case ArtSortMethod::TITLE:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
-		const std::shared_ptr<RssItem>& b) {
-			const auto left = utils::utf8_to_locale(a->title());
-			const auto right = utils::utf8_to_locale(b->title());
+		sort_by_key(items_,
+		[](const std::shared_ptr<RssItem>& item) {
+			return item->title_sort_key();
+		},
+		[&](const std::string& left, const std::string& right) {
 			const auto cmp = utils::strnaturalcmp(left, right);
 			return sort_strategy.sd == SortDirection::DESC ? (cmp > 0) : (cmp < 0);
 		});
@@ -290,13 +544,12 @@ void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
 		});
 		break;
 	case ArtSortMethod::AUTHOR:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
-		const std::shared_ptr<RssItem>& b) {
-			const auto author_a = utils::utf8_to_locale(a->author());
-			const auto author_b = utils::utf8_to_locale(b->author());
-			const auto cmp = strcmp(author_a.c_str(), author_b.c_str());
+		sort_by_key(items_,
+		[](const std::shared_ptr<RssItem>& item) {
+			return item->author_sort_key();
+		},
+		[&](const std::string& left, const std::string& right) {
+			const auto cmp = strcmp(left.c_str(), right.c_str());
 			return sort_strategy.sd == SortDirection::DESC ? (cmp > 0) : (cmp < 0);
 		});
 		break;
@@ -358,6 +611,7 @@ void RssFeed::purge_deleted_items()
 		for (const auto& item : items_) {
 			if (item->deleted()) {
 				items_guid_map.erase(item->guid());
+				item_removed(*item);
 			}
 		}
 	}
@@ -1,6 +1,7 @@
 #include "rssignores.h"
 
 #include <algorithm>
+#include <cinttypes>
 #include <curl/curl.h>
 #include <langinfo.h>
 #include <sys/utsname.h>
@@ -40,17 +41,21 @@ void RssIgnores::handle_action(std::string_view action,
 			std::string errorMessage;
 			const std::string pattern = ignore_rssurl.substr(prefix_len,
 					ignore_rssurl.length() - prefix_len);
-			const auto regex = Regex::compile(pattern, REG_EXTENDED | REG_ICASE, errorMessage);
+			std::shared_ptr<Regex> regex = Regex::compile(pattern,
+					REG_EXTENDED | REG_ICASE, errorMessage);
 			if (regex == nullptr) {
 				throw ConfigHandlerException(strprintf::fmt(
 						_("`%s' is not a valid regular expression: %s"),
 						pattern, errorMessage));
 			}
 
-			regex_ignores.push_back(FeedUrlExprPair(pattern, m));
+			regex_ignores.push_back({pattern, regex, m});
 		} else {
 			non_regex_ignores.insert({ignore_rssurl, m});
 		}
+
+		std::lock_guard<std::mutex> guard(rules_cache_mutex);
+		rules_cache.clear();
 	} else if (action == "always-download") {
 		if (params.empty()) {
 			throw ConfigHandlerException(ActionHandlerStatus::TOO_FEW_PARAMS);
@@ -87,9 +92,9 @@ void RssIgnores::dump_config(std::vector<std::string>& config_output) const
 	}
 	for (const auto& ign : regex_ignores) {
 		std::string configline = "ignore-article ";
-		configline.append(utils::quote(REGEX_PREFIX + ign.first));
+		configline.append(utils::quote(REGEX_PREFIX + ign.pattern));
 		configline.append(" ");
-		configline.append(utils::quote(ign.second->get_expression()));
+		configline.append(utils::quote(ign.expr->get_expression()));
 		config_output.push_back(configline);
 	}
 	for (const auto& ign_lm : ignores_lastmodified) {
@@ -102,50 +107,56 @@ void RssIgnores::dump_config(std::vector<std::string>& config_output) const
 	}
 }
 
-bool RssIgnores::matches_expr(std::shared_ptr<Matcher> expr, RssItem* item)
+bool FeedIgnoreRules::matches(RssItem* item) const
 {
-	if (expr->matches(item)) {
-		LOG(Level::DEBUG,
-			"RssIgnores::matches_expr: found match");
-		return true;
+	for (const auto& matcher : matchers) {
+		if (matcher->matches(item)) {
+			LOG(Level::DEBUG, "FeedIgnoreRules::matches: found match");
+			return true;
+		}
 	}
-
 	return false;
 }
 
-bool RssIgnores::matches(RssItem* item)
+std::shared_ptr<const FeedIgnoreRules> RssIgnores::rules_for(
+	const std::string& feedurl)
 {
-	auto search = non_regex_ignores.equal_range(item->feedurl());
+	std::lock_guard<std::mutex> guard(rules_cache_mutex);
+
+	auto& rules = rules_cache[feedurl];
+	if (rules != nullptr) {
+		return rules;
+	}
+
+	auto result = std::make_shared<FeedIgnoreRules>();
+
+	auto search = non_regex_ignores.equal_range(feedurl);
 	for (auto itr = search.first; itr != search.second; itr++) {
-		if (matches_expr(itr->second, item)) {
-			return true;
-		}
+		result->matchers.push_back(itr->second);
 	}
 
 	search = non_regex_ignores.equal_range("*");
 	for (auto itr = search.first; itr != search.second; itr++) {
-		if (matches_expr(itr->second, item)) {
-			return true;
-		}
+		result->matchers.push_back(itr->second);
 	}
 
 	for (const auto& ign : regex_ignores) {
-		const std::string pattern = ign.first;
-
-		LOG(Level::DEBUG,
-			"RssIgnores::matches: ign.first = `%s' item->feedurl = `%s'",
-			pattern,
-			item->feedurl());
-
-		std::string errorMessage;
-		const auto regex = Regex::compile(pattern, REG_EXTENDED | REG_ICASE, errorMessage);
-		const auto matches = regex->matches(item->feedurl(), 1, 0);
-		if (!matches.empty() && matches_expr(ign.second, item)) {
-			return true;
+		if (!ign.regex->matches(feedurl, 1, 0).empty()) {
+			result->matchers.push_back(ign.expr);
 		}
 	}
 
-	return false;
+	LOG(Level::DEBUG, "RssIgnores::rules_for: %" PRIu64 " rules apply to %s",
+		static_cast<uint64_t>(result->matchers.size()),
+		feedurl);
+
+	rules = result;
+	return rules;
+}
+
+bool RssIgnores::matches(RssItem* item)
+{
+	return rules_for(item->feedurl())->matches(item);
 }
 
 bool RssIgnores::matches_lastmodified(const std::string& url)
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <langinfo.h>
+#include <limits>
 
 #include "cache.h"
 #include "dbexception.h"
@@ -13,6 +14,8 @@
 
 namespace newsboat {
 
+std::mutex RssItem::unread_mutex;
+
 RssItem::RssItem(Cache* c)
 	: ch(c)
 	, idx(0)
@@ -22,6 +25,7 @@ RssItem::RssItem(Cache* c)
 	, enqueued_(false)
 	, deleted_(0)
 	, override_unread_(false)
+	, version_(0)
 {
 }
 
@@ -31,17 +35,44 @@ void RssItem::set_title(const std::string& t)
 {
 	title_ = utils::consolidate_whitespace(t);
 	utils::trim(title_);
+	touch();
+
+	std::lock_guard<std::mutex> guard(sort_keys_mutex);
+	title_sort_key_.reset();
+}
+
+std::string RssItem::title_sort_key() const
+{
+	std::lock_guard<std::mutex> guard(sort_keys_mutex);
+	if (!title_sort_key_.has_value()) {
+		title_sort_key_ = utils::utf8_to_locale(title_);
+	}
+	return title_sort_key_.value();
 }
 
 void RssItem::set_link(const std::string& l)
 {
 	link_ = l;
 	utils::trim(link_);
+	touch();
 }
 
 void RssItem::set_author(const std::string& a)
 {
 	author_ = a;
+	touch();
+
+	std::lock_guard<std::mutex> guard(sort_keys_mutex);
+	author_sort_key_.reset();
+}
+
+std::string RssItem::author_sort_key() const
+{
+	std::lock_guard<std::mutex> guard(sort_keys_mutex);
+	if (!author_sort_key_.has_value()) {
+		author_sort_key_ = utils::utf8_to_locale(author_);
+	}
+	return author_sort_key_.value();
 }
 
 void RssItem::set_description(const std::string& content,
@@ -49,6 +80,7 @@ void RssItem::set_description(const std::string& content,
 {
 	std::lock_guard<std::mutex> guard(description_mutex);
 	description_ = {content, mime_type};
+	touch();
 }
 
 void RssItem::set_size(unsigned int size)
@@ -75,21 +107,37 @@ std::string RssItem::length() const
 void RssItem::set_pubDate(time_t t)
 {
 	pubDate_ = t;
+	touch();
 }
 
 void RssItem::set_guid(const std::string& g)
 {
 	guid_ = g;
+	touch();
 }
 
-void RssItem::set_unread_nowrite(bool u)
+void RssItem::set_unread_flag(bool u)
 {
+	std::lock_guard<std::mutex> guard(unread_mutex);
+	if (unread_ == u) {
+		return;
+	}
 	unread_ = u;
+	for (RssFeed* feed : containing_feeds) {
+		feed->item_unread_changed(*this);
+	}
+}
+
+void RssItem::set_unread_nowrite(bool u)
+{
+	set_unread_flag(u);
+	touch();
 }
 
 void RssItem::set_unread_nowrite_notify(bool u, bool notify)
 {
-	unread_ = u;
+	set_unread_flag(u);
+	touch();
 	std::shared_ptr<RssFeed> feedptr = feedptr_.lock();
 	if (feedptr && notify) {
 		feedptr->get_item_by_guid(guid_)->set_unread_nowrite(
@@ -101,7 +149,8 @@ void RssItem::set_unread(bool u)
 {
 	if (unread_ != u) {
 		bool old_u = unread_;
-		unread_ = u;
+		set_unread_flag(u);
+		touch();
 		std::shared_ptr<RssFeed> feedptr = feedptr_.lock();
 		if (feedptr)
 			feedptr->get_item_by_guid(guid_)->set_unread_nowrite(
@@ -114,7 +163,7 @@ void RssItem::set_unread(bool u)
 		} catch (const DbException& e) {
 			// if the update failed, restore the old unread flag and
 			// rethrow the exception
-			unread_ = old_u;
+			set_unread_flag(old_u);
 			throw;
 		}
 	}
@@ -156,11 +205,13 @@ const std::string& RssItem::enclosure_description_mime_type() const
 void RssItem::set_enclosure_url(const std::string& url)
 {
 	enclosure_url_ = url;
+	touch();
 }
 
 void RssItem::set_enclosure_type(const std::string& type)
 {
 	enclosure_type_ = type;
+	touch();
 }
 
 void RssItem::set_enclosure_description(const std::string& description)
@@ -241,6 +292,27 @@ std::optional<std::string> RssItem::attribute_value(const std::string&
 	return std::nullopt;
 }
 
+std::optional<int> RssItem::attribute_value_as_number(
+	const std::string& attribname) const
+{
+	if (attribname == "age") {
+		const time_t age = (time(nullptr) - pubDate_timestamp()) / 86400;
+		return static_cast<int>(std::clamp<time_t>(age,
+					std::numeric_limits<int>::min(),
+					std::numeric_limits<int>::max()));
+	} else if (attribname == "articleindex") {
+		return static_cast<int>(std::min<unsigned int>(idx,
+					std::numeric_limits<int>::max()));
+	}
+
+	std::shared_ptr<RssFeed> feedptr = feedptr_.lock();
+	if (feedptr) {
+		return feedptr->RssFeed::attribute_value_as_number(attribname);
+	}
+
+	return std::nullopt;
+}
+
 void RssItem::update_flags()
 {
 	if (ch) {
@@ -253,6 +325,7 @@ void RssItem::set_flags(const std::string& ff)
 	oldflags_ = flags_;
 	flags_ = ff;
 	sort_flags();
+	touch();
 }
 
 void RssItem::sort_flags()
@@ -13,6 +13,7 @@
 #include "rss/rssparser.h"
 #include "rssfeed.h"
 #include "rssignores.h"
+#include "scopemeasure.h"
 #include "utils.h"
 
 namespace newsboat {
@@ -32,6 +33,7 @@ RssParser::~RssParser() {}
 
 std::shared_ptr<RssFeed> RssParser::parse(const rsspp::Feed& upstream_feed)
 {
+	ScopeMeasure sm("RssParser::parse", my_uri);
 	if (upstream_feed.rss_version == rsspp::Feed::Version::UNKNOWN) {
 		return nullptr;
 	}
@@ -163,6 +165,12 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed,
 	 * each item, and fill it with the appropriate values from the data
 	 * structure.
 	 */
+	// Looked up once rather than for each article
+	std::shared_ptr<const FeedIgnoreRules> ignore_rules;
+	if (ign) {
+		ignore_rules = ign->rules_for(feed->rssurl());
+	}
+
 	for (const auto& item : upstream_feed.items) {
 		std::shared_ptr<RssItem> x(new RssItem(&ch));
 
@@ -283,7 +291,7 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed,
 			static_cast<int64_t>(x->pubDate_timestamp()),
 			x->description().text);
 
-		add_item_to_feed(feed, x);
+		add_item_to_feed(feed, x, ignore_rules.get());
 	}
 }
 
@@ -440,11 +448,12 @@ void RssParser::set_item_enclosure(std::shared_ptr<RssItem> x,
 }
 
 void RssParser::add_item_to_feed(std::shared_ptr<RssFeed> feed,
-	std::shared_ptr<RssItem> item)
+	std::shared_ptr<RssItem> item,
+	const FeedIgnoreRules* rules)
 {
 	// only add item to feed if it isn't on the ignore list or if there is
 	// no ignore list
-	if (!ign || !ign->matches(item.get())) {
+	if (!rules || !rules->matches(item.get())) {
 		feed->add_item(item);
 		LOG(Level::INFO,
 			"RssParser::parse: added article title = `%s' link = "
@@ -1,15 +1,40 @@
 #include "scopemeasure.h"
 
+#include "logger.h"
+
 namespace newsboat {
 
-ScopeMeasure::ScopeMeasure(const std::string& func)
-	: rs_object(scopemeasure::bridged::create(func))
+ScopeMeasure::ScopeMeasure(const std::string& func,
+	const std::string& feed_url)
+	: tracing(tracer::is_enabled())
+	, start_time(tracer::Clock::now())
+{
+	if (tracing) {
+		this->func = func;
+		this->feed_url = feed_url;
+	}
+	// Formatting log messages isn't free, so skip it if they would be dropped
+	if (static_cast<int64_t>(Level::DEBUG) <= logger::get_loglevel()) {
+		rs_object.emplace(scopemeasure::bridged::create(func));
+	}
+}
+
+ScopeMeasure::~ScopeMeasure()
 {
+	if (tracing) {
+		tracer::record(func, feed_url, start_time, tracer::Clock::now());
+	}
 }
 
 void ScopeMeasure::stopover(const std::string& son)
 {
-	scopemeasure::bridged::stopover(*rs_object, son);
+	if (tracing) {
+		tracer::record(func + " (" + son + ")", feed_url, start_time,
+			tracer::Clock::now());
+	}
+	if (rs_object.has_value()) {
+		scopemeasure::bridged::stopover(**rs_object, son);
+	}
 }
 
 } // namespace newsboat
@@ -0,0 +1,249 @@
+#include "segmentedfile.h"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "strprintf.h"
+
+using namespace newsboat;
+
+namespace podboat {
+
+namespace {
+
+const std::chrono::seconds SYNC_INTERVAL(1);
+
+bool allocate(int fd, std::uint64_t size)
+{
+#if defined(__APPLE__) || defined(__OpenBSD__)
+	return ftruncate(fd, size) == 0;
+#else
+	const int rc = posix_fallocate(fd, 0, size);
+	if (rc == EINVAL || rc == EOPNOTSUPP) {
+		// The filesystem can't reserve the space up front
+		return ftruncate(fd, size) == 0;
+	}
+	errno = rc;
+	return rc == 0;
+#endif
+}
+
+bool write_all(int fd, const std::string& data)
+{
+	size_t written = 0;
+	while (written < data.size()) {
+		const ssize_t rc = ::write(fd, data.data() + written, data.size() - written);
+		if (rc == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		written += rc;
+	}
+	return true;
+}
+
+} // namespace
+
+SegmentedFile::SegmentedFile()
+	: fd(-1)
+	, journal_fd(-1)
+	, size_(0)
+{
+}
+
+SegmentedFile::~SegmentedFile()
+{
+	close();
+}
+
+bool SegmentedFile::open(const Filepath& path, std::uint64_t size,
+	unsigned int segments)
+{
+	close();
+	size_ = size;
+	done.assign(segments, false);
+
+	const std::string filename = path.to_locale_string();
+	const std::string journal = journal_path(path).to_locale_string();
+
+	bool resumed = read_journal(journal);
+	struct stat sb;
+	if (resumed && (stat(filename.c_str(), &sb) == -1
+			|| static_cast<std::uint64_t>(sb.st_size) != size)) {
+		resumed = false;
+	}
+	if (!resumed) {
+		done.assign(segments, false);
+	}
+	last_sync = std::chrono::steady_clock::now();
+
+	fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		return false;
+	}
+	journal_fd = ::open(journal.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+			0644);
+	if (journal_fd == -1) {
+		close();
+		return false;
+	}
+
+	if (!resumed) {
+		LOG(Level::DEBUG, "SegmentedFile::open: starting %s from scratch",
+			filename);
+		if (ftruncate(fd, 0) == -1 || !allocate(fd, size)
+			|| ftruncate(journal_fd, 0) == -1
+			|| !write_all(journal_fd, strprintf::fmt("segments %" PRIu64 " %u\n",
+					size, segments))) {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SegmentedFile::close()
+{
+	// A complete file doesn't need its journal anymore
+	if (fd != -1 && !is_complete() && !sync()) {
+		LOG(Level::ERROR, "SegmentedFile::close: couldn't update the journal: %s",
+			strerror(errno));
+	}
+	unsynced.clear();
+
+	if (fd != -1) {
+		::close(fd);
+		fd = -1;
+	}
+	if (journal_fd != -1) {
+		::close(journal_fd);
+		journal_fd = -1;
+	}
+}
+
+std::pair<std::uint64_t, std::uint64_t> SegmentedFile::segment(
+	unsigned int i) const
+{
+	const std::uint64_t length = size_ / done.size();
+	const std::uint64_t first = i * length;
+	if (i + 1 == done.size()) {
+		return {first, size_ - first};
+	}
+	return {first, length};
+}
+
+bool SegmentedFile::is_complete() const
+{
+	for (const bool d : done) {
+		if (!d) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::uint64_t SegmentedFile::completed_bytes() const
+{
+	std::uint64_t result = 0;
+	for (unsigned int i = 0; i < done.size(); ++i) {
+		if (done[i]) {
+			result += segment(i).second;
+		}
+	}
+	return result;
+}
+
+bool SegmentedFile::write(std::uint64_t offset, const char* data, size_t len)
+{
+	while (len > 0) {
+		const ssize_t rc = pwrite(fd, data, len, offset);
+		if (rc == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		data += rc;
+		len -= rc;
+		offset += rc;
+	}
+	return true;
+}
+
+bool SegmentedFile::mark_done(unsigned int i)
+{
+	done[i] = true;
+	unsynced.push_back(i);
+	if (std::chrono::steady_clock::now() - last_sync < SYNC_INTERVAL) {
+		return true;
+	}
+	return sync();
+}
+
+bool SegmentedFile::sync()
+{
+	last_sync = std::chrono::steady_clock::now();
+	if (unsynced.empty()) {
+		return true;
+	}
+
+	// The journal must never list a segment whose data could still be lost
+	if (fsync(fd) == -1) {
+		return false;
+	}
+	std::string lines;
+	for (const unsigned int i : unsynced) {
+		lines += std::to_string(i) + "\n";
+	}
+	if (!write_all(journal_fd, lines)) {
+		return false;
+	}
+	unsynced.clear();
+	return true;
+}
+
+Filepath SegmentedFile::journal_path(const Filepath& path)
+{
+	Filepath result = path;
+	result.add_extension("segments");
+	return result;
+}
+
+bool SegmentedFile::has_journal(const Filepath& path)
+{
+	struct stat sb;
+	return stat(journal_path(path).to_locale_string().c_str(), &sb) == 0;
+}
+
+bool SegmentedFile::read_journal(const std::string& journal)
+{
+	std::ifstream f(journal);
+	std::string magic;
+	std::uint64_t size = 0;
+	unsigned int segments = 0;
+	if (!(f >> magic >> size >> segments) || magic != "segments"
+		|| size != size_ || segments != done.size()) {
+		return false;
+	}
+
+	unsigned int i;
+	while (f >> i) {
+		if (i < done.size()) {
+			done[i] = true;
+		}
+	}
+	return true;
+}
+
+} // namespace podboat
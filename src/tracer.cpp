@@ -0,0 +1,306 @@
+#include "tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "3rd-party/json.hpp"
+#include "strprintf.h"
+
+namespace newsboat {
+
+namespace tracer {
+
+namespace {
+
+/// Maximum number of spans kept per thread
+const std::size_t BUFFER_CAPACITY = 65536;
+
+struct Span {
+	std::string name;
+	std::string feed_url;
+	// Both in microseconds
+	std::int64_t start;
+	std::int64_t duration;
+};
+
+struct ThreadBuffer {
+	explicit ThreadBuffer(unsigned int id)
+		: tid(id)
+		, recorded(0)
+		, writing(false)
+	{
+	}
+
+	const unsigned int tid;
+	/// Grows up to BUFFER_CAPACITY, then wraps around
+	std::vector<Span> spans;
+	/// Number of spans ever recorded into this buffer
+	std::atomic<std::uint64_t> recorded;
+	/// Set while the owning thread is modifying `spans`, see Pause
+	std::atomic<bool> writing;
+};
+
+std::atomic<bool> enabled(false);
+std::once_flag epoch_initialized;
+Clock::time_point epoch;
+
+// Buffers are never destroyed, so that spans of threads which already exited
+// end up in the trace too. The mutex is only taken when a thread records its
+// first span, and when the trace is written.
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+thread_local ThreadBuffer* current_buffer = nullptr;
+
+ThreadBuffer& this_thread_buffer()
+{
+	if (current_buffer == nullptr) {
+		std::lock_guard<std::mutex> guard(buffers_mutex);
+		buffers.push_back(std::make_unique<ThreadBuffer>(buffers.size() + 1));
+		current_buffer = buffers.back().get();
+	}
+	return *current_buffer;
+}
+
+std::int64_t microseconds_since_epoch(Clock::time_point t)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(t - epoch).count();
+}
+
+/// Stops recording and waits for spans that are being recorded, so that the
+/// buffers can be read or cleared safely. Recording is resumed on destruction
+/// if it was enabled before. Holds `buffers_mutex` meanwhile.
+class Pause {
+public:
+	Pause()
+		: guard(buffers_mutex)
+		, was_enabled(enabled.exchange(false))
+	{
+		// record() sets `writing` before it checks `enabled` again, so
+		// a thread either sees that the tracer is disabled, or is waited for
+		for (const auto& buffer : buffers) {
+			while (buffer->writing.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	~Pause()
+	{
+		if (was_enabled) {
+			enabled.store(true);
+		}
+	}
+
+private:
+	std::lock_guard<std::mutex> guard;
+	const bool was_enabled;
+};
+
+/// Calls `func(tid, span)` for each span still kept in the buffers. Has to be
+/// called with recording paused.
+template<typename Func>
+void for_each_span(Func func)
+{
+	for (const auto& buffer : buffers) {
+		const auto recorded = buffer->recorded.load(std::memory_order_acquire);
+		const auto kept = std::min<std::uint64_t>(recorded, buffer->spans.size());
+		for (std::uint64_t i = recorded - kept; i < recorded; ++i) {
+			func(buffer->tid, buffer->spans[i % BUFFER_CAPACITY]);
+		}
+	}
+}
+
+double milliseconds(std::int64_t microseconds)
+{
+	return microseconds / 1000.0;
+}
+
+} // namespace
+
+void enable()
+{
+	std::call_once(epoch_initialized, []() {
+		epoch = Clock::now();
+	});
+	enabled.store(true, std::memory_order_release);
+}
+
+void disable()
+{
+	enabled.store(false, std::memory_order_release);
+}
+
+bool is_enabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void record(const std::string& name, const std::string& feed_url,
+	Clock::time_point start, Clock::time_point end)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	ThreadBuffer& buffer = this_thread_buffer();
+	buffer.writing.store(true);
+	if (!enabled.load()) {
+		// Paused while we were getting the buffer
+		buffer.writing.store(false, std::memory_order_release);
+		return;
+	}
+
+	// Only this thread writes to the buffer, so a relaxed load is enough
+	const auto recorded = buffer.recorded.load(std::memory_order_relaxed);
+	if (buffer.spans.size() < BUFFER_CAPACITY) {
+		buffer.spans.emplace_back();
+	}
+	// Assigning to a reused span doesn't allocate unless the new strings are
+	// longer than the old ones
+	Span& span = buffer.spans[recorded % BUFFER_CAPACITY];
+	span.name = name;
+	span.feed_url = feed_url;
+	span.start = microseconds_since_epoch(start);
+	span.duration =
+		std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	buffer.recorded.store(recorded + 1, std::memory_order_release);
+	buffer.writing.store(false, std::memory_order_release);
+}
+
+void write_trace(std::ostream& out)
+{
+	const auto pid = getpid();
+
+	nlohmann::json events = nlohmann::json::array();
+	unsigned int max_tid = 0;
+	{
+		Pause pause;
+		for_each_span([&](unsigned int tid, const Span& span) {
+			nlohmann::json event = {
+				{"name", span.name},
+				{"cat", "newsboat"},
+				{"ph", "X"},
+				{"ts", span.start},
+				{"dur", span.duration},
+				{"pid", pid},
+				{"tid", tid},
+			};
+			if (!span.feed_url.empty()) {
+				event["args"] = {{"feed", span.feed_url}};
+			}
+			events.push_back(std::move(event));
+			max_tid = std::max(max_tid, tid);
+		});
+	}
+	for (unsigned int tid = 1; tid <= max_tid; ++tid) {
+		events.push_back({
+			{"name", "thread_name"},
+			{"ph", "M"},
+			{"pid", pid},
+			{"tid", tid},
+			{"args", {{"name", strprintf::fmt("thread %u", tid)}}},
+		});
+	}
+
+	const nlohmann::json trace = {
+		{"traceEvents", std::move(events)},
+		{"displayTimeUnit", "ms"},
+	};
+	out << trace.dump() << '\n';
+}
+
+void write_summary(std::ostream& out)
+{
+	std::map<std::string, std::vector<std::int64_t>> durations;
+	std::uint64_t overwritten = 0;
+	{
+		Pause pause;
+		for_each_span([&](unsigned int, const Span& span) {
+			durations[span.name].push_back(span.duration);
+		});
+		for (const auto& buffer : buffers) {
+			overwritten += buffer->recorded.load() - buffer->spans.size();
+		}
+	}
+	if (overwritten > 0) {
+		out << strprintf::fmt("# %" PRIu64
+				" oldest spans were overwritten and aren't counted below\n",
+				overwritten);
+	}
+
+	// Upper bounds of histogram buckets, in microseconds. The last bucket
+	// has no upper bound.
+	const std::vector<std::int64_t> bounds = {100, 1000, 10000, 100000, 1000000};
+
+	out << strprintf::fmt("%8s %10s %9s %9s %9s %9s %9s %7s %7s %7s %7s %7s %7s  %s\n",
+			"count", "total_ms", "mean_ms", "p50_ms", "p90_ms", "p99_ms", "max_ms",
+			"<0.1ms", "<1ms", "<10ms", "<100ms", "<1s", ">=1s", "span");
+	for (auto& entry : durations) {
+		auto& values = entry.second;
+		std::sort(values.begin(), values.end());
+
+		std::int64_t total = 0;
+		std::vector<std::size_t> histogram(bounds.size() + 1, 0);
+		for (const auto value : values) {
+			total += value;
+			const auto bucket = std::upper_bound(bounds.begin(), bounds.end(),
+					value) - bounds.begin();
+			histogram[bucket]++;
+		}
+		const auto percentile = [&values](std::size_t p) {
+			return values[(values.size() - 1) * p / 100];
+		};
+
+		out << strprintf::fmt("%8zu %10.3f %9.3f %9.3f %9.3f %9.3f %9.3f",
+				values.size(),
+				milliseconds(total),
+				milliseconds(total) / values.size(),
+				milliseconds(percentile(50)),
+				milliseconds(percentile(90)),
+				milliseconds(percentile(99)),
+				milliseconds(values.back()));
+		for (const auto count : histogram) {
+			out << strprintf::fmt(" %7zu", count);
+		}
+		out << "  " << entry.first << '\n';
+	}
+}
+
+bool write_files(const Filepath& path)
+{
+	disable();
+
+	std::ofstream trace(path.to_locale_string());
+	write_trace(trace);
+	trace.close();
+
+	Filepath summary_path = path;
+	summary_path.add_extension("summary");
+	std::ofstream summary(summary_path.to_locale_string());
+	write_summary(summary);
+	summary.close();
+
+	return !trace.fail() && !summary.fail();
+}
+
+void reset()
+{
+	Pause pause;
+	for (const auto& buffer : buffers) {
+		buffer->spans.clear();
+		buffer->recorded.store(0);
+	}
+}
+
+} // namespace tracer
+
+} // namespace newsboat
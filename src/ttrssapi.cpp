@@ -2,7 +2,6 @@
 
 #include <algorithm>
 #include <cinttypes>
-#include <thread>
 #include <time.h>
 
 #include "3rd-party/json.hpp"
@@ -17,6 +16,13 @@ using json = nlohmann::json;
 
 namespace newsboat {
 
+namespace {
+
+/// Maximum number of articles getHeadlines returns at once
+const unsigned int HEADLINES_PAGE_SIZE = 200;
+
+} // namespace
+
 TtRssApi::TtRssApi(ConfigContainer& c)
 	: RemoteApi(c)
 {
@@ -332,19 +338,18 @@ bool TtRssApi::mark_all_read(const std::string& feed_url)
 
 bool TtRssApi::mark_article_read(const std::string& guid, bool read)
 {
-	// Do this in a thread, as we don't care about the result enough to wait
-	// for it.
-	std::thread t{[=]()
-	{
-		LOG(Level::DEBUG,
-			"TtRssApi::mark_article_read: inside thread, marking "
-			"thread as read...");
-
-		// Call the TtRssApi's update_article function as a thread.
-		this->update_article(guid, 2, read ? 0 : 1);
-	}};
-	t.detach();
-	return true;
+	return update_article(guid, 2, read ? 0 : 1);
+}
+
+bool TtRssApi::mark_articles_read(const std::vector<std::string>& guids)
+{
+	// updateArticle takes a comma-separated list of article IDs
+	return update_article(utils::join(guids, ","), 2, 0);
+}
+
+bool TtRssApi::mark_articles_unread(const std::vector<std::string>& guids)
+{
+	return update_article(utils::join(guids, ","), 2, 1);
 }
 
 bool TtRssApi::update_article_flags(const std::string& oldflags,
@@ -370,92 +375,117 @@ bool TtRssApi::update_article_flags(const std::string& oldflags,
 	return success;
 }
 
-rsspp::Feed TtRssApi::fetch_feed(const std::string& id, CurlHandle& cached_handle)
+rsspp::Feed TtRssApi::fetch_feed(const std::string& id, CurlHandle& cached_handle,
+	const std::string& sync_position)
 {
 	rsspp::Feed f;
 
 	f.rss_version = rsspp::Feed::TTRSS_JSON;
 
+	// Incremental fetches ask for the articles with IDs above the highest
+	// one seen so far, a page at a time
+	const bool incremental = !sync_position.empty();
+	long max_id = incremental ? std::strtol(sync_position.c_str(), nullptr, 10) : 0;
+
 	std::map<std::string, std::string> args;
 	args["feed_id"] = id;
 	args["show_content"] = "1";
 	args["include_attachments"] = "1";
-	json content = run_op("getHeadlines", args, cached_handle, true);
-
-	if (content.is_null()) {
-		return f;
+	if (incremental) {
+		args["since_id"] = sync_position;
+		args["limit"] = std::to_string(HEADLINES_PAGE_SIZE);
 	}
 
-	if (!content.is_array()) {
-		LOG(Level::ERROR,
-			"TtRssApi::fetch_feed: content is not an array");
-		return f;
-	}
+	bool complete = true;
+	for (unsigned int skip = 0;;) {
+		if (skip > 0) {
+			args["skip"] = std::to_string(skip);
+		}
+		json content = run_op("getHeadlines", args, cached_handle, true);
 
-	LOG(Level::DEBUG,
-		"TtRssApi::fetch_feed: %" PRIu64 " items",
-		static_cast<uint64_t>(content.size()));
+		if (content.is_null()) {
+			return f;
+		}
 
-	try {
-		for (const auto& item_obj : content) {
-			rsspp::Item item;
+		if (!content.is_array()) {
+			LOG(Level::ERROR,
+				"TtRssApi::fetch_feed: content is not an array");
+			return f;
+		}
 
-			if (!item_obj["title"].is_null()) {
-				item.title = item_obj["title"];
-			}
+		LOG(Level::DEBUG,
+			"TtRssApi::fetch_feed: %" PRIu64 " items",
+			static_cast<uint64_t>(content.size()));
 
-			if (!item_obj["link"].is_null()) {
-				item.link = item_obj["link"];
-			}
+		try {
+			for (const auto& item_obj : content) {
+				rsspp::Item item;
 
-			if (!item_obj["author"].is_null()) {
-				item.author = item_obj["author"];
-			}
+				if (!item_obj["title"].is_null()) {
+					item.title = item_obj["title"];
+				}
 
-			if (!item_obj["content"].is_null()) {
-				item.content_encoded = item_obj["content"];
-			}
+				if (!item_obj["link"].is_null()) {
+					item.link = item_obj["link"];
+				}
 
-			if (!item_obj["attachments"].is_null()) {
-				for (const json& a : item_obj["attachments"]) {
-					if (!a["content_url"].is_null() && !a["content_type"].is_null()) {
-						item.enclosures.push_back(
-						rsspp::Enclosure {
-							a["content_url"],
-							a["content_type"],
-							"",
-							"",
+				if (!item_obj["author"].is_null()) {
+					item.author = item_obj["author"];
+				}
+
+				if (!item_obj["content"].is_null()) {
+					item.content_encoded = item_obj["content"];
+				}
+
+				if (!item_obj["attachments"].is_null()) {
+					for (const json& a : item_obj["attachments"]) {
+						if (!a["content_url"].is_null() && !a["content_type"].is_null()) {
+							item.enclosures.push_back(
+							rsspp::Enclosure {
+								a["content_url"],
+								a["content_type"],
+								"",
+								"",
+							}
+							);
+							break;
 						}
-						);
-						break;
 					}
 				}
-			}
 
-			int id = item_obj["id"];
-			item.guid = strprintf::fmt("%d", id);
+				int id = item_obj["id"];
+				item.guid = strprintf::fmt("%d", id);
+				max_id = std::max<long>(max_id, id);
 
-			bool unread = item_obj["unread"];
-			if (unread) {
-				item.labels.push_back("ttrss:unread");
-			} else {
-				item.labels.push_back("ttrss:read");
-			}
+				bool unread = item_obj["unread"];
+				if (unread) {
+					item.labels.push_back("ttrss:unread");
+				} else {
+					item.labels.push_back("ttrss:read");
+				}
 
-			int updated_time = item_obj["updated"];
-			time_t updated = static_cast<time_t>(updated_time);
+				int updated_time = item_obj["updated"];
+				time_t updated = static_cast<time_t>(updated_time);
 
-			item.pubDate = utils::mt_strf_localtime(
-					"%a, %d %b %Y %H:%M:%S %z",
-					updated);
-			item.pubDate_ts = updated;
+				item.pubDate = utils::mt_strf_localtime(
+						"%a, %d %b %Y %H:%M:%S %z",
+						updated);
+				item.pubDate_ts = updated;
 
-			f.items.push_back(item);
+				f.items.push_back(item);
+			}
+		} catch (json::exception& e) {
+			LOG(Level::ERROR,
+				"Exception occurred while parsing feeed: ",
+				e.what());
+			complete = false;
+			break;
 		}
-	} catch (json::exception& e) {
-		LOG(Level::ERROR,
-			"Exception occurred while parsing feeed: ",
-			e.what());
+
+		if (!incremental || content.size() < HEADLINES_PAGE_SIZE) {
+			break;
+		}
+		skip += content.size();
 	}
 
 	std::sort(f.items.begin(),
@@ -464,9 +494,63 @@ rsspp::Feed TtRssApi::fetch_feed(const std::string& id, CurlHandle& cached_handl
 		return a.pubDate_ts > b.pubDate_ts;
 	});
 
+	if (!complete) {
+		// Try again from the same position next time
+		return f;
+	}
+	if (incremental) {
+		f.unread_guids = fetch_unread_ids(id, cached_handle);
+		if (f.unread_guids == nullptr) {
+			return f;
+		}
+	}
+	if (max_id > 0) {
+		f.sync_position = std::to_string(max_id);
+	}
+
 	return f;
 }
 
+std::shared_ptr<const std::unordered_set<std::string>> TtRssApi::fetch_unread_ids(
+		const std::string& id, CurlHandle& cached_handle)
+{
+	std::map<std::string, std::string> args;
+	args["feed_id"] = id;
+	args["view_mode"] = "unread";
+	args["show_content"] = "0";
+	args["limit"] = std::to_string(HEADLINES_PAGE_SIZE);
+
+	std::unordered_set<std::string> ids;
+	for (unsigned int skip = 0;;) {
+		args["skip"] = std::to_string(skip);
+		json content = run_op("getHeadlines", args, cached_handle, true);
+		if (!content.is_array()) {
+			LOG(Level::ERROR,
+				"TtRssApi::fetch_unread_ids: content is not an array");
+			return nullptr;
+		}
+
+		try {
+			for (const auto& item_obj : content) {
+				int item_id = item_obj["id"];
+				ids.insert(std::to_string(item_id));
+			}
+		} catch (json::exception& e) {
+			LOG(Level::ERROR,
+				"TtRssApi::fetch_unread_ids: failed to parse headlines: %s",
+				e.what());
+			return nullptr;
+		}
+
+		if (content.size() < HEADLINES_PAGE_SIZE) {
+			break;
+		}
+		skip += content.size();
+	}
+
+	return std::make_shared<const std::unordered_set<std::string>>(std::move(ids));
+}
+
 void TtRssApi::fetch_feeds_per_category(const json& cat,
 	std::vector<TaggedFeedUrl>& feeds)
 {
@@ -0,0 +1,29 @@
+#include "unreadindex.h"
+
+namespace newsboat {
+
+void UnreadIndex::add(const std::string& guid)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	refcounts[guid]++;
+}
+
+void UnreadIndex::remove(const std::string& guid)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	auto it = refcounts.find(guid);
+	if (it == refcounts.end()) {
+		return;
+	}
+	if (--it->second == 0) {
+		refcounts.erase(it);
+	}
+}
+
+unsigned int UnreadIndex::size() const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	return refcounts.size();
+}
+
+} // namespace newsboat
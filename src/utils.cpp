@@ -799,12 +799,27 @@ std::optional<LinkType> utils::podcast_mime_to_link_type(
 std::string utils::string_from_utf8_lossy(const std::vector<std::uint8_t>& text)
 {
 	auto input = rust::Slice<std::uint8_t const>(text.data(), text.size());
+	if (utils::bridged::is_valid_utf8(input)) {
+		return std::string(text.begin(), text.end());
+	}
 	auto result = utils::bridged::string_from_utf8_lossy(input);
 	return std::string(result);
 }
 
+bool utils::is_valid_utf8(std::string_view text)
+{
+	const auto input = rust::Slice<std::uint8_t const>(
+			reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+	return utils::bridged::is_valid_utf8(input);
+}
+
 std::string utils::sanitize_utf8(const std::string& text)
 {
+	// Almost everything that comes through here is valid already, and
+	// doesn't need to make the round-trip through Rust
+	if (is_valid_utf8(text)) {
+		return text;
+	}
 	const std::vector<std::uint8_t> vec(text.begin(), text.end());
 	return string_from_utf8_lossy(vec);
 }
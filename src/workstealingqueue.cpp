@@ -0,0 +1,72 @@
+#include "workstealingqueue.h"
+
+#include <algorithm>
+
+#include "utils.h"
+
+namespace newsboat {
+
+WorkStealingQueue::WorkStealingQueue(unsigned int size, unsigned int num_workers)
+{
+	num_workers = std::max(1u, std::min(num_workers, size));
+	if (size == 0) {
+		ranges.emplace_back(new Range());
+		ranges.back()->begin = 0;
+		ranges.back()->end = 0;
+		return;
+	}
+
+	for (const auto& partition : utils::partition_indexes(0, size - 1, num_workers)) {
+		ranges.emplace_back(new Range());
+		ranges.back()->begin = partition.first;
+		ranges.back()->end = partition.second + 1;
+	}
+}
+
+bool WorkStealingQueue::next(unsigned int worker, unsigned int& index)
+{
+	if (worker < ranges.size()) {
+		Range& own = *ranges[worker];
+		std::lock_guard<std::mutex> guard(own.mutex);
+		if (own.begin < own.end) {
+			index = own.begin++;
+			return true;
+		}
+	}
+
+	return steal(worker, index);
+}
+
+bool WorkStealingQueue::steal(unsigned int thief, unsigned int& index)
+{
+	while (true) {
+		// Pick the victim with the most work left. The sizes might change
+		// before we lock the victim, in which case we simply look again.
+		Range* victim = nullptr;
+		unsigned int victim_size = 0;
+		for (unsigned int i = 0; i < ranges.size(); ++i) {
+			if (i == thief) {
+				continue;
+			}
+			Range& range = *ranges[i];
+			std::lock_guard<std::mutex> guard(range.mutex);
+			const unsigned int size = range.end - range.begin;
+			if (size > victim_size) {
+				victim = &range;
+				victim_size = size;
+			}
+		}
+
+		if (victim == nullptr) {
+			return false;
+		}
+
+		std::lock_guard<std::mutex> guard(victim->mutex);
+		if (victim->begin < victim->end) {
+			index = --victim->end;
+			return true;
+		}
+	}
+}
+
+} // namespace newsboat
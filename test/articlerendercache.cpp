@@ -0,0 +1,171 @@
+#include "articlerendercache.h"
+
+#include <memory>
+#include <string>
+
+#include "3rd-party/catch.hpp"
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "regexmanager.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+
+using namespace newsboat;
+
+namespace {
+
+std::shared_ptr<RssItem> create_item(Cache* c, const std::string& guid)
+{
+	auto item = std::make_shared<RssItem>(c);
+	item->set_guid(guid);
+	item->set_title("Article " + guid);
+	item->set_description("<p>Hello from " + guid + "</p>", "text/html");
+	return item;
+}
+
+} // namespace
+
+TEST_CASE("get() renders an article only once for the same width",
+	"[ArticleRenderCache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RegexManager rxman;
+	ArticleRenderCache article_cache;
+	auto item = create_item(rsscache.get(), "1");
+
+	const auto rendered = article_cache.get(cfg, *item, 80, 85, rxman);
+	REQUIRE(rendered->text.find("Hello from 1") != std::string::npos);
+	REQUIRE(rendered->num_lines > 0);
+
+	REQUIRE(article_cache.get(cfg, *item, 80, 85, rxman) == rendered);
+	REQUIRE(article_cache.size() == 1);
+
+	SECTION("A different width needs another rendering") {
+		REQUIRE(article_cache.get(cfg, *item, 40, 85, rxman) != rendered);
+		REQUIRE(article_cache.get(cfg, *item, 80, 120, rxman) != rendered);
+		REQUIRE(article_cache.size() == 3);
+	}
+
+	SECTION("Reading an article doesn't change how it looks") {
+		item->set_unread_nowrite(false);
+		REQUIRE(article_cache.get(cfg, *item, 80, 85, rxman) == rendered);
+	}
+}
+
+TEST_CASE("get() renders an article again once anything that's shown changed",
+	"[ArticleRenderCache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RegexManager rxman;
+	ArticleRenderCache article_cache;
+	auto item = create_item(rsscache.get(), "1");
+
+	const auto rendered = article_cache.get(cfg, *item, 80, 85, rxman);
+
+	SECTION("Content") {
+		item->set_description("<p>Updated</p>", "text/html");
+		const auto updated = article_cache.get(cfg, *item, 80, 85, rxman);
+		REQUIRE(updated != rendered);
+		REQUIRE(updated->text.find("Updated") != std::string::npos);
+	}
+
+	SECTION("Flags") {
+		item->set_flags("s");
+		REQUIRE(article_cache.get(cfg, *item, 80, 85, rxman) != rendered);
+	}
+
+	SECTION("Highlighting rules") {
+		rxman.handle_action("highlight", {"article", "Hello", "red"});
+		REQUIRE(article_cache.get(cfg, *item, 80, 85, rxman) != rendered);
+	}
+}
+
+TEST_CASE("get() puts the podcast first among the links",
+	"[ArticleRenderCache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RegexManager rxman;
+	ArticleRenderCache article_cache;
+	auto item = create_item(rsscache.get(), "1");
+	item->set_description(
+		"<a href=\"https://example.com/more\">More</a>", "text/html");
+	item->set_enclosure_url("https://example.com/episode.mp3");
+	item->set_enclosure_type("audio/mpeg");
+
+	const auto rendered = article_cache.get(cfg, *item, 80, 85, rxman);
+	REQUIRE(rendered->links.size() == 2);
+	REQUIRE(rendered->links[0].url == "https://example.com/episode.mp3");
+	REQUIRE(rendered->links[1].url == "https://example.com/more");
+}
+
+TEST_CASE("The least recently used articles are dropped first",
+	"[ArticleRenderCache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RegexManager rxman;
+	ArticleRenderCache article_cache(2);
+	auto first = create_item(rsscache.get(), "1");
+	auto second = create_item(rsscache.get(), "2");
+	auto third = create_item(rsscache.get(), "3");
+
+	const auto first_rendered = article_cache.get(cfg, *first, 80, 85, rxman);
+	const auto second_rendered = article_cache.get(cfg, *second, 80, 85, rxman);
+	REQUIRE(article_cache.get(cfg, *first, 80, 85, rxman) == first_rendered);
+
+	article_cache.get(cfg, *third, 80, 85, rxman);
+	REQUIRE(article_cache.size() == 2);
+
+	REQUIRE(article_cache.get(cfg, *first, 80, 85, rxman) == first_rendered);
+	REQUIRE(article_cache.get(cfg, *second, 80, 85, rxman) != second_rendered);
+}
+
+TEST_CASE("prerender() renders articles in the background",
+	"[ArticleRenderCache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RegexManager rxman;
+	ArticleRenderCache article_cache;
+	auto first = create_item(rsscache.get(), "1");
+	auto second = create_item(rsscache.get(), "2");
+
+	article_cache.prerender(cfg, {first, second}, 80, 85, rxman);
+	article_cache.wait_for_prerender();
+	REQUIRE(article_cache.size() == 2);
+
+	const auto rendered = article_cache.get(cfg, *first, 80, 85, rxman);
+	REQUIRE(rendered->text.find("Hello from 1") != std::string::npos);
+	REQUIRE(article_cache.size() == 2);
+
+	SECTION("Articles are rendered with the rules at the time of the call") {
+		article_cache.prerender(cfg, {second}, 80, 85, rxman);
+		rxman.handle_action("highlight", {"article", "Hello", "red"});
+		article_cache.wait_for_prerender();
+
+		article_cache.get(cfg, *second, 80, 85, rxman);
+		REQUIRE(article_cache.size() == 3);
+	}
+
+	SECTION("Articles are rendered as they were at the time of the call") {
+		auto feed = std::make_shared<RssFeed>(rsscache.get(),
+				"https://example.com/feed.xml");
+		feed->set_title("Example feed");
+		auto third = create_item(rsscache.get(), "3");
+		third->set_feedptr(feed);
+
+		article_cache.prerender(cfg, {third}, 80, 85, rxman);
+		third->set_title("Changed while rendering");
+		article_cache.wait_for_prerender();
+		REQUIRE(article_cache.size() == 3);
+
+		third->set_title("Article 3");
+		const auto third_rendered = article_cache.get(cfg, *third, 80, 85, rxman);
+		REQUIRE(article_cache.size() == 3);
+		REQUIRE(third_rendered->text.find("Example feed") != std::string::npos);
+	}
+}
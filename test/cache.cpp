@@ -8,6 +8,7 @@
 #include "3rd-party/catch.hpp"
 #include "configcontainer.h"
 #include "curlhandle.h"
+#include "feedloadexception.h"
 #include "feedretriever.h"
 #include "rssfeed.h"
 #include "rssignores.h"
@@ -699,6 +700,49 @@ TEST_CASE("search_for_items finds all items with matching title or content",
 	}
 }
 
+TEST_CASE("search_for_items matches substrings of titles and contents "
+	"regardless of case",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	const auto search_index = GENERATE(as<std::string> {}, "no", "yes");
+	cfg.set_configvalue("search-index", search_index);
+	auto rsscache = Cache::in_memory(cfg);
+	const std::string url = "file://data/atom10_1.xml";
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, *rsscache, easyHandle);
+	RssParser parser(url, *rsscache, cfg, nullptr);
+	auto feed = parser.parse(feed_retriever.retrieve(url));
+	rsscache->externalize_rssfeed(*feed, false);
+
+	RssIgnores ign;
+	REQUIRE(rsscache->search_for_items("GENTLE intro", "", ign).size() == 1);
+	REQUIRE(rsscache->search_for_items("ntle", "", ign).size() == 1);
+	REQUIRE(rsscache->search_for_items("me cont", "", ign).size() == 3);
+	REQUIRE(rsscache->search_for_items("\"quoted\"", "", ign).size() == 0);
+
+	SECTION("Queries shorter than three characters") {
+		REQUIRE(rsscache->search_for_items("nt", "", ign).size() == 3);
+	}
+
+	SECTION("Updated articles are found by their new content") {
+		feed->items()[0]->set_description("completely different", "text/html");
+		rsscache->externalize_rssfeed(*feed, false);
+
+		REQUIRE(rsscache->search_for_items("different", "", ign).size() == 1);
+		REQUIRE(rsscache->search_for_items("me cont", "", ign).size() == 2);
+	}
+
+	SECTION("search_in_items finds the same articles") {
+		std::unordered_set<std::string> guids;
+		for (const auto& item : feed->items()) {
+			guids.insert(item->guid());
+		}
+		REQUIRE(rsscache->search_in_items("ntle", guids).size() == 1);
+		REQUIRE(rsscache->search_in_items("SOME content", guids).size() == 3);
+	}
+}
+
 TEST_CASE("update_rssitem_flags dumps `rss_item` object's flags to DB",
 	"[Cache]")
 {
@@ -885,6 +929,33 @@ TEST_CASE("externalize_rssfeed doesn't store more than `max-items` items",
 	REQUIRE(feed->total_item_count() == 3);
 }
 
+TEST_CASE("externalize_rssfeed updates items which are already in the cache "
+	"instead of duplicating them",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	const auto feedurl = "file://data/rss.xml";
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, *rsscache, easyHandle);
+	RssParser parser(feedurl, *rsscache, cfg, nullptr);
+	auto feed = parser.parse(feed_retriever.retrieve(feedurl));
+	REQUIRE(feed->total_item_count() == 8);
+	rsscache->externalize_rssfeed(*feed, false);
+
+	const auto guid = feed->items()[0]->guid();
+	feed->items()[0]->set_title("Updated title");
+	feed->items()[0]->set_author("Updated author");
+	rsscache->externalize_rssfeed(*feed, false);
+
+	feed = rsscache->internalize_rssfeed(feedurl, nullptr);
+	REQUIRE(feed->total_item_count() == 8);
+	const auto item = feed->get_item_by_guid(guid);
+	REQUIRE(item->title() == "Updated title");
+	REQUIRE(item->author() == "Updated author");
+}
+
 TEST_CASE("externalize_rssfeed does nothing if it's passed a query feed",
 	"[Cache]")
 {
@@ -951,6 +1022,158 @@ TEST_CASE(
 	REQUIRE(feed->rssurl() == feedurl);
 }
 
+TEST_CASE("merge_rssfeed returns the same feed as externalize_rssfeed "
+	"followed by internalize_rssfeed",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	const auto feedurl = "file://data/rss.xml";
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, *rsscache, easyHandle);
+	RssParser parser(feedurl, *rsscache, cfg, nullptr);
+	auto initial_feed = parser.parse(feed_retriever.retrieve(feedurl));
+	REQUIRE(initial_feed->total_item_count() == 8);
+	rsscache->externalize_rssfeed(*initial_feed, false);
+
+	// The same feed, but with one updated article and some new ones
+	auto newfeed = parser.parse(
+			feed_retriever.retrieve("file://data/atom10_1.xml"));
+	const auto new_items_count = newfeed->total_item_count();
+	REQUIRE(new_items_count > 0);
+	auto updated_item = parser.parse(feed_retriever.retrieve(feedurl))->items()[0];
+	updated_item->set_title("Updated title");
+	newfeed->add_item(updated_item);
+
+	auto oldfeed = rsscache->internalize_rssfeed(feedurl, nullptr);
+	std::shared_ptr<RssItem> untouched_item;
+	for (const auto& item : oldfeed->items()) {
+		if (item->guid() != updated_item->guid()) {
+			untouched_item = item;
+		}
+	}
+	REQUIRE(untouched_item != nullptr);
+	untouched_item->set_unread(false);
+
+	const auto merged = rsscache->merge_rssfeed(*oldfeed, *newfeed, false, nullptr);
+	const auto loaded = rsscache->internalize_rssfeed(feedurl, nullptr);
+
+	REQUIRE(merged->total_item_count() == 8 + new_items_count);
+	REQUIRE(merged->total_item_count() == loaded->total_item_count());
+	for (const auto& expected : loaded->items()) {
+		const auto actual = merged->get_item_by_guid(expected->guid());
+		REQUIRE(actual->guid() == expected->guid());
+		REQUIRE(actual->title() == expected->title());
+		REQUIRE(actual->unread() == expected->unread());
+		REQUIRE(actual->pubDate_timestamp() == expected->pubDate_timestamp());
+		REQUIRE(actual->get_feedptr() == merged);
+	}
+	REQUIRE(merged->get_item_by_guid(updated_item->guid())->title() ==
+		"Updated title");
+
+	// Articles which weren't in the new feed aren't read from the database
+	REQUIRE(merged->get_item_by_guid(untouched_item->guid()) == untouched_item);
+	REQUIRE_FALSE(untouched_item->unread());
+}
+
+TEST_CASE("merge_rssfeed reads back feeds whose GUIDs don't fit into one "
+	"statement", "[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	const std::string feedurl = "https://example.com/feed.xml";
+	const auto oldfeed = rsscache->internalize_rssfeed(feedurl, nullptr);
+
+	// Listing all of the GUIDs would take more than SQLite's default limit
+	// of 1,000,000 bytes per statement
+	const unsigned int count = 5000;
+	RssFeed newfeed(rsscache.get(), feedurl);
+	for (unsigned int i = 0; i < count; ++i) {
+		auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid(std::string(250, 'g') + std::to_string(i));
+		item->set_title(std::to_string(i));
+		item->set_feedurl(feedurl);
+		item->set_pubDate(i);
+		newfeed.add_item(item);
+	}
+
+	const auto merged = rsscache->merge_rssfeed(*oldfeed, newfeed, false, nullptr);
+	REQUIRE(merged->total_item_count() == count);
+	REQUIRE(merged->get_item_by_guid(std::string(250, 'g') + "1234")->title() ==
+		"1234");
+}
+
+TEST_CASE("internalize_rssfeeds returns the same feeds as calling "
+	"internalize_rssfeed for each of them",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, *rsscache, easyHandle);
+	const std::vector<std::string> stored_urls = {
+		"file://data/rss.xml",
+		"file://data/atom10_1.xml",
+	};
+	for (const auto& url : stored_urls) {
+		RssParser parser(url, *rsscache, cfg, nullptr);
+		auto feed = parser.parse(feed_retriever.retrieve(url));
+		REQUIRE(feed->total_item_count() > 0);
+		rsscache->externalize_rssfeed(*feed, false);
+	}
+
+	const std::vector<std::string> urls = {
+		"file://data/atom10_1.xml",
+		"query:misc:age between 0:10",
+		"file://data/not-in-the-cache.xml",
+		"file://data/rss.xml",
+		"file://data/atom10_1.xml",
+	};
+	const auto feeds = rsscache->internalize_rssfeeds(urls, nullptr);
+	REQUIRE(feeds.size() == urls.size());
+
+	for (unsigned int i = 0; i < urls.size(); ++i) {
+		const auto expected = rsscache->internalize_rssfeed(urls[i], nullptr);
+		const auto& actual = feeds[i];
+		REQUIRE(actual->rssurl() == urls[i]);
+		REQUIRE(actual->title_raw() == expected->title_raw());
+		REQUIRE(actual->link() == expected->link());
+		REQUIRE(actual->total_item_count() == expected->total_item_count());
+		for (unsigned int j = 0; j < expected->total_item_count(); ++j) {
+			REQUIRE(actual->items()[j]->guid() == expected->items()[j]->guid());
+			REQUIRE(actual->items()[j]->get_feedptr() == actual);
+		}
+	}
+	REQUIRE(feeds[0]->total_item_count() > 0);
+	REQUIRE(feeds[3]->total_item_count() == 8);
+	// Articles aren't shared between feeds with the same URL
+	REQUIRE(feeds[0]->items()[0] != feeds[4]->items()[0]);
+}
+
+TEST_CASE("internalize_rssfeeds reports which query feed has an invalid query",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	const std::vector<std::string> urls = {
+		"query:fine:age between 0:10",
+		"query:broken:title =",
+		"file://data/rss.xml",
+	};
+
+	try {
+		rsscache->internalize_rssfeeds(urls, nullptr);
+		FAIL("No exception thrown");
+	} catch (const FeedLoadException& e) {
+		REQUIRE(e.url() == "query:broken:title =");
+		REQUIRE_FALSE(std::string(e.what()).empty());
+	}
+}
+
 TEST_CASE("internalize_rssfeed doesn't return items that are ignored",
 	"[Cache]")
 {
@@ -974,6 +1197,50 @@ TEST_CASE("internalize_rssfeed doesn't return items that are ignored",
 	REQUIRE(feed->total_item_count() == 2);
 }
 
+TEST_CASE("Articles dropped by ignore rules are removed from the feed's "
+	"unread count and GUID lookup",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	const std::string feedurl("file://data/rss092_1.xml");
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, *rsscache, easyHandle);
+	RssParser parser(feedurl, *rsscache, cfg, nullptr);
+	auto feed = parser.parse(feed_retriever.retrieve(feedurl));
+	REQUIRE(feed->total_item_count() == 3);
+	std::string ignored_guid;
+	for (const auto& item : feed->items()) {
+		if (item->title() == "A third item") {
+			ignored_guid = item->guid();
+		}
+	}
+	REQUIRE_FALSE(ignored_guid.empty());
+	rsscache->externalize_rssfeed(*feed, false);
+
+	RssIgnores ign;
+	ign.handle_action("ignore-article", {"*", "title =~ \"third\""});
+
+	SECTION("internalize_rssfeed") {
+		const auto loaded = rsscache->internalize_rssfeed(feedurl, &ign);
+		REQUIRE(loaded->total_item_count() == 2);
+		REQUIRE(loaded->unread_item_count() == 2);
+		REQUIRE(loaded->get_item_by_guid(ignored_guid) == nullptr);
+	}
+
+	SECTION("merge_rssfeed") {
+		const auto oldfeed = rsscache->internalize_rssfeed(feedurl, nullptr);
+		REQUIRE(oldfeed->unread_item_count() == 3);
+		const auto newfeed = parser.parse(feed_retriever.retrieve(feedurl));
+
+		const auto merged = rsscache->merge_rssfeed(*oldfeed, *newfeed, false, &ign);
+		REQUIRE(merged->total_item_count() == 2);
+		REQUIRE(merged->unread_item_count() == 2);
+		REQUIRE(merged->get_item_by_guid(ignored_guid) == nullptr);
+	}
+}
+
 TEST_CASE(
 	"externalize_rssfeed resets \"unread\" field if item's content "
 	"changed and reset_unread = \"yes\"",
@@ -1208,3 +1475,141 @@ TEST_CASE("Ignoring articles in search", "[Cache]")
 	REQUIRE(search_items.size() == 0 );
 	REQUIRE(no_ignore_items.size() == 1);
 }
+
+TEST_CASE("Reload schedules are stored alongside the feed", "[Cache]")
+{
+	test_helpers::TempFile dbfile;
+	ConfigContainer cfg;
+	Cache rsscache(dbfile.get_path(), cfg);
+	const std::string uri = "file://data/rss.xml";
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, rsscache, easyHandle);
+	RssParser parser(uri, rsscache, cfg, nullptr);
+	auto feed = parser.parse(feed_retriever.retrieve(uri));
+	rsscache.externalize_rssfeed(*feed, false);
+
+	SECTION("Feeds start out without a schedule") {
+		const auto schedule = rsscache.fetch_reload_schedule(uri);
+		REQUIRE(schedule.next_reload == 0);
+		REQUIRE(schedule.publish_interval == 0);
+		REQUIRE(schedule.unchanged_reloads == 0);
+		REQUIRE(schedule.not_before == 0);
+	}
+
+	SECTION("update_reload_schedule() doesn't touch not_before") {
+		rsscache.update_reload_not_before(uri, 12345);
+
+		ReloadSchedule schedule;
+		schedule.next_reload = 1000;
+		schedule.publish_interval = 3600;
+		schedule.unchanged_reloads = 3;
+		schedule.not_before = 99999;
+		rsscache.update_reload_schedule(uri, schedule);
+
+		const auto stored = rsscache.fetch_reload_schedule(uri);
+		REQUIRE(stored.next_reload == 1000);
+		REQUIRE(stored.publish_interval == 3600);
+		REQUIRE(stored.unchanged_reloads == 3);
+		REQUIRE(stored.not_before == 12345);
+
+		const auto all = rsscache.fetch_reload_schedules();
+		REQUIRE(all.size() == 1);
+		REQUIRE(all.at(uri).next_reload == 1000);
+	}
+
+	SECTION("Schedules survive a restart") {
+		ReloadSchedule schedule;
+		schedule.next_reload = 4242;
+		rsscache.update_reload_schedule(uri, schedule);
+
+		Cache reopened(dbfile.get_path(), cfg);
+		REQUIRE(reopened.fetch_reload_schedule(uri).next_reload == 4242);
+	}
+}
+
+TEST_CASE("Changes queued for remote APIs are merged per article", "[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	rsscache->queue_remote_read_state("ttrss", {"1", "2"}, true);
+	rsscache->queue_remote_read_state("ttrss", {"1"}, false);
+	rsscache->queue_remote_flags("ttrss", "2", "", "s");
+	rsscache->queue_remote_flags("ttrss", "2", "s", "sp");
+	rsscache->queue_remote_read_state("miniflux", {"1"}, true);
+
+	const auto entries = rsscache->fetch_remote_outbox("ttrss");
+	REQUIRE(entries.size() == 2);
+
+	REQUIRE(entries[0].guid == "1");
+	REQUIRE(entries[0].read == false);
+	REQUIRE_FALSE(entries[0].newflags.has_value());
+
+	REQUIRE(entries[1].guid == "2");
+	REQUIRE(entries[1].read == true);
+	// The API never learned about the intermediate "s"
+	REQUIRE(entries[1].oldflags == "");
+	REQUIRE(entries[1].newflags == "sp");
+
+	SECTION("Sent changes are removed") {
+		rsscache->remove_from_remote_outbox("ttrss", entries[0]);
+		REQUIRE(rsscache->fetch_remote_outbox("ttrss").size() == 1);
+		REQUIRE(rsscache->fetch_remote_outbox("miniflux").size() == 1);
+	}
+
+	SECTION("Changes made while sending are kept") {
+		rsscache->queue_remote_flags("ttrss", "2", "sp", "");
+		rsscache->remove_from_remote_outbox("ttrss", entries[1]);
+
+		const auto remaining = rsscache->fetch_remote_outbox("ttrss");
+		REQUIRE(remaining.size() == 2);
+		REQUIRE(remaining[1].oldflags == "sp");
+		REQUIRE(remaining[1].newflags == "");
+	}
+
+	SECTION("Postponed changes count their attempts") {
+		rsscache->postpone_remote_outbox_entry("ttrss", entries[0], 12345);
+
+		const auto remaining = rsscache->fetch_remote_outbox("ttrss");
+		REQUIRE(remaining[1].guid == "1");
+		REQUIRE(remaining[1].attempts == 1);
+		REQUIRE(remaining[1].not_before == 12345);
+
+		// A new change is sent right away
+		rsscache->queue_remote_read_state("ttrss", {"1"}, true);
+		REQUIRE(rsscache->fetch_remote_outbox("ttrss")[0].not_before == 0);
+	}
+}
+
+TEST_CASE("sync_unread_state() applies the read state reported by a remote API",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	const std::string uri = "file://data/rss.xml";
+	CurlHandle easyHandle;
+	FeedRetriever feed_retriever(cfg, *rsscache, easyHandle);
+	RssParser parser(uri, *rsscache, cfg, nullptr);
+	auto feed = parser.parse(feed_retriever.retrieve(uri));
+	REQUIRE(feed->total_item_count() == 8);
+	rsscache->externalize_rssfeed(*feed, false);
+
+	REQUIRE(rsscache->fetch_sync_position(uri) == "");
+	rsscache->update_sync_position(uri, "12345");
+	REQUIRE(rsscache->fetch_sync_position(uri) == "12345");
+
+	const auto items = feed->items();
+	// The user marked this one read, but that wasn't sent to the API yet
+	rsscache->queue_remote_read_state("ttrss", {items[1]->guid()}, true);
+
+	const auto changed = rsscache->sync_unread_state(uri, {items[0]->guid()});
+	REQUIRE(changed.size() == 6);
+	REQUIRE(changed.count(items[0]->guid()) == 0);
+	REQUIRE(changed.count(items[1]->guid()) == 0);
+	REQUIRE(changed.at(items[2]->guid()) == false);
+
+	feed = rsscache->internalize_rssfeed(uri, nullptr);
+	REQUIRE(feed->unread_item_count() == 2);
+
+	REQUIRE(rsscache->sync_unread_state(uri, {items[0]->guid()}).empty());
+}
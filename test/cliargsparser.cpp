@@ -525,6 +525,28 @@ TEST_CASE("Sets `do_cleanup` if --cleanup is provided", "[CliArgsParser]")
 	}
 }
 
+TEST_CASE("Sets `daemon` and requests silent mode if --daemon is provided",
+	"[CliArgsParser]")
+{
+	test_helpers::Opts opts = {"newsboat", "--daemon"};
+	CliArgsParser args(opts.argc(), opts.argv());
+
+	REQUIRE(args.daemon());
+	REQUIRE(args.silent());
+	REQUIRE_FALSE(args.return_code().has_value());
+}
+
+TEST_CASE("Asks to print usage and exit with failure if --daemon is combined "
+	"with -x",
+	"[CliArgsParser]")
+{
+	test_helpers::Opts opts = {"newsboat", "--daemon", "-x", "reload"};
+	CliArgsParser args(opts.argc(), opts.argv());
+
+	REQUIRE(args.should_print_usage());
+	REQUIRE(args.return_code() == EXIT_FAILURE);
+}
+
 TEST_CASE("Increases `show_version` with each -v/-V/--version provided",
 	"[CliArgsParser]")
 {
@@ -784,6 +806,25 @@ TEST_CASE("Sets `log_file` if -d/--log-file is provided",
 	}
 }
 
+TEST_CASE("Sets `trace_file` if --trace-file is provided", "[CliArgsParser]")
+{
+	const auto filename = "trace file.json"_path;
+
+	test_helpers::Opts opts = {"newsboat", "--trace-file=" + filename.to_locale_string()};
+	CliArgsParser args(opts.argc(), opts.argv());
+
+	REQUIRE(args.trace_file() == filename);
+}
+
+TEST_CASE("`trace_file` is empty if --trace-file is not provided",
+	"[CliArgsParser]")
+{
+	test_helpers::Opts opts = {"newsboat"};
+	CliArgsParser args(opts.argc(), opts.argv());
+
+	REQUIRE_FALSE(args.trace_file().has_value());
+}
+
 TEST_CASE("Resolves tilde to homedir in -d/--log-file", "[CliArgsParser]")
 {
 	test_helpers::TempDir tmp;
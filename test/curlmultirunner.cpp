@@ -0,0 +1,149 @@
+#include "curlmultirunner.h"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "curldatareceiver.h"
+#include "strprintf.h"
+#include "test_helpers/httptestserver.h"
+
+using namespace newsboat;
+
+TEST_CASE("run() performs all transfers and finishes each of them once",
+	"[CurlMultiRunner]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "hello";
+	auto mockRegistration = testServer.add_endpoint("/data", {}, 200, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()));
+	const auto url = strprintf::fmt("http://%s/data", address);
+
+	const size_t num_transfers = 10;
+	std::vector<std::unique_ptr<CurlDataReceiver>> receivers(num_transfers);
+	std::vector<std::string> received(num_transfers);
+	std::vector<CURLcode> results(num_transfers, CURLE_FAILED_INIT);
+	std::atomic<unsigned int> finished{0};
+
+	std::vector<CurlMultiRunner::Transfer> transfers;
+	for (size_t i = 0; i < num_transfers; ++i) {
+		CurlMultiRunner::Transfer transfer;
+		transfer.setup = [&, i](CurlHandle& handle) {
+			curl_easy_reset(handle.ptr());
+			curl_easy_setopt(handle.ptr(), CURLOPT_URL, url.c_str());
+			receivers[i] = CurlDataReceiver::register_data_handler(handle);
+			return true;
+		};
+		transfer.finish = [&, i](CurlHandle&, CURLcode result) {
+			results[i] = result;
+			received[i] = receivers[i]->get_data();
+			receivers[i].reset();
+			++finished;
+		};
+		transfers.push_back(std::move(transfer));
+	}
+
+	CurlMultiRunner runner(3, 2, 2);
+	runner.run(transfers);
+
+	REQUIRE(finished == num_transfers);
+	REQUIRE(testServer.num_hits(mockRegistration) == num_transfers);
+	for (size_t i = 0; i < num_transfers; ++i) {
+		INFO("Transfer #" << i);
+		REQUIRE(results[i] == CURLE_OK);
+		REQUIRE(received[i] == body);
+	}
+}
+
+TEST_CASE("run() finishes transfers whose setup failed with CURLE_FAILED_INIT",
+	"[CurlMultiRunner]")
+{
+	std::vector<CURLcode> results;
+	std::mutex results_mutex;
+
+	std::vector<CurlMultiRunner::Transfer> transfers;
+	for (int i = 0; i < 2; ++i) {
+		CurlMultiRunner::Transfer transfer;
+		transfer.setup = [i](CurlHandle&) -> bool {
+			if (i == 0) {
+				return false;
+			}
+			throw std::runtime_error("setup failed");
+		};
+		transfer.finish = [&](CurlHandle&, CURLcode result) {
+			std::lock_guard<std::mutex> guard(results_mutex);
+			results.push_back(result);
+		};
+		transfers.push_back(std::move(transfer));
+	}
+
+	CurlMultiRunner runner(8, 0, 4);
+	runner.run(transfers);
+
+	REQUIRE(results == std::vector<CURLcode>({CURLE_FAILED_INIT, CURLE_FAILED_INIT}));
+}
+
+TEST_CASE("run() does nothing if there are no transfers", "[CurlMultiRunner]")
+{
+	std::vector<CurlMultiRunner::Transfer> transfers;
+	CurlMultiRunner runner(1, 1, 1);
+	REQUIRE_NOTHROW(runner.run(transfers));
+}
+
+TEST_CASE("run() reuses the connections left open by the previous run()",
+	"[CurlMultiRunner]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "hello";
+	auto mockRegistration = testServer.add_endpoint("/reused", {}, 200, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()));
+	const auto url = strprintf::fmt("http://%s/reused", address);
+
+	auto connects_of_single_transfer = [&](CurlMultiRunner& runner) {
+		std::unique_ptr<CurlDataReceiver> receiver;
+		CURLcode transfer_result = CURLE_FAILED_INIT;
+		long connects = -1;
+
+		std::vector<CurlMultiRunner::Transfer> transfers(1);
+		transfers[0].setup = [&](CurlHandle& handle) {
+			curl_easy_reset(handle.ptr());
+			curl_easy_setopt(handle.ptr(), CURLOPT_URL, url.c_str());
+			receiver = CurlDataReceiver::register_data_handler(handle);
+			return true;
+		};
+		transfers[0].finish = [&](CurlHandle& handle, CURLcode result) {
+			transfer_result = result;
+			curl_easy_getinfo(handle.ptr(), CURLINFO_NUM_CONNECTS, &connects);
+			receiver.reset();
+		};
+
+		runner.run(transfers);
+		REQUIRE(transfer_result == CURLE_OK);
+		return connects;
+	};
+
+	CurlShareHandle share;
+
+	SECTION("The same runner opens a single connection") {
+		CurlMultiRunner runner(1, 0, 1, &share);
+		REQUIRE(connects_of_single_transfer(runner) == 1);
+		runner.set_limits(2, 1, 2);
+		REQUIRE(connects_of_single_transfer(runner) == 0);
+		REQUIRE(testServer.num_hits(mockRegistration) == 2);
+	}
+
+	SECTION("Runners with the same CurlShareHandle open connections of their own") {
+		CurlMultiRunner first(1, 0, 1, &share);
+		REQUIRE(connects_of_single_transfer(first) == 1);
+		CurlMultiRunner second(1, 0, 1, &share);
+		REQUIRE(connects_of_single_transfer(second) == 1);
+		REQUIRE(testServer.num_hits(mockRegistration) == 2);
+	}
+}
@@ -0,0 +1,222 @@
+#include "daemon.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "3rd-party/catch.hpp"
+#include "configpaths.h"
+#include "controller.h"
+#include "test_helpers/tempdir.h"
+#include "view.h"
+
+using namespace newsboat;
+
+namespace {
+
+// Accepts a single connection, stores what the client sent and answers with
+// `reply`
+class FakeDaemon {
+public:
+	FakeDaemon(const Filepath& path, const std::string& reply)
+	{
+		const std::string p = path.to_locale_string();
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		std::strncpy(address.sun_path, p.c_str(), sizeof(address.sun_path) - 1);
+
+		fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		REQUIRE(fd >= 0);
+		REQUIRE(::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+		REQUIRE(::listen(fd, 1) == 0);
+
+		thread = std::thread([this, reply]() {
+			const int client = ::accept(fd, nullptr, nullptr);
+			char buf[256];
+			ssize_t n;
+			while ((n = ::read(client, buf, sizeof(buf))) > 0) {
+				request.append(buf, n);
+			}
+			if (::write(client, reply.data(), reply.size()) < 0) {
+				// The test will notice the missing reply
+			}
+			::close(client);
+		});
+	}
+
+	~FakeDaemon()
+	{
+		if (thread.joinable()) {
+			thread.join();
+		}
+		::close(fd);
+	}
+
+	std::string get_request()
+	{
+		thread.join();
+		return request;
+	}
+
+private:
+	int fd;
+	std::thread thread;
+	std::string request;
+};
+
+// Connects to the socket at `path` and sends `request`, without shutting
+// down the connection
+int send_request(const Filepath& path, const std::string& request)
+{
+	const std::string p = path.to_locale_string();
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, p.c_str(), sizeof(address.sun_path) - 1);
+
+	const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	REQUIRE(fd >= 0);
+	REQUIRE(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+	REQUIRE(::write(fd, request.data(), request.size())
+		== static_cast<ssize_t>(request.size()));
+	return fd;
+}
+
+// Reads until the daemon closes the connection, then closes it on our side
+std::string read_reply(int fd)
+{
+	std::string reply;
+	char buf[256];
+	ssize_t n;
+	while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+		reply.append(buf, n);
+	}
+	::close(fd);
+	return reply;
+}
+
+} // namespace
+
+TEST_CASE("socket_path() puts the socket next to the cache", "[Daemon]")
+{
+	REQUIRE(Daemon::socket_path("/home/user/.newsboat/cache.db"_path)
+		== "/home/user/.newsboat/cache.db.sock"_path);
+}
+
+TEST_CASE("forward_commands() returns nothing if no daemon is running",
+	"[Daemon]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("cache.db.sock"_path);
+
+	std::ostringstream out;
+	std::ostringstream err;
+	const auto ret = Daemon::forward_commands(path, {"print-unread"}, out, err);
+
+	REQUIRE_FALSE(ret.has_value());
+	REQUIRE(out.str().empty());
+	REQUIRE(err.str().empty());
+}
+
+TEST_CASE("forward_commands() sends commands to the daemon and passes on its "
+	"reply",
+	"[Daemon]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("cache.db.sock"_path);
+
+	std::ostringstream out;
+	std::ostringstream err;
+
+	SECTION("Successful commands") {
+		FakeDaemon daemon(path,
+			"out 3 unread articles\n"
+			"out 1\thttp://example.com/feed.xml\n"
+			"exit 0\n");
+		const auto ret = Daemon::forward_commands(path,
+		{"print-unread", "print-feeds-unread"}, out, err);
+
+		REQUIRE(daemon.get_request() == "32\nprint-unread\nprint-feeds-unread\n");
+		REQUIRE(ret == EXIT_SUCCESS);
+		REQUIRE(out.str() == "3 unread articles\n1\thttp://example.com/feed.xml\n");
+		REQUIRE(err.str().empty());
+	}
+
+	SECTION("Failed command") {
+		FakeDaemon daemon(path,
+			"err newsboat: frobnicate: unknown command\n"
+			"exit 1\n");
+		const auto ret = Daemon::forward_commands(path, {"frobnicate"}, out, err);
+
+		REQUIRE(ret == EXIT_FAILURE);
+		REQUIRE(out.str().empty());
+		REQUIRE(err.str() == "newsboat: frobnicate: unknown command\n");
+	}
+
+	SECTION("Daemon goes away without replying") {
+		FakeDaemon daemon(path, "");
+		const auto ret = Daemon::forward_commands(path, {"reload"}, out, err);
+
+		REQUIRE(ret == EXIT_FAILURE);
+		REQUIRE_FALSE(err.str().empty());
+	}
+}
+
+TEST_CASE("Daemon answers requests sent through its socket, and only complete "
+	"ones", "[Daemon]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("cache.db.sock"_path);
+
+	ConfigPaths paths{};
+	Controller c(paths);
+	newsboat::View v(c);
+	c.set_view(&v);
+
+	Daemon daemon(c, path);
+	REQUIRE(daemon.listen());
+
+	const std::string request = "13\nprint-unread\n";
+
+	SECTION("Complete request") {
+		const int client = send_request(path, request);
+		::shutdown(client, SHUT_WR);
+		REQUIRE(daemon.serve_client(std::chrono::seconds(10)));
+		REQUIRE(read_reply(client) == "out 0 unread articles\nexit 0\n");
+	}
+
+	SECTION("Request that's shorter than its size says") {
+		const int client = send_request(path, "100\nprint-unread\n");
+		::shutdown(client, SHUT_WR);
+		REQUIRE(daemon.serve_client(std::chrono::seconds(10)));
+		REQUIRE(read_reply(client).empty());
+	}
+
+	SECTION("Request without a size") {
+		const int client = send_request(path, "print-unread\n");
+		::shutdown(client, SHUT_WR);
+		REQUIRE(daemon.serve_client(std::chrono::seconds(10)));
+		REQUIRE(read_reply(client).empty());
+	}
+
+	SECTION("A client that stops sending is disconnected, and the next one is "
+		"served") {
+		// Neither finishes its request nor closes the connection
+		const int stalled = send_request(path, request.substr(0, 8));
+		const int next = send_request(path, request);
+		::shutdown(next, SHUT_WR);
+
+		REQUIRE(daemon.serve_client(std::chrono::seconds(10)));
+		REQUIRE(read_reply(stalled).empty());
+
+		REQUIRE(daemon.serve_client(std::chrono::seconds(10)));
+		REQUIRE(read_reply(next) == "out 0 unread articles\nexit 0\n");
+	}
+
+	SECTION("No client") {
+		REQUIRE_FALSE(daemon.serve_client(std::chrono::milliseconds(10)));
+	}
+}
@@ -0,0 +1,335 @@
+#include "downloadengine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "configcontainer.h"
+#include "download.h"
+#include "strprintf.h"
+#include "test_helpers/httptestserver.h"
+#include "test_helpers/tempdir.h"
+
+using namespace newsboat;
+using namespace podboat;
+
+namespace {
+
+// Applies engine events until `dl` is no longer downloading, or until we give up
+void wait_until_done(DownloadEngine& engine, const Download& dl)
+{
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (dl.status() == DlStatus::DOWNLOADING
+		&& std::chrono::steady_clock::now() < deadline) {
+		struct pollfd pfd;
+		pfd.fd = engine.event_fd();
+		pfd.events = POLLIN;
+		poll(&pfd, 1, 100);
+		engine.process_events();
+	}
+}
+
+std::string read_file(const Filepath& path)
+{
+	std::ifstream f(path.to_locale_string());
+	std::stringstream contents;
+	contents << f.rdbuf();
+	return contents.str();
+}
+
+bool file_exists(const Filepath& path)
+{
+	struct stat sb;
+	return stat(path.to_locale_string().c_str(), &sb) == 0;
+}
+
+} // namespace
+
+TEST_CASE("DownloadEngine stores the downloaded file under its final name",
+	"[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "episode contents";
+	auto mockRegistration = testServer.add_endpoint("/episode.mp3", {}, 200, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()));
+
+	test_helpers::TempDir tmp;
+	const auto filename = tmp.get_path().join("podcasts/episode.mp3"_path);
+
+	Download dl([]() {});
+	dl.set_url(strprintf::fmt("http://%s/episode.mp3", address));
+	dl.set_filename(filename);
+
+	ConfigContainer cfg;
+	DownloadEngine engine(cfg);
+	engine.start(dl);
+	REQUIRE(dl.status() == DlStatus::DOWNLOADING);
+
+	wait_until_done(engine, dl);
+
+	REQUIRE(dl.status() == DlStatus::READY);
+	REQUIRE(read_file(filename) == body);
+	REQUIRE_FALSE(file_exists(tmp.get_path().join("podcasts/episode.mp3.part"_path)));
+}
+
+TEST_CASE("DownloadEngine reports failed downloads and removes the partial file",
+	"[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "not found";
+	auto mockRegistration = testServer.add_endpoint("/missing.mp3", {}, 404, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()));
+
+	test_helpers::TempDir tmp;
+	const auto filename = tmp.get_path().join("missing.mp3"_path);
+
+	Download dl([]() {});
+	dl.set_url(strprintf::fmt("http://%s/missing.mp3", address));
+	dl.set_filename(filename);
+
+	ConfigContainer cfg;
+	DownloadEngine engine(cfg);
+	engine.start(dl);
+	wait_until_done(engine, dl);
+
+	REQUIRE(dl.status() == DlStatus::FAILED);
+	REQUIRE_FALSE(dl.status_msg().empty());
+	REQUIRE_FALSE(file_exists(filename));
+	REQUIRE_FALSE(file_exists(tmp.get_path().join("missing.mp3.part"_path)));
+}
+
+TEST_CASE("DownloadEngine ignores progress of cancelled downloads",
+	"[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "slow episode";
+	auto mockRegistration = testServer.add_endpoint("/slow.mp3", {}, 200, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()),
+			std::chrono::milliseconds(500));
+
+	test_helpers::TempDir tmp;
+
+	Download dl([]() {});
+	dl.set_url(strprintf::fmt("http://%s/slow.mp3", address));
+	dl.set_filename(tmp.get_path().join("slow.mp3"_path));
+
+	ConfigContainer cfg;
+	DownloadEngine engine(cfg);
+	engine.start(dl);
+	engine.cancel(dl);
+	REQUIRE(dl.status() == DlStatus::CANCELLED);
+
+	// Give a transfer which wasn't stopped the time to finish
+	std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+	engine.process_events();
+
+	REQUIRE(dl.status() == DlStatus::CANCELLED);
+	REQUIRE_FALSE(file_exists(tmp.get_path().join("slow.mp3"_path)));
+}
+
+TEST_CASE("DownloadEngine runs several downloads at once", "[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "episode";
+	auto mockRegistration = testServer.add_endpoint("/many.mp3", {}, 200, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()));
+
+	test_helpers::TempDir tmp;
+
+	ConfigContainer cfg;
+
+	std::vector<Download> downloads;
+	for (int i = 0; i < 5; ++i) {
+		Download dl([]() {});
+		dl.set_url(strprintf::fmt("http://%s/many.mp3", address));
+		dl.set_filename(tmp.get_path().join(Filepath::from_locale_string(std::to_string(i) + ".mp3")));
+		downloads.push_back(dl);
+	}
+
+	DownloadEngine engine(cfg);
+	for (auto& dl : downloads) {
+		engine.start(dl);
+	}
+	for (const auto& dl : downloads) {
+		wait_until_done(engine, dl);
+	}
+
+	for (const auto& dl : downloads) {
+		INFO(dl.filename().to_locale_string());
+		REQUIRE(dl.status() == DlStatus::READY);
+		REQUIRE(read_file(dl.filename()) == body);
+	}
+	REQUIRE(testServer.num_hits(mockRegistration) == downloads.size());
+}
+
+TEST_CASE("DownloadEngine opens at most `max-download-host-connections` "
+	"connections to a host", "[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::string body = "episode";
+	auto mockRegistration = testServer.add_endpoint("/queued.mp3", {}, 200, {},
+			std::vector<std::uint8_t>(body.begin(), body.end()),
+			std::chrono::milliseconds(500));
+
+	test_helpers::TempDir tmp;
+
+	ConfigContainer cfg;
+	cfg.set_configvalue("max-download-host-connections", "1");
+
+	std::vector<Download> downloads;
+	for (int i = 0; i < 4; ++i) {
+		Download dl([]() {});
+		dl.set_url(strprintf::fmt("http://%s/queued.mp3", address));
+		dl.set_filename(tmp.get_path().join(Filepath::from_locale_string(std::to_string(i) + ".mp3")));
+		downloads.push_back(dl);
+	}
+
+	DownloadEngine engine(cfg);
+	const auto started = std::chrono::steady_clock::now();
+	for (auto& dl : downloads) {
+		engine.start(dl);
+	}
+	for (const auto& dl : downloads) {
+		wait_until_done(engine, dl);
+	}
+	const auto elapsed = std::chrono::steady_clock::now() - started;
+
+	for (const auto& dl : downloads) {
+		INFO(dl.filename().to_locale_string());
+		REQUIRE(dl.status() == DlStatus::READY);
+	}
+	REQUIRE(testServer.num_hits(mockRegistration) == downloads.size());
+	// The responses are delayed by half a second each. Over a single
+	// connection they take two seconds; in parallel, half a second.
+	REQUIRE(elapsed >= std::chrono::milliseconds(1500));
+}
+
+TEST_CASE("DownloadEngine downloads large files in segments if the server "
+	"supports ranges", "[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	// Big enough to be split into two segments
+	const std::uint64_t size = 5 * 1024 * 1024;
+	std::vector<std::uint8_t> body(size);
+	for (std::uint64_t i = 0; i < size; ++i) {
+		body[i] = i % 251;
+	}
+	const std::uint64_t half = size / 2;
+
+	const auto add_range = [&](std::uint64_t first, std::uint64_t last) {
+		const auto range = strprintf::fmt("%" PRIu64 "-%" PRIu64, first, last);
+		return testServer.add_endpoint("/video.mp4",
+		{{"Range", "bytes=" + range}},
+		206,
+		{{"Content-Range", strprintf::fmt("bytes %s/%" PRIu64, range, size)}},
+		std::vector<std::uint8_t>(body.begin() + first, body.begin() + last + 1));
+	};
+	auto probe = add_range(0, 0);
+	auto first_half = add_range(0, half - 1);
+	auto second_half = add_range(half, size - 1);
+
+	test_helpers::TempDir tmp;
+	const auto filename = tmp.get_path().join("video.mp4"_path);
+
+	Download dl([]() {});
+	dl.set_url(strprintf::fmt("http://%s/video.mp4", address));
+	dl.set_filename(filename);
+
+	ConfigContainer cfg;
+	cfg.set_configvalue("download-segments", "2");
+	DownloadEngine engine(cfg);
+	engine.start(dl);
+	wait_until_done(engine, dl);
+
+	REQUIRE(dl.status() == DlStatus::READY);
+	const auto contents = read_file(filename);
+	REQUIRE(contents.size() == size);
+	REQUIRE(std::equal(contents.begin(), contents.end(), body.begin()));
+	REQUIRE(testServer.num_hits(probe) == 1);
+	REQUIRE(testServer.num_hits(first_half) == 1);
+	REQUIRE(testServer.num_hits(second_half) == 1);
+	REQUIRE_FALSE(file_exists(tmp.get_path().join("video.mp4.part.segments"_path)));
+}
+
+TEST_CASE("DownloadEngine downloads the file as a whole if the server ignores "
+	"ranges", "[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	const std::vector<std::uint8_t> body(5 * 1024 * 1024, 'x');
+	auto mockRegistration = testServer.add_endpoint("/video.mp4", {}, 200, {},
+			body);
+
+	test_helpers::TempDir tmp;
+	const auto filename = tmp.get_path().join("video.mp4"_path);
+
+	Download dl([]() {});
+	dl.set_url(strprintf::fmt("http://%s/video.mp4", address));
+	dl.set_filename(filename);
+
+	ConfigContainer cfg;
+	cfg.set_configvalue("download-segments", "2");
+	DownloadEngine engine(cfg);
+	engine.start(dl);
+	wait_until_done(engine, dl);
+
+	REQUIRE(dl.status() == DlStatus::READY);
+	REQUIRE(read_file(filename) == std::string(body.begin(), body.end()));
+	REQUIRE_FALSE(file_exists(tmp.get_path().join("video.mp4.part.segments"_path)));
+}
+
+TEST_CASE("DownloadEngine limits the speed of a download that replaces its "
+	"probe", "[DownloadEngine]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	// The server ignores ranges, so the probe is followed by a stream of the
+	// whole file, started within the same step of the event loop
+	const std::vector<std::uint8_t> body(1024 * 1024, 'x');
+	auto mockRegistration = testServer.add_endpoint("/limited.mp4", {}, 200, {},
+			body);
+
+	test_helpers::TempDir tmp;
+	const auto filename = tmp.get_path().join("limited.mp4"_path);
+
+	Download dl([]() {});
+	dl.set_url(strprintf::fmt("http://%s/limited.mp4", address));
+	dl.set_filename(filename);
+
+	ConfigContainer cfg;
+	cfg.set_configvalue("download-segments", "2");
+	cfg.set_configvalue("max-download-speed", "256");
+	DownloadEngine engine(cfg);
+	const auto started = std::chrono::steady_clock::now();
+	engine.start(dl);
+	wait_until_done(engine, dl);
+	const auto elapsed = std::chrono::steady_clock::now() - started;
+
+	REQUIRE(dl.status() == DlStatus::READY);
+	REQUIRE(read_file(filename) == std::string(body.begin(), body.end()));
+	// 1 MiB at 256 KiB/s takes four seconds; without a limit it's a matter
+	// of milliseconds
+	REQUIRE(elapsed >= std::chrono::seconds(2));
+}
@@ -1090,6 +1090,87 @@ TEST_CASE("unread_item_count() returns number of distinct unread items "
 	}
 }
 
+TEST_CASE("unread_item_count() follows changes made after the feeds were "
+	"added",
+	"[FeedContainer]")
+{
+	FeedContainer feedcontainer;
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+
+	auto feeds = get_five_empty_feeds(rsscache.get());
+	for (int j = 0; j < 2; ++j) {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid(std::to_string(j) + "item");
+		feeds[j]->add_item(item);
+	}
+	feedcontainer.set_feeds(feeds);
+	REQUIRE(feedcontainer.unread_item_count() == 2);
+
+	SECTION("Articles are marked read and unread") {
+		const auto item = feeds[0]->items()[0];
+		item->set_unread_nowrite(false);
+		REQUIRE(feedcontainer.unread_item_count() == 1);
+		item->set_unread_nowrite(true);
+		REQUIRE(feedcontainer.unread_item_count() == 2);
+
+		feedcontainer.mark_all_feeds_read();
+		REQUIRE(feedcontainer.unread_item_count() == 0);
+	}
+
+	SECTION("Articles are added and removed") {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid("new item");
+		feeds[2]->add_item(item);
+		REQUIRE(feedcontainer.unread_item_count() == 3);
+
+		feeds[0]->erase_item(feeds[0]->items().begin());
+		REQUIRE(feedcontainer.unread_item_count() == 2);
+	}
+
+	SECTION("Articles with the same GUID are counted once") {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid("0item");
+		feeds[3]->add_item(item);
+		REQUIRE(feedcontainer.unread_item_count() == 2);
+
+		feeds[0]->items()[0]->set_unread_nowrite(false);
+		REQUIRE(feedcontainer.unread_item_count() == 2);
+
+		item->set_unread_nowrite(false);
+		REQUIRE(feedcontainer.unread_item_count() == 1);
+	}
+
+	SECTION("Feed is replaced") {
+		const auto feed = std::make_shared<RssFeed>(rsscache.get(), "");
+		for (int i = 0; i < 3; ++i) {
+			const auto item = std::make_shared<RssItem>(rsscache.get());
+			item->set_guid(std::to_string(i) + "replacement");
+			feed->add_item(item);
+		}
+
+		feedcontainer.replace_feed(0, feed);
+		REQUIRE(feedcontainer.unread_item_count() == 4);
+
+		// The old feed is no longer in the container
+		feeds[0]->items()[0]->set_unread_nowrite(false);
+		REQUIRE(feedcontainer.unread_item_count() == 4);
+	}
+
+	SECTION("Feed is hidden, then shown again") {
+		feeds[0]->set_tags({"!hidden"});
+		REQUIRE(feedcontainer.unread_item_count() == 1);
+
+		feeds[0]->set_tags({});
+		REQUIRE(feedcontainer.unread_item_count() == 2);
+	}
+
+	SECTION("Feeds are removed") {
+		feedcontainer.set_feeds({feeds[1]});
+		REQUIRE(feedcontainer.unread_item_count() == 1);
+	}
+}
+
 TEST_CASE("get_unread_feed_count_per_tag returns 0 if there are no feeds "
 	"with given tag",
 	"[FeedContainer]")
@@ -4,6 +4,7 @@
 #include "cache.h"
 #include "configcontainer.h"
 #include "curlhandle.h"
+#include "freshrssapi.h"
 #include "rss/exception.h"
 #include "rssfeed.h"
 #include "strprintf.h"
@@ -280,3 +281,134 @@ TEST_CASE("Feed retriever with exec: feed", "[FeedRetriever]")
 		REQUIRE(feed.title == title_utf8);
 	}
 }
+
+TEST_CASE("retrieve_in_bulk() hands the articles of FreshRSS's reading list to "
+	"their feeds", "[FeedRetriever]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	ConfigContainer cfg;
+	cfg.set_configvalue("urls-source", "freshrss");
+	cfg.set_configvalue("freshrss-url", strprintf::fmt("http://%s", address));
+	auto rsscache = Cache::in_memory(cfg);
+
+	const auto prefix = strprintf::fmt("http://%s/reader/api/0/stream/contents/",
+			address);
+	const std::vector<std::string> urls = {
+		prefix + "feed%2F1",
+		prefix + "feed%2F2",
+		prefix + "feed%2F3",
+		prefix + "user/-/state/com.google/starred",
+	};
+	for (const auto& url : urls) {
+		RssFeed feed(rsscache.get(), url);
+		rsscache->externalize_rssfeed(feed, false);
+	}
+	rsscache->update_sync_position(urls[0], "1000");
+	rsscache->update_sync_position(urls[1], "2000");
+	// The third feed was never fetched, so it has to be fetched in full
+
+	// Starred articles aren't found by their feed in the reading list, so
+	// they have to be fetched on their own even if they have a position
+	rsscache->update_sync_position(urls[3], "1500");
+
+	const std::string reading_list = R"({"items": [
+		{"id": "tag:google.com,2005:reader/item/0000000000000002",
+			"timestampUsec": "3000000000", "title": "Second",
+			"origin": {"streamId": "feed/2"}},
+		{"id": "tag:google.com,2005:reader/item/0000000000000001",
+			"timestampUsec": "2500000000", "title": "First",
+			"origin": {"streamId": "feed/1"}},
+		{"id": "tag:google.com,2005:reader/item/0000000000000009",
+			"timestampUsec": "2400000000", "title": "Not requested",
+			"origin": {"streamId": "feed/9"}}
+	]})";
+	const std::string unread_ids = R"({"itemRefs": [{"id": "2"}]})";
+	auto readingListRegistration = testServer.add_endpoint(
+			"/reader/api/0/stream/contents/user%2F-%2Fstate%2Fcom.google%2Freading-list",
+			{}, 200, {
+				{"content-type", "application/json"},
+			}, std::vector<std::uint8_t>(reading_list.begin(), reading_list.end()));
+	auto unreadIdsRegistration = testServer.add_endpoint(
+			"/reader/api/0/stream/items/ids", {}, 200, {
+				{"content-type", "application/json"},
+			}, std::vector<std::uint8_t>(unread_ids.begin(), unread_ids.end()));
+
+	FreshRssApi api(cfg);
+	CurlHandle easyHandle;
+	FeedRetriever feedRetriever(cfg, *rsscache, easyHandle, nullptr, &api);
+	auto feeds = feedRetriever.retrieve_in_bulk(urls);
+
+	REQUIRE(testServer.num_hits(readingListRegistration) == 1);
+	REQUIRE(testServer.num_hits(unreadIdsRegistration) == 1);
+
+	REQUIRE(feeds.size() == 2);
+	REQUIRE(feeds.count(urls[2]) == 0);
+	REQUIRE(feeds.count(urls[3]) == 0);
+
+	REQUIRE(feeds[urls[0]].items.size() == 1);
+	REQUIRE(feeds[urls[0]].items[0].title == "First");
+	REQUIRE(feeds[urls[1]].items.size() == 1);
+	REQUIRE(feeds[urls[1]].items[0].title == "Second");
+
+	REQUIRE(feeds[urls[0]].sync_position == "3000");
+	REQUIRE(feeds[urls[1]].sync_position == "3000");
+
+	REQUIRE(feeds[urls[0]].unread_guids != nullptr);
+	REQUIRE(feeds[urls[0]].unread_guids == feeds[urls[1]].unread_guids);
+	REQUIRE(*feeds[urls[0]].unread_guids == std::unordered_set<std::string> {
+		"tag:google.com,2005:reader/item/0000000000000002",
+	});
+}
+
+TEST_CASE("retrieve() fetches FreshRSS's starred articles in full even if they "
+	"were fetched before", "[FeedRetriever]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+
+	ConfigContainer cfg;
+	cfg.set_configvalue("urls-source", "freshrss");
+	cfg.set_configvalue("freshrss-url", strprintf::fmt("http://%s", address));
+	auto rsscache = Cache::in_memory(cfg);
+
+	const auto url = strprintf::fmt(
+			"http://%s/reader/api/0/stream/contents/user/-/state/com.google/starred",
+			address);
+	RssFeed feed(rsscache.get(), url);
+	rsscache->externalize_rssfeed(feed, false);
+	rsscache->update_sync_position(url, "3000");
+
+	// Added long before the sync position, but starred after it
+	const std::string starred = R"({"items": [
+		{"id": "tag:google.com,2005:reader/item/0000000000000001",
+			"timestampUsec": "1000000000", "title": "Old but starred",
+			"origin": {"streamId": "feed/1"}}
+	]})";
+	auto starredRegistration = testServer.add_endpoint(
+			"/reader/api/0/stream/contents/user/-/state/com.google/starred",
+			{}, 200, {
+				{"content-type", "application/json"},
+			}, std::vector<std::uint8_t>(starred.begin(), starred.end()));
+	auto unreadIdsRegistration = testServer.add_endpoint(
+			"/reader/api/0/stream/items/ids", {}, 200, {
+				{"content-type", "application/json"},
+			}, {});
+
+	FreshRssApi api(cfg);
+	REQUIRE_FALSE(api.is_feed_stream(url));
+	REQUIRE(api.is_feed_stream(strprintf::fmt(
+				"http://%s/reader/api/0/stream/contents/feed%%2F1", address)));
+
+	CurlHandle easyHandle;
+	FeedRetriever feedRetriever(cfg, *rsscache, easyHandle, nullptr, &api);
+	const auto fetched = feedRetriever.retrieve(url);
+
+	REQUIRE(testServer.num_hits(starredRegistration) == 1);
+	// Only incremental fetches ask for the unread articles separately
+	REQUIRE(testServer.num_hits(unreadIdsRegistration) == 0);
+	REQUIRE(fetched.items.size() == 1);
+	REQUIRE(fetched.items[0].title == "Old but starred");
+	REQUIRE(fetched.sync_position.empty());
+}
@@ -928,3 +928,66 @@ TEST_CASE("get_referenced_attributes() includes all referenced attributes",
 		});
 	}
 }
+
+TEST_CASE("Numeric operators use attribute_value_as_number() if available",
+	"[Matcher]")
+{
+	class NumericMatchable : public Matchable {
+	public:
+		std::optional<std::string> attribute_value(const std::string& attr)
+		const override
+		{
+			if (attr == "count") {
+				return "not a number";
+			}
+			return std::nullopt;
+		}
+
+		std::optional<int> attribute_value_as_number(const std::string& attr)
+		const override
+		{
+			if (attr == "count") {
+				return 42;
+			}
+			return std::nullopt;
+		}
+	};
+
+	NumericMatchable mock;
+	Matcher m;
+
+	REQUIRE(m.parse("count > 41"));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("count between 40:50"));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("count <= 41"));
+	REQUIRE_FALSE(m.matches(&mock));
+
+	REQUIRE(m.parse("count = \"not a number\""));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("other > 0"));
+	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
+}
+
+TEST_CASE("Operands of `and` and `or` are evaluated left to right",
+	"[Matcher]")
+{
+	// `feedtitle` isn't available, so it throws whenever it's evaluated
+	MatcherMockMatchable mock({{"title", "fine"}});
+	Matcher m;
+
+	REQUIRE(m.parse("title = \"fine\" or feedtitle = \"x\""));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("title = \"other\" and feedtitle = \"x\""));
+	REQUIRE_FALSE(m.matches(&mock));
+
+	REQUIRE(m.parse("feedtitle = \"x\" or title = \"fine\""));
+	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
+
+	REQUIRE(m.parse("title = \"fine\" and feedtitle = \"x\""));
+	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
+}
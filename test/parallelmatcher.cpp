@@ -0,0 +1,98 @@
+#include "parallelmatcher.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "cache.h"
+#include "configcontainer.h"
+#include "matcher.h"
+#include "matcherexception.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+
+using namespace newsboat;
+
+TEST_CASE("matches() returns the results in the order of the articles",
+	"[ParallelMatcher]")
+{
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (int i = 0; i < 1000; ++i) {
+		auto item = std::make_shared<RssItem>(nullptr);
+		item->set_title(std::to_string(i));
+		items.push_back(item);
+	}
+
+	Matcher matcher("title =~ \"[37]$\"");
+	ParallelMatcher parallel_matcher(matcher, nullptr);
+	const auto results = parallel_matcher.matches(items);
+
+	REQUIRE(results.size() == items.size());
+	for (unsigned int i = 0; i < items.size(); ++i) {
+		INFO("article #" << i);
+		REQUIRE(results[i] == matcher.matches(items[i].get()));
+	}
+
+	REQUIRE(parallel_matcher.matches({}).empty());
+}
+
+TEST_CASE("matches() rethrows errors no matter which article caused them",
+	"[ParallelMatcher]")
+{
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (int i = 0; i < 1000; ++i) {
+		auto item = std::make_shared<RssItem>(nullptr);
+		item->set_title(i == 900 ? "broken" : "fine");
+		items.push_back(item);
+	}
+
+	// Articles have no feed, so `feedtitle` is only unavailable for the one
+	// article whose title doesn't short-circuit the expression
+	Matcher matcher("title = \"fine\" or feedtitle = \"x\"");
+	ParallelMatcher parallel_matcher(matcher, nullptr);
+	REQUIRE_THROWS_AS(parallel_matcher.matches(items), MatcherException);
+
+	// The same ParallelMatcher can be used again
+	items.erase(items.begin() + 900);
+	const auto results = parallel_matcher.matches(items);
+	REQUIRE(std::count(results.begin(), results.end(), true) == 999);
+}
+
+TEST_CASE("matches() fetches the content of unloaded articles from the cache",
+	"[ParallelMatcher]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	auto feed = std::make_shared<RssFeed>(rsscache.get(),
+			"https://example.com/feed.xml");
+	for (int i = 0; i < 300; ++i) {
+		auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid(std::to_string(i));
+		item->set_title("Article");
+		item->set_description(i % 3 == 0 ? "needle" : "haystack", "text/plain");
+		item->set_feedurl(feed->rssurl());
+		feed->add_item(item);
+	}
+	rsscache->externalize_rssfeed(*feed, false);
+
+	// Some articles keep their content in memory, the rest have to be
+	// looked up
+	for (const auto& item : feed->items()) {
+		if (item->guid().back() != '1') {
+			item->unload();
+		}
+	}
+
+	Matcher matcher("content =~ \"needle\"");
+	ParallelMatcher parallel_matcher(matcher, rsscache.get());
+	const auto results = parallel_matcher.matches(feed->items());
+
+	REQUIRE(results.size() == 300);
+	for (unsigned int i = 0; i < results.size(); ++i) {
+		INFO("article #" << i);
+		REQUIRE(results[i] == (i % 3 == 0));
+	}
+	REQUIRE_FALSE(feed->items()[0]->has_description());
+}
@@ -907,3 +907,23 @@ TEST_CASE("quote_and_highlight() keeps stfl-encoded angle brackets and allows ma
 		REQUIRE(input.stfl_quoted() == output);
 	}
 }
+
+TEST_CASE("version() changes whenever rules are added or removed",
+	"[RegexManager]")
+{
+	RegexManager rxman;
+	const auto initial = rxman.version();
+
+	rxman.handle_action("highlight", {"article", "foo", "blue", "red"});
+	const auto after_adding = rxman.version();
+	REQUIRE(after_adding != initial);
+
+	rxman.remove_last_regex(Dialog::Article);
+	REQUIRE(rxman.version() != after_adding);
+	REQUIRE(rxman.version() != initial);
+
+	const auto after_removing = rxman.version();
+	// Nothing left to remove
+	rxman.remove_last_regex(Dialog::Article);
+	REQUIRE(rxman.version() == after_removing);
+}
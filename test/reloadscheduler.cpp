@@ -0,0 +1,206 @@
+#include "reloadscheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+using namespace newsboat;
+
+namespace {
+
+const time_t MINUTE = 60;
+const time_t HOUR = 60 * MINUTE;
+const time_t DAY = 24 * HOUR;
+
+const time_t NOW = 1600000000;
+
+// Jitter is at most a tenth of the interval, and never more than 15 minutes
+void require_next_reload_after(const ReloadSchedule& schedule, time_t interval)
+{
+	INFO("expected interval: " << interval);
+	REQUIRE(schedule.next_reload >= NOW + interval);
+	REQUIRE(schedule.next_reload <= NOW + interval + std::min(interval / 10,
+			15 * MINUTE));
+}
+
+} // namespace
+
+TEST_CASE("publish_interval() returns the average time between articles",
+	"[ReloadScheduler]")
+{
+	SECTION("Not enough articles") {
+		REQUIRE(ReloadScheduler::publish_interval({}) == 0);
+		REQUIRE(ReloadScheduler::publish_interval({NOW}) == 0);
+		REQUIRE(ReloadScheduler::publish_interval({NOW, NOW}) == 0);
+	}
+
+	SECTION("Articles without a date are skipped") {
+		REQUIRE(ReloadScheduler::publish_interval({0, NOW, 0, NOW - HOUR}) == HOUR);
+	}
+
+	SECTION("Order doesn't matter") {
+		REQUIRE(ReloadScheduler::publish_interval({NOW - 2 * HOUR, NOW, NOW - 4 * HOUR})
+			== 2 * HOUR);
+	}
+
+	SECTION("Only the most recent 20 articles are looked at") {
+		std::vector<time_t> pubdates;
+		for (time_t i = 0; i < 20; i++) {
+			pubdates.push_back(NOW - i * HOUR);
+		}
+		// Long before the others
+		pubdates.push_back(NOW - 1000 * DAY);
+		REQUIRE(ReloadScheduler::publish_interval(pubdates) == HOUR);
+	}
+}
+
+TEST_CASE("record_reload() doubles the interval with every reload that brings "
+	"nothing new",
+	"[ReloadScheduler]")
+{
+	const ReloadScheduler scheduler(HOUR, DAY);
+	ReloadSchedule schedule;
+
+	scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+		ReloadScheduler::Outcome::NEW_ARTICLES, {});
+	REQUIRE(schedule.unchanged_reloads == 0);
+	require_next_reload_after(schedule, HOUR);
+
+	scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+		ReloadScheduler::Outcome::UNCHANGED, {});
+	REQUIRE(schedule.unchanged_reloads == 1);
+	require_next_reload_after(schedule, 2 * HOUR);
+
+	scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+		ReloadScheduler::Outcome::UNCHANGED, {});
+	REQUIRE(schedule.unchanged_reloads == 2);
+	require_next_reload_after(schedule, 4 * HOUR);
+
+	SECTION("...but never beyond the maximum") {
+		for (int i = 0; i < 100; i++) {
+			scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+				ReloadScheduler::Outcome::UNCHANGED, {});
+		}
+		require_next_reload_after(schedule, DAY);
+	}
+
+	SECTION("New articles reset the interval") {
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::NEW_ARTICLES, {});
+		REQUIRE(schedule.unchanged_reloads == 0);
+		require_next_reload_after(schedule, HOUR);
+	}
+}
+
+TEST_CASE("record_reload() checks feeds twice as often as they publish "
+	"articles",
+	"[ReloadScheduler]")
+{
+	const ReloadScheduler scheduler(HOUR, DAY);
+	ReloadSchedule schedule;
+	schedule.unchanged_reloads = 10;
+
+	SECTION("Regularly updated feed") {
+		const std::vector<time_t> pubdates = {NOW, NOW - 4 * HOUR, NOW - 8 * HOUR};
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::UNCHANGED, pubdates);
+		REQUIRE(schedule.publish_interval == 4 * HOUR);
+		require_next_reload_after(schedule, 2 * HOUR);
+	}
+
+	SECTION("Feed which publishes more often than the minimum interval") {
+		const std::vector<time_t> pubdates = {NOW, NOW - MINUTE, NOW - 2 * MINUTE};
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::UNCHANGED, pubdates);
+		require_next_reload_after(schedule, HOUR);
+	}
+
+	SECTION("Feed which went quiet is checked less often") {
+		const std::vector<time_t> pubdates = {NOW - 10 * HOUR, NOW - 12 * HOUR, NOW - 14 * HOUR};
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::UNCHANGED, pubdates);
+		require_next_reload_after(schedule, 5 * HOUR);
+	}
+
+	SECTION("Estimate follows changes gradually") {
+		schedule.publish_interval = 8 * HOUR;
+		const std::vector<time_t> pubdates = {NOW, NOW - 4 * HOUR};
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::UNCHANGED, pubdates);
+		REQUIRE(schedule.publish_interval == 7 * HOUR);
+	}
+}
+
+TEST_CASE("record_reload() honors the server's wishes up to the maximum "
+	"interval",
+	"[ReloadScheduler]")
+{
+	const ReloadScheduler scheduler(HOUR, DAY);
+	ReloadSchedule schedule;
+
+	SECTION("Server asks for a longer wait") {
+		schedule.not_before = NOW + 5 * HOUR;
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::NEW_ARTICLES, {});
+		REQUIRE(schedule.next_reload == NOW + 5 * HOUR);
+	}
+
+	SECTION("Server asks for a wait longer than the maximum") {
+		schedule.not_before = NOW + 10 * DAY;
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::NEW_ARTICLES, {});
+		REQUIRE(schedule.next_reload == NOW + DAY);
+	}
+
+	SECTION("Server asks for a shorter wait") {
+		schedule.not_before = NOW + MINUTE;
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::NEW_ARTICLES, {});
+		require_next_reload_after(schedule, HOUR);
+	}
+}
+
+TEST_CASE("record_reload() retries failed reloads as soon as the server "
+	"allows",
+	"[ReloadScheduler]")
+{
+	const ReloadScheduler scheduler(HOUR, DAY);
+	ReloadSchedule schedule;
+	schedule.unchanged_reloads = 3;
+	schedule.publish_interval = 2 * HOUR;
+
+	SECTION("No hint from the server") {
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::FAILED, {NOW});
+		REQUIRE(scheduler.is_due(schedule, NOW + HOUR));
+	}
+
+	SECTION("Server sent Retry-After") {
+		schedule.not_before = NOW + 3 * HOUR;
+		scheduler.record_reload("http://example.com/feed.xml", schedule, NOW,
+			ReloadScheduler::Outcome::FAILED, {NOW});
+		REQUIRE(schedule.next_reload == NOW + 3 * HOUR);
+	}
+
+	REQUIRE(schedule.unchanged_reloads == 3);
+	REQUIRE(schedule.publish_interval == 2 * HOUR);
+}
+
+TEST_CASE("is_due() includes feeds which would be late by the next reload",
+	"[ReloadScheduler]")
+{
+	const ReloadScheduler scheduler(HOUR, DAY);
+	ReloadSchedule schedule;
+
+	REQUIRE(scheduler.is_due(schedule, NOW));
+
+	schedule.next_reload = NOW - MINUTE;
+	REQUIRE(scheduler.is_due(schedule, NOW));
+
+	schedule.next_reload = NOW + 20 * MINUTE;
+	REQUIRE(scheduler.is_due(schedule, NOW));
+
+	schedule.next_reload = NOW + 40 * MINUTE;
+	REQUIRE_FALSE(scheduler.is_due(schedule, NOW));
+}
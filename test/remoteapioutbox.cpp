@@ -0,0 +1,257 @@
+#include "remoteapioutbox.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "remoteapi.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+#include "test_helpers/tempfile.h"
+
+using namespace newsboat;
+
+namespace {
+
+/// Records the calls made to it, and fails them while `failing` is set
+class RecordingApi : public RemoteApi {
+public:
+	explicit RecordingApi(ConfigContainer& c)
+		: RemoteApi(c)
+	{
+	}
+	bool authenticate() override
+	{
+		return true;
+	}
+	std::vector<TaggedFeedUrl> get_subscribed_urls() override
+	{
+		return {};
+	}
+	void add_custom_headers(curl_slist**) override
+	{
+	}
+	bool mark_all_read(const std::string& feedurl) override
+	{
+		feeds_marked_read.push_back(feedurl);
+		return !failing;
+	}
+	bool mark_article_read(const std::string& guid, bool read) override
+	{
+		single_calls.push_back(guid + (read ? " read" : " unread"));
+		return !failing;
+	}
+	bool mark_articles_read(const std::vector<std::string>& guids) override
+	{
+		read_batches.push_back(guids);
+		return !failing;
+	}
+	bool mark_articles_unread(const std::vector<std::string>& guids) override
+	{
+		unread_batches.push_back(guids);
+		return !failing;
+	}
+	bool update_article_flags(const std::string& oldflags,
+		const std::string& newflags,
+		const std::string& guid) override
+	{
+		flag_updates[guid] = oldflags + "->" + newflags;
+		return !failing;
+	}
+
+	bool failing = false;
+	std::vector<std::string> feeds_marked_read;
+	std::vector<std::string> single_calls;
+	std::vector<std::vector<std::string>> read_batches;
+	std::vector<std::vector<std::string>> unread_batches;
+	std::map<std::string, std::string> flag_updates;
+};
+
+/// Stores a feed at \a feedurl with a single unread article \a guid
+void add_feed(Cache& rsscache, const std::string& feedurl,
+	const std::string& guid)
+{
+	RssFeed feed(&rsscache, feedurl);
+	auto item = std::make_shared<RssItem>(&rsscache);
+	item->set_guid(guid);
+	item->set_feedurl(feedurl);
+	item->set_unread_nowrite(true);
+	feed.add_item(item);
+	rsscache.externalize_rssfeed(feed, false);
+}
+
+} // namespace
+
+TEST_CASE("RemoteApiOutbox sends read state changes in batches",
+	"[RemoteApiOutbox]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RecordingApi api(cfg);
+	RemoteApiOutbox outbox(api, *rsscache, "test");
+
+	for (int i = 0; i < 250; ++i) {
+		outbox.mark_article_read(std::to_string(i), true);
+	}
+	outbox.mark_article_read("42", false);
+	outbox.mark_article_read("unread", false);
+
+	REQUIRE(outbox.send_due_changes(1000) == 0);
+
+	REQUIRE(api.single_calls.empty());
+	REQUIRE(api.read_batches.size() == 3);
+	REQUIRE(api.read_batches[0].size() == 100);
+	REQUIRE(api.read_batches[2].size() == 49);
+	REQUIRE(api.unread_batches.size() == 1);
+	REQUIRE(api.unread_batches[0] == std::vector<std::string> {"42", "unread"});
+
+	REQUIRE(rsscache->fetch_remote_outbox("test").empty());
+}
+
+TEST_CASE("RemoteApiOutbox sends the overall change of flags",
+	"[RemoteApiOutbox]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RecordingApi api(cfg);
+	RemoteApiOutbox outbox(api, *rsscache, "test");
+
+	outbox.update_article_flags("", "s", "starred");
+	outbox.update_article_flags("s", "sp", "starred");
+	outbox.update_article_flags("p", "", "toggled");
+	outbox.update_article_flags("", "p", "toggled");
+
+	REQUIRE(outbox.send_due_changes(1000) == 0);
+
+	REQUIRE(api.flag_updates.size() == 1);
+	REQUIRE(api.flag_updates["starred"] == "->sp");
+	REQUIRE(rsscache->fetch_remote_outbox("test").empty());
+}
+
+TEST_CASE("RemoteApiOutbox retries failed changes with a growing delay",
+	"[RemoteApiOutbox]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RecordingApi api(cfg);
+	RemoteApiOutbox outbox(api, *rsscache, "test");
+
+	api.failing = true;
+	outbox.mark_article_read("1", true);
+
+	const time_t first_retry = outbox.send_due_changes(1000);
+	REQUIRE(first_retry == 1000 + RemoteApiOutbox::retry_delay(1));
+
+	// Not due yet
+	REQUIRE(outbox.send_due_changes(1001) == first_retry);
+	REQUIRE(api.read_batches.size() == 1);
+
+	const time_t second_retry = outbox.send_due_changes(first_retry);
+	REQUIRE(second_retry - first_retry == RemoteApiOutbox::retry_delay(2));
+	REQUIRE(api.read_batches.size() == 2);
+
+	api.failing = false;
+	REQUIRE(outbox.send_due_changes(second_retry) == 0);
+	REQUIRE(api.read_batches.size() == 3);
+	REQUIRE(rsscache->fetch_remote_outbox("test").empty());
+}
+
+TEST_CASE("retry_delay() doubles up to an hour", "[RemoteApiOutbox]")
+{
+	REQUIRE(RemoteApiOutbox::retry_delay(1) == 30);
+	REQUIRE(RemoteApiOutbox::retry_delay(2) == 60);
+	REQUIRE(RemoteApiOutbox::retry_delay(3) == 120);
+	REQUIRE(RemoteApiOutbox::retry_delay(8) == 3600);
+	REQUIRE(RemoteApiOutbox::retry_delay(1000) == 3600);
+}
+
+TEST_CASE("Changes which weren't sent are sent by the next outbox",
+	"[RemoteApiOutbox]")
+{
+	test_helpers::TempFile dbfile;
+	ConfigContainer cfg;
+	RecordingApi api(cfg);
+
+	{
+		Cache rsscache(dbfile.get_path(), cfg);
+		RemoteApiOutbox outbox(api, rsscache, "test");
+		outbox.mark_articles_read({"1", "2"});
+	}
+
+	Cache rsscache(dbfile.get_path(), cfg);
+	RemoteApiOutbox outbox(api, rsscache, "test");
+	REQUIRE(outbox.send_due_changes(1000) == 0);
+	REQUIRE(api.read_batches.size() == 1);
+	REQUIRE(api.read_batches[0] == std::vector<std::string> {"1", "2"});
+}
+
+TEST_CASE("Articles queued to be marked unread stay read once their feed is "
+	"marked read",
+	"[RemoteApiOutbox]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RecordingApi api(cfg);
+	RemoteApiOutbox outbox(api, *rsscache, "test");
+
+	add_feed(*rsscache, "https://example.com/a.xml", "a");
+	add_feed(*rsscache, "https://example.com/b.xml", "b");
+	outbox.mark_article_read("a", false);
+	outbox.mark_article_read("b", false);
+
+	// The API marks the whole feed read before the queued change is sent
+	rsscache->mark_all_read("https://example.com/a.xml");
+	outbox.mark_feed_read("https://example.com/a.xml", {"a"});
+	REQUIRE(api.feeds_marked_read ==
+		std::vector<std::string> {"https://example.com/a.xml"});
+
+	REQUIRE(outbox.send_due_changes(1000) == 0);
+	REQUIRE(api.read_batches == std::vector<std::vector<std::string>> {{"a"}});
+	REQUIRE(api.unread_batches == std::vector<std::vector<std::string>> {{"b"}});
+
+	SECTION("Marking all feeds read overrides all of them") {
+		outbox.mark_article_read("a", false);
+		outbox.mark_article_read("b", false);
+		rsscache->mark_all_read();
+
+		const auto entries = rsscache->fetch_remote_outbox("test");
+		REQUIRE(entries.size() == 2);
+		for (const auto& entry : entries) {
+			REQUIRE(entry.read == true);
+		}
+	}
+}
+
+TEST_CASE("mark_feed_read() queues the feed's articles if the API fails",
+	"[RemoteApiOutbox]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RecordingApi api(cfg);
+	RemoteApiOutbox outbox(api, *rsscache, "test");
+
+	SECTION("Nothing is queued if the feed was marked read") {
+		outbox.mark_feed_read("https://example.com/feed.xml", {"1", "2"});
+		REQUIRE(rsscache->fetch_remote_outbox("test").empty());
+	}
+
+	SECTION("The articles are retried if the API failed") {
+		api.failing = true;
+		outbox.mark_feed_read("https://example.com/feed.xml", {"1", "2"});
+
+		const auto entries = rsscache->fetch_remote_outbox("test");
+		REQUIRE(entries.size() == 2);
+		REQUIRE(entries[0].read == true);
+		REQUIRE(entries[1].read == true);
+
+		api.failing = false;
+		REQUIRE(outbox.send_due_changes(1000) == 0);
+		REQUIRE(api.read_batches ==
+			std::vector<std::vector<std::string>> {{"1", "2"}});
+	}
+}
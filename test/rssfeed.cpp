@@ -211,6 +211,97 @@ TEST_CASE("RssFeed::sort() correctly sorts articles", "[RssFeed]")
 	}
 }
 
+TEST_CASE("RssFeed::update_items() keeps query feed in sync with changed "
+	"articles",
+	"[RssFeed]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	auto feed = std::make_shared<RssFeed>(rsscache.get(), "https://example.com/feed.xml");
+	for (int i = 0; i < 5; ++i) {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid(std::to_string(i));
+		item->set_title("Article " + std::to_string(i));
+		feed->add_item(item);
+	}
+	const std::vector<std::shared_ptr<RssFeed>> feeds = {feed};
+
+	RssFeed query(rsscache.get(),
+		"query:Unread:unread = \"yes\" and title =~ \"Article\"");
+	query.update_items(feeds);
+	REQUIRE(query.total_item_count() == 5);
+	REQUIRE(query.evaluated_item_count() == 5);
+
+	SECTION("Only changed articles are matched again") {
+		feed->get_item_by_guid("2")->set_title("Article two");
+		query.update_items(feeds);
+		REQUIRE(query.total_item_count() == 5);
+		REQUIRE(query.evaluated_item_count() == 1);
+	}
+
+	SECTION("Articles that are no longer matched are dropped") {
+		feed->get_item_by_guid("1")->set_unread_nowrite(false);
+		feed->get_item_by_guid("3")->set_title("Something else");
+		query.update_items(feeds);
+		REQUIRE(query.total_item_count() == 3);
+
+		feed->get_item_by_guid("1")->set_unread_nowrite(true);
+		query.update_items(feeds);
+		REQUIRE(query.total_item_count() == 4);
+	}
+
+	SECTION("Added and removed articles are taken into account") {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid("new");
+		item->set_title("Article new");
+		feed->add_item(item);
+		feed->erase_item(feed->items().begin());
+		query.update_items(feeds);
+		REQUIRE(query.total_item_count() == 5);
+		REQUIRE(query.get_item_by_guid("new") == item);
+	}
+
+	SECTION("Articles of a reloaded feed aren't matched again") {
+		auto new_feed = std::make_shared<RssFeed>(rsscache.get(), feed->rssurl());
+		new_feed->add_items(feed->items());
+		query.update_items({new_feed});
+		REQUIRE(query.total_item_count() == 5);
+		REQUIRE(query.evaluated_item_count() == 0);
+		REQUIRE(query.items()[0]->get_feedptr() == new_feed);
+	}
+}
+
+TEST_CASE("RssFeed::update_items() matches articles of a reloaded feed again "
+	"if the query refers to the feed",
+	"[RssFeed]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	auto feed = std::make_shared<RssFeed>(rsscache.get(), "https://example.com/feed.xml");
+	feed->set_title("Old title");
+	for (int i = 0; i < 3; ++i) {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid(std::to_string(i));
+		item->set_title("Article " + std::to_string(i));
+		item->set_feedptr(feed);
+		feed->add_item(item);
+	}
+
+	RssFeed query(rsscache.get(), "query:Old:feedtitle = \"Old title\"");
+	query.update_items({feed});
+	REQUIRE(query.total_item_count() == 3);
+
+	auto new_feed = std::make_shared<RssFeed>(rsscache.get(), feed->rssurl());
+	new_feed->set_title("New title");
+	new_feed->add_items(feed->items());
+	for (const auto& item : new_feed->items()) {
+		item->set_feedptr(new_feed);
+	}
+	query.update_items({new_feed});
+	REQUIRE(query.evaluated_item_count() == 3);
+	REQUIRE(query.total_item_count() == 0);
+}
+
 TEST_CASE("RssFeed::unread_item_count() returns number of unread articles",
 	"[RssFeed]")
 {
@@ -241,6 +332,85 @@ TEST_CASE("RssFeed::unread_item_count() returns number of unread articles",
 	REQUIRE(f.unread_item_count() == 0);
 }
 
+TEST_CASE("RssFeed::unread_item_count() follows articles being added and "
+	"removed",
+	"[RssFeed]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RssFeed f(rsscache.get(), "");
+	for (int i = 0; i < 4; ++i) {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		item->set_guid(std::to_string(i));
+		item->set_unread_nowrite(i % 2 == 0);
+		f.add_item(item);
+	}
+	REQUIRE(f.unread_item_count() == 2);
+
+	SECTION("erase_item()") {
+		f.erase_item(f.items().begin());
+		REQUIRE(f.unread_item_count() == 1);
+		f.erase_item(f.items().begin());
+		REQUIRE(f.unread_item_count() == 1);
+	}
+
+	SECTION("erase_items()") {
+		f.erase_items(f.items().begin(), f.items().end());
+		REQUIRE(f.unread_item_count() == 0);
+	}
+
+	SECTION("set_items()") {
+		const auto item = std::make_shared<RssItem>(rsscache.get());
+		f.set_items({item});
+		REQUIRE(f.unread_item_count() == 1);
+	}
+
+	SECTION("purge_deleted_items()") {
+		f.get_item_by_guid("0")->set_deleted(true);
+		f.get_item_by_guid("1")->set_deleted(true);
+		f.purge_deleted_items();
+		REQUIRE(f.unread_item_count() == 1);
+	}
+
+	SECTION("Removed articles no longer affect the count") {
+		const auto item = f.get_item_by_guid("0");
+		f.erase_item(f.items().begin());
+		item->set_unread_nowrite(false);
+		item->set_unread_nowrite(true);
+		REQUIRE(f.unread_item_count() == 1);
+	}
+
+	SECTION("Articles shared with another feed update both") {
+		RssFeed other(rsscache.get(), "");
+		other.add_items(f.items());
+		REQUIRE(other.unread_item_count() == 2);
+
+		f.get_item_by_guid("0")->set_unread_nowrite(false);
+		REQUIRE(f.unread_item_count() == 1);
+		REQUIRE(other.unread_item_count() == 1);
+	}
+}
+
+TEST_CASE("RssFeed::title() follows changes to the title and tags",
+	"[RssFeed]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RssFeed f(rsscache.get(), "");
+
+	f.set_title("Feed title");
+	REQUIRE(f.title() == "Feed title");
+
+	f.set_tags({"~Title from a tag"});
+	REQUIRE(f.title() == "Title from a tag");
+
+	f.set_title("New feed title");
+	REQUIRE(f.title() == "Title from a tag");
+
+	f.set_tags({"news"});
+	REQUIRE(f.title() == "New feed title");
+}
+
 TEST_CASE("RssFeed::matches_tag() returns true if article has a specified tag",
 	"[RssFeed]")
 {
@@ -298,3 +298,41 @@ TEST_CASE("RssIgnores::matches() returns true if given RssItem matches any "
 		REQUIRE(ignores.matches(&item));
 	}
 }
+
+TEST_CASE("RssIgnores::rules_for() returns the rules which apply to the feed",
+	"[RssIgnores]")
+{
+	RssIgnores ignores;
+	ignores.handle_action("ignore-article", {"https://example.com/feed.xml", "title = \"a\""});
+	ignores.handle_action("ignore-article", {"https://example.org/feed.xml", "title = \"b\""});
+	ignores.handle_action("ignore-article", {"*", "title = \"c\""});
+	ignores.handle_action("ignore-article", {"regex:example\\.com", "title = \"d\""});
+
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RssItem item(rsscache.get());
+	item.set_feedurl("https://example.com/feed.xml");
+
+	const auto rules = ignores.rules_for("https://example.com/feed.xml");
+
+	for (const auto& title : {"a", "c", "d"}) {
+		item.set_title(title);
+		REQUIRE(rules->matches(&item));
+	}
+	item.set_title("b");
+	REQUIRE_FALSE(rules->matches(&item));
+
+	SECTION("The rules are resolved once per feed URL") {
+		REQUIRE(ignores.rules_for("https://example.com/feed.xml") == rules);
+		REQUIRE(ignores.rules_for("https://example.org/feed.xml") != rules);
+	}
+
+	SECTION("Adding a rule makes the rules get resolved again") {
+		ignores.handle_action("ignore-article", {"*", "title = \"b\""});
+
+		const auto updated = ignores.rules_for("https://example.com/feed.xml");
+		REQUIRE(updated != rules);
+		REQUIRE(updated->matches(&item));
+		REQUIRE(ignores.matches(&item));
+	}
+}
@@ -275,3 +275,22 @@ TEST_CASE("set_title() removes superfluous whitespace", "[RssItem]")
 		REQUIRE(item.title() == "lorem ipsum");
 	}
 }
+
+TEST_CASE("Sort keys follow changes to the title and author", "[RssItem]")
+{
+	ConfigContainer cfg;
+	auto rsscache = Cache::in_memory(cfg);
+	RssItem item(rsscache.get());
+
+	item.set_title("First title");
+	item.set_author("First author");
+	REQUIRE(item.title_sort_key() == "First title");
+	REQUIRE(item.author_sort_key() == "First author");
+
+	item.set_title("Second title");
+	REQUIRE(item.title_sort_key() == "Second title");
+	REQUIRE(item.author_sort_key() == "First author");
+
+	item.set_author("Second author");
+	REQUIRE(item.author_sort_key() == "Second author");
+}
@@ -0,0 +1,162 @@
+#include "rss/feedstream.h"
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "3rd-party/catch.hpp"
+#include "rss/exception.h"
+#include "rss/parser.h"
+#include "test_helpers/exceptionwithmsg.h"
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+rsspp::Feed parse_in_chunks(const std::string& data, size_t chunk_size,
+	std::optional<std::string> charset = std::nullopt)
+{
+	rsspp::FeedStream stream("http://example.com/feed.xml", charset);
+	for (size_t i = 0; i < data.size(); i += chunk_size) {
+		stream.parse_chunk(data.data() + i, std::min(chunk_size, data.size() - i));
+	}
+	return stream.finish();
+}
+
+} // namespace
+
+TEST_CASE("finish() returns the same feed as Parser::parse_file(), "
+	"no matter how the data is split up",
+	"[rsspp::FeedStream]")
+{
+	const auto filename = GENERATE(
+			"data/atom10_1.xml",
+			"data/atom10_feed_authors.xml",
+			"data/rss091_1.xml",
+			"data/rss10_1.xml",
+			"data/rss20_1.xml",
+			"data/rss20_2.xml");
+	const auto chunk_size = GENERATE(1, 7, 4096);
+	INFO(filename << " in chunks of " << chunk_size << " bytes");
+
+	rsspp::Parser p;
+	const auto expected = p.parse_file(newsboat::Filepath::from_locale_string(filename));
+	const auto actual = parse_in_chunks(read_file(filename), chunk_size);
+
+	REQUIRE(actual.rss_version == expected.rss_version);
+	REQUIRE(actual.title == expected.title);
+	REQUIRE(actual.description == expected.description);
+	REQUIRE(actual.link == expected.link);
+	REQUIRE(actual.language == expected.language);
+	REQUIRE(actual.pubDate == expected.pubDate);
+	REQUIRE(actual.items.size() == expected.items.size());
+	for (size_t i = 0; i < expected.items.size(); ++i) {
+		REQUIRE(actual.items[i].title == expected.items[i].title);
+		REQUIRE(actual.items[i].link == expected.items[i].link);
+		REQUIRE(actual.items[i].description == expected.items[i].description);
+		REQUIRE(actual.items[i].author == expected.items[i].author);
+		REQUIRE(actual.items[i].guid == expected.items[i].guid);
+		REQUIRE(actual.items[i].pubDate == expected.items[i].pubDate);
+		REQUIRE(actual.items[i].enclosures.size() == expected.items[i].enclosures.size());
+	}
+}
+
+TEST_CASE("finish() picks up feed elements that come after the articles",
+	"[rsspp::FeedStream]")
+{
+	SECTION("RSS 2.0") {
+		const std::string feed =
+			R"(<rss version="2.0"><channel>)"
+			R"(<item><title>First</title></item>)"
+			R"(<item><title>Second</title></item>)"
+			R"(<title>Feed title</title>)"
+			R"(</channel></rss>)";
+
+		const auto f = parse_in_chunks(feed, 5);
+		REQUIRE(f.title == "Feed title");
+		REQUIRE(f.items.size() == 2);
+		REQUIRE(f.items[0].title == "First");
+		REQUIRE(f.items[1].title == "Second");
+	}
+
+	SECTION("Atom feed authors are applied to all entries") {
+		const std::string feed =
+			R"(<feed xmlns="http://www.w3.org/2005/Atom">)"
+			R"(<entry><id>1</id><title>First</title></entry>)"
+			R"(<author><name>Feed author</name></author>)"
+			R"(<entry><id>2</id><title>Second</title></entry>)"
+			R"(</feed>)";
+
+		const auto f = parse_in_chunks(feed, 5);
+		REQUIRE(f.items.size() == 2);
+		REQUIRE(f.items[0].author == "Feed author");
+		REQUIRE(f.items[1].author == "Feed author");
+	}
+}
+
+TEST_CASE("finish() ignores articles outside of the first RSS channel",
+	"[rsspp::FeedStream]")
+{
+	const std::string feed =
+		R"(<rss version="2.0">)"
+		R"(<channel><item><title>Included</title></item></channel>)"
+		R"(<channel><item><title>Ignored</title></item></channel>)"
+		R"(</rss>)";
+
+	const auto f = parse_in_chunks(feed, 3);
+	REQUIRE(f.items.size() == 1);
+	REQUIRE(f.items[0].title == "Included");
+}
+
+TEST_CASE("finish() keeps UTF-8 split between chunks and replaces invalid "
+	"sequences",
+	"[rsspp::FeedStream]")
+{
+	const std::string feed =
+		"<rss version=\"2.0\"><channel>"
+		"<item><title>\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80</title></item>"
+		"<item><title>a\xE2\x82 b \xFF c</title></item>"
+		"</channel></rss>";
+	const auto chunk_size = GENERATE(1, 2, 3, 4096);
+	const auto charset = GENERATE(std::optional<std::string>(),
+			std::optional<std::string>("UTF-8"));
+	INFO("chunks of " << chunk_size << " bytes, charset " << charset.value_or("none"));
+
+	const auto f = parse_in_chunks(feed, chunk_size, charset);
+	REQUIRE(f.items.size() == 2);
+	REQUIRE(f.items[0].title == "\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80");
+	REQUIRE(f.items[1].title == "a\xEF\xBF\xBD b \xEF\xBF\xBD c");
+}
+
+TEST_CASE("finish() throws if the data is not a feed", "[rsspp::FeedStream]")
+{
+	using test_helpers::ExceptionWithMsg;
+
+	SECTION("No data at all") {
+		rsspp::FeedStream stream("http://example.com/feed.xml");
+		REQUIRE_THROWS_MATCHES(stream.finish(),
+			rsspp::Exception,
+			ExceptionWithMsg<rsspp::Exception>("could not parse buffer"));
+	}
+
+	SECTION("Unknown format") {
+		REQUIRE_THROWS_MATCHES(parse_in_chunks("<html><body>Hi</body></html>", 4),
+			rsspp::Exception,
+			ExceptionWithMsg<rsspp::Exception>("unsupported feed format"));
+	}
+
+	SECTION("Missing RSS version") {
+		REQUIRE_THROWS_MATCHES(
+			parse_in_chunks("<rss><channel><item/></channel></rss>", 4),
+			rsspp::Exception,
+			ExceptionWithMsg<rsspp::Exception>("no RSS version"));
+	}
+}
@@ -465,6 +465,62 @@ TEST_CASE("parse_url() extracts etag and lastmodified data", "[rsspp::Parser]")
 	REQUIRE(parser.get_last_modified() == 1445412480);
 }
 
+TEST_CASE("parse_url() extracts the time before which the server shouldn't be "
+	"contacted again",
+	"[rsspp::Parser]")
+{
+	using namespace newsboat;
+
+	auto feed_xml = test_helpers::read_binary_file("data/atom10_1.xml"_path);
+	std::vector<std::pair<std::string, std::string>> headers = {
+		{"content-type", "text/xml"},
+	};
+	time_t expected_delay = 0;
+
+	SECTION("No caching headers") {
+	}
+
+	SECTION("Cache-Control max-age, minus Age") {
+		headers.push_back({"Cache-Control", "public, max-age=3600"});
+		headers.push_back({"Age", "600"});
+		expected_delay = 3000;
+	}
+
+	SECTION("Retry-After in seconds") {
+		headers.push_back({"Retry-After", "7200"});
+		expected_delay = 7200;
+	}
+
+	SECTION("The latest of several hints") {
+		headers.push_back({"Cache-Control", "max-age=60"});
+		headers.push_back({"Retry-After", "1800"});
+		expected_delay = 1800;
+	}
+
+	SECTION("Expiry in the past") {
+		headers.push_back({"Expires", "Wed, 21 Oct 2015 07:28:00 GMT"});
+	}
+
+	auto& test_server = test_helpers::HttpTestServer::get_instance();
+	auto mock_registration = test_server.add_endpoint("/feed", {}, 200, headers,
+			feed_xml);
+	const auto address = test_server.get_address();
+	const auto url = strprintf::fmt("http://%s/feed", address);
+
+	rsspp::Parser parser;
+	CurlHandle easyhandle;
+	const time_t before = time(nullptr);
+	REQUIRE(parser.parse_url(url, easyhandle).has_value());
+	const time_t after = time(nullptr);
+
+	if (expected_delay == 0) {
+		REQUIRE(parser.get_not_before() == 0);
+	} else {
+		REQUIRE(parser.get_not_before() >= before + expected_delay);
+		REQUIRE(parser.get_not_before() <= after + expected_delay);
+	}
+}
+
 // Placeholders:
 // %s: encoding
 // %s: feed title
@@ -0,0 +1,150 @@
+#include "segmentedfile.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "3rd-party/catch.hpp"
+#include "test_helpers/tempdir.h"
+
+using namespace newsboat;
+using namespace podboat;
+
+namespace {
+
+std::uint64_t file_size(const Filepath& path)
+{
+	struct stat sb;
+	REQUIRE(stat(path.to_locale_string().c_str(), &sb) == 0);
+	return sb.st_size;
+}
+
+std::string read_file(const Filepath& path)
+{
+	std::ifstream f(path.to_locale_string());
+	std::stringstream contents;
+	contents << f.rdbuf();
+	return contents.str();
+}
+
+} // namespace
+
+TEST_CASE("SegmentedFile::open() allocates the whole file and splits it into "
+	"segments", "[SegmentedFile]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("episode.mp3.part"_path);
+
+	SegmentedFile file;
+	REQUIRE(file.open(path, 10, 3));
+
+	REQUIRE(file_size(path) == 10);
+	REQUIRE(file.segment_count() == 3);
+	REQUIRE(file.segment(0) == std::make_pair<std::uint64_t, std::uint64_t>(0, 3));
+	REQUIRE(file.segment(1) == std::make_pair<std::uint64_t, std::uint64_t>(3, 3));
+	// The last segment takes the remainder
+	REQUIRE(file.segment(2) == std::make_pair<std::uint64_t, std::uint64_t>(6, 4));
+	REQUIRE_FALSE(file.is_done(0));
+	REQUIRE_FALSE(file.is_complete());
+	REQUIRE(file.completed_bytes() == 0);
+	REQUIRE(SegmentedFile::has_journal(path));
+}
+
+TEST_CASE("SegmentedFile writes segments in any order", "[SegmentedFile]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("episode.mp3.part"_path);
+
+	SegmentedFile file;
+	REQUIRE(file.open(path, 10, 3));
+	REQUIRE(file.write(6, "ghij", 4));
+	REQUIRE(file.mark_done(2));
+	REQUIRE(file.write(0, "abc", 3));
+	REQUIRE(file.mark_done(0));
+	REQUIRE(file.write(3, "def", 3));
+	REQUIRE(file.mark_done(1));
+	file.close();
+
+	REQUIRE(file.is_complete());
+	REQUIRE(file.completed_bytes() == 10);
+	REQUIRE(read_file(path) == "abcdefghij");
+}
+
+TEST_CASE("SegmentedFile::open() picks up segments recorded in the journal",
+	"[SegmentedFile]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("episode.mp3.part"_path);
+
+	{
+		SegmentedFile file;
+		REQUIRE(file.open(path, 10, 3));
+		REQUIRE(file.write(3, "def", 3));
+		REQUIRE(file.mark_done(1));
+		// Written, but never finished
+		REQUIRE(file.write(0, "ab", 2));
+	}
+
+	SECTION("same size and number of segments: finished segments are kept") {
+		SegmentedFile file;
+		REQUIRE(file.open(path, 10, 3));
+		REQUIRE_FALSE(file.is_done(0));
+		REQUIRE(file.is_done(1));
+		REQUIRE_FALSE(file.is_done(2));
+		REQUIRE(file.completed_bytes() == 3);
+		file.close();
+		REQUIRE(read_file(path).substr(3, 3) == "def");
+	}
+
+	SECTION("different size: the download starts over") {
+		SegmentedFile file;
+		REQUIRE(file.open(path, 12, 3));
+		REQUIRE(file.completed_bytes() == 0);
+		REQUIRE(file_size(path) == 12);
+	}
+
+	SECTION("different number of segments: the download starts over") {
+		SegmentedFile file;
+		REQUIRE(file.open(path, 10, 2));
+		REQUIRE(file.completed_bytes() == 0);
+	}
+}
+
+TEST_CASE("SegmentedFile::open() starts over if the file doesn't match the "
+	"journal", "[SegmentedFile]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("episode.mp3.part"_path);
+
+	{
+		SegmentedFile file;
+		REQUIRE(file.open(path, 10, 2));
+		REQUIRE(file.write(0, "abcde", 5));
+		REQUIRE(file.mark_done(0));
+	}
+	REQUIRE(truncate(path.to_locale_string().c_str(), 5) == 0);
+
+	SegmentedFile file;
+	REQUIRE(file.open(path, 10, 2));
+	REQUIRE_FALSE(file.is_done(0));
+	REQUIRE(file_size(path) == 10);
+}
+
+TEST_CASE("SegmentedFile::sync() records finished segments in the journal",
+	"[SegmentedFile]")
+{
+	test_helpers::TempDir tmp;
+	const auto path = tmp.get_path().join("episode.mp3.part"_path);
+
+	SegmentedFile file;
+	REQUIRE(file.open(path, 10, 3));
+	REQUIRE(file.write(3, "def", 3));
+	REQUIRE(file.mark_done(1));
+	REQUIRE(file.sync());
+	// Nothing new to record
+	REQUIRE(file.sync());
+
+	REQUIRE(read_file(SegmentedFile::journal_path(path)) == "segments 10 3\n1\n");
+}
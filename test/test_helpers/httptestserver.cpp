@@ -38,7 +38,8 @@ HttpTestServer::MockRegistration HttpTestServer::add_endpoint(const std::string&
 	std::vector<std::pair<std::string, std::string>> expectedHeaders,
 	std::uint16_t status,
 	std::vector<std::pair<std::string, std::string>> responseHeaders,
-	std::vector<std::uint8_t> body)
+	std::vector<std::uint8_t> body,
+	std::chrono::milliseconds delay)
 {
 	process.write_line("add_endpoint");
 	process.write_line(path);
@@ -60,6 +61,8 @@ HttpTestServer::MockRegistration HttpTestServer::add_endpoint(const std::string&
 	process.write_line(std::to_string(body.size()));
 	process.write_binary(body.data(), body.size());
 
+	process.write_line(std::to_string(delay.count()));
+
 	const auto mockId = process.read_line();
 
 	// Use shared_ptr's custom deleter feature to automatically remove endpoint
@@ -3,6 +3,7 @@
 
 #include "inputoutputprocess.h"
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -29,11 +30,13 @@ public:
 	std::string get_address();
 
 	// Returns a `MockRegistration` with a lifetime object which will remove the endpoint when it goes out of scope
+	// `delay` is waited before each response is sent, to simulate slow servers
 	MockRegistration add_endpoint(const std::string& path,
 		std::vector<std::pair<std::string, std::string>> expectedHeaders,
 		std::uint16_t status,
 		std::vector<std::pair<std::string, std::string>> responseHeaders,
-		std::vector<std::uint8_t> body);
+		std::vector<std::uint8_t> body,
+		std::chrono::milliseconds delay = std::chrono::milliseconds(0));
 
 	std::uint32_t num_hits(MockRegistration& mockRegistration);
 
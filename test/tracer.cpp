@@ -0,0 +1,199 @@
+#include "tracer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "3rd-party/json.hpp"
+#include "scopemeasure.h"
+#include "test_helpers/tempfile.h"
+
+using namespace newsboat;
+
+namespace {
+
+// Enables the tracer and drops previously recorded spans upon construction,
+// and disables it upon destruction
+class TracerEnabler {
+public:
+	TracerEnabler()
+	{
+		tracer::reset();
+		tracer::enable();
+	}
+
+	~TracerEnabler()
+	{
+		tracer::disable();
+		tracer::reset();
+	}
+};
+
+nlohmann::json spans_in_trace()
+{
+	std::ostringstream out;
+	tracer::write_trace(out);
+	const auto trace = nlohmann::json::parse(out.str());
+
+	nlohmann::json result = nlohmann::json::array();
+	for (const auto& event : trace["traceEvents"]) {
+		if (event["ph"] == "X") {
+			result.push_back(event);
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("record() does nothing if the tracer is not enabled", "[tracer]")
+{
+	tracer::reset();
+	REQUIRE_FALSE(tracer::is_enabled());
+
+	const auto now = tracer::Clock::now();
+	tracer::record("span", "", now, now);
+
+	REQUIRE(spans_in_trace().empty());
+}
+
+TEST_CASE("write_trace() writes recorded spans as complete events", "[tracer]")
+{
+	TracerEnabler enabler;
+
+	const auto start = tracer::Clock::now();
+	const auto end = start + std::chrono::milliseconds(5);
+	tracer::record("Cache::externalize_feed", "https://example.com/feed.xml",
+		start, end);
+	tracer::record("FeedListFormAction::prepare", "", start, end);
+
+	const auto spans = spans_in_trace();
+	REQUIRE(spans.size() == 2);
+
+	REQUIRE(spans[0]["name"] == "Cache::externalize_feed");
+	REQUIRE(spans[0]["dur"] == 5000);
+	REQUIRE(spans[0]["args"]["feed"] == "https://example.com/feed.xml");
+
+	REQUIRE(spans[1]["name"] == "FeedListFormAction::prepare");
+	REQUIRE_FALSE(spans[1].contains("args"));
+}
+
+TEST_CASE("Spans recorded by different threads get different thread IDs",
+	"[tracer]")
+{
+	TracerEnabler enabler;
+
+	const auto now = tracer::Clock::now();
+	tracer::record("main", "", now, now);
+	std::thread worker([&now]() {
+		tracer::record("worker", "", now, now);
+	});
+	worker.join();
+
+	const auto spans = spans_in_trace();
+	REQUIRE(spans.size() == 2);
+	REQUIRE(spans[0]["tid"] != spans[1]["tid"]);
+}
+
+TEST_CASE("The trace can be written while other threads record spans",
+	"[tracer]")
+{
+	TracerEnabler enabler;
+
+	std::atomic<bool> stop(false);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < 4; ++i) {
+		workers.emplace_back([&stop]() {
+			for (int j = 0; j < 2000 && !stop; ++j) {
+				const auto now = tracer::Clock::now();
+				tracer::record("worker", "https://example.com/", now, now);
+			}
+		});
+	}
+
+	for (int i = 0; i < 5; ++i) {
+		const auto spans = spans_in_trace();
+		for (const auto& span : spans) {
+			REQUIRE(span["name"] == "worker");
+		}
+	}
+	// Recording is resumed once the trace is written
+	REQUIRE(tracer::is_enabled());
+
+	stop = true;
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+TEST_CASE("ScopeMeasure records a span while the tracer is enabled",
+	"[tracer][ScopeMeasure]")
+{
+	TracerEnabler enabler;
+
+	{
+		ScopeMeasure sm("scope", "https://example.com/");
+		sm.stopover("halfway");
+	}
+
+	const auto spans = spans_in_trace();
+	REQUIRE(spans.size() == 2);
+	REQUIRE(spans[0]["name"] == "scope (halfway)");
+	REQUIRE(spans[1]["name"] == "scope");
+	REQUIRE(spans[1]["args"]["feed"] == "https://example.com/");
+}
+
+TEST_CASE("write_summary() writes one line per span name", "[tracer]")
+{
+	TracerEnabler enabler;
+
+	const auto start = tracer::Clock::now();
+	for (int i = 1; i <= 10; ++i) {
+		tracer::record("fast", "", start, start + std::chrono::microseconds(i * 10));
+	}
+	tracer::record("slow", "", start, start + std::chrono::seconds(2));
+
+	std::ostringstream out;
+	tracer::write_summary(out);
+
+	std::istringstream in(out.str());
+	std::string header;
+	std::getline(in, header);
+	REQUIRE(header.find("p99_ms") != std::string::npos);
+
+	std::string line;
+	std::getline(in, line);
+	// count, total, mean, p50, p90, p99, max, then the histogram
+	REQUIRE(line == "      10      0.550     0.055     0.050     0.090     0.090     0.100"
+		"       9       1       0       0       0       0  fast");
+	std::getline(in, line);
+	REQUIRE(line.find("  slow") == line.size() - 6);
+
+	REQUIRE_FALSE(std::getline(in, line));
+}
+
+TEST_CASE("write_files() writes the trace and the summary", "[tracer]")
+{
+	TracerEnabler enabler;
+	test_helpers::TempFile trace_file;
+
+	const auto now = tracer::Clock::now();
+	tracer::record("span", "", now, now);
+
+	REQUIRE(tracer::write_files(trace_file.get_path()));
+	REQUIRE_FALSE(tracer::is_enabled());
+
+	std::ifstream trace(trace_file.get_path().to_locale_string());
+	REQUIRE(nlohmann::json::parse(trace)["traceEvents"].size() > 0);
+
+	Filepath summary_path = trace_file.get_path();
+	summary_path.add_extension("summary");
+	std::ifstream summary(summary_path.to_locale_string());
+	REQUIRE(summary.good());
+	std::remove(summary_path.to_locale_string().c_str());
+}
@@ -1506,6 +1506,26 @@ TEST_CASE("string_from_utf8_lossy() replaces invalid utf-8 code units with repla
 	REQUIRE(output == "abc�def");
 }
 
+TEST_CASE("is_valid_utf8() returns true only for valid UTF-8", "[utils]")
+{
+	REQUIRE(utils::is_valid_utf8(""));
+	REQUIRE(utils::is_valid_utf8("abc"));
+	REQUIRE(utils::is_valid_utf8("\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80"));
+	REQUIRE(utils::is_valid_utf8(std::string("a\0b", 3)));
+
+	REQUIRE_FALSE(utils::is_valid_utf8("abc" "\x81" "def"));
+	REQUIRE_FALSE(utils::is_valid_utf8("\xE2\x82"));
+	REQUIRE_FALSE(utils::is_valid_utf8("\xFF"));
+}
+
+TEST_CASE("sanitize_utf8() returns valid UTF-8 unchanged and replaces invalid "
+	"code units",
+	"[utils]")
+{
+	REQUIRE(utils::sanitize_utf8("caf\xC3\xA9") == "caf\xC3\xA9");
+	REQUIRE(utils::sanitize_utf8("abc" "\x81" "def") == "abc\xEF\xBF\xBD" "def");
+}
+
 TEST_CASE("parse_rss_author_email() extracts name and email from string",
 	"[utils]")
 {
@@ -0,0 +1,175 @@
+#include "workstealingqueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "curlhandle.h"
+#include "strprintf.h"
+#include "test_helpers/httptestserver.h"
+
+using namespace newsboat;
+
+TEST_CASE("next() hands out the worker's own range front to back",
+	"[WorkStealingQueue]")
+{
+	WorkStealingQueue queue(10, 2);
+	REQUIRE(queue.workers_count() == 2);
+
+	unsigned int index = 0;
+	for (unsigned int expected = 0; expected < 5; ++expected) {
+		REQUIRE(queue.next(0, index));
+		REQUIRE(index == expected);
+	}
+	for (unsigned int expected = 5; expected < 10; ++expected) {
+		REQUIRE(queue.next(1, index));
+		REQUIRE(index == expected);
+	}
+	REQUIRE_FALSE(queue.next(0, index));
+	REQUIRE_FALSE(queue.next(1, index));
+}
+
+TEST_CASE("next() steals from the back of the biggest remaining range",
+	"[WorkStealingQueue]")
+{
+	WorkStealingQueue queue(9, 3);
+	unsigned int index = 0;
+
+	// Worker 2 finishes its own range [6, 9)
+	for (int i = 0; i < 3; ++i) {
+		REQUIRE(queue.next(2, index));
+	}
+	// Worker 0 made some progress on [0, 3)
+	REQUIRE(queue.next(0, index));
+	REQUIRE(index == 0);
+
+	// Worker 1 hasn't started on [3, 6), so that's the biggest range left
+	REQUIRE(queue.next(2, index));
+	REQUIRE(index == 5);
+
+	// Worker 1 carries on with what is left of its range, [3, 5)
+	REQUIRE(queue.next(1, index));
+	REQUIRE(index == 3);
+
+	// Worker 0's range [1, 3) is now the biggest one
+	REQUIRE(queue.next(2, index));
+	REQUIRE(index == 2);
+}
+
+TEST_CASE("Every index is handed out exactly once, even with concurrent workers",
+	"[WorkStealingQueue]")
+{
+	const unsigned int size = 10000;
+	const unsigned int num_workers = 8;
+	WorkStealingQueue queue(size, num_workers);
+
+	std::mutex seen_mutex;
+	std::vector<unsigned int> seen;
+	std::vector<std::thread> threads;
+	for (unsigned int worker = 0; worker < num_workers; ++worker) {
+		threads.emplace_back([&, worker]() {
+			std::vector<unsigned int> mine;
+			unsigned int index = 0;
+			while (queue.next(worker, index)) {
+				mine.push_back(index);
+			}
+			std::lock_guard<std::mutex> guard(seen_mutex);
+			seen.insert(seen.end(), mine.begin(), mine.end());
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	REQUIRE(seen.size() == size);
+	std::sort(seen.begin(), seen.end());
+	for (unsigned int i = 0; i < size; ++i) {
+		REQUIRE(seen[i] == i);
+	}
+}
+
+TEST_CASE("Workers never get more workers than items", "[WorkStealingQueue]")
+{
+	SECTION("Fewer items than workers") {
+		WorkStealingQueue queue(2, 5);
+		REQUIRE(queue.workers_count() == 2);
+
+		unsigned int index = 0;
+		REQUIRE(queue.next(4, index));
+		REQUIRE(queue.next(4, index));
+		REQUIRE_FALSE(queue.next(4, index));
+	}
+
+	SECTION("No items at all") {
+		WorkStealingQueue queue(0, 3);
+		unsigned int index = 0;
+		REQUIRE_FALSE(queue.next(0, index));
+	}
+}
+
+TEST_CASE("Idle workers take over slow downloads, which shortens the tail",
+	"[WorkStealingQueue]")
+{
+	auto& testServer = test_helpers::HttpTestServer::get_instance();
+	const auto address = testServer.get_address();
+	const auto delay = std::chrono::milliseconds(500);
+
+	auto slowRegistration = testServer.add_endpoint("/slow", {}, 200, {}, {}, delay);
+	auto fastRegistration = testServer.add_endpoint("/fast", {}, 200, {}, {});
+
+	// With static partitioning, worker 0 would get items 0 to 3, three of
+	// which are slow, and would download them one after another
+	const std::set<unsigned int> slow_items = {0, 1, 2};
+	const unsigned int num_items = 8;
+	const unsigned int num_workers = 2;
+
+	WorkStealingQueue queue(num_items, num_workers);
+	std::vector<unsigned int> processed(num_workers, 0);
+
+	std::mutex slow_mutex;
+	unsigned int slow_running = 0;
+	unsigned int max_slow_running = 0;
+
+	std::vector<std::thread> threads;
+	for (unsigned int worker = 0; worker < num_workers; ++worker) {
+		threads.emplace_back([&, worker]() {
+			CurlHandle easyhandle;
+			unsigned int index = 0;
+			while (queue.next(worker, index)) {
+				const bool slow = slow_items.count(index) > 0;
+				const auto url = strprintf::fmt("http://%s/%s", address,
+						slow ? "slow" : "fast");
+				if (slow) {
+					std::lock_guard<std::mutex> guard(slow_mutex);
+					slow_running++;
+					max_slow_running = std::max(max_slow_running, slow_running);
+				}
+				curl_easy_reset(easyhandle.ptr());
+				curl_easy_setopt(easyhandle.ptr(), CURLOPT_URL, url.c_str());
+				curl_easy_perform(easyhandle.ptr());
+				if (slow) {
+					std::lock_guard<std::mutex> guard(slow_mutex);
+					slow_running--;
+				}
+				processed[worker]++;
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	REQUIRE(testServer.num_hits(slowRegistration) == slow_items.size());
+	REQUIRE(testServer.num_hits(fastRegistration) == num_items - slow_items.size());
+
+	// Worker 1 finished its own four items and then stole from worker 0,
+	// downloading a slow item while worker 0 was busy with another one
+	REQUIRE(processed[1] > num_items / num_workers);
+	REQUIRE(max_slow_running == num_workers);
+}